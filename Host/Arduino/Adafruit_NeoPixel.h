@@ -0,0 +1,34 @@
+/**
+ * @file Adafruit_NeoPixel.h
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Host replacement of Adafruit's NeoPixel
+ * library. Nothing is shown.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+#pragma once
+
+// - INCLUDES - //
+#include "Arduino.h"
+
+// - DEFINES - //
+#define NEO_GRB 0x52
+#define NEO_KHZ800 0x0000
+
+class Adafruit_NeoPixel
+{
+public:
+    Adafruit_NeoPixel() {}
+    Adafruit_NeoPixel(uint16_t count, int16_t pin, uint16_t type) {}
+    void begin() {}
+    void show() {}
+    bool canShow() { return true; }
+    void clear() {}
+    void setPin(int16_t pin) {}
+    void setPixelColor(uint16_t index, uint32_t colour) {}
+    void setPixelColor(uint16_t index, uint8_t red, uint8_t green, uint8_t blue) {}
+    static uint32_t Color(uint8_t red, uint8_t green, uint8_t blue) { return ((uint32_t)red << 16) | ((uint32_t)green << 8) | blue; }
+};
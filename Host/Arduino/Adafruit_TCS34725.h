@@ -0,0 +1,28 @@
+/**
+ * @file Adafruit_TCS34725.h
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Host replacement of Adafruit's TCS34725 colour
+ * sensor library. Every colour read is 0.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+#pragma once
+
+// - INCLUDES - //
+#include "Arduino.h"
+
+// - DEFINES - //
+#define TCS34725_INTEGRATIONTIME_50MS 0xEB
+#define TCS34725_GAIN_4X 0x01
+
+class Adafruit_TCS34725
+{
+public:
+    Adafruit_TCS34725(uint8_t integrationTime, uint8_t gain) {}
+    bool begin() { return true; }
+    void setInterrupt(bool enabled) {}
+    void getRawData(uint16_t* red, uint16_t* green, uint16_t* blue, uint16_t* clear) { *red = 0; *green = 0; *blue = 0; *clear = 0; }
+};
@@ -0,0 +1,275 @@
+/**
+ * @file Arduino.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * File containing the host replacement of the
+ * Arduino core: its virtual clock, its pins and
+ * its serial ports. See Host.hpp
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Arduino.h"
+#include "Host.hpp"
+#include <stdio.h>
+
+// - GLOBAL LOCAL ACCESS - //
+HardwareSerial Serial;
+HardwareSerial Serial1;
+HardwareSerial Serial2;
+HardwareSerial Serial3;
+
+/// @brief Virtual clock. Only moved by @ref Host_SetTime_us and delay.
+unsigned long long _hostTime_us = 0;
+
+int _digitalPins[NUM_DIGITAL_PINS];
+int _analogPins[NUM_DIGITAL_PINS];
+unsigned long _pulses_us[NUM_DIGITAL_PINS];
+
+/// @brief State of random. Changed by randomSeed.
+unsigned long _randomState = 1;
+
+// #pragma region [String]
+
+String::String(double value, unsigned char decimals)
+{
+    char text[32];
+    snprintf(text, sizeof(text), "%.*f", decimals, value);
+    _text = text;
+}
+
+bool String::endsWith(const String& suffix) const
+{
+    if(suffix._text.size() > _text.size()) return false;
+    return _text.compare(_text.size() - suffix._text.size(), suffix._text.size(), suffix._text) == 0;
+}
+
+int String::indexOf(char character) const
+{
+    size_t index = _text.find(character);
+    return (index == std::string::npos) ? -1 : (int)index;
+}
+
+String String::substring(unsigned int from) const
+{
+    if(from >= _text.size()) return String();
+    return String(_text.substr(from));
+}
+
+String String::substring(unsigned int from, unsigned int to) const
+{
+    if(from >= _text.size() || to <= from) return String();
+    return String(_text.substr(from, to - from));
+}
+
+// #pragma endregion
+
+// #pragma region [Serial]
+
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+    size_t written = 0;
+    while(written < size && write(buffer[written])) written++;
+    return written;
+}
+
+int HardwareSerial::available()
+{
+    return _rxCount;
+}
+
+int HardwareSerial::read()
+{
+    int character = peek();
+    if(character < 0) return -1;
+    _rxOldest = (_rxOldest + 1) % SERIAL_RX_BUFFER_SIZE;
+    _rxCount--;
+    return character;
+}
+
+int HardwareSerial::peek()
+{
+    if(_rxCount == 0) return -1;
+    return _rx[_rxOldest];
+}
+
+int HardwareSerial::availableForWrite()
+{
+    // Like the Mega, one byte of the buffer is never used.
+    if(_echo) return SERIAL_TX_BUFFER_SIZE - 1;
+    return SERIAL_TX_BUFFER_SIZE - 1 - _txCount;
+}
+
+size_t HardwareSerial::write(uint8_t character)
+{
+    if(_echo)
+    {
+        fputc(character, stdout);
+        return 1;
+    }
+
+    // The Mega would wait for space. Nothing empties the buffer while the firmware runs on the host.
+    if(_txCount >= SERIAL_TX_BUFFER_SIZE - 1) return 0;
+    _tx[(_txOldest + _txCount) % SERIAL_TX_BUFFER_SIZE] = character;
+    _txCount++;
+    return 1;
+}
+
+/**
+ * @brief
+ * Gives a byte to the port as if the UART just
+ * received it.
+ * @param character
+ * The received byte.
+ * @return true:
+ * The byte was saved in the RX buffer.
+ * @return false:
+ * The RX buffer was full. The byte is lost like
+ * on the Mega.
+ */
+bool HardwareSerial::Host_Receive(uint8_t character)
+{
+    if(_rxCount >= SERIAL_RX_BUFFER_SIZE - 1)
+    {
+        _rxOverruns++;
+        return false;
+    }
+    _rx[(_rxOldest + _rxCount) % SERIAL_RX_BUFFER_SIZE] = character;
+    _rxCount++;
+    return true;
+}
+
+/**
+ * @brief
+ * Takes the oldest byte of the TX buffer as if
+ * the UART just sent it.
+ * @return int:
+ * The byte or -1 if there is nothing to send.
+ */
+int HardwareSerial::Host_Transmit()
+{
+    int character = 0;
+
+    if(_txCount == 0) return -1;
+    character = _tx[_txOldest];
+    _txOldest = (_txOldest + 1) % SERIAL_TX_BUFFER_SIZE;
+    _txCount--;
+    return character;
+}
+
+// #pragma endregion
+
+// #pragma region [Time]
+
+void Host_SetTime_us(unsigned long long time_us)
+{
+    if(time_us > _hostTime_us) _hostTime_us = time_us;
+}
+
+unsigned long long Host_GetTime_us()
+{
+    return _hostTime_us;
+}
+
+unsigned long millis()
+{
+    // Wraps around like the Mega's 32 bits counter.
+    return (uint32_t)(_hostTime_us / 1000);
+}
+
+unsigned long micros()
+{
+    return (uint32_t)_hostTime_us;
+}
+
+void delay(unsigned long milliseconds)
+{
+    _hostTime_us += milliseconds * 1000ULL;
+}
+
+void delayMicroseconds(unsigned int microseconds)
+{
+    _hostTime_us += microseconds;
+}
+
+// #pragma endregion
+
+// #pragma region [Pins]
+
+void Host_SetDigitalPin(uint8_t pin, int value)
+{
+    if(pin < NUM_DIGITAL_PINS) _digitalPins[pin] = value;
+}
+
+int Host_GetDigitalPin(uint8_t pin)
+{
+    return (pin < NUM_DIGITAL_PINS) ? _digitalPins[pin] : LOW;
+}
+
+void Host_SetAnalogPin(uint8_t pin, int value)
+{
+    if(pin < NUM_DIGITAL_PINS) _analogPins[pin] = value;
+}
+
+void Host_SetPulse(uint8_t pin, unsigned long duration_us)
+{
+    if(pin < NUM_DIGITAL_PINS) _pulses_us[pin] = duration_us;
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+}
+
+int digitalRead(uint8_t pin)
+{
+    return Host_GetDigitalPin(pin);
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    Host_SetDigitalPin(pin, value);
+}
+
+int analogRead(uint8_t pin)
+{
+    return (pin < NUM_DIGITAL_PINS) ? _analogPins[pin] : 0;
+}
+
+void analogWrite(uint8_t pin, int value)
+{
+    Host_SetAnalogPin(pin, value);
+}
+
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout_us)
+{
+    if(pin >= NUM_DIGITAL_PINS || _pulses_us[pin] > timeout_us) return 0;
+    _hostTime_us += _pulses_us[pin];
+    return _pulses_us[pin];
+}
+
+// #pragma endregion
+
+// #pragma region [Random]
+
+long random(long maximum)
+{
+    if(maximum <= 0) return 0;
+    // Linear congruential generator. Same sequence on every run.
+    _randomState = (_randomState * 1103515245UL + 12345UL) & 0x7FFFFFFFUL;
+    return (long)(_randomState % (unsigned long)maximum);
+}
+
+long random(long minimum, long maximum)
+{
+    if(minimum >= maximum) return minimum;
+    return minimum + random(maximum - minimum);
+}
+
+void randomSeed(unsigned long seed)
+{
+    if(seed != 0) _randomState = seed;
+}
+
+// #pragma endregion
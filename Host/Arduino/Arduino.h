@@ -0,0 +1,233 @@
+/**
+ * @file Arduino.h
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Host replacement of the Arduino core used to
+ * build XFactor's and SafeBox's sources natively
+ * for the tests and benchmarks of Host/.
+ * Only what the two projects use is declared.
+ *
+ * @attention
+ * Time is virtual. It only moves when the host
+ * program calls @ref Host_SetTime_us or when the
+ * firmware calls delay. Serial ports keep what
+ * is written to them in a 64 bytes buffer that
+ * the host program empties. See Host.hpp
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+#pragma once
+
+// - INCLUDES - //
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+
+// - DEFINES - //
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+#define PI 3.1415926535897932384626433832795
+
+/// @brief Size of the RX and TX buffers of a serial port. Same as the Mega's.
+#define SERIAL_RX_BUFFER_SIZE 64
+#define SERIAL_TX_BUFFER_SIZE 64
+
+/// @brief How many digital pins the Mega has. Analog pins follow them.
+#define NUM_DIGITAL_PINS 70
+#define A0 54
+#define A1 55
+#define A2 56
+#define A3 57
+#define A4 58
+#define A5 59
+#define A6 60
+#define A7 61
+#define A8 62
+#define A9 63
+#define A10 64
+#define A11 65
+#define A12 66
+#define A13 67
+#define A14 68
+#define A15 69
+
+// There is no flash on the host. Constants stay where they are.
+#define PROGMEM
+#define PSTR(s) (s)
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define pgm_read_word(address) (*(const uint16_t*)(address))
+#define memcpy_P memcpy
+#define strlen_P strlen
+
+// The host program and the firmware never run at the same time.
+#define noInterrupts()
+#define interrupts()
+#define cli()
+#define sei()
+
+#define square(x) ((x)*(x))
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+template<class T, class L, class H> T constrain(T value, L low, H high)
+{
+    return value < low ? low : (value > high ? high : value);
+}
+
+/**
+ * @brief
+ * Arduino's String, kept in a std::string.
+ */
+class String
+{
+public:
+    String() {}
+    String(const char* text) : _text(text ? text : "") {}
+    String(const std::string& text) : _text(text) {}
+    String(char character) : _text(1, character) {}
+    String(unsigned char value) : _text(std::to_string((unsigned int)value)) {}
+    String(int value) : _text(std::to_string(value)) {}
+    String(unsigned int value) : _text(std::to_string(value)) {}
+    String(long value) : _text(std::to_string(value)) {}
+    String(unsigned long value) : _text(std::to_string(value)) {}
+    String(long long value) : _text(std::to_string(value)) {}
+    String(unsigned long long value) : _text(std::to_string(value)) {}
+    String(float value, unsigned char decimals = 2) : String((double)value, decimals) {}
+    String(double value, unsigned char decimals = 2);
+
+    unsigned int length() const { return _text.size(); }
+    const char* c_str() const { return _text.c_str(); }
+    char charAt(unsigned int index) const { return index < _text.size() ? _text[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+    bool concat(const String& other) { _text += other._text; return true; }
+    int compareTo(const String& other) const { return _text.compare(other._text); }
+    bool endsWith(const String& suffix) const;
+    bool startsWith(const String& prefix) const { return _text.compare(0, prefix._text.size(), prefix._text) == 0; }
+    int indexOf(char character) const;
+    String substring(unsigned int from) const;
+    String substring(unsigned int from, unsigned int to) const;
+    long toInt() const { return atol(_text.c_str()); }
+    float toFloat() const { return (float)atof(_text.c_str()); }
+    void reserve(unsigned int size) { _text.reserve(size); }
+
+    String& operator+=(const String& other) { _text += other._text; return *this; }
+    bool operator==(const String& other) const { return _text == other._text; }
+    bool operator!=(const String& other) const { return _text != other._text; }
+    friend String operator+(const String& left, const String& right) { return String(left._text + right._text); }
+
+private:
+    std::string _text;
+};
+
+/**
+ * @brief
+ * Base of everything that can be printed to.
+ */
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t character) = 0;
+    size_t write(const uint8_t* buffer, size_t size);
+    size_t write(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+
+    size_t print(const String& text) { return write(text.c_str()); }
+    size_t print(const char* text) { return write(text); }
+    size_t print(char character) { return write((uint8_t)character); }
+    size_t print(int value) { return print(String(value)); }
+    size_t print(unsigned int value) { return print(String(value)); }
+    size_t print(long value) { return print(String(value)); }
+    size_t print(unsigned long value) { return print(String(value)); }
+    size_t print(double value, int decimals = 2) { return print(String(value, decimals)); }
+
+    template<class T> size_t println(const T& value) { return print(value) + println(); }
+    size_t println() { return write("\r\n"); }
+};
+
+/**
+ * @brief
+ * Base of everything that can be read from.
+ */
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+    virtual void flush() {}
+    void setTimeout(unsigned long timeout_ms) {}
+};
+
+/**
+ * @brief
+ * Serial port of the Mega. Bytes written are
+ * kept in its TX buffer until the host program
+ * takes them with @ref Host_Transmit and bytes
+ * given with @ref Host_Receive are read from
+ * its RX buffer. Both buffers are as big as on
+ * the Mega and drop bytes once full.
+ */
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long baudrate) { _baudrate = baudrate; }
+    void end() { _baudrate = 0; }
+    int available();
+    int read();
+    int peek();
+    int availableForWrite();
+    void flush() {}
+    size_t write(uint8_t character);
+    using Print::write;
+    operator bool() { return true; }
+
+    // - HOST - //
+    unsigned long Host_GetBaudrate() const { return _baudrate; }
+    bool Host_Receive(uint8_t character);
+    int Host_Transmit();
+    int Host_TransmitAvailable() const { return _txCount; }
+    void Host_SetEcho(bool echo) { _echo = echo; }
+    unsigned long Host_GetRxOverruns() const { return _rxOverruns; }
+
+private:
+    unsigned long _baudrate = 0;
+    bool _echo = false;
+    uint8_t _rx[SERIAL_RX_BUFFER_SIZE] = {0};
+    uint8_t _rxOldest = 0;
+    uint8_t _rxCount = 0;
+    unsigned long _rxOverruns = 0;
+    uint8_t _tx[SERIAL_TX_BUFFER_SIZE] = {0};
+    uint8_t _txOldest = 0;
+    uint8_t _txCount = 0;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+extern HardwareSerial Serial2;
+extern HardwareSerial Serial3;
+
+// - FUNCTIONS - //
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long milliseconds);
+void delayMicroseconds(unsigned int microseconds);
+
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+int analogRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+unsigned long pulseIn(uint8_t pin, uint8_t state, unsigned long timeout_us = 1000000L);
+
+long random(long maximum);
+long random(long minimum, long maximum);
+void randomSeed(unsigned long seed);
@@ -0,0 +1,35 @@
+/**
+ * @file EEPROM.h
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Host replacement of the Mega's EEPROM. Kept in
+ * RAM and erased (0xFF) at the start of each
+ * program.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+#pragma once
+
+// - INCLUDES - //
+#include "Arduino.h"
+
+// - DEFINES - //
+/// @brief Size of the Mega's EEPROM.
+#define EEPROM_SIZE 4096
+
+class EEPROMClass
+{
+public:
+    EEPROMClass() { memset(_bytes, 0xFF, sizeof(_bytes)); }
+    uint8_t read(int address) { return (address >= 0 && address < EEPROM_SIZE) ? _bytes[address] : 0xFF; }
+    void write(int address, uint8_t value) { if(address >= 0 && address < EEPROM_SIZE) _bytes[address] = value; }
+    void update(int address, uint8_t value) { write(address, value); }
+    uint16_t length() { return EEPROM_SIZE; }
+
+private:
+    uint8_t _bytes[EEPROM_SIZE];
+};
+
+extern EEPROMClass EEPROM;
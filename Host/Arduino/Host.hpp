@@ -0,0 +1,83 @@
+/**
+ * @file Host.hpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Header file containing the functions that the
+ * host programs of Host/ use to drive the
+ * replacement Arduino core: its virtual clock and
+ * the values read on its pins.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+#pragma once
+
+// - INCLUDES - //
+#include "Arduino.h"
+
+// - FUNCTIONS - //
+
+/**
+ * @brief
+ * Moves the virtual clock to the specified time.
+ * The clock never goes back. A time that is
+ * before the current one is ignored, which
+ * happens after the firmware called delay.
+ * @param time_us
+ * Microseconds since the start of the program.
+ */
+void Host_SetTime_us(unsigned long long time_us);
+
+/**
+ * @brief
+ * Returns the virtual clock in microseconds.
+ * Unlike micros(), it never wraps around.
+ * @return unsigned long long:
+ * Microseconds since the start of the program.
+ */
+unsigned long long Host_GetTime_us();
+
+/**
+ * @brief
+ * Sets the value that digitalRead returns for a
+ * pin. Pins start LOW.
+ * @param pin
+ * Pin number, A0 to A15 included.
+ * @param value
+ * HIGH or LOW.
+ */
+void Host_SetDigitalPin(uint8_t pin, int value);
+
+/**
+ * @brief
+ * Returns the last value given to digitalWrite
+ * for a pin.
+ * @param pin
+ * Pin number, A0 to A15 included.
+ * @return int:
+ * HIGH or LOW.
+ */
+int Host_GetDigitalPin(uint8_t pin);
+
+/**
+ * @brief
+ * Sets the value that analogRead returns for a
+ * pin. Pins start at 0.
+ * @param pin
+ * Pin number, A0 to A15 included.
+ * @param value
+ * 0 to 1023.
+ */
+void Host_SetAnalogPin(uint8_t pin, int value);
+
+/**
+ * @brief
+ * Sets the duration that pulseIn returns for a
+ * pin. Pins start at 0, which is a time out.
+ * @param pin
+ * Pin number, A0 to A15 included.
+ * @param duration_us
+ * Duration of the pulse in microseconds.
+ */
+void Host_SetPulse(uint8_t pin, unsigned long duration_us);
@@ -0,0 +1,66 @@
+/**
+ * @file LibRobus.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * File containing the host replacement of
+ * LibRobus. See LibRobus.h
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "LibRobus.h"
+#include "EEPROM.h"
+#include "Wire.h"
+
+// - GLOBAL LOCAL ACCESS - //
+EEPROMClass EEPROM;
+TwoWire Wire;
+
+int32_t _encoders[2] = {0, 0};
+float _motorSpeeds[2] = {0, 0};
+
+void BoardInit() {}
+void AX_BuzzerON(unsigned int frequency, unsigned long duration_ms) {}
+void AX_BuzzerOFF() {}
+bool AX_IsLowBat() { return false; }
+
+int32_t ENCODER_Read(uint8_t id)
+{
+    return (id < 2) ? _encoders[id] : 0;
+}
+
+int32_t ENCODER_ReadReset(uint8_t id)
+{
+    int32_t pulses = ENCODER_Read(id);
+    ENCODER_Reset(id);
+    return pulses;
+}
+
+void ENCODER_Reset(uint8_t id)
+{
+    if(id < 2) _encoders[id] = 0;
+}
+
+void MOTOR_SetSpeed(uint8_t id, float speed)
+{
+    if(id < 2) _motorSpeeds[id] = speed;
+}
+
+void SERVO_Enable(uint8_t id) {}
+void SERVO_Disable(uint8_t id) {}
+void SERVO_SetAngle(uint8_t id, uint8_t angle) {}
+
+void IR_Init(uint8_t id) {}
+uint16_t IR_Read(uint8_t id) { return 0; }
+
+void Host_SetEncoder(uint8_t id, int32_t pulses)
+{
+    if(id < 2) _encoders[id] = pulses;
+}
+
+float Host_GetMotorSpeed(uint8_t id)
+{
+    return (id < 2) ? _motorSpeeds[id] : 0;
+}
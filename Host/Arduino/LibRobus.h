@@ -0,0 +1,61 @@
+/**
+ * @file LibRobus.h
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Host replacement of LibRobus. Encoders are
+ * set by the host program and motor speeds are
+ * saved so that it can read them back.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+#pragma once
+
+// - INCLUDES - //
+#include "Arduino.h"
+
+// - DEFINES - //
+#define LEFT 0
+#define RIGHT 1
+
+// - FUNCTIONS - //
+void BoardInit();
+void AX_BuzzerON(unsigned int frequency = 2000, unsigned long duration_ms = 0);
+void AX_BuzzerOFF();
+bool AX_IsLowBat();
+
+int32_t ENCODER_Read(uint8_t id);
+int32_t ENCODER_ReadReset(uint8_t id);
+void ENCODER_Reset(uint8_t id);
+
+void MOTOR_SetSpeed(uint8_t id, float speed);
+
+void SERVO_Enable(uint8_t id);
+void SERVO_Disable(uint8_t id);
+void SERVO_SetAngle(uint8_t id, uint8_t angle);
+
+void IR_Init(uint8_t id);
+uint16_t IR_Read(uint8_t id);
+
+// - HOST - //
+
+/**
+ * @brief
+ * Sets the value that ENCODER_Read returns.
+ * @param id
+ * LEFT or RIGHT.
+ * @param pulses
+ * Pulses counted since the last reset.
+ */
+void Host_SetEncoder(uint8_t id, int32_t pulses);
+
+/**
+ * @brief
+ * Returns the last speed given to a motor.
+ * @param id
+ * LEFT or RIGHT.
+ * @return float:
+ * -1 to 1.
+ */
+float Host_GetMotorSpeed(uint8_t id);
@@ -0,0 +1,29 @@
+/**
+ * @file Servo.h
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Host replacement of Arduino's Servo library.
+ * Only remembers the last angle written.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+#pragma once
+
+// - INCLUDES - //
+#include "Arduino.h"
+
+class Servo
+{
+public:
+    uint8_t attach(int pin) { _pin = pin; return 0; }
+    void detach() { _pin = -1; }
+    bool attached() { return _pin >= 0; }
+    void write(int angle) { _angle = angle; }
+    int read() { return _angle; }
+
+private:
+    int _pin = -1;
+    int _angle = 0;
+};
@@ -0,0 +1,31 @@
+/**
+ * @file Wire.h
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Host replacement of Arduino's I2C library.
+ * There is no device on the bus. Every read
+ * returns 0.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+#pragma once
+
+// - INCLUDES - //
+#include "Arduino.h"
+
+class TwoWire
+{
+public:
+    void begin() {}
+    void setClock(uint32_t frequency) {}
+    void beginTransmission(uint8_t address) {}
+    uint8_t endTransmission(bool sendStop = true) { return 0; }
+    size_t write(uint8_t value) { return 1; }
+    uint8_t requestFrom(uint8_t address, uint8_t quantity, uint8_t sendStop = true) { return quantity; }
+    int available() { return 0; }
+    int read() { return 0; }
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,170 @@
+/**
+ * @file LinkBenchmark.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Benchmark of XFactor's and SafeBox's protocol
+ * stacks running together over the simulated
+ * link. XFactor asks SafeBox for snapshots back
+ * to back over lines of increasing badness. For
+ * each line, it prints how many exchanges
+ * completed per second of virtual time and the
+ * percentiles of their end-to-end latency.
+ *
+ * Usage: LinkBenchmark [exchanges per line]
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Link.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// - DEFINES - //
+/// @brief Exchanges measured on each line unless specified on the command line.
+#define BENCHMARK_DEFAULT_EXCHANGES 1000
+/// @brief Time given to the link to settle before measuring. Lets the first status sync happen.
+#define BENCHMARK_SETTLE_US 2000000ULL
+/// @brief Gives up on an exchange after this long. Longer than any request can last.
+#define BENCHMARK_EXCHANGE_LIMIT_US 30000000ULL
+
+/**
+ * @brief
+ * A line on which the link is measured.
+ */
+typedef struct
+{
+    const char* name;
+    Channel_Settings settings;
+} Benchmark_Line;
+
+const Benchmark_Line _lines[] = {
+    {"Wired",           {0,     0,     0.0f,   0.0f}},
+    {"HC-05",           {15000, 10000, 0.0f,   0.0f}},
+    {"HC-05 0.5% loss", {15000, 10000, 0.005f, 0.0f}},
+    {"HC-05 2% loss",   {15000, 10000, 0.02f,  0.0f}},
+    {"HC-05 1% flips",  {15000, 10000, 0.0f,   0.01f}},
+};
+
+/**
+ * @brief
+ * Returns a percentile of sorted latencies.
+ * @param latencies_us
+ * Latencies sorted from the lowest.
+ * @param percentile
+ * 0 to 100.
+ * @return double:
+ * The latency in milliseconds.
+ */
+double Percentile_ms(const std::vector<unsigned long long>& latencies_us, double percentile)
+{
+    size_t index = 0;
+
+    if(latencies_us.empty()) return 0;
+    index = (size_t)(percentile / 100.0 * (latencies_us.size() - 1) + 0.5);
+    return latencies_us[index] / 1000.0;
+}
+
+/**
+ * @brief
+ * Measures the link over one line. Executed in
+ * its own process so that both sides start from
+ * a fresh boot.
+ * @param line
+ * The line to measure.
+ * @param exchanges
+ * How many exchanges to measure.
+ */
+void MeasureLine(const Benchmark_Line* line, unsigned long exchanges)
+{
+    // - VARIABLES - //
+    Link link;
+    std::vector<unsigned long long> latencies_us;
+    unsigned long failures = 0;
+    unsigned long long start_us = 0;
+    unsigned long long submitted_us = 0;
+    unsigned char handle = 0;
+    unsigned char state = LINK_EXCHANGE_RUNNING;
+
+    Link_Init(&link, &line->settings, 1);
+    Link_Run(&link, BENCHMARK_SETTLE_US);
+    start_us = link.time_us;
+
+    // - FUNCTION EXECUTION - //
+    while(latencies_us.size() + failures < exchanges)
+    {
+        handle = XFactorSide_SubmitSnapshot();
+        if(handle == 0xFF)
+        {
+            Link_Step(&link);
+            continue;
+        }
+
+        submitted_us = link.time_us;
+        do
+        {
+            Link_Step(&link);
+            state = XFactorSide_PollExchange(handle);
+        }
+        while(state == LINK_EXCHANGE_RUNNING && link.time_us - submitted_us < BENCHMARK_EXCHANGE_LIMIT_US);
+
+        if(state == LINK_EXCHANGE_COMPLETED) latencies_us.push_back(link.time_us - submitted_us);
+        else failures++;
+    }
+
+    // - RESULTS - //
+    std::sort(latencies_us.begin(), latencies_us.end());
+    printf("%-16s %9lu %7lu %11.1f %8.1f %8.1f %8.1f %8.1f %8lu %8lu\n",
+        line->name,
+        (unsigned long)latencies_us.size(),
+        failures,
+        latencies_us.size() / ((link.time_us - start_us) / 1000000.0),
+        Percentile_ms(latencies_us, 50),
+        Percentile_ms(latencies_us, 90),
+        Percentile_ms(latencies_us, 99),
+        Percentile_ms(latencies_us, 100),
+        link.toSafeBox.stats.bytesLost + link.toXFactor.stats.bytesLost,
+        link.toSafeBox.stats.bytesCorrupted + link.toXFactor.stats.bytesCorrupted);
+    fflush(stdout);
+}
+
+int main(int argc, char** argv)
+{
+    // - VARIABLES - //
+    unsigned long exchanges = BENCHMARK_DEFAULT_EXCHANGES;
+    int status = 0;
+    int result = 0;
+    pid_t child = 0;
+
+    if(argc > 1) exchanges = strtoul(argv[1], 0, 10);
+    if(exchanges == 0)
+    {
+        fprintf(stderr, "Usage: %s [exchanges per line]\n", argv[0]);
+        return 2;
+    }
+
+    printf("Snapshot exchanges between XFactor and SafeBox over the simulated link\n");
+    printf("%-16s %9s %7s %11s %8s %8s %8s %8s %8s %8s\n", "Line", "Completed", "Failed", "Exchanges/s", "p50 ms", "p90 ms", "p99 ms", "Max ms", "Lost B", "Flip B");
+    fflush(stdout);
+
+    for(size_t i = 0; i < sizeof(_lines) / sizeof(_lines[0]); i++)
+    {
+        child = fork();
+        if(child == 0)
+        {
+            MeasureLine(&_lines[i], exchanges);
+            _exit(0);
+        }
+        if(child < 0 || waitpid(child, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            fprintf(stderr, "%s: measurement crashed\n", _lines[i].name);
+            result = 1;
+        }
+    }
+    return result;
+}
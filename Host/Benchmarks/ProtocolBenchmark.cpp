@@ -0,0 +1,169 @@
+/**
+ * @file ProtocolBenchmark.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Benchmark of the encoder and decoder of the
+ * binary frames sent between XFactor and
+ * SafeBox. For payloads of increasing length,
+ * it prints how long encoding and decoding a
+ * frame takes and how many bytes per second the
+ * decoder goes through. The last line decodes
+ * frames that lost a byte, which makes the
+ * decoder search the discarded bytes.
+ *
+ * @attention
+ * Times are those of the host, not of the Mega.
+ * Compare lines and builds with each other.
+ *
+ * Usage: ProtocolBenchmark [frames per line]
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Communication/Protocol.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+// - DEFINES - //
+/// @brief Frames encoded and decoded on each line unless specified on the command line.
+#define BENCHMARK_DEFAULT_FRAMES 1000000UL
+/// @brief Frames in the stream that the decoder goes through over and over.
+#define BENCHMARK_STREAM_FRAMES 64
+
+/// @brief Keeps the compiler from removing what is measured.
+volatile unsigned long _benchmarkSink = 0;
+
+/**
+ * @brief
+ * Returns the time elapsed since a start point.
+ * @return double:
+ * Nanoseconds.
+ */
+double ElapsedNs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief
+ * Decodes a stream of frames over and over.
+ * @param stream
+ * Encoded frames back to back.
+ * @param size
+ * Size of the stream in bytes.
+ * @param repetitions
+ * How many times the stream is decoded.
+ * @param decoded
+ * Incremented for each valid frame.
+ * @return double:
+ * Nanoseconds taken.
+ */
+double DecodeStream(const unsigned char* stream, unsigned long size, unsigned long repetitions, unsigned long* decoded)
+{
+    // - VARIABLES - //
+    Protocol_Decoder decoder;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    Protocol_ResetDecoder(&decoder);
+    for(unsigned long repetition = 0; repetition < repetitions; repetition++)
+    {
+        for(unsigned long i = 0; i < size; i++)
+        {
+            if(Protocol_DecodeByte(&decoder, stream[i])) (*decoded)++;
+        }
+    }
+    return ElapsedNs(start);
+}
+
+/**
+ * @brief
+ * Measures the encoder and the decoder with
+ * payloads of one length.
+ * @param name
+ * Name of the line.
+ * @param length
+ * Length of the payloads.
+ * @param lostByte
+ * Every other frame loses its byte at this
+ * index. 0 to lose nothing.
+ * @param frames
+ * How many frames to encode and decode.
+ */
+void MeasureLine(const char* name, unsigned char length, unsigned char lostByte, unsigned long frames)
+{
+    // - VARIABLES - //
+    unsigned char payload[PROTOCOL_MAX_PAYLOAD_LENGTH];
+    unsigned char buffer[PROTOCOL_MAX_FRAME_LENGTH];
+    unsigned char stream[BENCHMARK_STREAM_FRAMES * PROTOCOL_MAX_FRAME_LENGTH];
+    unsigned long size = 0;
+    unsigned char encoded = 0;
+    unsigned long decoded = 0;
+    unsigned long repetitions = frames / BENCHMARK_STREAM_FRAMES;
+    double encode_ns = 0;
+    double decode_ns = 0;
+    std::chrono::steady_clock::time_point start;
+
+    for(unsigned char i = 0; i < length; i++) payload[i] = (unsigned char)(i * 37);
+    if(repetitions == 0) repetitions = 1;
+    frames = repetitions * BENCHMARK_STREAM_FRAMES;
+
+    // - ENCODING - //
+    start = std::chrono::steady_clock::now();
+    for(unsigned long frame = 0; frame < frames; frame++)
+    {
+        if(length > 0) payload[0] = (unsigned char)frame;
+        encoded = Protocol_Encode(0x42, (unsigned char)frame, payload, length, buffer, sizeof(buffer));
+        _benchmarkSink += buffer[encoded - 1];
+    }
+    encode_ns = ElapsedNs(start);
+
+    // - STREAM - //
+    for(unsigned long frame = 0; frame < BENCHMARK_STREAM_FRAMES; frame++)
+    {
+        encoded = Protocol_Encode(0x42, (unsigned char)(frame + 1), payload, length, &stream[size], PROTOCOL_MAX_FRAME_LENGTH);
+        if(lostByte > 0 && (frame % 2) == 0)
+        {
+            memmove(&stream[size + lostByte], &stream[size + lostByte + 1], encoded - lostByte - 1);
+            encoded--;
+        }
+        size += encoded;
+    }
+
+    // - DECODING - //
+    decode_ns = DecodeStream(stream, size, repetitions, &decoded);
+    _benchmarkSink += decoded;
+
+    printf("%-20s %9lu %9.1f %9.1f %9.1f %9.1f\n",
+        name,
+        decoded,
+        encode_ns / frames,
+        decode_ns / frames,
+        decode_ns / (size * repetitions),
+        (double)size * repetitions / decode_ns * 1000.0);
+}
+
+int main(int argc, char** argv)
+{
+    // - VARIABLES - //
+    unsigned long frames = BENCHMARK_DEFAULT_FRAMES;
+
+    if(argc > 1) frames = strtoul(argv[1], 0, 10);
+    if(frames == 0)
+    {
+        fprintf(stderr, "Usage: %s [frames per line]\n", argv[0]);
+        return 2;
+    }
+
+    printf("Encoding and decoding of protocol frames\n");
+    printf("%-20s %9s %9s %9s %9s %9s\n", "Line", "Decoded", "Enc ns", "Dec ns", "ns/B", "MB/s");
+    MeasureLine("Empty", 0, 0, frames);
+    MeasureLine("8 B payload", 8, 0, frames);
+    MeasureLine("16 B payload", 16, 0, frames);
+    MeasureLine("32 B payload", PROTOCOL_MAX_PAYLOAD_LENGTH, 0, frames);
+    MeasureLine("32 B, 1/2 lose 1 B", PROTOCOL_MAX_PAYLOAD_LENGTH, 3, frames);
+    return 0;
+}
@@ -0,0 +1,457 @@
+/**
+ * @file ReaderBenchmark.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Benchmark of how XFactor reads what SafeBox
+ * sends. The same byte stream is replayed over
+ * the simulated line at 19200 bauds into two
+ * readers. The first is a copy of the reader
+ * that the ring buffer replaced: GetMessage
+ * built a String one character at a time and
+ * waited 10 ms (XFactor) or 20 ms (SafeBox)
+ * after each of them. The second is BT_Poll and
+ * its frame decoder. Frames are sent back to
+ * back, then spaced out enough for the old
+ * reader to keep up. For each reader, it prints
+ * how many frames arrived intact, the bytes of
+ * those per second of virtual time and the
+ * percentiles of their latency. Spaced out, the
+ * bytes per second are the sender's. Compare
+ * the latencies there.
+ *
+ * @attention
+ * Each frame is a text frame whose payload ends
+ * with '\n'. Its header and CRC are not
+ * printable, so the old reader sees the same
+ * line of text that SafeBox used to send.
+ *
+ * Usage: ReaderBenchmark [frames per line]
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Host.hpp"
+#include "Channel.hpp"
+#include "Communication/Bluetooth.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// - DEFINES - //
+/// @brief Frames replayed on each line unless specified on the command line.
+#define BENCHMARK_DEFAULT_FRAMES 200
+/// @brief Time that each pass of a reader's loop takes.
+#define BENCHMARK_PASS_US 50
+/// @brief Time between the frames of the spaced out lines. The old reader takes about 300 ms per frame.
+#define BENCHMARK_SPACED_PERIOD_US 1000000UL
+/// @brief Timeout given to the old reader. Its callers used about that.
+#define BENCHMARK_OLD_TIMEOUT_MS 100
+/// @brief What the old reader returns when nothing was received. BT_NO_MESSAGE of the old Bluetooth.hpp.
+#define BENCHMARK_NO_MESSAGE "%_NAN_%"
+
+/**
+ * @brief
+ * The byte stream replayed into the readers and
+ * where it is at.
+ */
+typedef struct
+{
+    /// @brief Payload of each frame. Text that ends with '\n'.
+    std::vector<std::string> payloads;
+    /// @brief What the old reader must return for each frame.
+    std::vector<std::string> lines;
+    /// @brief Every frame, encoded back to back.
+    std::vector<unsigned char> bytes;
+    /// @brief Index in bytes of the first byte of each frame.
+    std::vector<size_t> frameStarts;
+    /// @brief When the first byte of each frame was given to the UART.
+    std::vector<unsigned long long> frameSent_us;
+    size_t nextByte;
+    size_t nextFrame;
+    unsigned long long start_us;
+    /// @brief Time between the start of two frames. 0 sends them back to back.
+    unsigned long period_us;
+    Channel_Line line;
+} Benchmark_Replay;
+
+/**
+ * @brief
+ * What a reader got out of the stream.
+ */
+typedef struct
+{
+    std::vector<unsigned long long> latencies_us;
+    /// @brief Frame bytes that arrived intact.
+    unsigned long intactBytes;
+    /// @brief When the last intact frame was returned.
+    unsigned long long lastReceived_us;
+} Benchmark_Result;
+
+Benchmark_Replay _replay;
+
+// #pragma region [Replay]
+
+unsigned long ReplayGetBaudrate()
+{
+    return BT_HC05_BAUDRATE;
+}
+
+/**
+ * @brief
+ * SafeBox's UART taking the next byte of the
+ * stream. A frame is not started before its
+ * time.
+ */
+int ReplayTransmit()
+{
+    if(_replay.nextByte >= _replay.bytes.size()) return -1;
+
+    if(_replay.nextFrame < _replay.frameStarts.size() && _replay.nextByte == _replay.frameStarts[_replay.nextFrame])
+    {
+        if(Host_GetTime_us() < _replay.start_us + (unsigned long long)_replay.nextFrame * _replay.period_us) return -1;
+        _replay.frameSent_us[_replay.nextFrame] = Host_GetTime_us();
+        _replay.nextFrame++;
+    }
+    return _replay.bytes[_replay.nextByte++];
+}
+
+bool ReplayReceive(unsigned char character)
+{
+    return BT_SERIAL.Host_Receive(character);
+}
+
+const Link_Side _replaySender = {"SafeBox", 0, 0, 0, ReplayGetBaudrate, ReplayTransmit, 0};
+const Link_Side _replayReceiver = {"XFactor", 0, 0, 0, 0, 0, ReplayReceive};
+
+/**
+ * @brief
+ * Encodes the frames of the stream. The CRC of
+ * each frame is kept unprintable by adding '\r',
+ * which the old reader ignores, before its '\n'.
+ * @param frames
+ * How many frames the stream has.
+ */
+void BuildReplay(unsigned long frames)
+{
+    // - VARIABLES - //
+    char text[64];
+    unsigned char buffer[PROTOCOL_MAX_FRAME_LENGTH];
+    unsigned char length = 0;
+    unsigned char crc = 0;
+    std::string payload = "";
+
+    for(unsigned long i = 0; i < frames; i++)
+    {
+        snprintf(text, sizeof(text), "STATUS %05lu LID %lu DOOR %lu", i, i & 1, (i >> 1) & 1);
+        payload = text;
+        // The length byte must stay below ' ' for the old reader to ignore it.
+        while(true)
+        {
+            length = Protocol_Encode(PROTOCOL_OPCODE_TEXT, PROTOCOL_NO_SEQUENCE, (const unsigned char*)(payload + "\n").c_str(), payload.size() + 1, buffer, sizeof(buffer));
+            crc = buffer[length - 1];
+            if((crc < ' ' || crc > '~') && crc != '\n') break;
+            if(payload.size() + 1 >= ' ' - 1) break;
+            payload += '\r';
+        }
+
+        _replay.payloads.push_back(payload + "\n");
+        _replay.lines.push_back(text);
+        _replay.frameStarts.push_back(_replay.bytes.size());
+        _replay.bytes.insert(_replay.bytes.end(), buffer, buffer + length);
+    }
+    _replay.frameSent_us.resize(frames);
+}
+
+/**
+ * @brief
+ * Replays the stream from its start on a clean
+ * line.
+ * @param period_us
+ * Time between the start of two frames.
+ */
+void StartReplay(unsigned long period_us)
+{
+    // - VARIABLES - //
+    Channel_Settings clean = {0, 0, 0.0f, 0.0f};
+
+    while(BT_SERIAL.read() >= 0);
+    Channel_Init(&_replay.line, &clean, 1);
+    _replay.nextByte = 0;
+    _replay.nextFrame = 0;
+    _replay.start_us = Host_GetTime_us();
+    _replay.period_us = period_us;
+}
+
+/**
+ * @brief
+ * One pass of a reader's loop. The line keeps
+ * delivering bytes meanwhile.
+ */
+void StepReplay()
+{
+    delayMicroseconds(BENCHMARK_PASS_US);
+    Channel_Update(&_replay.line, &_replaySender, &_replayReceiver, Host_GetTime_us());
+}
+
+/**
+ * @brief
+ * Tells if every byte of the stream reached
+ * XFactor's UART.
+ */
+bool ReplayIsDone()
+{
+    return _replay.nextByte >= _replay.bytes.size() && _replay.line.inFlightCount == 0;
+}
+
+/**
+ * @brief
+ * Saves a frame that a reader returned intact.
+ * @param result
+ * What the reader got so far.
+ * @param frame
+ * Index of the frame in the stream.
+ * @param received
+ * Frames already returned. Duplicates are not
+ * counted twice.
+ */
+void SaveIntactFrame(Benchmark_Result* result, size_t frame, std::vector<bool>* received)
+{
+    if((*received)[frame]) return;
+    (*received)[frame] = true;
+
+    result->latencies_us.push_back(Host_GetTime_us() - _replay.frameSent_us[frame]);
+    result->intactBytes += (frame + 1 < _replay.frameStarts.size() ? _replay.frameStarts[frame + 1] : _replay.bytes.size()) - _replay.frameStarts[frame];
+    result->lastReceived_us = Host_GetTime_us();
+}
+
+// #pragma endregion
+
+// #pragma region [Old reader]
+
+/**
+ * @brief
+ * Serial1 as seen by the old reader. Each call
+ * to available() is a pass of its loop.
+ */
+class Benchmark_OldSerial : public Stream
+{
+public:
+    int available() { StepReplay(); return BT_SERIAL.available(); }
+    int read() { return BT_SERIAL.read(); }
+    int peek() { return BT_SERIAL.peek(); }
+    size_t write(uint8_t character) { return BT_SERIAL.write(character); }
+    using Print::write;
+};
+
+Benchmark_OldSerial _oldSerial;
+
+/**
+ * @brief
+ * Copy of GetMessage before the ring buffer.
+ * Only its serial port and its delay after each
+ * character, which differed between XFactor and
+ * SafeBox, are parameters.
+ */
+String OldGetMessage(int millisecondsTimeOut, unsigned long characterDelay_ms)
+{
+    // - VARIABLES - //
+    char receivedCharacter = 0;
+    bool hasReceivedMessage = false;
+
+    unsigned long currentTime = millis();
+    unsigned long oldTime = millis();
+
+    String _currentMessage = "";
+
+    while ((currentTime-oldTime) < (unsigned long)millisecondsTimeOut)
+    {
+        currentTime = millis();
+        // Empty the internal buffer
+        while(_oldSerial.available())
+        {
+            hasReceivedMessage = true;
+            receivedCharacter = (char)_oldSerial.read();
+            if(receivedCharacter >= 32 && receivedCharacter <= 126)
+            {
+                _currentMessage += receivedCharacter;
+            }
+            else
+            {
+                // END OF STRING
+                if(receivedCharacter == '\n')
+                {
+                    return _currentMessage;
+                }
+                else
+                {
+                    if(receivedCharacter == '\r')
+                    {
+                        // Expected. Disregarded
+                    }
+                    else
+                    {
+                        Debug_Warning("Bluetooth", "BT_SERIAL_EVENT", "Unknown character");
+                    }
+                }
+            }
+            delay(characterDelay_ms);
+        }
+    }
+
+    if(hasReceivedMessage)
+    {
+        return _currentMessage;
+    }
+    return BENCHMARK_NO_MESSAGE;
+}
+
+/**
+ * @brief
+ * Reads the stream with the old reader until
+ * nothing is left.
+ * @param result
+ * Where to save the intact frames.
+ * @param characterDelay_ms
+ * Delay after each character.
+ */
+void ReadWithOldReader(Benchmark_Result* result, unsigned long characterDelay_ms)
+{
+    // - VARIABLES - //
+    std::vector<bool> received(_replay.lines.size(), false);
+    String message = "";
+    unsigned long frame = 0;
+
+    while(true)
+    {
+        message = OldGetMessage(BENCHMARK_OLD_TIMEOUT_MS, characterDelay_ms);
+        if(message == BENCHMARK_NO_MESSAGE)
+        {
+            if(ReplayIsDone() && BT_SERIAL.available() == 0) return;
+            continue;
+        }
+
+        // Merged or truncated lines do not count.
+        if(sscanf(message.c_str(), "STATUS %lu", &frame) != 1 || frame >= _replay.lines.size()) continue;
+        if(message == String(_replay.lines[frame])) SaveIntactFrame(result, frame, &received);
+    }
+}
+
+// #pragma endregion
+
+/**
+ * @brief
+ * Reads the stream with BT_Poll and the frame
+ * decoder until nothing is left.
+ * @param result
+ * Where to save the intact frames.
+ */
+void ReadWithRingBuffer(Benchmark_Result* result)
+{
+    // - VARIABLES - //
+    std::vector<bool> received(_replay.payloads.size(), false);
+    Protocol_Frame frame;
+    unsigned long index = 0;
+
+    while(!ReplayIsDone() || BT_SERIAL.available() > 0 || BT_MessagesAvailable() > 0)
+    {
+        StepReplay();
+        BT_Poll();
+        while(BT_GetLatestFrame(&frame))
+        {
+            if(sscanf((const char*)frame.payload, "STATUS %lu", &index) != 1 || index >= _replay.payloads.size()) continue;
+            if(_replay.payloads[index] == std::string((const char*)frame.payload, frame.length)) SaveIntactFrame(result, index, &received);
+        }
+    }
+}
+
+/**
+ * @brief
+ * Returns a percentile of sorted latencies.
+ * @param latencies_us
+ * Latencies sorted from the lowest.
+ * @param percentile
+ * 0 to 100.
+ * @return double:
+ * The latency in milliseconds.
+ */
+double Percentile_ms(const std::vector<unsigned long long>& latencies_us, double percentile)
+{
+    size_t index = 0;
+
+    if(latencies_us.empty()) return 0;
+    index = (size_t)(percentile / 100.0 * (latencies_us.size() - 1) + 0.5);
+    return latencies_us[index] / 1000.0;
+}
+
+/**
+ * @brief
+ * Replays the stream into one reader and prints
+ * what it got.
+ * @param reader
+ * Name of the reader.
+ * @param characterDelay_ms
+ * Delay after each character of the old
+ * reader. 0 uses the ring buffer.
+ * @param period_us
+ * Time between the start of two frames.
+ */
+void MeasureReader(const char* reader, unsigned long characterDelay_ms, unsigned long period_us)
+{
+    // - VARIABLES - //
+    Benchmark_Result result;
+    unsigned long long elapsed_us = 0;
+
+    result.intactBytes = 0;
+    result.lastReceived_us = 0;
+    StartReplay(period_us);
+
+    if(characterDelay_ms == 0) ReadWithRingBuffer(&result);
+    else ReadWithOldReader(&result, characterDelay_ms);
+
+    // - RESULTS - //
+    std::sort(result.latencies_us.begin(), result.latencies_us.end());
+    elapsed_us = (result.lastReceived_us > _replay.start_us) ? (result.lastReceived_us - _replay.start_us) : 0;
+    printf("%-24s %-12s %6lu/%-6lu %10lu %9.1f %8.1f %8.1f %8.1f\n",
+        reader,
+        (period_us == 0) ? "Back to back" : "Spaced out",
+        (unsigned long)result.latencies_us.size(),
+        (unsigned long)_replay.payloads.size(),
+        _replay.line.stats.bytesOverrun,
+        (elapsed_us == 0) ? 0.0 : (result.intactBytes / (elapsed_us / 1000000.0)),
+        Percentile_ms(result.latencies_us, 50),
+        Percentile_ms(result.latencies_us, 99),
+        Percentile_ms(result.latencies_us, 100));
+    fflush(stdout);
+}
+
+int main(int argc, char** argv)
+{
+    // - VARIABLES - //
+    unsigned long frames = BENCHMARK_DEFAULT_FRAMES;
+    const unsigned long periods_us[] = {0, BENCHMARK_SPACED_PERIOD_US};
+
+    if(argc > 1) frames = strtoul(argv[1], 0, 10);
+    if(frames == 0)
+    {
+        fprintf(stderr, "Usage: %s [frames per line]\n", argv[0]);
+        return 2;
+    }
+
+    Debug_Init();
+    BT_Init();
+    BuildReplay(frames);
+
+    printf("Frames read out of the same %lu bytes at %lu bauds\n", (unsigned long)_replay.bytes.size(), (unsigned long)BT_HC05_BAUDRATE);
+    printf("%-24s %-12s %13s %10s %9s %8s %8s %8s\n", "Reader", "Pacing", "Intact", "Overrun B", "Bytes/s", "p50 ms", "p99 ms", "Max ms");
+    for(size_t i = 0; i < sizeof(periods_us) / sizeof(periods_us[0]); i++)
+    {
+        MeasureReader("String, 10 ms per byte", 10, periods_us[i]);
+        MeasureReader("String, 20 ms per byte", 20, periods_us[i]);
+        MeasureReader("Ring buffer", 0, periods_us[i]);
+    }
+    return 0;
+}
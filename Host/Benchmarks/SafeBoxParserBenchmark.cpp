@@ -0,0 +1,152 @@
+/**
+ * @file SafeBoxParserBenchmark.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Benchmark of the parsers of SafeBox that read
+ * what XFactor sends. Prints how many
+ * nanoseconds SafeBox_SaveReceivedXFactorStatus
+ * takes per message, and how long
+ * SafeBox_CheckAndExecuteMessage takes to
+ * decode, dispatch and answer a command received
+ * on the Bluetooth serial port. Valid, invalid
+ * and maximum length frames are measured.
+ *
+ * @attention
+ * Times are those of the host, not of the Mega.
+ * Compare lines and builds with each other.
+ *
+ * Usage: SafeBoxParserBenchmark [messages per line]
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Fuzz.hpp"
+#include "SafeBox/Communication.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+// - DEFINES - //
+/// @brief Messages parsed on each line unless specified on the command line.
+#define BENCHMARK_DEFAULT_MESSAGES 200000UL
+
+/// @brief Keeps the compiler from removing what is measured.
+volatile unsigned long _benchmarkSink = 0;
+
+/**
+ * @brief
+ * A message received from XFactor.
+ */
+typedef struct
+{
+    const char* name;
+    unsigned char opcode;
+    unsigned char length;
+    /// @brief First byte of the payload. The rest is zeros.
+    unsigned char status;
+    /// @brief Flips a bit of the CRC once encoded.
+    bool isCorrupted;
+} Benchmark_Message;
+
+const Benchmark_Message _messages[] = {
+    {"Snapshot",                COMMAND_SNAPSHOT,        1,                           (unsigned char)XFactor_Status::WaitingForDelivery, false},
+    {"Status, max length",      COMMAND_STATUS_EXCHANGE, PROTOCOL_MAX_PAYLOAD_LENGTH, (unsigned char)XFactor_Status::WaitingForDelivery, false},
+    {"Status, unknown status",  COMMAND_STATUS_EXCHANGE, 1,                           0xEE,                                              false},
+    {"Unknown opcode",          0x0F,                    0,                           0,                                                 false},
+    {"Snapshot, bad CRC",       COMMAND_SNAPSHOT,        1,                           (unsigned char)XFactor_Status::WaitingForDelivery, true},
+    {"Max length, bad CRC",     COMMAND_STATUS_EXCHANGE, PROTOCOL_MAX_PAYLOAD_LENGTH, (unsigned char)XFactor_Status::WaitingForDelivery, true},
+};
+
+/**
+ * @brief
+ * Returns the time elapsed since a start point.
+ * @return double:
+ * Nanoseconds.
+ */
+double ElapsedNs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief
+ * Parses one message over and over, alone and
+ * then received on the serial port.
+ * @param message
+ * The message to parse.
+ * @param messages
+ * How many times it is parsed.
+ */
+void MeasureMessage(const Benchmark_Message* message, unsigned long messages)
+{
+    // - VARIABLES - //
+    Protocol_Frame frame;
+    unsigned char buffer[PROTOCOL_MAX_FRAME_LENGTH];
+    unsigned char encoded = 0;
+    unsigned long accepted = 0;
+    unsigned long answered = 0;
+    double status_ns = 0;
+    double execute_ns = 0;
+    std::chrono::steady_clock::time_point start;
+
+    memset(&frame, 0, sizeof(frame));
+    frame.opcode = message->opcode;
+    frame.length = message->length;
+    frame.payload[0] = message->status;
+
+    // - STATUS PARSER - //
+    start = std::chrono::steady_clock::now();
+    for(unsigned long i = 0; i < messages; i++)
+    {
+        if(SafeBox_SaveReceivedXFactorStatus(&frame)) accepted++;
+    }
+    status_ns = ElapsedNs(start);
+
+    // - RECEPTION AND EXECUTION - //
+    start = std::chrono::steady_clock::now();
+    for(unsigned long i = 0; i < messages; i++)
+    {
+        // A new sequence every time so that it is never taken for a retransmission.
+        frame.sequence = (unsigned char)(i % 255 + 1);
+        encoded = Protocol_Encode(frame.opcode, frame.sequence, frame.payload, frame.length, buffer, sizeof(buffer));
+        if(message->isCorrupted) buffer[encoded - 1] ^= 0x01;
+        for(unsigned char j = 0; j < encoded; j++) BT_SERIAL.Host_Receive(buffer[j]);
+
+        SafeBox_CheckAndExecuteMessage();
+        while(BT_SERIAL.Host_Transmit() >= 0) answered++;
+    }
+    execute_ns = ElapsedNs(start);
+    _benchmarkSink += accepted + answered;
+
+    // A bad CRC only exists on the serial port.
+    if(message->isCorrupted) printf("%-24s %8s %10s %10s %10.1f\n", message->name, "-", "-", (answered > 0) ? "yes" : "no", execute_ns / messages);
+    else printf("%-24s %8s %10.1f %10s %10.1f\n", message->name, (accepted > 0) ? "yes" : "no", status_ns / messages, (answered > 0) ? "yes" : "no", execute_ns / messages);
+}
+
+int main(int argc, char** argv)
+{
+    // - VARIABLES - //
+    unsigned long messages = BENCHMARK_DEFAULT_MESSAGES;
+
+    if(argc > 1) messages = strtoul(argv[1], 0, 10);
+    if(messages == 0)
+    {
+        fprintf(stderr, "Usage: %s [messages per line]\n", argv[0]);
+        return 2;
+    }
+
+    Debug_Init();
+    BT_Init();
+    SafeBox_SetNewStatus(SafeBox_Status::WaitingForDelivery);
+    Host_SetDigitalPin(LID_CLOSED_SWITCH_PIN, HIGH);
+
+    printf("Parsing of the messages SafeBox receives\n");
+    printf("%-24s %8s %10s %10s %10s\n", "Message", "Accepted", "Status ns", "Answered", "Execute ns");
+    for(size_t i = 0; i < sizeof(_messages) / sizeof(_messages[0]); i++)
+    {
+        MeasureMessage(&_messages[i], messages);
+    }
+    return 0;
+}
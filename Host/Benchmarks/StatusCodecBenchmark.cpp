@@ -0,0 +1,115 @@
+/**
+ * @file StatusCodecBenchmark.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Benchmark of the decoding of the status codes
+ * received over Bluetooth. Prints how long the
+ * codec's table lookup takes for valid and
+ * invalid codes, next to the switch that
+ * XFactor_SetNewStatus uses to check the same
+ * codes.
+ *
+ * @attention
+ * Times are those of the host, not of the Mega.
+ * Compare lines and builds with each other.
+ *
+ * Usage: StatusCodecBenchmark [decodes per line]
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Communication/StatusCodec.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+
+// - DEFINES - //
+/// @brief Codes decoded on each line unless specified on the command line.
+#define BENCHMARK_DEFAULT_DECODES 10000000UL
+
+/// @brief Keeps the compiler from removing what is measured.
+volatile unsigned long _benchmarkSink = 0;
+
+/**
+ * @brief
+ * Decodes codes over and over with the codec.
+ * @param codes
+ * Codes to decode.
+ * @param decodes
+ * How many codes to decode in total.
+ * @return double:
+ * Nanoseconds per decode.
+ */
+double MeasureCodec(const std::vector<unsigned char>& codes, unsigned long decodes)
+{
+    // - VARIABLES - //
+    XFactor_Status status = XFactor_Status::Off;
+    unsigned long accepted = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for(unsigned long i = 0, index = 0; i < decodes; i++, index = (index + 1 == codes.size()) ? 0 : index + 1)
+    {
+        if(StatusCodec_DecodeXFactor(codes[index], &status)) accepted += (unsigned long)status;
+    }
+    _benchmarkSink += accepted;
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / decodes;
+}
+
+/**
+ * @brief
+ * Checks codes over and over with the switch of
+ * XFactor_SetNewStatus.
+ * @param codes
+ * Codes to check.
+ * @param decodes
+ * How many codes to check in total.
+ * @return double:
+ * Nanoseconds per check.
+ */
+double MeasureSwitch(const std::vector<unsigned char>& codes, unsigned long decodes)
+{
+    // - VARIABLES - //
+    unsigned long accepted = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for(unsigned long i = 0, index = 0; i < decodes; i++, index = (index + 1 == codes.size()) ? 0 : index + 1)
+    {
+        if(XFactor_SetNewStatus((XFactor_Status)codes[index])) accepted++;
+    }
+    _benchmarkSink += accepted;
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / decodes;
+}
+
+int main(int argc, char** argv)
+{
+    // - VARIABLES - //
+    unsigned long decodes = BENCHMARK_DEFAULT_DECODES;
+    std::vector<unsigned char> valid;
+    std::vector<unsigned char> invalid;
+    std::vector<unsigned char> all;
+    XFactor_Status status = XFactor_Status::Off;
+
+    if(argc > 1) decodes = strtoul(argv[1], 0, 10);
+    if(decodes == 0)
+    {
+        fprintf(stderr, "Usage: %s [decodes per line]\n", argv[0]);
+        return 2;
+    }
+
+    for(unsigned int code = 0; code < 256; code++)
+    {
+        if(StatusCodec_DecodeXFactor((unsigned char)code, &status)) valid.push_back((unsigned char)code);
+        else invalid.push_back((unsigned char)code);
+        all.push_back((unsigned char)code);
+    }
+
+    printf("Decoding of XFactor status codes\n");
+    printf("%-16s %12s %12s\n", "Codes", "Codec ns", "Switch ns");
+    printf("%-16s %12.2f %12.2f\n", "Valid", MeasureCodec(valid, decodes), MeasureSwitch(valid, decodes));
+    printf("%-16s %12.2f %12.2f\n", "Invalid", MeasureCodec(invalid, decodes), MeasureSwitch(invalid, decodes));
+    printf("%-16s %12.2f %12.2f\n", "All 256", MeasureCodec(all, decodes), MeasureSwitch(all, decodes));
+    return 0;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file XFactorParserBenchmark.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Benchmark of the parsers of XFactor that read
+ * what SafeBox sends. Prints how many
+ * nanoseconds ParseReceivedAnswer and
+ * SafeBox_SaveReceivedEvent take per message for
+ * valid, invalid and maximum length frames.
+ *
+ * @attention
+ * Times are those of the host, not of the Mega.
+ * Compare lines and builds with each other.
+ *
+ * Usage: XFactorParserBenchmark [messages per line]
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "SafeBox/Communication.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+
+// - DEFINES - //
+/// @brief Messages parsed on each line unless specified on the command line.
+#define BENCHMARK_DEFAULT_MESSAGES 1000000UL
+
+/// @brief Not declared in a header. Only SafeBox/Communication.cpp and this benchmark use it.
+bool ParseReceivedAnswer(const Protocol_Frame* answer);
+
+/// @brief Keeps the compiler from removing what is measured.
+volatile unsigned long _benchmarkSink = 0;
+
+/**
+ * @brief
+ * A message given to one of the parsers.
+ */
+typedef struct
+{
+    const char* name;
+    bool (*parser)(const Protocol_Frame*);
+    unsigned char opcode;
+    unsigned char length;
+    /// @brief First bytes of the payload. The rest is zeros.
+    unsigned char payload[5];
+} Benchmark_Message;
+
+const Benchmark_Message _messages[] = {
+    {"Answer lid open",            ParseReceivedAnswer,       ANSWER_LID_OPEN,        0,                           {0}},
+    {"Answer snapshot",            ParseReceivedAnswer,       ANSWER_SNAPSHOT,        SNAPSHOT_PAYLOAD_STATUS + 1, {1, 0, 0, 0, (unsigned char)SafeBox_Status::WaitingForDelivery}},
+    {"Answer status, max length",  ParseReceivedAnswer,       ANSWER_STATUS_EXCHANGE, PROTOCOL_MAX_PAYLOAD_LENGTH, {(unsigned char)SafeBox_Status::WaitingForDelivery}},
+    {"Answer unknown status",      ParseReceivedAnswer,       ANSWER_STATUS_EXCHANGE, 1,                           {0xEE}},
+    {"Answer unknown opcode",      ParseReceivedAnswer,       0x7E,                   0,                           {0}},
+    {"Event lid changed",          SafeBox_SaveReceivedEvent, EVENT_LID_CHANGED,      1,                           {1}},
+    {"Event status, max length",   SafeBox_SaveReceivedEvent, EVENT_STATUS_CHANGED,   PROTOCOL_MAX_PAYLOAD_LENGTH, {(unsigned char)SafeBox_Status::WaitingForDelivery}},
+    {"Event unknown",              SafeBox_SaveReceivedEvent, 0xFE,                   0,                           {0}},
+};
+
+/**
+ * @brief
+ * Parses one message over and over.
+ * @param message
+ * The message to parse.
+ * @param messages
+ * How many times it is parsed.
+ */
+void MeasureMessage(const Benchmark_Message* message, unsigned long messages)
+{
+    // - VARIABLES - //
+    Protocol_Frame frame;
+    unsigned long accepted = 0;
+    std::chrono::steady_clock::time_point start;
+    double elapsed_ns = 0;
+
+    memset(&frame, 0, sizeof(frame));
+    frame.opcode = message->opcode;
+    frame.length = message->length;
+    memcpy(frame.payload, message->payload, sizeof(message->payload));
+
+    start = std::chrono::steady_clock::now();
+    for(unsigned long i = 0; i < messages; i++)
+    {
+        if(message->parser(&frame)) accepted++;
+    }
+    elapsed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    _benchmarkSink += accepted;
+
+    printf("%-28s %8s %10.1f\n", message->name, (accepted > 0) ? "yes" : "no", elapsed_ns / messages);
+}
+
+int main(int argc, char** argv)
+{
+    // - VARIABLES - //
+    unsigned long messages = BENCHMARK_DEFAULT_MESSAGES;
+
+    if(argc > 1) messages = strtoul(argv[1], 0, 10);
+    if(messages == 0)
+    {
+        fprintf(stderr, "Usage: %s [messages per line]\n", argv[0]);
+        return 2;
+    }
+
+    Debug_Init();
+    XFactor_SetNewStatus(XFactor_Status::WaitingForDelivery);
+
+    printf("Parsing of the messages XFactor receives\n");
+    printf("%-28s %8s %10s\n", "Message", "Accepted", "ns");
+    for(size_t i = 0; i < sizeof(_messages) / sizeof(_messages[0]); i++)
+    {
+        MeasureMessage(&_messages[i], messages);
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file Channel.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * File containing the simulated serial line
+ * that carries the bytes sent by one side of the
+ * link to the other. See Channel.hpp
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Channel.hpp"
+#include <string.h>
+
+/**
+ * @brief
+ * Returns the next random number of a line.
+ * Xorshift, so that a seed always gives the same
+ * sequence.
+ * @param line
+ * The line whose random numbers are used.
+ * @return float:
+ * Between 0 included and 1 excluded.
+ */
+float NextRandom(Channel_Line* line)
+{
+    unsigned long state = line->randomState;
+    state ^= (state << 13) & 0xFFFFFFFFUL;
+    state ^= state >> 17;
+    state ^= (state << 5) & 0xFFFFFFFFUL;
+    line->randomState = state;
+    return (float)(state & 0xFFFFFF) / (float)0x1000000;
+}
+
+/**
+ * @brief
+ * Puts a byte sent by the sender's UART on its
+ * way unless the line loses it.
+ * @param line
+ * The line on which the byte was sent.
+ * @param character
+ * The byte.
+ * @param sent_us
+ * When its last bit left the UART.
+ */
+void SendOnLine(Channel_Line* line, unsigned char character, unsigned long long sent_us)
+{
+    // - VARIABLES - //
+    unsigned long long arrival_us = sent_us + line->settings.latency_us;
+    unsigned short newest = 0;
+
+    line->stats.bytesSent++;
+
+    // - PRELIMINARY CHECKS - //
+    if(NextRandom(line) < line->settings.lossRate || line->inFlightCount >= CHANNEL_IN_FLIGHT_SIZE)
+    {
+        line->stats.bytesLost++;
+        return;
+    }
+
+    // - FUNCTION EXECUTION - //
+    if(NextRandom(line) < line->settings.corruptionRate)
+    {
+        character ^= (unsigned char)(1 << (int)(NextRandom(line) * 8));
+        line->stats.bytesCorrupted++;
+    }
+
+    arrival_us += (unsigned long long)(NextRandom(line) * line->settings.jitter_us);
+    if(arrival_us < line->lastArrival_us) arrival_us = line->lastArrival_us;
+    line->lastArrival_us = arrival_us;
+
+    newest = (line->inFlightOldest + line->inFlightCount) % CHANNEL_IN_FLIGHT_SIZE;
+    line->inFlight[newest] = character;
+    line->inFlightArrival_us[newest] = arrival_us;
+    line->inFlightCount++;
+}
+
+void Channel_Init(Channel_Line* line, const Channel_Settings* settings, unsigned long seed)
+{
+    memset(line, 0, sizeof(Channel_Line));
+    line->settings = *settings;
+    line->randomState = (seed != 0) ? seed : 1;
+    line->uartIsIdle = true;
+}
+
+void Channel_Update(Channel_Line* line, const Link_Side* sender, const Link_Side* receiver, unsigned long long now_us)
+{
+    // - VARIABLES - //
+    unsigned long baudrate = sender->GetBaudrate();
+    unsigned long long byteDuration_us = 0;
+    unsigned long long start_us = 0;
+    int character = 0;
+
+    // - SENDER'S UART - //
+    if(baudrate != 0)
+    {
+        byteDuration_us = (CHANNEL_BITS_PER_BYTE * 1000000ULL + baudrate - 1) / baudrate;
+        while(true)
+        {
+            // Bytes written while the UART is busy are sent back to back.
+            start_us = line->uartIsIdle ? now_us : line->uartFree_us;
+            if(start_us > now_us) break;
+
+            character = sender->Transmit();
+            if(character < 0)
+            {
+                line->uartIsIdle = true;
+                break;
+            }
+
+            line->uartIsIdle = false;
+            line->uartFree_us = start_us + byteDuration_us;
+            SendOnLine(line, (unsigned char)character, line->uartFree_us);
+        }
+    }
+
+    // - RECEIVER'S UART - //
+    while(line->inFlightCount > 0 && line->inFlightArrival_us[line->inFlightOldest] <= now_us)
+    {
+        if(!receiver->Receive(line->inFlight[line->inFlightOldest])) line->stats.bytesOverrun++;
+        line->inFlightOldest = (line->inFlightOldest + 1) % CHANNEL_IN_FLIGHT_SIZE;
+        line->inFlightCount--;
+    }
+}
@@ -0,0 +1,106 @@
+/**
+ * @file Channel.hpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Header file containing the simulated serial
+ * line that carries the bytes sent by one side
+ * of the link to the other. Bytes leave the
+ * sender's UART at its baudrate and arrive after
+ * a latency and a jitter, in order, unless they
+ * are lost or corrupted on the way.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+#pragma once
+
+// - INCLUDES - //
+#include "LinkSide.hpp"
+
+// - DEFINES - //
+/// @brief How many bytes can be on their way at once. More are lost.
+#define CHANNEL_IN_FLIGHT_SIZE 1024
+/// @brief Bits sent per byte by a UART in 8N1.
+#define CHANNEL_BITS_PER_BYTE 10
+
+/**
+ * @brief
+ * How bad a line is.
+ */
+typedef struct
+{
+    /// @brief Time between the end of a byte's transmission and its reception.
+    unsigned long latency_us;
+    /// @brief Random extra latency between 0 and this. Bytes still arrive in order.
+    unsigned long jitter_us;
+    /// @brief Chance between 0 and 1 that a byte never arrives.
+    float lossRate;
+    /// @brief Chance between 0 and 1 that a bit of a byte is flipped.
+    float corruptionRate;
+} Channel_Settings;
+
+/**
+ * @brief
+ * What happened to the bytes sent over a line.
+ */
+typedef struct
+{
+    unsigned long bytesSent;
+    unsigned long bytesLost;
+    unsigned long bytesCorrupted;
+    /// @brief Bytes that arrived while the receiver's RX buffer was full.
+    unsigned long bytesOverrun;
+} Channel_Stats;
+
+/**
+ * @brief
+ * One direction of the link.
+ */
+typedef struct
+{
+    Channel_Settings settings;
+    Channel_Stats stats;
+    unsigned long randomState;
+    /// @brief When the sender's UART can start sending its next byte.
+    unsigned long long uartFree_us;
+    bool uartIsIdle;
+    /// @brief Arrival of the last byte put on its way. The next one cannot arrive before it.
+    unsigned long long lastArrival_us;
+    unsigned char inFlight[CHANNEL_IN_FLIGHT_SIZE];
+    unsigned long long inFlightArrival_us[CHANNEL_IN_FLIGHT_SIZE];
+    unsigned short inFlightOldest;
+    unsigned short inFlightCount;
+} Channel_Line;
+
+// - FUNCTIONS - //
+
+/**
+ * @brief
+ * Empties a line and sets how bad it is.
+ * @param line
+ * The line to initialise.
+ * @param settings
+ * Latency, jitter, loss and corruption.
+ * @param seed
+ * Seed of the line's random numbers. The same
+ * seed gives the same losses on each run.
+ */
+void Channel_Init(Channel_Line* line, const Channel_Settings* settings, unsigned long seed);
+
+/**
+ * @brief
+ * Moves the bytes that the sender's UART had the
+ * time to send since the last update onto the
+ * line and gives the receiver the bytes that
+ * arrived.
+ * @param line
+ * The line between the two sides.
+ * @param sender
+ * The side whose Serial1 sends on this line.
+ * @param receiver
+ * The side whose Serial1 receives from it.
+ * @param now_us
+ * Current time of the link.
+ */
+void Channel_Update(Channel_Line* line, const Link_Side* sender, const Link_Side* receiver, unsigned long long now_us);
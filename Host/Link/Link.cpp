@@ -0,0 +1,83 @@
+/**
+ * @file Link.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * File containing the simulated link that runs
+ * XFactor's and SafeBox's protocol stacks
+ * together. See Link.hpp
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Link.hpp"
+
+void Link_Init(Link* link, const Channel_Settings* settings, unsigned long seed)
+{
+    // - VARIABLES - //
+    static bool sidesAreInitialised = false;
+
+    link->xFactor = XFactorSide_Get();
+    link->safeBox = SafeBoxSide_Get();
+    link->step_us = LINK_DEFAULT_STEP_US;
+    Channel_Init(&link->toSafeBox, settings, seed);
+    Channel_Init(&link->toXFactor, settings, seed * 2654435761UL + 1);
+
+    if(sidesAreInitialised) return;
+    sidesAreInitialised = true;
+    link->time_us = 0;
+    link->xFactor->Init();
+    link->safeBox->Init();
+}
+
+/// @brief Link stepped while XFactor waits inside of its step. See Link_LetXFactorWait
+Link* _waitedLink = 0;
+
+/**
+ * @brief
+ * Moves the virtual clock by one step and
+ * carries the bytes over the lines.
+ * @param link
+ * The link to move.
+ */
+void MoveLink(Link* link)
+{
+    link->time_us += link->step_us;
+    link->xFactor->SetTime_us(link->time_us);
+    link->safeBox->SetTime_us(link->time_us);
+
+    Channel_Update(&link->toSafeBox, link->xFactor, link->safeBox, link->time_us);
+    Channel_Update(&link->toXFactor, link->safeBox, link->xFactor, link->time_us);
+}
+
+/**
+ * @brief
+ * Called by XFactor while it waits. XFactor is
+ * still inside of its step, so only SafeBox is
+ * stepped.
+ */
+void StepWhileXFactorWaits()
+{
+    MoveLink(_waitedLink);
+    _waitedLink->safeBox->Step();
+}
+
+void Link_Step(Link* link)
+{
+    MoveLink(link);
+    link->xFactor->Step();
+    link->safeBox->Step();
+}
+
+void Link_LetXFactorWait(Link* link)
+{
+    _waitedLink = link;
+    XFactorSide_SetWait(StepWhileXFactorWaits);
+}
+
+void Link_Run(Link* link, unsigned long long duration_us)
+{
+    unsigned long long end_us = link->time_us + duration_us;
+    while(link->time_us < end_us) Link_Step(link);
+}
@@ -0,0 +1,93 @@
+/**
+ * @file Link.hpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Header file containing the simulated link
+ * that runs XFactor's and SafeBox's protocol
+ * stacks together. Both sides share a virtual
+ * clock that the link moves in fixed steps.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+#pragma once
+
+// - INCLUDES - //
+#include "LinkSide.hpp"
+#include "Channel.hpp"
+
+// - DEFINES - //
+/// @brief Default time between two steps of the sides. About what a loop takes on the Mega.
+#define LINK_DEFAULT_STEP_US 200
+
+/**
+ * @brief
+ * Both sides and the lines between them.
+ */
+typedef struct
+{
+    const Link_Side* xFactor;
+    const Link_Side* safeBox;
+    /// @brief Carries what XFactor sends to SafeBox.
+    Channel_Line toSafeBox;
+    /// @brief Carries what SafeBox sends to XFactor.
+    Channel_Line toXFactor;
+    unsigned long long time_us;
+    unsigned long step_us;
+} Link;
+
+// - FUNCTIONS - //
+
+/**
+ * @brief
+ * Initialises both sides and the lines between
+ * them. Both lines get the same settings but
+ * their own random numbers.
+ *
+ * @attention
+ * The sides are only initialised by the first
+ * call. Their globals cannot be reset, so later
+ * calls on the same link only change its lines. Run each case in
+ * its own process to start from a fresh boot.
+ * @param link
+ * The link to initialise.
+ * @param settings
+ * How bad both lines are.
+ * @param seed
+ * Seed of the lines' random numbers.
+ */
+void Link_Init(Link* link, const Channel_Settings* settings, unsigned long seed);
+
+/**
+ * @brief
+ * Moves the virtual clock by one step, carries
+ * the bytes over the lines and executes one pass
+ * of each side.
+ * @param link
+ * The link to step.
+ */
+void Link_Step(Link* link);
+
+/**
+ * @brief
+ * Lets XFactor wait for SafeBox inside of its
+ * step, like its actions do. While it waits,
+ * the link keeps moving the clock, carrying the
+ * bytes and stepping SafeBox.
+ * @param link
+ * The link that XFactor waits on. Only one link
+ * can be waited on.
+ */
+void Link_LetXFactorWait(Link* link);
+
+/**
+ * @brief
+ * Steps the link until the specified time has
+ * passed.
+ * @param link
+ * The link to step.
+ * @param duration_us
+ * How long to run the link for.
+ */
+void Link_Run(Link* link, unsigned long long duration_us);
@@ -0,0 +1,184 @@
+/**
+ * @file LinkSide.hpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Header file containing what the simulated
+ * link of Host/ needs from each firmware.
+ * XFactor's and SafeBox's sources define the
+ * same functions, so each one is built in its
+ * own shared library whose only visible
+ * functions are the ones declared here.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+#pragma once
+
+// - DEFINES - //
+/// @brief Makes a function of a firmware's shared library visible to the host program.
+#define LINK_SIDE_EXPORT extern "C" __attribute__((visibility("default")))
+
+/// @brief Returned by @ref XFactorSide_PollExchange while the exchange is not done.
+#define LINK_EXCHANGE_RUNNING 0
+/// @brief Returned by @ref XFactorSide_PollExchange once SafeBox's answer is parsed.
+#define LINK_EXCHANGE_COMPLETED 1
+/// @brief Returned by @ref XFactorSide_PollExchange when the exchange timed out or failed.
+#define LINK_EXCHANGE_FAILED 2
+
+/**
+ * @brief
+ * One firmware as seen by the simulated link.
+ * Each function runs inside of that firmware's
+ * shared library, with its own virtual clock
+ * and its own Serial1.
+ */
+typedef struct
+{
+    const char* name;
+    /// @brief Initialises the firmware's Bluetooth and whatever its communication needs.
+    void (*Init)();
+    /// @brief Moves the firmware's virtual clock. It never goes back.
+    void (*SetTime_us)(unsigned long long time_us);
+    /// @brief Executes one pass of the firmware's communication code.
+    void (*Step)();
+    /// @brief Baudrate given to Serial1.begin. 0 until then.
+    unsigned long (*GetBaudrate)();
+    /// @brief Takes the next byte sent by Serial1. -1 if there is none.
+    int (*Transmit)();
+    /// @brief Gives a byte to Serial1 as if received. false if its RX buffer overflowed.
+    bool (*Receive)(unsigned char character);
+} Link_Side;
+
+/**
+ * @brief
+ * Results of a firmware's communication
+ * self-test. Only filled by the libraries built
+ * with COMMUNICATION_SELF_TEST.
+ */
+typedef struct
+{
+    /// @brief XFactor printed its results. SafeBox sent each of its status back once.
+    bool isDone;
+    /// @brief XFactor's answered commands and exchanges. SafeBox's received exchanges.
+    unsigned long exchanges;
+    /// @brief Unanswered or invalid answers for XFactor. Invalid status for SafeBox.
+    unsigned long errors;
+    /// @brief How many different status of the other firmware were received.
+    unsigned int receivedStatus;
+    /// @brief How many status the other firmware has.
+    unsigned int validStatus;
+    /// @brief p99 of XFactor's round trips. 0 for SafeBox.
+    unsigned long roundTripP99_ms;
+    /// @brief Status exchanges per second of XFactor's benchmark. 0 for SafeBox.
+    float exchangesPerSecond;
+} Link_SelfTest;
+
+// - FUNCTIONS - //
+
+/**
+ * @brief
+ * Returns XFactor's side of the link. Its step
+ * is XFactor's communication task.
+ */
+LINK_SIDE_EXPORT const Link_Side* XFactorSide_Get();
+
+/**
+ * @brief
+ * Makes XFactor submit a snapshot request to
+ * SafeBox, the exchange the getters rely on.
+ * @return unsigned char:
+ * Handle to poll or 0xFF if it could not be
+ * submitted.
+ */
+LINK_SIDE_EXPORT unsigned char XFactorSide_SubmitSnapshot();
+
+/**
+ * @brief
+ * Checks if an exchange submitted by
+ * @ref XFactorSide_SubmitSnapshot is done. Stop
+ * polling a handle once it is.
+ * @return unsigned char:
+ * One of the LINK_EXCHANGE_ defines.
+ */
+LINK_SIDE_EXPORT unsigned char XFactorSide_PollExchange(unsigned char handle);
+
+/**
+ * @brief
+ * Asks XFactor if SafeBox's doorbell rang, like
+ * its actions do.
+ *
+ * @attention
+ * Only call it right after a snapshot exchange
+ * or once Link_LetXFactorWait was called.
+ * Otherwise XFactor waits for a new snapshot
+ * while nothing steps SafeBox.
+ * @return true:
+ * The doorbell rang.
+ */
+LINK_SIDE_EXPORT bool XFactorSide_GetDoorbell();
+
+/**
+ * @brief
+ * Tells if XFactor thinks that the link is up.
+ * Without the HC-05's STATE pin, it goes down
+ * when nothing is received for
+ * BT_LINK_SILENCE_MS.
+ * @return true:
+ * XFactor sends its requests.
+ */
+LINK_SIDE_EXPORT bool XFactorSide_LinkIsUp();
+
+/**
+ * @brief
+ * Makes XFactor call the specified function
+ * while it waits for SafeBox, in between the
+ * passes of BT_WaitForRequest. It is run as one
+ * of XFactor's scheduler tasks.
+ * @param wait
+ * Must move the clock and step SafeBox but not
+ * XFactor, which is still in its step.
+ */
+LINK_SIDE_EXPORT void XFactorSide_SetWait(void (*wait)());
+
+/**
+ * @brief
+ * Gets the results of XFactor's self-test. Its
+ * first step runs the whole self-test.
+ * @param results
+ * Where to copy them.
+ */
+LINK_SIDE_EXPORT void XFactorSide_GetSelfTest(Link_SelfTest* results);
+
+/**
+ * @brief
+ * Returns SafeBox's side of the link. Its step
+ * is what SafeBox's loop does for the link.
+ */
+LINK_SIDE_EXPORT const Link_Side* SafeBoxSide_Get();
+
+/**
+ * @brief
+ * Sets what SafeBox's doorbell detects.
+ * @param ringing
+ * true while someone rings.
+ */
+LINK_SIDE_EXPORT void SafeBoxSide_SetDoorbell(bool ringing);
+
+/**
+ * @brief
+ * Sets what SafeBox's garage distance sensor
+ * sees.
+ * @param open
+ * true if the door is open.
+ */
+LINK_SIDE_EXPORT void SafeBoxSide_SetGarageOpen(bool open);
+
+/**
+ * @brief
+ * Gets the results of SafeBox's side of the
+ * self-test.
+ * @param results
+ * Where to copy them.
+ */
+LINK_SIDE_EXPORT void SafeBoxSide_GetSelfTest(Link_SelfTest* results);
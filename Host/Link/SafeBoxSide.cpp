@@ -0,0 +1,100 @@
+/**
+ * @file SafeBoxSide.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * File containing SafeBox's side of the
+ * simulated link. Built in SafeBox's shared
+ * library. See LinkSide.hpp
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "LinkSide.hpp"
+#include "Host.hpp"
+#include "SafeBox/Communication.hpp"
+#include "SafeBox/CommunicationTest.hpp"
+
+// - DEFINES - //
+/// @brief Echo duration that the garage's distance sensor measures when the door is open. 100 cm.
+#define SAFEBOX_SIDE_OPEN_GARAGE_ECHO_US 5882
+
+/**
+ * @brief
+ * Initialises what SafeBox_Init initialises for
+ * the link.
+ */
+void SafeBoxSide_Init()
+{
+    Debug_Init();
+    BT_Init();
+    SafeBox_SetNewStatus(SafeBox_Status::WaitingForDelivery);
+    // The lid's switch is closed.
+    Host_SetDigitalPin(LID_CLOSED_SWITCH_PIN, HIGH);
+}
+
+/**
+ * @brief
+ * What SafeBox's loop does for the link. Built
+ * for the self-test, what its loop does then.
+ */
+void SafeBoxSide_Step()
+{
+#ifdef COMMUNICATION_SELF_TEST
+    TestGoodCommunications();
+#else
+    SafeBox_CheckAndExecuteMessage();
+#endif
+    SafeBox_CheckAndSendEvents();
+    SafeBox_UpdateScheduledGarage();
+}
+
+unsigned long SafeBoxSide_GetBaudrate()
+{
+    return BT_SERIAL.Host_GetBaudrate();
+}
+
+int SafeBoxSide_Transmit()
+{
+    return BT_SERIAL.Host_Transmit();
+}
+
+bool SafeBoxSide_Receive(unsigned char character)
+{
+    return BT_SERIAL.Host_Receive(character);
+}
+
+const Link_Side* SafeBoxSide_Get()
+{
+    static const Link_Side side = {"SafeBox", SafeBoxSide_Init, Host_SetTime_us, SafeBoxSide_Step, SafeBoxSide_GetBaudrate, SafeBoxSide_Transmit, SafeBoxSide_Receive};
+    return &side;
+}
+
+void SafeBoxSide_SetDoorbell(bool ringing)
+{
+    Host_SetDigitalPin(DOORBELL_SWITCH_BYPASS_PIN, ringing ? HIGH : LOW);
+}
+
+void SafeBoxSide_SetGarageOpen(bool open)
+{
+    Host_SetPulse(GARAGE_ECHO_PIN, open ? SAFEBOX_SIDE_OPEN_GARAGE_ECHO_US : 0);
+}
+
+void SafeBoxSide_GetSelfTest(Link_SelfTest* results)
+{
+    // - VARIABLES - //
+    XFactor_Status status = XFactor_Status::Off;
+
+    results->isDone = SelfTestIsDone();
+    results->exchanges = GetSelfTestStatusExchanges();
+    results->errors = GetSelfTestErrors();
+    results->receivedStatus = GetSelfTestReceivedStatus();
+    results->validStatus = 0;
+    for(unsigned int code = 0; code < 256; code++)
+    {
+        if(StatusCodec_DecodeXFactor((unsigned char)code, &status)) results->validStatus++;
+    }
+    results->roundTripP99_ms = 0;
+    results->exchangesPerSecond = 0.0f;
+}
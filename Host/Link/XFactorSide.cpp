@@ -0,0 +1,136 @@
+/**
+ * @file XFactorSide.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * File containing XFactor's side of the
+ * simulated link. Built in XFactor's shared
+ * library. See LinkSide.hpp
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "LinkSide.hpp"
+#include "Host.hpp"
+#include "SafeBox/Communication.hpp"
+#include "SafeBox/CommunicationTest.hpp"
+#include "Actions/Actions.hpp"
+#include "Scheduler/Scheduler.hpp"
+
+/// @brief Set by XFactorSide_SetWait
+void (*_linkWait)() = 0;
+
+/**
+ * @brief
+ * Initialises what XFactor_Init initialises for
+ * the link.
+ */
+void XFactorSide_Init()
+{
+    Debug_Init();
+    BT_Init();
+    BT_InitRequests();
+    XFactor_SetNewStatus(XFactor_Status::WaitingForDelivery);
+}
+
+/**
+ * @brief
+ * XFactor's communication task. Built for the
+ * self-test, what its loop does instead.
+ */
+void XFactorSide_Step()
+{
+#ifdef COMMUNICATION_SELF_TEST
+    Execute_CurrentFunction();
+#else
+    BT_UpdateRequests();
+    SafeBox_UpdateStatusSync();
+#endif
+}
+
+/**
+ * @brief
+ * Scheduler task that lets the link move while
+ * XFactor waits.
+ */
+void XFactorSide_Wait()
+{
+    if(_linkWait != 0) _linkWait();
+}
+
+unsigned long XFactorSide_GetBaudrate()
+{
+    return BT_SERIAL.Host_GetBaudrate();
+}
+
+int XFactorSide_Transmit()
+{
+    return BT_SERIAL.Host_Transmit();
+}
+
+bool XFactorSide_Receive(unsigned char character)
+{
+    return BT_SERIAL.Host_Receive(character);
+}
+
+const Link_Side* XFactorSide_Get()
+{
+    static const Link_Side side = {"XFactor", XFactorSide_Init, Host_SetTime_us, XFactorSide_Step, XFactorSide_GetBaudrate, XFactorSide_Transmit, XFactorSide_Receive};
+    return &side;
+}
+
+unsigned char XFactorSide_SubmitSnapshot()
+{
+    return SafeBox_SubmitSnapshot();
+}
+
+unsigned char XFactorSide_PollExchange(unsigned char handle)
+{
+    switch(SafeBox_PollCommand(handle, 0))
+    {
+        case(BT_RequestState::Queued):
+        case(BT_RequestState::WaitingForAnswer):
+            return LINK_EXCHANGE_RUNNING;
+
+        case(BT_RequestState::Completed):
+            return LINK_EXCHANGE_COMPLETED;
+
+        default:
+            return LINK_EXCHANGE_FAILED;
+    }
+}
+
+bool XFactorSide_GetDoorbell()
+{
+    return SafeBox_GetDoorBellStatus();
+}
+
+bool XFactorSide_LinkIsUp()
+{
+    return BT_LinkIsUp();
+}
+
+void XFactorSide_SetWait(void (*wait)())
+{
+    if(_linkWait == 0) Scheduler_AddTask("Link", XFactorSide_Wait, SCHEDULER_EVERY_PASS, SCHEDULER_NO_BUDGET);
+    _linkWait = wait;
+}
+
+void XFactorSide_GetSelfTest(Link_SelfTest* results)
+{
+    // - VARIABLES - //
+    SafeBox_Status status = SafeBox_Status::Off;
+
+    results->isDone = SelfTestIsDone();
+    results->exchanges = GetSelfTestRoundTrips();
+    results->errors = GetSelfTestErrors();
+    results->receivedStatus = GetSelfTestReceivedStatus();
+    results->validStatus = 0;
+    for(unsigned int code = 0; code < 256; code++)
+    {
+        if(StatusCodec_DecodeSafeBox((unsigned char)code, &status)) results->validStatus++;
+    }
+    results->roundTripP99_ms = GetSelfTestRoundTripP99();
+    results->exchangesPerSecond = GetSelfTestExchangesPerSecond();
+}
@@ -0,0 +1,225 @@
+/**
+ * @file BaudRateTest.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Tests how XFactor moves its HC-05 to the fast
+ * baudrate when built with BT_NEGOTIATE_BAUDRATE.
+ * HC05.hpp replaces BT_SERIAL by a fake module
+ * that answers AT commands. Each case is a boot
+ * of the Mega, so the EEPROM is kept in between
+ * them. A module that refuses the new baudrate,
+ * does not answer or answers garbage must leave
+ * XFactor at 19200 without hanging its start.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Host.hpp"
+#include "EEPROM.h"
+#include "Communication/Bluetooth.hpp"
+#include "Test.hpp"
+
+// - DEFINES - //
+/// @brief Longest that BT_Init may take when the module does not answer. Three AT commands time out.
+#define TEST_MAX_SILENT_INIT_MS (4 * BT_AT_TIMEOUT_MS)
+
+/// @brief See HC05.hpp
+HC05 _hc05;
+
+// #pragma region HC05
+void HC05::begin(unsigned long baudRate)
+{
+    uartBaudRate = baudRate;
+    _line = "";
+    _answer = "";
+}
+
+int HC05::available()
+{
+    return (int)_answer.size();
+}
+
+int HC05::read()
+{
+    // - VARIABLES - //
+    int character = 0;
+
+    // A few bytes at 19200 bauds.
+    delayMicroseconds(10);
+    if(_answer.empty()) return -1;
+
+    character = (unsigned char)_answer[0];
+    _answer.erase(0, 1);
+    return character;
+}
+
+int HC05::peek()
+{
+    return _answer.empty() ? -1 : (unsigned char)_answer[0];
+}
+
+size_t HC05::write(uint8_t character)
+{
+    // At another baudrate, the module only sees framing errors.
+    if(uartBaudRate != moduleBaudRate) return 1;
+    // Without KEY, commands are sent to the paired device.
+    if(Host_GetDigitalPin(BT_HC05_KEY_PIN) != HIGH) return 1;
+
+    if(character == '\r') return 1;
+    if(character != '\n')
+    {
+        _line += (char)character;
+        return 1;
+    }
+
+    commands.push_back(_line);
+    Execute(_line);
+    _line = "";
+    return 1;
+}
+
+/**
+ * @brief
+ * Answers a command like the HC-05 does, or
+ * like the specified behaviour says.
+ * @param command
+ * Received command without its "\r\n".
+ */
+void HC05::Execute(const std::string& command)
+{
+    switch(behaviour)
+    {
+        case(HC05_Behaviour::Silent):
+            return;
+
+        case(HC05_Behaviour::Garbage):
+            _answer += "\x80\xFE+INQ:\r\n";
+            return;
+
+        default:
+            break;
+    }
+
+    if(command == "AT")
+    {
+        _answer += "OK\r\n";
+    }
+    else if(command.compare(0, 8, "AT+UART=") == 0)
+    {
+        pendingBaudRate = strtoul(command.c_str() + 8, 0, 10);
+        _answer += "OK\r\n";
+    }
+    else if(command == "AT+RESET")
+    {
+        _answer += "OK\r\n";
+        if(behaviour != HC05_Behaviour::KeepsBaudRate) moduleBaudRate = pendingBaudRate;
+    }
+    else
+    {
+        _answer += "ERROR:(0)\r\n";
+    }
+}
+// #pragma endregion
+
+/**
+ * @brief
+ * Restarts XFactor's Bluetooth like a boot of
+ * the Mega does.
+ * @return unsigned long:
+ * How long BT_Init took in ms.
+ */
+unsigned long Boot()
+{
+    // - VARIABLES - //
+    unsigned long start_ms = millis();
+
+    _hc05.commands.clear();
+    BT_Init();
+    return millis() - start_ms;
+}
+
+void TestFirstBoot()
+{
+    // Nothing is saved. The module uses the slow baudrate it was configured with.
+    TEST_CHECK(EEPROM.read(EEPROM.length() - 80) == 0xFF);
+    Boot();
+
+    TEST_CHECK(BT_GetBaudRate() == BT_HC05_FAST_BAUDRATE);
+    TEST_CHECK(_hc05.uartBaudRate == BT_HC05_FAST_BAUDRATE);
+    TEST_CHECK(_hc05.moduleBaudRate == BT_HC05_FAST_BAUDRATE);
+    TEST_CHECK(_hc05.commands.size() == 4);
+    if(_hc05.commands.size() == 4)
+    {
+        // Nothing is heard at the fast baudrate, then the slow one answers.
+        TEST_CHECK(_hc05.commands[0] == "AT");
+        TEST_CHECK(_hc05.commands[1] == BT_HC05_FAST_BAUDRATE_COMMAND);
+        TEST_CHECK(_hc05.commands[2] == "AT+RESET");
+        // Verified once restarted.
+        TEST_CHECK(_hc05.commands[3] == "AT");
+    }
+    TEST_CHECK(EEPROM.read(EEPROM.length() - 80) == BT_HC05_FAST_BAUDRATE / 1200);
+    TEST_CHECK(Host_GetDigitalPin(BT_HC05_KEY_PIN) == LOW);
+}
+
+void TestSavedBaudRate()
+{
+    // The saved baudrate answers first. Nothing else is sent.
+    Boot();
+    TEST_CHECK(BT_GetBaudRate() == BT_HC05_FAST_BAUDRATE);
+    TEST_CHECK(_hc05.commands.size() == 1);
+    TEST_CHECK(EEPROM.read(EEPROM.length() - 80) == BT_HC05_FAST_BAUDRATE / 1200);
+    TEST_CHECK(Host_GetDigitalPin(BT_HC05_KEY_PIN) == LOW);
+}
+
+void TestFailedVerification()
+{
+    // Another module that accepts the new baudrate but restarts at the old one.
+    _hc05.moduleBaudRate = BT_HC05_BAUDRATE;
+    _hc05.behaviour = HC05_Behaviour::KeepsBaudRate;
+    Boot();
+
+    TEST_CHECK(BT_GetBaudRate() == BT_HC05_BAUDRATE);
+    TEST_CHECK(_hc05.uartBaudRate == BT_HC05_BAUDRATE);
+    TEST_CHECK(_hc05.commands.size() == 4);
+    if(_hc05.commands.size() == 4)
+    {
+        TEST_CHECK(_hc05.commands[1] == BT_HC05_FAST_BAUDRATE_COMMAND);
+        TEST_CHECK(_hc05.commands[2] == "AT+RESET");
+    }
+    TEST_CHECK(EEPROM.read(EEPROM.length() - 80) == BT_HC05_BAUDRATE / 1200);
+    TEST_CHECK(Host_GetDigitalPin(BT_HC05_KEY_PIN) == LOW);
+}
+
+void TestNoAnswer(HC05_Behaviour behaviour)
+{
+    // - VARIABLES - //
+    unsigned long duration_ms = 0;
+
+    _hc05.moduleBaudRate = BT_HC05_BAUDRATE;
+    _hc05.behaviour = behaviour;
+    duration_ms = Boot();
+
+    // Every AT command timed out instead of waiting forever.
+    TEST_CHECK(duration_ms >= BT_AT_TIMEOUT_MS);
+    TEST_CHECK(duration_ms <= TEST_MAX_SILENT_INIT_MS);
+    TEST_CHECK(BT_GetBaudRate() == BT_HC05_BAUDRATE);
+    TEST_CHECK(_hc05.uartBaudRate == BT_HC05_BAUDRATE);
+    // Heard at the saved baudrate, then at the slow one. Nothing else is tried.
+    TEST_CHECK(_hc05.commands.size() == 2);
+    TEST_CHECK(EEPROM.read(EEPROM.length() - 80) == BT_HC05_BAUDRATE / 1200);
+    TEST_CHECK(Host_GetDigitalPin(BT_HC05_KEY_PIN) == LOW);
+}
+
+int main()
+{
+    Debug_Init();
+
+    TestFirstBoot();
+    TestSavedBaudRate();
+    TestFailedVerification();
+    TestNoAnswer(HC05_Behaviour::Silent);
+    TestNoAnswer(HC05_Behaviour::Garbage);
+    return Test_Result();
+}
@@ -0,0 +1,93 @@
+/**
+ * @file DoorbellTest.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Tests that XFactor learns about every ring of
+ * SafeBox's doorbell exactly once over a lossy
+ * line. A ring is only told by
+ * @ref EVENT_DOORBELL_RANG, which SafeBox repeats
+ * until a status exchange acknowledges it. The
+ * rings are too short for any snapshot to see
+ * them.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Link.hpp"
+#include "Test.hpp"
+
+// - DEFINES - //
+/// @brief How many times the doorbell rings.
+#define TEST_RINGS 40
+/// @brief How long each ring lasts.
+#define TEST_RING_US 20000ULL
+/// @brief Time given to the link after a ring. Longer than a status heartbeat.
+#define TEST_AFTER_RING_US 2500000ULL
+/// @brief Snapshots tried before the test gives up on the line.
+#define TEST_SNAPSHOT_TRIES 20
+
+/**
+ * @brief
+ * Makes XFactor ask for snapshots until one
+ * arrives, so that asking for the doorbell does
+ * not wait for one.
+ * @return true:
+ * A snapshot was received.
+ */
+bool ExchangeSnapshot(Link* link)
+{
+    // - VARIABLES - //
+    unsigned char handle = 0xFF;
+    unsigned char state = LINK_EXCHANGE_RUNNING;
+
+    for(int i = 0; i < TEST_SNAPSHOT_TRIES; i++)
+    {
+        handle = XFactorSide_SubmitSnapshot();
+        if(handle == 0xFF) return false;
+
+        do
+        {
+            Link_Step(link);
+            state = XFactorSide_PollExchange(handle);
+        }
+        while(state == LINK_EXCHANGE_RUNNING);
+
+        if(state == LINK_EXCHANGE_COMPLETED) return true;
+    }
+    return false;
+}
+
+int main()
+{
+    // - VARIABLES - //
+    Link link;
+    // About one frame of six bytes in six is lost or corrupted.
+    Channel_Settings bad = {15000, 10000, 0.02f, 0.01f};
+    unsigned long told = 0;
+    unsigned long repeated = 0;
+
+    Link_Init(&link, &bad, 4);
+    Link_Run(&link, 1000000);
+
+    for(int ring = 0; ring < TEST_RINGS; ring++)
+    {
+        SafeBoxSide_SetDoorbell(true);
+        Link_Run(&link, TEST_RING_US);
+        SafeBoxSide_SetDoorbell(false);
+        Link_Run(&link, TEST_AFTER_RING_US);
+
+        // The snapshot says that the doorbell does not ring anymore. Only the event tells about the ring.
+        if(!ExchangeSnapshot(&link)) continue;
+        if(XFactorSide_GetDoorbell()) told++;
+        if(XFactorSide_GetDoorbell()) repeated++;
+    }
+
+    printf("%lu of %d rings told, %lu told twice\n", told, TEST_RINGS, repeated);
+    TEST_CHECK(told == TEST_RINGS);
+    TEST_CHECK(repeated == 0);
+    TEST_CHECK(link.toXFactor.stats.bytesLost > 0);
+
+    return Test_Result();
+}
@@ -0,0 +1,91 @@
+/**
+ * @file Fuzz.hpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Header file containing what the fuzz tests
+ * and the parser benchmarks use to make random
+ * frames and give them to a firmware. The random
+ * generator is seeded so that a failing run can
+ * be replayed.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+#pragma once
+
+// - INCLUDES - //
+#include "Host.hpp"
+#include "Communication/Protocol.hpp"
+
+/**
+ * @brief
+ * Returns the next number of a xorshift
+ * generator.
+ * @param state
+ * State of the generator. Must not be 0.
+ * @return unsigned long:
+ * 32 random bits.
+ */
+static inline unsigned long Fuzz_Random(unsigned long* state)
+{
+    unsigned long value = *state & 0xFFFFFFFFUL;
+    value ^= (value << 13) & 0xFFFFFFFFUL;
+    value ^= value >> 17;
+    value ^= (value << 5) & 0xFFFFFFFFUL;
+    *state = value;
+    return value;
+}
+
+/**
+ * @brief
+ * Fills a frame with a random opcode, sequence,
+ * length and payload. Bytes after the payload
+ * are random too, so parsers that read past the
+ * length read garbage instead of zeros.
+ * @param frame
+ * The frame to fill.
+ * @param state
+ * State of the random generator.
+ * @param firstOpcode
+ * Lowest opcode to pick.
+ * @param lastOpcode
+ * Highest opcode to pick.
+ */
+static inline void Fuzz_RandomFrame(Protocol_Frame* frame, unsigned long* state, unsigned char firstOpcode, unsigned char lastOpcode)
+{
+    frame->opcode = (unsigned char)(firstOpcode + Fuzz_Random(state) % (lastOpcode - firstOpcode + 1));
+    frame->sequence = (unsigned char)Fuzz_Random(state);
+    frame->length = (unsigned char)(Fuzz_Random(state) % (PROTOCOL_MAX_PAYLOAD_LENGTH + 1));
+    for(unsigned char i = 0; i < sizeof(frame->payload); i++)
+    {
+        frame->payload[i] = (unsigned char)Fuzz_Random(state);
+    }
+}
+
+/**
+ * @brief
+ * Encodes a frame and gives its bytes to a
+ * serial port as if they were just received.
+ * @param serial
+ * The firmware's Bluetooth serial port.
+ * @param frame
+ * The frame to receive.
+ * @return true:
+ * Every byte fit in the RX buffer.
+ * @return false:
+ * Bytes were lost.
+ */
+static inline bool Fuzz_ReceiveFrame(HardwareSerial* serial, const Protocol_Frame* frame)
+{
+    // - VARIABLES - //
+    unsigned char buffer[PROTOCOL_MAX_FRAME_LENGTH];
+    unsigned char length = Protocol_Encode(frame->opcode, frame->sequence, frame->payload, frame->length, buffer, sizeof(buffer));
+    bool received = (length > 0);
+
+    for(unsigned char i = 0; i < length; i++)
+    {
+        if(!serial->Host_Receive(buffer[i])) received = false;
+    }
+    return received;
+}
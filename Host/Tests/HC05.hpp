@@ -0,0 +1,79 @@
+/**
+ * @file HC05.hpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Header file included before everything else
+ * in the XFactor that BaudRateTest builds with
+ * BT_NEGOTIATE_BAUDRATE. BT_SERIAL becomes a
+ * fake HC-05 that answers AT commands like the
+ * module does. Defined by the test.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+#pragma once
+
+// - INCLUDES - //
+#include "Arduino.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief
+ * How the fake HC-05 answers.
+ */
+enum class HC05_Behaviour {
+    /// @brief Answers and applies AT+UART on AT+RESET.
+    Normal,
+    /// @brief Answers OK to AT+UART but restarts at its old baudrate.
+    KeepsBaudRate,
+    /// @brief Never answers.
+    Silent,
+    /// @brief Answers bytes that are neither OK nor ERROR.
+    Garbage
+};
+
+/**
+ * @brief
+ * HC-05 in AT mode wired to the Mega's UART.
+ * It only hears the commands sent at its own
+ * baudrate while its KEY pin is high. Reading
+ * moves the virtual clock, so that waiting for
+ * an answer that never comes ends.
+ */
+class HC05 : public Stream
+{
+public:
+    void begin(unsigned long baudRate);
+    int available();
+    int read();
+    int peek();
+    int availableForWrite() { return 64; }
+    void flush() {}
+    size_t write(uint8_t character);
+    using Print::write;
+
+    // - TEST - //
+    /// @brief Baudrate that the UART was opened at.
+    unsigned long uartBaudRate = 0;
+    /// @brief Baudrate that the module uses.
+    unsigned long moduleBaudRate = 19200;
+    /// @brief Baudrate set by AT+UART. Used once it restarts.
+    unsigned long pendingBaudRate = 19200;
+    HC05_Behaviour behaviour = HC05_Behaviour::Normal;
+    /// @brief Every command that the module heard, in order.
+    std::vector<std::string> commands;
+
+private:
+    void Execute(const std::string& command);
+
+    std::string _line;
+    std::string _answer;
+};
+
+/// @brief The module used as BT_SERIAL. Defined by the test.
+extern HC05 _hc05;
+
+#define BT_SERIAL _hc05
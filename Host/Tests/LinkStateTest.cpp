@@ -0,0 +1,167 @@
+/**
+ * @file LinkStateTest.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Tests that XFactor follows the HC-05's STATE
+ * output when built with BT_USE_STATE_PIN.
+ * StatePin.hpp replaces the pin by a variable.
+ * Requests must fail right away while it is low
+ * and each change must raise
+ * BT_LinkChangedEvent once. LinkTest covers the
+ * builds without the pin, where a silent line
+ * takes the link down.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Host.hpp"
+#include "SafeBox/Communication.hpp"
+#include "Test.hpp"
+
+#include <string>
+
+// - DEFINES - //
+/// @brief What BT_LinkChangedEvent prints when the link goes down.
+#define TEST_LINK_DOWN "Bluetooth link is down"
+/// @brief What BT_LinkChangedEvent prints when the link comes back.
+#define TEST_LINK_UP "Bluetooth link is up"
+
+/// @brief Read by BT_READ_STATE_PIN. See StatePin.hpp
+int _statePin = HIGH;
+
+/**
+ * @brief
+ * Takes everything written on the debug serial
+ * port since the last call.
+ */
+std::string TakeDebugOutput()
+{
+    // - VARIABLES - //
+    std::string output = "";
+    int character = 0;
+
+    while((character = DEBUG_SERIAL.Host_Transmit()) >= 0) output += (char)character;
+    return output;
+}
+
+/**
+ * @brief
+ * Takes everything XFactor sent to the HC-05.
+ * @return unsigned long:
+ * How many bytes were sent.
+ */
+unsigned long TakeSentBytes()
+{
+    // - VARIABLES - //
+    unsigned long count = 0;
+
+    while(BT_SERIAL.Host_Transmit() >= 0) count++;
+    return count;
+}
+
+/**
+ * @brief
+ * Does one pass of XFactor's communication task.
+ * @return std::string:
+ * What it printed.
+ */
+std::string Step()
+{
+    TakeDebugOutput();
+    delay(1);
+    BT_UpdateRequests();
+    return TakeDebugOutput();
+}
+
+void TestPaired()
+{
+    // - VARIABLES - //
+    unsigned char handle = 0;
+
+    // Nothing is received, but the pin is trusted over the silence.
+    for(int i = 0; i < BT_LINK_SILENCE_MS * 2; i++)
+    {
+        TEST_CHECK(Step().find("BT_LinkChangedEvent") == std::string::npos);
+    }
+    TEST_CHECK(BT_LinkIsUp());
+
+    handle = BT_SubmitRequest(COMMAND_DOORBELL_GET, 0, 0, COMMS_TIMEOUT_MS);
+    TEST_CHECK(handle != 0xFF);
+    Step();
+    TEST_CHECK(BT_GetRequestState(handle) == BT_RequestState::WaitingForAnswer);
+    TEST_CHECK(TakeSentBytes() > 0);
+    BT_ReleaseRequest(handle);
+    Step();
+}
+
+void TestUnpaired()
+{
+    // - VARIABLES - //
+    unsigned char handle = 0;
+    std::string output = "";
+
+    // - HIGH TO LOW - //
+    _statePin = LOW;
+    output = Step();
+    TEST_CHECK(!BT_LinkIsUp());
+    TEST_CHECK(output.find(TEST_LINK_DOWN) != std::string::npos);
+
+    // Raised once, not on every pass.
+    TEST_CHECK(Step().find("BT_LinkChangedEvent") == std::string::npos);
+
+    // - SUBMITTED WHILE DOWN - //
+    TakeSentBytes();
+    handle = BT_SubmitRequest(COMMAND_DOORBELL_GET, 0, 0, COMMS_TIMEOUT_MS);
+    TEST_CHECK(handle != 0xFF);
+    BT_UpdateRequests();
+    TEST_CHECK(BT_GetRequestState(handle) == BT_RequestState::Failed);
+    TEST_CHECK(TakeSentBytes() == 0);
+    BT_ReleaseRequest(handle);
+
+    // - LOW TO HIGH - //
+    ClockSync_SaveSample(0, 10, 20);
+    TEST_CHECK(ClockSync_IsSynced());
+    _statePin = HIGH;
+    output = Step();
+    TEST_CHECK(BT_LinkIsUp());
+    TEST_CHECK(output.find(TEST_LINK_UP) != std::string::npos);
+    // SafeBox may have rebooted while unpaired.
+    TEST_CHECK(!ClockSync_IsSynced());
+    TEST_CHECK(Step().find("BT_LinkChangedEvent") == std::string::npos);
+}
+
+void TestUnpairedWhileWaiting()
+{
+    // - VARIABLES - //
+    unsigned char handle = 0;
+    std::string output = "";
+
+    handle = BT_SubmitRequest(COMMAND_DOORBELL_GET, 0, 0, COMMS_TIMEOUT_MS);
+    Step();
+    TEST_CHECK(BT_GetRequestState(handle) == BT_RequestState::WaitingForAnswer);
+    TakeSentBytes();
+
+    // The answer cannot come anymore. It fails instead of timing out.
+    _statePin = LOW;
+    output = Step();
+    TEST_CHECK(output.find(TEST_LINK_DOWN) != std::string::npos);
+    TEST_CHECK(BT_GetRequestState(handle) == BT_RequestState::Failed);
+    TEST_CHECK(TakeSentBytes() == 0);
+    BT_ReleaseRequest(handle);
+    _statePin = HIGH;
+    Step();
+}
+
+int main()
+{
+    Debug_Init();
+    BT_Init();
+    BT_InitRequests();
+
+    TestPaired();
+    TestUnpaired();
+    TestUnpairedWhileWaiting();
+    return Test_Result();
+}
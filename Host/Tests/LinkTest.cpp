@@ -0,0 +1,109 @@
+/**
+ * @file LinkTest.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Tests XFactor's and SafeBox's protocol stacks
+ * together over the simulated link. XFactor
+ * must get its snapshots quickly over a clean
+ * line and keep getting most of them over a
+ * lossy and corrupting one. A line that stays
+ * silent must take the link down.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Link.hpp"
+#include "Test.hpp"
+
+// - DEFINES - //
+/// @brief Gives up on an exchange after this long. Longer than any request can last.
+#define TEST_EXCHANGE_LIMIT_US 30000000ULL
+/// @brief BT_LINK_SILENCE_MS of the firmwares' Bluetooth.hpp
+#define TEST_LINK_SILENCE_MS 3000
+
+/**
+ * @brief
+ * Makes XFactor ask for a snapshot and steps the
+ * link until it is done.
+ * @param link
+ * The link to use.
+ * @param latency_us
+ * How long the exchange took.
+ * @return unsigned char:
+ * One of the LINK_EXCHANGE_ defines.
+ */
+unsigned char ExchangeSnapshot(Link* link, unsigned long long* latency_us)
+{
+    // - VARIABLES - //
+    unsigned long long submitted_us = link->time_us;
+    unsigned char handle = XFactorSide_SubmitSnapshot();
+    unsigned char state = LINK_EXCHANGE_RUNNING;
+
+    if(handle == 0xFF) return LINK_EXCHANGE_FAILED;
+
+    do
+    {
+        Link_Step(link);
+        state = XFactorSide_PollExchange(handle);
+    }
+    while(state == LINK_EXCHANGE_RUNNING && link->time_us - submitted_us < TEST_EXCHANGE_LIMIT_US);
+
+    *latency_us = link->time_us - submitted_us;
+    return state;
+}
+
+int main()
+{
+    // - VARIABLES - //
+    Link link;
+    Channel_Settings clean = {0, 0, 0.0f, 0.0f};
+    Channel_Settings bad = {15000, 10000, 0.02f, 0.01f};
+    Channel_Settings silent = {0, 0, 1.0f, 0.0f};
+    unsigned long long latency_us = 0;
+    unsigned long completed = 0;
+
+    Link_Init(&link, &clean, 1);
+    Link_Run(&link, 1000000);
+
+    // - CLEAN LINE - //
+    // A snapshot is two short frames. At 19200 bauds, it takes about 10 ms.
+    for(int i = 0; i < 20; i++)
+    {
+        TEST_CHECK(ExchangeSnapshot(&link, &latency_us) == LINK_EXCHANGE_COMPLETED);
+        TEST_CHECK(latency_us < 30000);
+    }
+    TEST_CHECK(link.toSafeBox.stats.bytesSent > 0);
+    TEST_CHECK(link.toXFactor.stats.bytesOverrun == 0);
+
+    // - LOSSY LINE - //
+    Link_Init(&link, &bad, 2);
+    for(int i = 0; i < 100; i++)
+    {
+        if(ExchangeSnapshot(&link, &latency_us) == LINK_EXCHANGE_COMPLETED) completed++;
+    }
+    printf("%lu of 100 snapshots over the lossy line\n", completed);
+    TEST_CHECK(completed >= 90);
+    TEST_CHECK(link.toSafeBox.stats.bytesLost > 0);
+    TEST_CHECK(link.toXFactor.stats.bytesCorrupted > 0);
+
+    // - SILENT LINE - //
+    // Nothing gets through. XFactor must notice it without the HC-05's STATE pin.
+    Link_Init(&link, &silent, 4);
+    Link_Run(&link, (TEST_LINK_SILENCE_MS - 500) * 1000ULL);
+    TEST_CHECK(XFactorSide_LinkIsUp());
+    Link_Run(&link, 1000000);
+    TEST_CHECK(!XFactorSide_LinkIsUp());
+    // Nobody can answer. Snapshots fail instead of timing out.
+    TEST_CHECK(ExchangeSnapshot(&link, &latency_us) == LINK_EXCHANGE_FAILED);
+    TEST_CHECK(latency_us < 10000);
+
+    // - RECOVERY - //
+    Link_Init(&link, &clean, 3);
+    Link_Run(&link, 3000000);
+    TEST_CHECK(ExchangeSnapshot(&link, &latency_us) == LINK_EXCHANGE_COMPLETED);
+    TEST_CHECK(XFactorSide_LinkIsUp());
+
+    return Test_Result();
+}
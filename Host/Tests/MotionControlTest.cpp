@@ -0,0 +1,175 @@
+/**
+ * @file MotionControlTest.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Tests XFactor's motion control step without
+ * its timer or its motors. Steps are fed with
+ * the ticks of a simulated pair of wheels whose
+ * left motor is weaker than the right one, and
+ * the speeds they compute are checked.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Movements/MotionControl.hpp"
+#include "Test.hpp"
+
+// - DEFINES - //
+/// @brief Encoder ticks that a wheel makes in one step at a speed of 1.
+#define TEST_TICKS_PER_STEP 75.0f
+/// @brief How fast the left wheel turns compared to the right one for the same speed.
+#define TEST_LEFT_MOTOR_RATIO 0.8f
+/// @brief Ticks of the right encoder at which the simulated movements are completed.
+#define TEST_TARGET_TICKS 3000.0f
+/// @brief Steps after which a movement that is not completed fails the test.
+#define TEST_MAX_STEPS 2000
+/// @brief Largest speed that the PID can ask for.
+#define TEST_SPEED_LIMIT (SPEED_MAX + 0.05f)
+
+/**
+ * @brief
+ * Simulated wheels. The encoders accumulate the
+ * ticks made at the speeds of the last step.
+ */
+typedef struct
+{
+    float leftTicks;
+    float rightTicks;
+} Wheels;
+
+/**
+ * @brief
+ * Computes one step from the simulated encoders
+ * then turns the wheels at the speeds it asked.
+ * Encoders are absolute like in
+ * @ref MotionControl_Tick
+ */
+void Simulate(MotionControl_State* state, Wheels* wheels)
+{
+    MotionControl_ComputeStep(state, (int32_t)wheels->leftTicks, (int32_t)wheels->rightTicks);
+    wheels->leftTicks  += fabsf(state->leftSpeed) * TEST_TICKS_PER_STEP * TEST_LEFT_MOTOR_RATIO;
+    wheels->rightTicks += fabsf(state->rightSpeed) * TEST_TICKS_PER_STEP;
+}
+
+void TestAccelerate()
+{
+    TEST_CHECK(fabsf(Accelerate(0.0f, SPEED_MAX) - 0.1f) < 0.0001f);
+    TEST_CHECK(fabsf(Accelerate(0.5f, SPEED_MAX) - SPEED_MAX) < 0.0001f);
+    TEST_CHECK(Accelerate(0.25f, SPEED_MAX) > Accelerate(0.05f, SPEED_MAX));
+    TEST_CHECK(Accelerate(0.95f, SPEED_MAX) < Accelerate(0.75f, SPEED_MAX));
+    TEST_CHECK(Accelerate(-0.5f, SPEED_MAX) == 0.0f);
+}
+
+void TestFirstStep()
+{
+    // - VARIABLES - //
+    MotionControl_State state;
+
+    MotionControl_InitState(&state, TEST_TARGET_TICKS, SPEED_MAX, 1, 1.0f);
+    MotionControl_ComputeStep(&state, 0, 0);
+
+    // Nothing moved yet. Both wheels start at the lowest speed of the acceleration.
+    TEST_CHECK(state.completionRatio == 0.0f);
+    TEST_CHECK(fabsf(state.leftSpeed - 0.1f) < 0.0001f);
+    TEST_CHECK(fabsf(state.rightSpeed - 0.1f) < 0.0001f);
+
+    MotionControl_ComputeStep(&state, 10, 30);
+    TEST_CHECK(fabsf(state.completionRatio - 30.0f / TEST_TARGET_TICKS) < 0.0001f);
+    TEST_CHECK(state.previousLeftPulse == 10);
+    TEST_CHECK(state.previousRightPulse == 30);
+    // The left wheel is behind. The PID speeds it up.
+    TEST_CHECK(state.leftSpeed > state.rightSpeed);
+}
+
+void TestSigns()
+{
+    // - VARIABLES - //
+    MotionControl_State backward;
+    MotionControl_State turn;
+
+    MotionControl_InitState(&backward, TEST_TARGET_TICKS, SPEED_MAX, -1, 1.0f);
+    MotionControl_InitState(&turn, TEST_TARGET_TICKS, SPEED_MAX, 1, -1.0f);
+
+    for(int step = 0; step < 20; step++)
+    {
+        MotionControl_ComputeStep(&backward, step * 20, step * 20);
+        MotionControl_ComputeStep(&turn, step * 20, step * 20);
+
+        TEST_CHECK(backward.leftSpeed < 0.0f);
+        TEST_CHECK(backward.rightSpeed < 0.0f);
+        TEST_CHECK(turn.leftSpeed < 0.0f);
+        TEST_CHECK(turn.rightSpeed > 0.0f);
+    }
+}
+
+void TestIndependentStates()
+{
+    // - VARIABLES - //
+    MotionControl_State alone;
+    MotionControl_State first;
+    MotionControl_State second;
+    Wheels aloneWheels = {0.0f, 0.0f};
+    Wheels firstWheels = {0.0f, 0.0f};
+    Wheels secondWheels = {0.0f, 0.0f};
+    bool isSame = true;
+
+    MotionControl_InitState(&alone, TEST_TARGET_TICKS, SPEED_MAX, 1, 1.0f);
+    MotionControl_InitState(&first, TEST_TARGET_TICKS, SPEED_MAX, 1, 1.0f);
+    MotionControl_InitState(&second, TEST_TARGET_TICKS / 2, SPEED_MAX / 2, -1, -1.0f);
+
+    // Steps of another movement in between must not change the outputs of this one.
+    for(int step = 0; step < 200; step++)
+    {
+        Simulate(&alone, &aloneWheels);
+        Simulate(&first, &firstWheels);
+        Simulate(&second, &secondWheels);
+        isSame = isSame && (alone.leftSpeed == first.leftSpeed) && (alone.rightSpeed == first.rightSpeed);
+    }
+    TEST_CHECK(isSame);
+
+    // A restarted movement must not remember the PID of the previous one.
+    MotionControl_InitState(&first, TEST_TARGET_TICKS, SPEED_MAX, 1, 1.0f);
+    MotionControl_InitState(&alone, TEST_TARGET_TICKS, SPEED_MAX, 1, 1.0f);
+    TEST_CHECK(first.pid.previousValue == 0.0f);
+    TEST_CHECK(first.pid.errorSum == 0.0f);
+    MotionControl_ComputeStep(&first, 0, 0);
+    TEST_CHECK(fabsf(first.leftSpeed - 0.1f) < 0.0001f);
+
+    TEST_CHECK(!ResetPID(0));
+}
+
+void TestMovement()
+{
+    // - VARIABLES - //
+    MotionControl_State state;
+    Wheels wheels = {0.0f, 0.0f};
+    int steps = 0;
+    bool isBounded = true;
+
+    MotionControl_InitState(&state, TEST_TARGET_TICKS, SPEED_MAX, 1, 1.0f);
+
+    while(state.completionRatio < 1.0f && steps < TEST_MAX_STEPS)
+    {
+        Simulate(&state, &wheels);
+        isBounded = isBounded && (fabsf(state.leftSpeed) <= TEST_SPEED_LIMIT) && (fabsf(state.rightSpeed) <= TEST_SPEED_LIMIT);
+        steps++;
+    }
+
+    printf("Movement of %.0f ticks: %d steps, left %.0f ticks, right %.0f ticks\n", TEST_TARGET_TICKS, steps, wheels.leftTicks, wheels.rightTicks);
+    TEST_CHECK(steps < TEST_MAX_STEPS);
+    TEST_CHECK(isBounded);
+    // Without the PID, the left wheel would be 20% behind.
+    TEST_CHECK(fabsf(wheels.leftTicks - wheels.rightTicks) < TEST_TARGET_TICKS * 0.05f);
+}
+
+int main()
+{
+    TestAccelerate();
+    TestFirstStep();
+    TestSigns();
+    TestIndependentStates();
+    TestMovement();
+    return Test_Result();
+}
@@ -0,0 +1,157 @@
+/**
+ * @file ProfilerTest.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Tests the profiler of Debug/Profiler.cpp. It
+ * only exists when PROFILER_ENABLED is defined,
+ * so it is compiled again with it for this test.
+ * Durations are recorded in its slots and what
+ * it measured, printed and cleared is checked.
+ * Both firmwares have the same copy of it.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Host.hpp"
+#include "Debug/Profiler.hpp"
+#include "Test.hpp"
+
+#include <string>
+
+/**
+ * @brief
+ * Takes everything written on the debug serial
+ * port. Only the start of a long print fits in
+ * its TX buffer.
+ */
+std::string TakeDebugOutput()
+{
+    // - VARIABLES - //
+    std::string output = "";
+    int character = 0;
+
+    while((character = DEBUG_SERIAL.Host_Transmit()) >= 0) output += (char)character;
+    return output;
+}
+
+void TestFirstUse()
+{
+    // - VARIABLES - //
+    const Profiler_Slot* measurements = Profiler_GetSlot(0);
+
+    // Nothing was recorded nor reset yet. The minimum must still start high.
+    TEST_CHECK(measurements != 0);
+    TEST_CHECK(measurements->count == 0);
+    TEST_CHECK(measurements->min_us == 0xFFFFFFFFUL);
+    TEST_CHECK(measurements->max_us == 0);
+}
+
+void TestRecord()
+{
+    // - VARIABLES - //
+    const Profiler_Slot* measurements = Profiler_GetSlot(3);
+
+    Profiler_Reset();
+    Profiler_Record(3, 100);
+    Profiler_Record(3, 10);
+    Profiler_Record(3, 70000);
+    Profiler_Record(3, 5000000);
+
+    TEST_CHECK(measurements->count == 4);
+    TEST_CHECK(measurements->min_us == 10);
+    TEST_CHECK(measurements->max_us == 5000000);
+    TEST_CHECK(measurements->total_us == 5070110ULL);
+
+    // Buckets are below 64, 256, 1024, 4096, 16384, 65536 and 262144us. The last one holds the rest.
+    TEST_CHECK(measurements->histogram[0] == 1);
+    TEST_CHECK(measurements->histogram[1] == 1);
+    TEST_CHECK(measurements->histogram[6] == 1);
+    TEST_CHECK(measurements->histogram[PROFILER_HISTOGRAM_BUCKETS - 1] == 1);
+    TEST_CHECK(Profiler_GetSlot(4)->count == 0);
+
+    // Bucket limits belong to the next bucket.
+    Profiler_Record(4, PROFILER_FIRST_BUCKET_US - 1);
+    Profiler_Record(4, PROFILER_FIRST_BUCKET_US);
+    TEST_CHECK(Profiler_GetSlot(4)->histogram[0] == 1);
+    TEST_CHECK(Profiler_GetSlot(4)->histogram[1] == 1);
+
+    // Slots that do not exist are ignored.
+    Profiler_Record(PROFILER_SLOTS, 10);
+    Profiler_Record(0xFF, 10);
+    TEST_CHECK(Profiler_GetSlot(PROFILER_SLOTS) == 0);
+    TEST_CHECK(Profiler_GetSlot(PROFILER_SLOT_LOOP)->count == 0);
+}
+
+void TestSaturation()
+{
+    // - VARIABLES - //
+    const Profiler_Slot* measurements = Profiler_GetSlot(PROFILER_SLOT_LOOP);
+
+    Profiler_Reset();
+    for(unsigned long i = 0; i < 0x10010UL; i++) Profiler_Record(PROFILER_SLOT_LOOP, 1);
+
+    // The histogram stops at its largest count instead of wrapping around. The count does not.
+    TEST_CHECK(measurements->histogram[0] == 0xFFFF);
+    TEST_CHECK(measurements->count == 0x10010UL);
+    TEST_CHECK(measurements->total_us == 0x10010ULL);
+}
+
+void TestMacros()
+{
+    Profiler_Reset();
+    PROFILER_START();
+    delayMicroseconds(300);
+    PROFILER_STOP(5);
+
+    TEST_CHECK(Profiler_GetSlot(5)->count == 1);
+    TEST_CHECK(Profiler_GetSlot(5)->min_us == 300);
+    TEST_CHECK(Profiler_GetSlot(5)->histogram[2] == 1);
+}
+
+void TestCommands()
+{
+    // - VARIABLES - //
+    std::string output = "";
+
+    Profiler_Reset();
+    Profiler_Record(2, 5);
+    TakeDebugOutput();
+
+    // Other characters are ignored.
+    DEBUG_SERIAL.Host_Receive('x');
+    PROFILER_HANDLE_COMMANDS();
+    TEST_CHECK(TakeDebugOutput().empty());
+    TEST_CHECK(Profiler_GetSlot(2)->count == 1);
+
+    // Printing keeps the measurements. Slots that were not measured are not printed.
+    DEBUG_SERIAL.Host_Receive(PROFILER_COMMAND_PRINT);
+    PROFILER_HANDLE_COMMANDS();
+    output = TakeDebugOutput();
+    TEST_CHECK(output.find("Function 2 Calls: 1") != std::string::npos);
+    TEST_CHECK(output.find("Function 1 ") == std::string::npos);
+    TEST_CHECK(Profiler_GetSlot(2)->count == 1);
+
+    DEBUG_SERIAL.Host_Receive(PROFILER_COMMAND_RESET);
+    PROFILER_HANDLE_COMMANDS();
+    TEST_CHECK(Profiler_GetSlot(2)->count == 0);
+    TEST_CHECK(Profiler_GetSlot(2)->min_us == 0xFFFFFFFFUL);
+    TEST_CHECK(DEBUG_SERIAL.available() == 0);
+
+    // Nothing is printed once everything is cleared.
+    DEBUG_SERIAL.Host_Receive(PROFILER_COMMAND_PRINT);
+    PROFILER_HANDLE_COMMANDS();
+    TEST_CHECK(TakeDebugOutput().empty());
+}
+
+int main()
+{
+    TestFirstUse();
+    Debug_Init();
+    TestRecord();
+    TestSaturation();
+    TestMacros();
+    TestCommands();
+    return Test_Result();
+}
@@ -0,0 +1,207 @@
+/**
+ * @file ProtocolTest.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Tests the encoder and decoder of the binary
+ * frames sent between XFactor and SafeBox. Every
+ * payload length is round tripped, corrupted
+ * frames must be rejected and the decoder must
+ * find the next frame after a lost byte.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Communication/Protocol.hpp"
+#include "Test.hpp"
+
+/**
+ * @brief
+ * CRC-8 with polynomial 0x07 computed bit by
+ * bit, to check the table of Protocol.cpp.
+ */
+unsigned char BitwiseCRC8(unsigned char crc, unsigned char data)
+{
+    crc ^= data;
+    for(int bit = 0; bit < 8; bit++)
+    {
+        crc = (crc & 0x80) ? (unsigned char)((crc << 1) ^ 0x07) : (unsigned char)(crc << 1);
+    }
+    return crc;
+}
+
+/**
+ * @brief
+ * Feeds bytes to a decoder.
+ * @return int:
+ * How many frames were completed.
+ */
+int Decode(Protocol_Decoder* decoder, const unsigned char* bytes, int count)
+{
+    int frames = 0;
+    for(int i = 0; i < count; i++)
+    {
+        if(Protocol_DecodeByte(decoder, bytes[i])) frames++;
+    }
+    return frames;
+}
+
+/**
+ * @brief
+ * Encodes a frame whose payload depends on its
+ * length and sequence.
+ * @return unsigned char:
+ * Encoded length.
+ */
+unsigned char EncodeTestFrame(unsigned char sequence, unsigned char length, unsigned char* buffer)
+{
+    unsigned char payload[PROTOCOL_MAX_PAYLOAD_LENGTH];
+    for(unsigned char i = 0; i < length; i++) payload[i] = (unsigned char)(i * 37 + sequence);
+    return Protocol_Encode(0x42, sequence, payload, length, buffer, PROTOCOL_MAX_FRAME_LENGTH);
+}
+
+/**
+ * @brief
+ * Checks that a decoded frame is the one that
+ * @ref EncodeTestFrame encodes.
+ */
+bool IsTestFrame(const Protocol_Frame* frame, unsigned char sequence, unsigned char length)
+{
+    if(frame->opcode != 0x42 || frame->sequence != sequence || frame->length != length) return false;
+    for(unsigned char i = 0; i < length; i++)
+    {
+        if(frame->payload[i] != (unsigned char)(i * 37 + sequence)) return false;
+    }
+    return frame->payload[length] == 0;
+}
+
+/**
+ * @brief
+ * Feeds bytes to a decoder and looks for a test
+ * frame in what it decodes.
+ * @return true:
+ * The frame of @ref EncodeTestFrame with that
+ * sequence and length was decoded.
+ */
+bool DecodeTestFrame(Protocol_Decoder* decoder, const unsigned char* bytes, int count, unsigned char sequence, unsigned char length)
+{
+    bool found = false;
+    for(int i = 0; i < count; i++)
+    {
+        if(Protocol_DecodeByte(decoder, bytes[i]) && IsTestFrame(&decoder->frame, sequence, length)) found = true;
+    }
+    return found;
+}
+
+int main()
+{
+    // - VARIABLES - //
+    Protocol_Decoder decoder;
+    unsigned char frame[PROTOCOL_MAX_FRAME_LENGTH];
+    unsigned char next[PROTOCOL_MAX_FRAME_LENGTH];
+    // A corrupted length can make a frame swallow the next one. The bytes that follow complete it.
+    unsigned char bytes[3 * PROTOCOL_MAX_FRAME_LENGTH] = {0};
+    unsigned char encoded = 0;
+    unsigned char nextEncoded = 0;
+    unsigned long rejectedFrames = 0;
+    unsigned long lostBytes = 0;
+    unsigned long missedFrames = 0;
+    unsigned char header[PROTOCOL_HEADER_LENGTH];
+    unsigned char crc = 0;
+
+    Protocol_ResetDecoder(&decoder);
+    decoder.rejectedFrames = 0;
+
+    // - CRC TABLE - //
+    for(int value = 0; value < 256; value++)
+    {
+        TEST_CHECK(Protocol_CRC8(0, (unsigned char)value) == BitwiseCRC8(0, (unsigned char)value));
+    }
+
+    // - ROUND TRIP - //
+    for(unsigned char length = 0; length <= PROTOCOL_MAX_PAYLOAD_LENGTH; length++)
+    {
+        encoded = EncodeTestFrame(length + 1, length, frame);
+        TEST_CHECK(encoded == length + PROTOCOL_FRAME_OVERHEAD);
+        TEST_CHECK(frame[0] == PROTOCOL_SYNC_BYTE);
+
+        // The frame is only complete on its last byte.
+        TEST_CHECK(Decode(&decoder, frame, encoded - 1) == 0);
+        TEST_CHECK(Protocol_DecodeByte(&decoder, frame[encoded - 1]));
+        TEST_CHECK(IsTestFrame(&decoder.frame, length + 1, length));
+    }
+    TEST_CHECK(decoder.rejectedFrames == 0);
+
+    // - ENCODER CHECKS - //
+    TEST_CHECK(Protocol_Encode(0x42, 1, frame, PROTOCOL_MAX_PAYLOAD_LENGTH + 1, bytes, sizeof(bytes)) == 0);
+    TEST_CHECK(Protocol_Encode(0x42, 1, 0, 1, frame, sizeof(frame)) == 0);
+    TEST_CHECK(Protocol_Encode(0x42, 1, next, 4, frame, 4 + PROTOCOL_FRAME_OVERHEAD - 1) == 0);
+    TEST_CHECK(Protocol_Encode(0x42, 1, 0, 0, frame, PROTOCOL_FRAME_OVERHEAD) == PROTOCOL_FRAME_OVERHEAD);
+
+    // - HEADER - //
+    // Bluetooth queues frames with the header alone. It must start them like Protocol_Encode does.
+    encoded = EncodeTestFrame(11, 9, frame);
+    crc = Protocol_EncodeHeader(0x42, 11, 9, header);
+    TEST_CHECK(memcmp(header, frame, PROTOCOL_HEADER_LENGTH) == 0);
+    for(unsigned char i = PROTOCOL_HEADER_LENGTH; i < encoded - 1; i++) crc = Protocol_CRC8(crc, frame[i]);
+    TEST_CHECK(crc == frame[encoded - 1]);
+
+    // - CORRUPTED BYTES - //
+    // Every single bit flip after the sync byte must be rejected, and the next frame still received.
+    for(unsigned char length = 0; length <= PROTOCOL_MAX_PAYLOAD_LENGTH; length++)
+    {
+        encoded = EncodeTestFrame(7, length, frame);
+        nextEncoded = EncodeTestFrame(8, length, next);
+        for(unsigned char corrupted = 1; corrupted < encoded; corrupted++)
+        {
+            for(int bit = 0; bit < 8; bit++)
+            {
+                memset(bytes, 0, sizeof(bytes));
+                memcpy(bytes, frame, encoded);
+                memcpy(&bytes[encoded], next, nextEncoded);
+                bytes[corrupted] ^= (unsigned char)(1 << bit);
+
+                Protocol_ResetDecoder(&decoder);
+                rejectedFrames = decoder.rejectedFrames;
+                TEST_CHECK(DecodeTestFrame(&decoder, bytes, sizeof(bytes), 8, length));
+                TEST_CHECK(decoder.rejectedFrames > rejectedFrames);
+            }
+        }
+    }
+
+    // - LOST BYTES - //
+    // A frame missing a byte must not swallow the next frame.
+    // Unless CRC-8 misses it, which happens for 1 in 256 frames, and the next frame's sync is taken as the CRC.
+    for(unsigned char length = 0; length <= PROTOCOL_MAX_PAYLOAD_LENGTH; length++)
+    {
+        encoded = EncodeTestFrame(9, length, frame);
+        nextEncoded = EncodeTestFrame(10, length, next);
+        for(unsigned char lost = 0; lost < encoded; lost++)
+        {
+            memset(bytes, 0, sizeof(bytes));
+            memcpy(bytes, frame, lost);
+            memcpy(&bytes[lost], &frame[lost + 1], encoded - lost - 1);
+            memcpy(&bytes[encoded - 1], next, nextEncoded);
+
+            Protocol_ResetDecoder(&decoder);
+            if(!DecodeTestFrame(&decoder, bytes, sizeof(bytes), 10, length)) missedFrames++;
+            lostBytes++;
+        }
+    }
+    printf("%lu of %lu frames that lost a byte swallowed the next one\n", missedFrames, lostBytes);
+    TEST_CHECK(missedFrames * 100 <= lostBytes);
+
+    // - GIBBERISH - //
+    // Bytes in between frames are ignored.
+    Protocol_ResetDecoder(&decoder);
+    for(int value = 0; value < 256; value++)
+    {
+        if(value != PROTOCOL_SYNC_BYTE) Protocol_DecodeByte(&decoder, (unsigned char)value);
+    }
+    encoded = EncodeTestFrame(11, 3, frame);
+    TEST_CHECK(Decode(&decoder, frame, encoded) == 1);
+    TEST_CHECK(IsTestFrame(&decoder.frame, 11, 3));
+
+    return Test_Result();
+}
@@ -0,0 +1,145 @@
+/**
+ * @file SafeBoxCommandTest.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Tests how SafeBox executes the commands that
+ * XFactor sends. Commands are received on the
+ * Bluetooth serial port, executed by
+ * SafeBox_CheckAndExecuteMessage and what SafeBox
+ * sends back is decoded.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Fuzz.hpp"
+#include "SafeBox/Communication.hpp"
+#include "Test.hpp"
+
+/**
+ * @brief
+ * Makes SafeBox receive and execute a command.
+ * @param answer
+ * Last frame that SafeBox sent back. Its opcode
+ * is 0 if nothing was sent.
+ */
+void Execute(unsigned char opcode, unsigned char sequence, const unsigned char* payload, unsigned char length, Protocol_Frame* answer)
+{
+    // - VARIABLES - //
+    Protocol_Frame command;
+    Protocol_Decoder decoder;
+    int character = 0;
+
+    command.opcode = opcode;
+    command.sequence = sequence;
+    command.length = length;
+    if(length > 0) memcpy(command.payload, payload, length);
+    Fuzz_ReceiveFrame(&BT_SERIAL, &command);
+
+    Host_SetTime_us(Host_GetTime_us() + 1000);
+    SafeBox_CheckAndExecuteMessage();
+
+    Protocol_ResetDecoder(&decoder);
+    answer->opcode = 0;
+    while((character = BT_SERIAL.Host_Transmit()) >= 0)
+    {
+        if(Protocol_DecodeByte(&decoder, (unsigned char)character)) memcpy(answer, &decoder.frame, sizeof(Protocol_Frame));
+    }
+}
+
+/**
+ * @brief
+ * Makes SafeBox execute a status exchange that
+ * XFactor sent during the specified session.
+ */
+void ExchangeStatus(XFactor_Status status, unsigned char session, unsigned char sequence, Protocol_Frame* answer)
+{
+    // - VARIABLES - //
+    unsigned char payload[STATUS_EXCHANGE_COMMAND_LENGTH] = {0};
+
+    StatusCodec_EncodeXFactor(status, &payload[0]);
+    payload[STATUS_EXCHANGE_PAYLOAD_SESSION] = session;
+    Execute(COMMAND_STATUS_EXCHANGE, sequence, payload, sizeof(payload), answer);
+}
+
+void TestSessions()
+{
+    // - VARIABLES - //
+    Protocol_Frame answer;
+
+    ExchangeStatus(XFactor_Status::WaitingForDelivery, 1, 3, &answer);
+    TEST_CHECK(answer.opcode == ANSWER_STATUS_EXCHANGE);
+    TEST_CHECK(answer.sequence == 3);
+    TEST_CHECK(XFactor_GetStatus() == XFactor_Status::WaitingForDelivery);
+
+    // A retransmission during the same session is answered again without being executed.
+    ExchangeStatus(XFactor_Status::LeavingSafeBox, 1, 3, &answer);
+    TEST_CHECK(answer.opcode == ANSWER_STATUS_EXCHANGE);
+    TEST_CHECK(answer.sequence == 3);
+    TEST_CHECK(XFactor_GetStatus() == XFactor_Status::WaitingForDelivery);
+
+    // XFactor rebooted and reused the sequence number. It is a new command.
+    ExchangeStatus(XFactor_Status::LeavingSafeBox, 2, 3, &answer);
+    TEST_CHECK(answer.opcode == ANSWER_STATUS_EXCHANGE);
+    TEST_CHECK(answer.sequence == 3);
+    TEST_CHECK(XFactor_GetStatus() == XFactor_Status::LeavingSafeBox);
+}
+
+/**
+ * @brief
+ * Command handler that fails before it answers.
+ */
+bool FailWithoutAnswer(const Protocol_Frame* command)
+{
+    return false;
+}
+
+void TestUnansweredCommands()
+{
+    // - VARIABLES - //
+    Protocol_Frame answer;
+    unsigned char unknownOpcodes[] = {0x00, 0x0E, 0x0F, 0x42};
+
+    // XFactor hears right away about a command that SafeBox does not know.
+    for(unsigned char i = 0; i < sizeof(unknownOpcodes); i++)
+    {
+        Execute(unknownOpcodes[i], 10 + i, 0, 0, &answer);
+        TEST_CHECK(answer.opcode == ANSWER_UNKNOWN_COMMAND);
+        TEST_CHECK(answer.sequence == 10 + i);
+        TEST_CHECK(answer.length == 1 && answer.payload[0] == unknownOpcodes[i]);
+    }
+
+    // A handler that fails without answering still gets an answer.
+    TEST_CHECK(SafeBox_RegisterCommand(0x0E, FailWithoutAnswer));
+    Execute(0x0E, 20, 0, 0, &answer);
+    TEST_CHECK(answer.opcode == ANSWER_COMMAND_FAILED);
+    TEST_CHECK(answer.sequence == 20);
+    TEST_CHECK(answer.length == 1 && answer.payload[0] == 0x0E);
+    TEST_CHECK(SafeBox_RegisterCommand(0x0E, 0));
+
+    // Every command of the protocol is answered.
+    Execute(COMMAND_LID_GET, 21, 0, 0, &answer);
+    TEST_CHECK(answer.opcode == ANSWER_LID_CLOSED);
+    Host_SetDigitalPin(LID_CLOSED_SWITCH_PIN, LOW);
+    Execute(COMMAND_LID_GET, 22, 0, 0, &answer);
+    TEST_CHECK(answer.opcode == ANSWER_LID_OPEN);
+    Host_SetDigitalPin(LID_CLOSED_SWITCH_PIN, HIGH);
+
+    Execute(COMMAND_GET_PACKAGE_COUNT, 23, 0, 0, &answer);
+    TEST_CHECK(answer.opcode == ANSWER_PACKAGE_COUNT);
+    TEST_CHECK(answer.sequence == 23);
+    TEST_CHECK(answer.length == 1 && answer.payload[0] == 0);
+}
+
+int main()
+{
+    Debug_Init();
+    BT_Init();
+    SafeBox_SetNewStatus(SafeBox_Status::WaitingForDelivery);
+    Host_SetDigitalPin(LID_CLOSED_SWITCH_PIN, HIGH);
+
+    TestSessions();
+    TestUnansweredCommands();
+    return Test_Result();
+}
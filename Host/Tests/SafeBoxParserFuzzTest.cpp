@@ -0,0 +1,132 @@
+/**
+ * @file SafeBoxParserFuzzTest.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Fuzz test of the parsers of SafeBox that read
+ * what XFactor sends. Random frames are given to
+ * SafeBox_SaveReceivedXFactorStatus, then random
+ * commands and bytes are received on the
+ * Bluetooth serial port and executed by
+ * SafeBox_CheckAndExecuteMessage. Built with
+ * ASan and UBSan when available so that a read
+ * out of a frame fails the test.
+ *
+ * Usage: SafeBoxParserFuzzTest [iterations] [seed]
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Fuzz.hpp"
+#include "SafeBox/Communication.hpp"
+#include "Test.hpp"
+
+// - DEFINES - //
+/// @brief Frames given to each parser unless specified on the command line.
+#define FUZZ_DEFAULT_ITERATIONS 100000UL
+
+/**
+ * @brief
+ * Returns what SafeBox_SaveReceivedXFactorStatus
+ * must return for a frame.
+ */
+bool IsStatus(const Protocol_Frame* command)
+{
+    // - VARIABLES - //
+    XFactor_Status status = XFactor_Status::Off;
+
+    if(command->opcode != COMMAND_STATUS_EXCHANGE && command->opcode != COMMAND_SNAPSHOT) return false;
+    return command->length > 0 && StatusCodec_DecodeXFactor(command->payload[0], &status);
+}
+
+/**
+ * @brief
+ * Takes everything SafeBox sent and decodes it.
+ * @param decoder
+ * Decoder of what SafeBox sends. Its rejected
+ * frames must stay at 0.
+ * @return unsigned long:
+ * How many frames were sent.
+ */
+unsigned long TakeTransmitted(Protocol_Decoder* decoder)
+{
+    // - VARIABLES - //
+    int character = 0;
+    unsigned long frames = 0;
+
+    while((character = BT_SERIAL.Host_Transmit()) >= 0)
+    {
+        if(Protocol_DecodeByte(decoder, (unsigned char)character)) frames++;
+    }
+    return frames;
+}
+
+int main(int argc, char** argv)
+{
+    // - VARIABLES - //
+    unsigned long iterations = FUZZ_DEFAULT_ITERATIONS;
+    unsigned long randomState = 0x2545F491UL;
+    unsigned long saved = 0;
+    unsigned long answers = 0;
+    Protocol_Decoder transmitted;
+    Protocol_Frame frame;
+
+    if(argc > 1) iterations = strtoul(argv[1], 0, 10);
+    if(argc > 2) randomState = strtoul(argv[2], 0, 10);
+    if(randomState == 0) randomState = 1;
+    printf("Seed %lu\n", randomState);
+
+    Debug_Init();
+    BT_Init();
+    SafeBox_SetNewStatus(SafeBox_Status::WaitingForDelivery);
+    Host_SetDigitalPin(LID_CLOSED_SWITCH_PIN, HIGH);
+    Protocol_ResetDecoder(&transmitted);
+    transmitted.rejectedFrames = 0;
+
+    // - STATUSES - //
+    for(unsigned long i = 0; i < iterations; i++)
+    {
+        if(i % 2 == 0) Fuzz_RandomFrame(&frame, &randomState, 0x00, 0xFF);
+        else Fuzz_RandomFrame(&frame, &randomState, COMMAND_STATUS_EXCHANGE, COMMAND_SNAPSHOT);
+        if(SafeBox_SaveReceivedXFactorStatus(&frame)) saved++;
+        TEST_CHECK(SafeBox_SaveReceivedXFactorStatus(&frame) == IsStatus(&frame));
+    }
+
+    // - BLUETOOTH RECEPTION - //
+    for(unsigned long i = 0; i < iterations; i++)
+    {
+        switch(Fuzz_Random(&randomState) % 4)
+        {
+            case(0):
+                for(unsigned long count = Fuzz_Random(&randomState) % 16; count > 0; count--)
+                {
+                    BT_SERIAL.Host_Receive((unsigned char)Fuzz_Random(&randomState));
+                }
+                break;
+
+            case(1):
+                Fuzz_RandomFrame(&frame, &randomState, 0x00, 0xFF);
+                Fuzz_ReceiveFrame(&BT_SERIAL, &frame);
+                break;
+
+            default:
+                Fuzz_RandomFrame(&frame, &randomState, 0x00, COMMAND_GARAGE_OPEN_AT + 1);
+                Fuzz_ReceiveFrame(&BT_SERIAL, &frame);
+                break;
+        }
+
+        Host_SetTime_us(Host_GetTime_us() + 1000);
+        SafeBox_CheckAndExecuteMessage();
+        SafeBox_CheckAndSendEvents();
+        SafeBox_UpdateScheduledGarage();
+        answers += TakeTransmitted(&transmitted);
+    }
+
+    printf("%lu of %lu statuses saved, %lu frames sent back\n", saved, iterations, answers);
+    TEST_CHECK(saved > 0);
+    TEST_CHECK(answers > 0);
+    // Whatever it received, SafeBox only sends valid frames.
+    TEST_CHECK(transmitted.rejectedFrames == 0);
+    return Test_Result();
+}
@@ -0,0 +1,133 @@
+/**
+ * @file SchedulerTest.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Tests that XFactor's periodic tasks keep their
+ * rate while an action waits for SafeBox. The
+ * tasks of Execute_CurrentFunction are
+ * registered with their real periods and
+ * budgets. The action asks SafeBox for its link
+ * statistics, which nobody answers, so it waits
+ * in BT_WaitForRequest until the request times
+ * out. The jitter of each task is printed.
+ * Asking if the status are exchanged must not
+ * wait at all.
+ *
+ * @attention
+ * Time only moves when a task says it worked.
+ * A wait that does not yield never ends, which
+ * ctest reports as a time out.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Host.hpp"
+#include "Actions/Actions.hpp"
+#include "Scheduler/Scheduler.hpp"
+#include "SafeBox/Communication.hpp"
+#include "Test.hpp"
+
+// - DEFINES - //
+/// @brief Time that each run of the sensors task takes.
+#define TEST_SENSORS_RUN_US 300
+/// @brief Time that each run of the communication task takes.
+#define TEST_COMMS_RUN_US 100
+/// @brief Time that a pass of the scheduler takes when no task is due.
+#define TEST_PASS_US 20
+/// @brief How long the test runs.
+#define TEST_DURATION_US 10000000ULL
+
+/// @brief How many times the action waited for SafeBox.
+unsigned long _waits = 0;
+/// @brief Longest wait of the action.
+unsigned long long _longestWait_us = 0;
+/// @brief Longest time that SafeBox_ExchangeStatus took.
+unsigned long long _longestExchange_us = 0;
+
+void SensorsTask()
+{
+    delayMicroseconds(TEST_SENSORS_RUN_US);
+}
+
+void CommsTask()
+{
+    BT_UpdateRequests();
+    SafeBox_UpdateStatusSync();
+    delayMicroseconds(TEST_COMMS_RUN_US);
+}
+
+void ActionsTask()
+{
+    // - VARIABLES - //
+    unsigned long long start_us = Host_GetTime_us();
+
+    SafeBox_ExchangeStatus();
+    if(Host_GetTime_us() - start_us > _longestExchange_us) _longestExchange_us = Host_GetTime_us() - start_us;
+
+    start_us = Host_GetTime_us();
+    SafeBox_PrintLinkStats();
+    if(Host_GetTime_us() - start_us > _longestWait_us) _longestWait_us = Host_GetTime_us() - start_us;
+    _waits++;
+}
+
+void PassTask()
+{
+    delayMicroseconds(TEST_PASS_US);
+}
+
+int main()
+{
+    // - VARIABLES - //
+    const Scheduler_Task* task = 0;
+
+    Debug_Init();
+    BT_Init();
+    XFactor_SetNewStatus(XFactor_Status::WaitingForDelivery);
+
+    // Same as Execute_CurrentFunction.
+    Scheduler_AddTask("Sensors", SensorsTask, TASK_SENSORS_PERIOD_US, TASK_SENSORS_BUDGET_US);
+    Scheduler_AddTask("Comms", CommsTask, TASK_COMMS_PERIOD_US, TASK_COMMS_BUDGET_US);
+    Scheduler_AddTask("Actions", ActionsTask, SCHEDULER_EVERY_PASS, SCHEDULER_NO_BUDGET);
+    Scheduler_AddTask("Pass", PassTask, SCHEDULER_EVERY_PASS, SCHEDULER_NO_BUDGET);
+
+    while(Host_GetTime_us() < TEST_DURATION_US)
+    {
+        // Nobody answers. Whatever XFactor sends is lost.
+        while(BT_SERIAL.Host_Transmit() >= 0);
+        Scheduler_Run();
+    }
+
+    // - RESULTS - //
+    printf("%lu waits for SafeBox, longest %.1f ms\n", _waits, _longestWait_us / 1000.0);
+    printf("%-8s %8s %8s %8s %12s %12s %12s\n", "Task", "Runs", "Overruns", "Missed", "Jitter avg", "Jitter max", "Longest");
+    for(unsigned char i = 0; i < Scheduler_GetTaskCount(); i++)
+    {
+        task = Scheduler_GetTask(i);
+        printf("%-8s %8lu %8lu %8lu %10luus %10luus %10luus\n",
+            task->name,
+            task->runs,
+            task->overruns,
+            task->missedPeriods,
+            (task->runs == 0) ? 0 : task->totalJitter_us / task->runs,
+            task->maxJitter_us,
+            task->maxDuration_us);
+    }
+
+    // The action really waited, and the periodic tasks never lost a period meanwhile.
+    TEST_CHECK(_waits > 0);
+    TEST_CHECK(_longestWait_us >= TASK_SENSORS_PERIOD_US * 10);
+    // SafeBox never answered the status exchanges. Asking about them still did not wait.
+    TEST_CHECK(!SafeBox_StatusIsSynced());
+    TEST_CHECK(_longestExchange_us == 0);
+    for(unsigned char i = 0; i < Scheduler_GetTaskCount(); i++)
+    {
+        task = Scheduler_GetTask(i);
+        if(task->period_us == SCHEDULER_EVERY_PASS) continue;
+        TEST_CHECK(task->missedPeriods == 0);
+        TEST_CHECK(task->maxJitter_us < task->period_us);
+        TEST_CHECK(task->overruns == 0);
+    }
+    return Test_Result();
+}
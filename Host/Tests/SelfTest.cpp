@@ -0,0 +1,72 @@
+/**
+ * @file SelfTest.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Runs the communication self-test of both
+ * firmwares, built with COMMUNICATION_SELF_TEST,
+ * over a clean simulated link. XFactor's first
+ * step runs the whole self-test while the link
+ * keeps stepping SafeBox. Every status and
+ * command must get its answer without a single
+ * error, and the round trips and throughput
+ * must have been measured.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Link.hpp"
+#include "Test.hpp"
+
+// - DEFINES - //
+/// @brief Commands sent once by TestAllCommands of XFactor's CommunicationTest.cpp
+#define TEST_COMMANDS 12
+/// @brief SELF_TEST_BENCHMARK_EXCHANGES of XFactor's CommunicationTest.hpp
+#define TEST_BENCHMARK_EXCHANGES 200
+/// @brief SELF_TEST_REPORT_MS of SafeBox's CommunicationTest.hpp
+#define TEST_REPORT_MS 5000
+
+int main()
+{
+    // - VARIABLES - //
+    Link link;
+    Channel_Settings clean = {0, 0, 0.0f, 0.0f};
+    Link_SelfTest xFactor;
+    Link_SelfTest safeBox;
+
+    Link_Init(&link, &clean, 1);
+    Link_LetXFactorWait(&link);
+
+    // The whole self-test runs inside of this step.
+    Link_Step(&link);
+    // Lets SafeBox report what it received.
+    Link_Run(&link, TEST_REPORT_MS * 1000ULL);
+
+    XFactorSide_GetSelfTest(&xFactor);
+    SafeBoxSide_GetSelfTest(&safeBox);
+    printf("XFactor: %lu round trips, p99: %lums, %.1f exchanges/s, %lu errors, SafeBox status received: %u/%u\n",
+        xFactor.exchanges, xFactor.roundTripP99_ms, xFactor.exchangesPerSecond, xFactor.errors, xFactor.receivedStatus, xFactor.validStatus);
+    printf("SafeBox: %lu status exchanges, %lu errors, XFactor status received: %u/%u\n",
+        safeBox.exchanges, safeBox.errors, safeBox.receivedStatus, safeBox.validStatus);
+
+    // - XFACTOR - //
+    TEST_CHECK(xFactor.isDone);
+    TEST_CHECK(xFactor.errors == 0);
+    TEST_CHECK(xFactor.exchanges == safeBox.validStatus + TEST_COMMANDS + TEST_BENCHMARK_EXCHANGES);
+    TEST_CHECK(xFactor.receivedStatus == xFactor.validStatus);
+    TEST_CHECK(xFactor.roundTripP99_ms > 0);
+    TEST_CHECK(xFactor.exchangesPerSecond > 0.0f);
+
+    // - SAFEBOX - //
+    TEST_CHECK(safeBox.isDone);
+    TEST_CHECK(safeBox.errors == 0);
+    TEST_CHECK(safeBox.exchanges == safeBox.validStatus + TEST_BENCHMARK_EXCHANGES);
+    TEST_CHECK(safeBox.receivedStatus == safeBox.validStatus);
+
+    // - LINK - //
+    TEST_CHECK(link.toSafeBox.stats.bytesOverrun == 0);
+    TEST_CHECK(link.toXFactor.stats.bytesOverrun == 0);
+
+    return Test_Result();
+}
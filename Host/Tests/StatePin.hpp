@@ -0,0 +1,19 @@
+/**
+ * @file StatePin.hpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Header file included before everything else
+ * in the XFactor that LinkStateTest builds with
+ * BT_USE_STATE_PIN. The HC-05's STATE output is
+ * replaced by a variable that the test sets.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+#pragma once
+
+/// @brief What the HC-05's STATE output reads. HIGH while paired. Defined by the test.
+extern int _statePin;
+
+#define BT_READ_STATE_PIN() (_statePin)
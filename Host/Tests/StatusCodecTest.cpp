@@ -0,0 +1,73 @@
+/**
+ * @file StatusCodecTest.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Tests the codec that turns XFactor's and
+ * SafeBox's status into the byte sent over
+ * Bluetooth. Every possible code is decoded and
+ * must only be accepted if it is a value of the
+ * enum, which XFactor_SetNewStatus and
+ * SafeBox_SetNewStatus know since they list
+ * every value. Every value is round tripped.
+ *
+ * @attention
+ * Built once with each firmware, whose status
+ * files are not shared.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Communication/StatusCodec.hpp"
+#include "Test.hpp"
+
+int main()
+{
+    // - VARIABLES - //
+    XFactor_Status xfactorStatus = XFactor_Status::Off;
+    SafeBox_Status safeBoxStatus = SafeBox_Status::Off;
+    unsigned char code = 0;
+    unsigned int xfactorValues = 0;
+    unsigned int safeBoxValues = 0;
+    bool isValue = false;
+
+    // - XFACTOR - //
+    for(unsigned int value = 0; value < 256; value++)
+    {
+        isValue = XFactor_SetNewStatus((XFactor_Status)value);
+        TEST_CHECK(StatusCodec_DecodeXFactor((unsigned char)value, &xfactorStatus) == isValue);
+        TEST_CHECK(StatusCodec_EncodeXFactor((XFactor_Status)value, &code) == isValue);
+        if(!isValue) continue;
+
+        xfactorValues++;
+        TEST_CHECK(code == value);
+        TEST_CHECK(StatusCodec_DecodeXFactor(code, &xfactorStatus));
+        TEST_CHECK(xfactorStatus == (XFactor_Status)value);
+    }
+
+    // - SAFEBOX - //
+    for(unsigned int value = 0; value < 256; value++)
+    {
+        isValue = SafeBox_SetNewStatus((SafeBox_Status)value);
+        TEST_CHECK(StatusCodec_DecodeSafeBox((unsigned char)value, &safeBoxStatus) == isValue);
+        TEST_CHECK(StatusCodec_EncodeSafeBox((SafeBox_Status)value, &code) == isValue);
+        if(!isValue) continue;
+
+        safeBoxValues++;
+        TEST_CHECK(code == value);
+        TEST_CHECK(StatusCodec_DecodeSafeBox(code, &safeBoxStatus));
+        TEST_CHECK(safeBoxStatus == (SafeBox_Status)value);
+    }
+
+    // - NULL POINTERS - //
+    TEST_CHECK(!StatusCodec_DecodeXFactor((unsigned char)XFactor_Status::Off, 0));
+    TEST_CHECK(!StatusCodec_EncodeXFactor(XFactor_Status::Off, 0));
+    TEST_CHECK(!StatusCodec_DecodeSafeBox((unsigned char)SafeBox_Status::Off, 0));
+    TEST_CHECK(!StatusCodec_EncodeSafeBox(SafeBox_Status::Off, 0));
+
+    printf("%u XFactor statuses and %u SafeBox statuses\n", xfactorValues, safeBoxValues);
+    TEST_CHECK(xfactorValues > 0);
+    TEST_CHECK(safeBoxValues > 0);
+    return Test_Result();
+}
@@ -0,0 +1,44 @@
+/**
+ * @file Test.hpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Header file containing the checks used by the
+ * host tests of Host/Tests. A failed check is
+ * printed and the test's main returns
+ * @ref Test_Result so that ctest sees it.
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+#pragma once
+
+// - INCLUDES - //
+#include <stdio.h>
+
+/// @brief How many checks failed so far.
+static unsigned long _testFailures = 0;
+
+/// @brief Fails the test if the condition is false. The test keeps running.
+#define TEST_CHECK(condition)                                                       \
+    do {                                                                            \
+        if(!(condition))                                                            \
+        {                                                                           \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);    \
+            _testFailures++;                                                        \
+        }                                                                           \
+    } while(0)
+
+/**
+ * @brief
+ * Prints how the test went.
+ * @return int:
+ * What main must return. 0 if every check
+ * passed.
+ */
+static inline int Test_Result()
+{
+    if(_testFailures == 0) printf("All checks passed\n");
+    else printf("%lu checks failed\n", _testFailures);
+    return (_testFailures == 0) ? 0 : 1;
+}
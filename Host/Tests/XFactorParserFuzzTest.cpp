@@ -0,0 +1,194 @@
+/**
+ * @file XFactorParserFuzzTest.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Fuzz test of the parsers of XFactor that read
+ * what SafeBox sends. Random frames are given to
+ * ParseReceivedAnswer and
+ * SafeBox_SaveReceivedEvent, then random frames
+ * and bytes are received on the Bluetooth serial
+ * port while requests are waiting for answers.
+ * Built with ASan and UBSan when available so
+ * that a read out of a frame fails the test.
+ *
+ * Usage: XFactorParserFuzzTest [iterations] [seed]
+ * @version 0.1
+ * @date 2023-12-08
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Fuzz.hpp"
+#include "SafeBox/Communication.hpp"
+#include "Test.hpp"
+
+// - DEFINES - //
+/// @brief Frames given to each parser unless specified on the command line.
+#define FUZZ_DEFAULT_ITERATIONS 100000UL
+
+/// @brief Not declared in a header. Only SafeBox/Communication.cpp and this test use it.
+bool ParseReceivedAnswer(const Protocol_Frame* answer);
+
+/**
+ * @brief
+ * Returns what ParseReceivedAnswer must return
+ * for a frame.
+ */
+bool IsParsable(const Protocol_Frame* answer)
+{
+    // - VARIABLES - //
+    SafeBox_Status status = SafeBox_Status::Off;
+
+    switch(answer->opcode)
+    {
+        case(ANSWER_PACKAGE_CHECK_SUCCESS):
+        case(ANSWER_PACKAGE_CHECK_FAILED):
+        case(ANSWER_DOORBELL_RANG):
+        case(ANSWER_DOORBELL_NOT_RANG):
+        case(ANSWER_GARAGE_SUCCESS):
+        case(ANSWER_GARAGE_FAILED):
+        case(ANSWER_GARAGE_OPEN):
+        case(ANSWER_GARAGE_CLOSED):
+        case(ANSWER_LID_SUCCESS):
+        case(ANSWER_LID_FAILED):
+        case(ANSWER_LID_OPEN):
+        case(ANSWER_LID_CLOSED):
+        case(ANSWER_UNKNOWN_COMMAND):
+        case(ANSWER_COMMAND_FAILED):
+            return true;
+
+        case(ANSWER_PACKAGE_COUNT):
+            return answer->length > 0;
+
+        case(ANSWER_STATUS_EXCHANGE):
+            return answer->length > 0 && StatusCodec_DecodeSafeBox(answer->payload[0], &status);
+
+        case(ANSWER_SNAPSHOT):
+            return answer->length > SNAPSHOT_PAYLOAD_STATUS && StatusCodec_DecodeSafeBox(answer->payload[SNAPSHOT_PAYLOAD_STATUS], &status);
+
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief
+ * Takes everything XFactor sent and decodes it.
+ * @param decoder
+ * Decoder of what XFactor sends. Its rejected
+ * frames must stay at 0.
+ * @param sequence
+ * Set to the sequence of the last command sent.
+ * Untouched if none was sent.
+ */
+void TakeTransmitted(Protocol_Decoder* decoder, unsigned char* sequence)
+{
+    // - VARIABLES - //
+    int character = 0;
+
+    while((character = BT_SERIAL.Host_Transmit()) >= 0)
+    {
+        if(Protocol_DecodeByte(decoder, (unsigned char)character) && decoder->frame.opcode < PROTOCOL_OPCODE_TEXT)
+        {
+            *sequence = decoder->frame.sequence;
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    // - VARIABLES - //
+    unsigned long iterations = FUZZ_DEFAULT_ITERATIONS;
+    unsigned long randomState = 0x2545F491UL;
+    unsigned long parsed = 0;
+    unsigned long completed = 0;
+    unsigned char sequence = PROTOCOL_NO_SEQUENCE;
+    unsigned char handle = BT_INVALID_REQUEST;
+    BT_RequestState state = BT_RequestState::Free;
+    Protocol_Decoder transmitted;
+    Protocol_Frame frame;
+
+    if(argc > 1) iterations = strtoul(argv[1], 0, 10);
+    if(argc > 2) randomState = strtoul(argv[2], 0, 10);
+    if(randomState == 0) randomState = 1;
+    printf("Seed %lu\n", randomState);
+
+    Debug_Init();
+    BT_Init();
+    XFactor_SetNewStatus(XFactor_Status::WaitingForDelivery);
+    Protocol_ResetDecoder(&transmitted);
+    transmitted.rejectedFrames = 0;
+
+    // - ANSWERS - //
+    for(unsigned long i = 0; i < iterations; i++)
+    {
+        if(i % 4 == 0) Fuzz_RandomFrame(&frame, &randomState, 0x00, 0xFF);
+        else Fuzz_RandomFrame(&frame, &randomState, ANSWER_LID_OPEN, ANSWER_COMMAND_FAILED);
+        if(ParseReceivedAnswer(&frame)) parsed++;
+        TEST_CHECK(ParseReceivedAnswer(&frame) == IsParsable(&frame));
+    }
+
+    // - EVENTS - //
+    for(unsigned long i = 0; i < iterations; i++)
+    {
+        Fuzz_RandomFrame(&frame, &randomState, PROTOCOL_FIRST_EVENT_OPCODE, 0xFF);
+        SafeBox_SaveReceivedEvent(&frame);
+    }
+
+    // - BLUETOOTH RECEPTION - //
+    // Random answers carry the sequence of the request waiting for one, so they reach the parsers.
+    for(unsigned long i = 0; i < iterations; i++)
+    {
+        if(handle == BT_INVALID_REQUEST) handle = SafeBox_SubmitSnapshot();
+
+        Host_SetTime_us(Host_GetTime_us() + 1000);
+        BT_UpdateRequests();
+        SafeBox_UpdateStatusSync();
+        TakeTransmitted(&transmitted, &sequence);
+
+        switch(Fuzz_Random(&randomState) % 4)
+        {
+            case(0):
+                for(unsigned long count = Fuzz_Random(&randomState) % 16; count > 0; count--)
+                {
+                    BT_SERIAL.Host_Receive((unsigned char)Fuzz_Random(&randomState));
+                }
+                break;
+
+            case(1):
+                Fuzz_RandomFrame(&frame, &randomState, 0x00, 0xFF);
+                Fuzz_ReceiveFrame(&BT_SERIAL, &frame);
+                break;
+
+            default:
+                Fuzz_RandomFrame(&frame, &randomState, ANSWER_LID_OPEN, ANSWER_COMMAND_FAILED);
+                frame.sequence = sequence;
+                Fuzz_ReceiveFrame(&BT_SERIAL, &frame);
+                break;
+        }
+
+        // The handle is released once the request is done.
+        if(handle == BT_INVALID_REQUEST) continue;
+        state = SafeBox_PollCommand(handle, 0);
+        if(state == BT_RequestState::Queued || state == BT_RequestState::WaitingForAnswer) continue;
+        if(state == BT_RequestState::Completed) completed++;
+        handle = BT_INVALID_REQUEST;
+    }
+
+    // - TELEMETRY - //
+    // Only telemetry opcodes can be sent as telemetry.
+    for(unsigned long i = 0; i < iterations; i++)
+    {
+        Fuzz_RandomFrame(&frame, &randomState, 0x00, 0xFF);
+        if(frame.opcode >= PROTOCOL_FIRST_TELEMETRY_OPCODE && frame.opcode < PROTOCOL_FIRST_EVENT_OPCODE) continue;
+        TEST_CHECK(!BT_SendTelemetry(frame.opcode, frame.payload, frame.length));
+    }
+    TakeTransmitted(&transmitted, &sequence);
+
+    printf("%lu of %lu answers parsed, %lu snapshots completed\n", parsed, iterations, completed);
+    TEST_CHECK(parsed > 0);
+    TEST_CHECK(completed > 0);
+    // Whatever it received, XFactor only sends valid frames.
+    TEST_CHECK(transmitted.rejectedFrames == 0);
+    return Test_Result();
+}
@@ -16,6 +16,7 @@
 
 // - INCLUDES - //
 #include "Actions/Utils.hpp"
+#include "Debug/Profiler.hpp"
 
 //#pragma region [FUNCTION_IDS]
 
@@ -32,15 +33,50 @@
 #define FUNCTION_ID_END_OF_PROGRAM 15
 #define FUNCTION_ID_SAVE_NEW_CARD 16
 
+/// @brief How many function IDs there are. IDs go from 0 to this minus 1.
+#define FUNCTION_ID_COUNT 17
+/// @brief No function. Used before the first function is entered.
+#define FUNCTION_ID_NONE 255
+
+//#pragma endregion
+
+//#pragma region [STATES]
+
+/// @brief Bit of a function ID inside @ref Action_State allowedTransitions
+#define ACTION_TRANSITION(functionID) (1UL << (functionID))
+
+/// @brief Hook of an execution function. 0 when the function has nothing to do at that moment.
+typedef void (*Action_Hook)();
+
+/**
+ * @brief
+ * Row of the state table of the execution
+ * functions, indexed by function ID.
+ * @ref Execute_CurrentFunction calls onExit of
+ * the previous function and onEnter of the new
+ * one once per transition, then onTick each
+ * time it is called.
+ */
+typedef struct
+{
+    Action_Hook onEnter;
+    /// @brief The execution function itself. 0 for IDs that are not used.
+    Action_Hook onTick;
+    Action_Hook onExit;
+    /// @brief @ref ACTION_TRANSITION of each function ID that this function can go to.
+    unsigned long allowedTransitions;
+} Action_State;
+
 //#pragma endregion
 
 //#pragma region [ACTION_HANDLERS]
 /**
  * @brief Function periodically called in void
- * loop. This function is a massive switch case
- * that checks which execution / action function
- * should currently be executed by SafeBox. To
- * specify that function, use
+ * loop. Executes the current execution / action
+ * function through its row of the state table.
+ * Its onExit and the new function's onEnter are
+ * executed first if the function changed since
+ * the last call. To specify that function, use
  * @ref SetNewExecutionFunction using defines
  * available in this header file.
  */
@@ -69,7 +105,8 @@ void Execute_CurrentFunction();
  * to the new ID.
  * @return false:
  * Failed to change the execution function to the
- * new ID. May be out of range.
+ * new ID. May be out of range or not allowed
+ * from the current execution function.
  */
 bool SetNewExecutionFunction(unsigned char functionID);
 
@@ -82,6 +119,17 @@ bool SetNewExecutionFunction(unsigned char functionID);
  * function ID
  */
 unsigned char GetCurrentExecutionFunction();
+
+/**
+ * @brief
+ * Function that returns how many times a new
+ * execution function was entered by
+ * @ref Execute_CurrentFunction since the start
+ * of the program.
+ * @return unsigned long:
+ * Number of transitions.
+ */
+unsigned long GetExecutionTransitionCount();
 //#pragma endregion
 
 //#pragma region [ACTION_FUNCTIONS]
@@ -0,0 +1,193 @@
+/**
+ * @file Protocol.hpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Header file containing the definitions of the
+ * binary frames sent between XFactor and SafeBox
+ * over Bluetooth. A frame is made of a sync byte,
+ * an opcode, a sequence number, the length of
+ * its payload, the payload itself and a CRC-8 of
+ * everything but the sync byte.
+ *
+ * @attention
+ * This file is shared by XFactor and SafeBox.
+ * Both copies must stay identical.
+ * @version 0.1
+ * @date 2023-11-29
+ * @copyright Copyright (c) 2023
+ */
+
+#pragma once
+
+// - INCLUDES - //
+#include "Arduino.h"
+
+// - DEFINES - //
+/// @brief First byte of every frame. Used to find where a frame starts in the received bytes.
+#define PROTOCOL_SYNC_BYTE 0xA5
+/// @brief How big in bytes can the payload of a frame be.
+#define PROTOCOL_MAX_PAYLOAD_LENGTH 32
+/// @brief How many bytes come before the payload. Sync, opcode, sequence and length.
+#define PROTOCOL_HEADER_LENGTH 4
+/// @brief How many bytes a frame adds to its payload. The header and the CRC.
+#define PROTOCOL_FRAME_OVERHEAD (PROTOCOL_HEADER_LENGTH + 1)
+/// @brief How big in bytes can a whole frame be once encoded.
+#define PROTOCOL_MAX_FRAME_LENGTH (PROTOCOL_MAX_PAYLOAD_LENGTH + PROTOCOL_FRAME_OVERHEAD)
+/// @brief Opcode of frames whose payload is plain ASCII text. Used by BT_SendString.
+#define PROTOCOL_OPCODE_TEXT 0x7F
+/// @brief Opcodes from this one up to PROTOCOL_FIRST_EVENT_OPCODE are telemetry. They are never answered and can be dropped.
+#define PROTOCOL_FIRST_TELEMETRY_OPCODE 0xA0
+/// @brief Opcodes from this one and up are events sent without being asked. They never answer a command.
+#define PROTOCOL_FIRST_EVENT_OPCODE 0xC0
+/// @brief Sequence number of frames that are not commands nor their answers. They are never deduplicated.
+#define PROTOCOL_NO_SEQUENCE 0
+
+/**
+ * @brief
+ * A decoded frame. The payload is always
+ * followed by a 0 so that text payloads can be
+ * read as strings. An answer carries the
+ * sequence number of the command it answers.
+ */
+typedef struct
+{
+    unsigned char opcode;
+    unsigned char sequence;
+    unsigned char length;
+    unsigned char payload[PROTOCOL_MAX_PAYLOAD_LENGTH + 1];
+} Protocol_Frame;
+
+/**
+ * @brief
+ * Enumeration of the parts of a frame that the
+ * decoder can be waiting for.
+ */
+enum class Protocol_DecoderState {
+
+    /// @brief Bytes are discarded until @ref PROTOCOL_SYNC_BYTE is received.
+    WaitingForSync = 0,
+
+    /// @brief The next byte is the frame's opcode.
+    WaitingForOpcode = 1,
+
+    /// @brief The next byte is the frame's sequence number.
+    WaitingForSequence = 2,
+
+    /// @brief The next byte is the length of the frame's payload.
+    WaitingForLength = 3,
+
+    /// @brief Bytes are saved in the frame's payload.
+    ReceivingPayload = 4,
+
+    /// @brief The next byte is the CRC of the frame.
+    WaitingForCRC = 5
+};
+
+/**
+ * @brief
+ * Everything the decoder needs to remember in
+ * between received bytes. Also counts the
+ * frames it discarded.
+ */
+typedef struct
+{
+    Protocol_DecoderState state;
+    unsigned char received;
+    unsigned char crc;
+    Protocol_Frame frame;
+    unsigned long rejectedFrames;
+} Protocol_Decoder;
+
+/**
+ * @brief
+ * Adds a byte to a running CRC-8 (polynomial
+ * 0x07). The CRC of a frame starts at 0.
+ * @param crc
+ * CRC of the bytes before this one.
+ * @param data
+ * Byte to add to the CRC.
+ * @return unsigned char:
+ * The new CRC.
+ */
+unsigned char Protocol_CRC8(unsigned char crc, unsigned char data);
+
+/**
+ * @brief
+ * Encodes the bytes that come before the payload
+ * of a frame. Used by @ref Protocol_Encode and by
+ * whatever encodes frames somewhere else than in
+ * a buffer, like a ring buffer.
+ * @param opcode
+ * One of the COMMAND_ or ANSWER_ defines.
+ * @param sequence
+ * Sequence number of the frame or
+ * @ref PROTOCOL_NO_SEQUENCE
+ * @param length
+ * How many bytes of payload follow.
+ * @param header
+ * Buffer of @ref PROTOCOL_HEADER_LENGTH bytes in
+ * which the header is encoded.
+ * @return unsigned char:
+ * CRC of the header. Add each payload byte to it
+ * with @ref Protocol_CRC8 and send it last.
+ */
+unsigned char Protocol_EncodeHeader(unsigned char opcode, unsigned char sequence, unsigned char length, unsigned char* header);
+
+/**
+ * @brief
+ * Encodes a frame in the specified buffer so
+ * that it can be sent as is.
+ *
+ * @param opcode
+ * One of the COMMAND_ or ANSWER_ defines.
+ * @param sequence
+ * Sequence number of the frame or
+ * @ref PROTOCOL_NO_SEQUENCE
+ * @param payload
+ * Bytes sent with the opcode. Can be 0 if
+ * length is 0.
+ * @param length
+ * How many bytes of payload there is.
+ * @param buffer
+ * Buffer in which the frame is encoded.
+ * @param bufferSize
+ * Size in bytes of the specified buffer.
+ * @return unsigned char:
+ * How many bytes were encoded. 0 if the payload
+ * or the buffer were too small.
+ */
+unsigned char Protocol_Encode(unsigned char opcode, unsigned char sequence, const unsigned char* payload, unsigned char length, unsigned char* buffer, unsigned char bufferSize);
+
+/**
+ * @brief
+ * Puts a decoder back in a state where it waits
+ * for the start of a new frame.
+ * @param decoder
+ * The decoder to reset.
+ */
+void Protocol_ResetDecoder(Protocol_Decoder* decoder);
+
+/**
+ * @brief
+ * Feeds a received byte to a decoder. Once a
+ * whole frame with a valid CRC is received, it
+ * is available in the decoder's frame until the
+ * next byte is fed. Frames with an invalid CRC
+ * or length are discarded and counted in the
+ * decoder's rejectedFrames.
+ * A lost byte makes a frame swallow the start of
+ * the next one. The bytes of a discarded frame
+ * are thus searched for a sync byte, and the
+ * decoder continues from the first one that
+ * starts a frame.
+ *
+ * @param decoder
+ * The decoder that receives the byte.
+ * @param receivedByte
+ * The byte received.
+ * @return true:
+ * A valid frame was completed by this byte.
+ * @return false:
+ * No frame is ready yet.
+ */
+bool Protocol_DecodeByte(Protocol_Decoder* decoder, unsigned char receivedByte);
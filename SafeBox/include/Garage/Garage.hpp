@@ -34,6 +34,9 @@
 
 #define GARAGE_IS_CLOSED_DEBUG_PIN 5
 
+/// @brief How long the servo motor takes to fully open the garage. Scheduled openings start this early.
+#define GARAGE_OPENING_TIME_MS 1000
+
 /**
  * @brief 
  * Returns wether the garage SHOULD be closed
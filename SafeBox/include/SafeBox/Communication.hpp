@@ -15,6 +15,8 @@
 // - INCLUDES - //
 #include "XFactor/Status.hpp"           //// Used to store the status of SafeBox and get the enumeration of its possible values
 #include "Communication/Bluetooth.hpp"  //// Used to communicate information and receive information from SafeBox
+#include "Communication/StatusCodec.hpp"    //// Used to turn status into the codes sent over Bluetooth
+#include "Communication/ClockSync.hpp"      //// Used to sync the clocks through the status exchange
 #include "SafeBox/Status.hpp"
 #include "Lid/Lid.hpp"
 #include "Garage/Garage.hpp"
@@ -24,39 +26,128 @@
 // - DEFINES - //
 // - DEFINES - //
 #define COMMS_TIMEOUT_MS 5000
+#ifndef STATUS_SYNC_HEARTBEAT_MS
+/// @brief How often SafeBox's status is sent to XFactor when it does not change. Can be set as a build flag.
+#define STATUS_SYNC_HEARTBEAT_MS 1000
+#endif
+/// @brief Time in between two sends of the same @ref EVENT_DOORBELL_RANG until XFactor acknowledges it.
+#define EVENT_DOORBELL_REPEAT_MS 250
 
-#define COMMAND_LID_OPEN  "C_LID_O"
-#define COMMAND_LID_CLOSE "C_LID_C"
-#define COMMAND_LID_GET "C_LID_G"
-#define COMMAND_GARAGE_OPEN   "C_GAR_O"
-#define COMMAND_GARAGE_CLOSE  "C_GAR_C"
-#define COMMAND_GARAGE_GET  "C_GAR_G"
-#define COMMAND_DOORBELL_GET  "C_DRB_G"
-#define COMMAND_GET_PACKAGE_COUNT "C_PCK_G"
-#define COMMAND_CHECK_PACKAGE     "C_PCK_C"
-#define COMMAND_STATUS_EXCHANGE   "C_STE_"
+/// @brief Opcodes of the frames exchanged with XFactor. Commands are sent by XFactor and answered by SafeBox. MUST match XFactor's.
+#define COMMAND_LID_OPEN          0x01
+#define COMMAND_LID_CLOSE         0x02
+#define COMMAND_LID_GET           0x03
+#define COMMAND_GARAGE_OPEN       0x04
+#define COMMAND_GARAGE_CLOSE      0x05
+#define COMMAND_GARAGE_GET        0x06
+#define COMMAND_DOORBELL_GET      0x07
+#define COMMAND_GET_PACKAGE_COUNT 0x08
+#define COMMAND_CHECK_PACKAGE     0x09
+/// @brief Payload is the status code of XFactor followed by its clock. See the STATUS_EXCHANGE_PAYLOAD_ defines.
+#define COMMAND_STATUS_EXCHANGE   0x0A
+/// @brief Payload is the status code of XFactor. Answered with @ref ANSWER_SNAPSHOT
+#define COMMAND_SNAPSHOT          0x0B
+/// @brief Answered with @ref ANSWER_LINK_STATS
+#define COMMAND_LINK_STATS        0x0C
+/// @brief Payload is SafeBox's millis() at which its garage must be open. See @ref ClockSync_EncodeTime. Answered with @ref ANSWER_GARAGE_SUCCESS or @ref ANSWER_GARAGE_FAILED
+#define COMMAND_GARAGE_OPEN_AT    0x0D
 
-#define ANSWER_LID_OPEN      "A_LID_O"
-#define ANSWER_LID_CLOSED    "A_LID_C"
-#define ANSWER_LID_SUCCESS   "A_LID_S"
-#define ANSWER_LID_FAILED    "A_LID_S"
+#define ANSWER_LID_OPEN      0x81
+#define ANSWER_LID_CLOSED    0x82
+#define ANSWER_LID_SUCCESS   0x83
+#define ANSWER_LID_FAILED    0x84
 
-#define ANSWER_GARAGE_OPEN      "A_GAR_O"
-#define ANSWER_GARAGE_CLOSED    "A_GAR_C"
-#define ANSWER_GARAGE_SUCCESS   "A_GAR_S"
-#define ANSWER_GARAGE_FAILED    "A_GAR_S"
+#define ANSWER_GARAGE_OPEN      0x85
+#define ANSWER_GARAGE_CLOSED    0x86
+#define ANSWER_GARAGE_SUCCESS   0x87
+#define ANSWER_GARAGE_FAILED    0x88
 
-#define ANSWER_DOORBELL_RANG     "A_DRB_R"
-#define ANSWER_DOORBELL_NOT_RANG "A_DRB_N"
+#define ANSWER_DOORBELL_RANG     0x89
+#define ANSWER_DOORBELL_NOT_RANG 0x8A
 
-#define ANSWER_PACKAGE_COUNT         "A_PCK_C"
-#define ANSWER_PACKAGE_CHECK_SUCCESS "A_PCK_S"
-#define ANSWER_PACKAGE_CHECK_FAILED  "A_PCK_F"
+/// @brief Payload is the amount of packages inside of SafeBox.
+#define ANSWER_PACKAGE_COUNT         0x8B
+#define ANSWER_PACKAGE_CHECK_SUCCESS 0x8C
+#define ANSWER_PACKAGE_CHECK_FAILED  0x8D
 
-#define ANSWER_STATUS_EXCHANGE       "A_STE_"
+/// @brief Payload is the status code of SafeBox followed by the clocks. See the STATUS_EXCHANGE_PAYLOAD_ defines.
+#define ANSWER_STATUS_EXCHANGE       0x8E
+/// @brief Index in a status exchange's payload of the millis() of XFactor when it sent the command. The answer carries it back. See @ref ClockSync_EncodeTime
+#define STATUS_EXCHANGE_PAYLOAD_TIME      1
+/// @brief Index in a status exchange command's payload of XFactor's estimate of SafeBox's clock minus its own. See @ref ClockSync_GetOffset
+#define STATUS_EXCHANGE_PAYLOAD_OFFSET    5
+/// @brief Index in a status exchange command's payload of the accuracy of the offset. 2 bytes.
+#define STATUS_EXCHANGE_PAYLOAD_ACCURACY  9
+/// @brief Index in a status exchange command's payload of the number of the last ring XFactor got. Acknowledges @ref EVENT_DOORBELL_RANG
+#define STATUS_EXCHANGE_PAYLOAD_DOORBELL_RING 11
+/// @brief Index in a status exchange command's payload of XFactor's session. Changes each time XFactor boots. See @ref BT_InitRequests
+#define STATUS_EXCHANGE_PAYLOAD_SESSION   12
+/// @brief How long a status exchange command with timestamps is.
+#define STATUS_EXCHANGE_COMMAND_LENGTH    13
+/// @brief Index in a status exchange answer's payload of the millis() of SafeBox when it answered.
+#define STATUS_EXCHANGE_PAYLOAD_PEER_TIME 5
+/// @brief How long a status exchange answer with timestamps is.
+#define STATUS_EXCHANGE_ANSWER_LENGTH     9
+
+/// @brief Everything XFactor needs to know about SafeBox in one answer. See the SNAPSHOT_PAYLOAD_ defines.
+#define ANSWER_SNAPSHOT              0x8F
+/// @brief Index in a snapshot's payload of the garage state. 1 is opened.
+#define SNAPSHOT_PAYLOAD_GARAGE   0
+/// @brief Index in a snapshot's payload of the lid state. 1 is opened.
+#define SNAPSHOT_PAYLOAD_LID      1
+/// @brief Index in a snapshot's payload of the doorbell latch. 1 is rang.
+#define SNAPSHOT_PAYLOAD_DOORBELL 2
+/// @brief Index in a snapshot's payload of how many packages are inside of SafeBox.
+#define SNAPSHOT_PAYLOAD_PACKAGES 3
+/// @brief Index in a snapshot's payload of SafeBox's status code.
+#define SNAPSHOT_PAYLOAD_STATUS   4
+
+/// @brief Payload is SafeBox's Bluetooth statistics. See @ref BT_EncodeStats
+#define ANSWER_LINK_STATS            0x90
+/// @brief Sent instead of an answer when SafeBox does not know the command. Payload is the command's opcode.
+#define ANSWER_UNKNOWN_COMMAND       0x91
+/// @brief Sent instead of an answer when SafeBox failed to execute the command. Payload is the command's opcode.
+#define ANSWER_COMMAND_FAILED        0x92
+
+/// @brief Sent by SafeBox without being asked when its doorbell starts ringing. Payload is the ring's number. Repeated until a status exchange acknowledges it.
+#define EVENT_DOORBELL_RANG   0xC0
+/// @brief Sent by SafeBox without being asked when it enters its alarm.
+#define EVENT_ALARM_STARTED   0xC1
+/// @brief Sent by SafeBox without being asked when its lid opens or closes. Payload is 1 if opened.
+#define EVENT_LID_CHANGED     0xC2
+/// @brief Sent by SafeBox without being asked when its status changes and every STATUS_SYNC_HEARTBEAT_MS. Payload is its status code.
+#define EVENT_STATUS_CHANGED  0xC3
+
+/// @brief How many opcodes the command table of @ref SafeBox_CheckAndExecuteMessage can hold. Commands go from 0x01 to 0x0F.
+#define SAFEBOX_COMMAND_TABLE_SIZE 16
+
+/**
+ * @brief
+ * Function that executes a command received
+ * from XFactor and sends its answer.
+ */
+typedef bool (*SafeBox_CommandHandler)(const Protocol_Frame* command);
 
 // #pragma region [Command_Requests]
 
+/**
+ * @brief
+ * Sets the function that SafeBox calls when it
+ * receives the specified command. Replaces the
+ * command's current handler if it has one.
+ * @param opcode
+ * One of the COMMAND_ defines. Must be below
+ * @ref SAFEBOX_COMMAND_TABLE_SIZE
+ * @param handler
+ * Function that executes the command and sends
+ * its answer. 0 makes the command unknown.
+ * @return true:
+ * The handler was registered.
+ * @return false:
+ * The opcode does not fit in the table.
+ */
+bool SafeBox_RegisterCommand(unsigned char opcode, SafeBox_CommandHandler handler);
+
 /**
  * @brief
  * When this function is called, it should check
@@ -64,6 +155,17 @@
  * messages. If a message was received, it
  * will be executed and a reply will be sent to
  * XFactor.
+ * A command that XFactor retransmits because it
+ * did not get the reply is not executed twice.
+ * The same reply is sent again instead, unless
+ * a status exchange told that XFactor rebooted
+ * since.
+ * The command's handler is found directly from
+ * its opcode. See @ref SafeBox_RegisterCommand
+ * A command that SafeBox does not know is
+ * answered with @ref ANSWER_UNKNOWN_COMMAND and
+ * one whose handler failed without answering
+ * with @ref ANSWER_COMMAND_FAILED
  *
  * @attention
  * This is the only function you should need to
@@ -134,12 +236,30 @@ bool SafeBox_ChangeLidState(bool wantedLidState);
  * represents if the status was successfully
  * handled or not, and if the function managed to
  * reply to XFactor or not.
+ * @param command
+ * The received status exchange. Its clock is
+ * sent back along with SafeBox's so that XFactor
+ * can sync them.
  * @return true:
  * Successfully stored the status and
  * @return false:
  * Failed to handle the status or exchange our own.
  */
-bool SafeBox_ReplyStatus();
+bool SafeBox_ReplyStatus(const Protocol_Frame* command);
+
+/**
+ * @brief
+ * Replies to XFactor's snapshot request with
+ * everything XFactor needs to know about SafeBox
+ * in a single answer: its status, garage, lid,
+ * doorbell and packages. See the
+ * SNAPSHOT_PAYLOAD_ defines.
+ * @return true:
+ * Successfully sent the snapshot.
+ * @return false:
+ * Failed to build or send the snapshot.
+ */
+bool SafeBox_ReplySnapshot();
 
 /**
  * @brief
@@ -199,11 +319,70 @@ bool SafeBox_GetDoorBellStatus();
  * through Bluetooth in the getter setter
  * functions.
  * @param command
- * The string received through Bluetooth
+ * The frame received through Bluetooth
  * @return true:
  * Successfully saved the status of XFactor.
  * @return false:
  * Failed to save the status of XFactor.
  */
-bool SafeBox_SaveReceivedXFactorStatus(String command);
-// #pragma endregion
\ No newline at end of file
+bool SafeBox_SaveReceivedXFactorStatus(const Protocol_Frame* command);
+// #pragma endregion
+
+// #pragma region [Scheduled_Garage]
+
+/**
+ * @brief
+ * Opens the garage once the time scheduled by
+ * @ref COMMAND_GARAGE_OPEN_AT is less than
+ * @ref GARAGE_OPENING_TIME_MS away, so that it
+ * is fully open when XFactor arrives. Does
+ * nothing if no opening is scheduled.
+ *
+ * @attention
+ * This must be called periodically from loop.
+ */
+void SafeBox_UpdateScheduledGarage();
+
+// #pragma endregion
+
+// #pragma region [Statistics]
+
+/**
+ * @brief
+ * Replies to XFactor with SafeBox's Bluetooth
+ * statistics. See @ref BT_EncodeStats
+ * @return true:
+ * Successfully sent the statistics.
+ * @return false:
+ * Failed to send the statistics.
+ */
+bool SafeBox_ReplyLinkStats();
+
+// #pragma endregion
+
+// #pragma region [Events]
+
+/**
+ * @brief
+ * Checks if the doorbell started ringing, if the
+ * alarm started, if the lid moved or if the
+ * status changed since the last call and sends
+ * the matching event to XFactor without waiting
+ * to be asked. XFactor thus learns about them
+ * right away instead of polling SafeBox for
+ * them. The status is also sent every
+ * @ref STATUS_SYNC_HEARTBEAT_MS
+ *
+ * A ring is the only event that XFactor would
+ * miss for good if it was lost. It is sent again
+ * every @ref EVENT_DOORBELL_REPEAT_MS until a
+ * status exchange from XFactor carries its
+ * number.
+ *
+ * @attention
+ * This must be called periodically from loop.
+ * The first call only saves the current states.
+ */
+void SafeBox_CheckAndSendEvents();
+
+// #pragma endregion
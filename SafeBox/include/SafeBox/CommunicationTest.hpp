@@ -5,6 +5,12 @@
  * File containing the definition of functions
  * and defines used to linearly test
  * communications between SafeBox and XFactor
+ *
+ * @note
+ * Build with COMMUNICATION_SELF_TEST for main
+ * to answer XFactor's self-test instead of
+ * running SafeBox's actions. XFactor must be
+ * built with it too.
  * @version 0.1
  * @date 2023-11-16
  * @copyright Copyright (c) 2023
@@ -18,6 +24,8 @@
 #include "XFactor/Status.hpp"
 
 // - DEFINES - //
+/// @brief How often SafeBox reports what it received during the self-test.
+#define SELF_TEST_REPORT_MS 5000
 
 // - FUNCTIONS - //
 
@@ -25,8 +33,69 @@ void ContinuouslyAnswerXFactor();
 /**
  * @brief 
  * Call this in main.cpp to test communications
- * between XFactor and SafeBox.
+ * between XFactor and SafeBox. Answers XFactor's
+ * self-test and moves SafeBox's status to the
+ * next one each time XFactor's status changes,
+ * until every status was sent back once. What
+ * was received is reported every
+ * @ref SELF_TEST_REPORT_MS
+ *
+ * @attention
+ * SafeBox's status is saved in EEPROM each time
+ * it changes. It is back to what it was once
+ * every status was sent.
  */
 void TestGoodCommunications();
+
+/**
+ * @brief
+ * Checks that one of XFactor's status was
+ * received during the self-test.
+ * @param testNumber
+ * Number printed if the test fails.
+ * @param status
+ * The status that XFactor should have sent.
+ * @return true:
+ * The status was received.
+ * @return false:
+ * The status was never received.
+ */
 bool TestOneStatus(int testNumber, XFactor_Status status);
-void TestAllStatusCommunications();
\ No newline at end of file
+
+/**
+ * @brief
+ * Calls @ref TestOneStatus with every valid
+ * @ref XFactor_Status and prints how many were
+ * received.
+ */
+void TestAllStatusCommunications();
+
+/**
+ * @brief
+ * Tells if every status of SafeBox was sent
+ * back to XFactor once.
+ * @return true:
+ * SafeBox's status is back to what it was.
+ */
+bool SelfTestIsDone();
+
+/**
+ * @brief
+ * Returns how many status exchanges were
+ * received during the self-test.
+ */
+unsigned long GetSelfTestStatusExchanges();
+
+/**
+ * @brief
+ * Returns how many status exchanges held a
+ * status that XFactor does not have.
+ */
+unsigned long GetSelfTestErrors();
+
+/**
+ * @brief
+ * Returns how many different status of XFactor
+ * were received during the self-test.
+ */
+unsigned int GetSelfTestReceivedStatus();
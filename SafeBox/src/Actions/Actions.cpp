@@ -27,71 +27,149 @@
  */
 static unsigned char currentFunctionID = 0;
 
-//#pragma region [ACTION_HANDLERS]
+/// @brief Function whose onEnter was last executed by @ref Execute_CurrentFunction
+static unsigned char enteredFunctionID = FUNCTION_ID_NONE;
+static unsigned long transitionCount = 0;
+
+//#pragma region [STATE_HOOKS]
 /**
- * @brief Function periodically called in void
- * loop. This function is a massive switch case
- * that checks which execution / action function
- * should currently be executed by SafeBox. To
- * specify that function, use
- * @ref SetNewExecutionFunction using defines
- * available in this header file.
+ * @brief Entry and exit work of the execution
+ * functions. Executed once per transition
+ * instead of on every execution. Statuses and
+ * LEDs are still set on every execution since
+ * communications and the RFID reader change
+ * them while a function is executed.
  */
-void Execute_CurrentFunction()
+void Enter_WaitForDelivery()
 {
-    switch(currentFunctionID){
+    Debug_Information("Actions", "Execute_WaitForDelivery", "Start of wait for delivery");
+    SafeBox_SetNewStatus(SafeBox_Status::WaitingForDelivery);
+}
 
-        case(FUNCTION_ID_ALARM):
-            Execute_Alarm();
-            break;
+void Enter_StartOfDelivery()
+{
+    XFactor_SetNewStatus(XFactor_Status::WaitingForDelivery);
+}
 
-        case(FUNCTION_ID_SAVE_NEW_CARD):
-            Execute_SaveNewEEPROMCard();
-            break;
+void Enter_Unlocked()
+{
+    XFactor_SetNewStatus(XFactor_Status::Unlocked);
+}
 
-        case(FUNCTION_ID_ERROR):
-            Execute_Error();
-            break;
+void Exit_Alarm()
+{
+    Alarm_SetState(false);
+}
 
-        case(FUNCTION_ID_WAIT_AFTER_XFACTOR):
-            Execute_WaitAfterXFactor();
-            break;
+void Enter_Error()
+{
+    Debug_Warning("Actions", "Execute_Error", "ERROR REACHED. DEBUG STOPPED");
+    Debug_Stop();
+}
 
-        case(FUNCTION_ID_START_OF_DELIVERY):
-            Execute_StartOfDelivery();
-            break;
+/// @brief Functions that SafeBox can always go to, whatever XFactor tells it.
+#define ACTION_TRANSITIONS_ALWAYS (ACTION_TRANSITION(FUNCTION_ID_ALARM) | ACTION_TRANSITION(FUNCTION_ID_ERROR))
+/// @brief Functions that an armed SafeBox follows XFactor's status to, or is unlocked to.
+#define ACTION_TRANSITIONS_ARMED (ACTION_TRANSITIONS_ALWAYS | ACTION_TRANSITION(FUNCTION_ID_UNLOCKED) | ACTION_TRANSITION(FUNCTION_ID_WAIT_FOR_RETRIEVAL) | ACTION_TRANSITION(FUNCTION_ID_WAIT_FOR_RETURN) | ACTION_TRANSITION(FUNCTION_ID_DROP_OFF))
 
-        case(FUNCTION_ID_WAIT_FOR_DELIVERY):
-            Execute_WaitForDelivery();
-            break;
+/**
+ * @brief
+ * State table of SafeBox's execution functions,
+ * indexed by function ID.
+ */
+constexpr Action_State actionStates[] =
+{
+    /* FUNCTION_ID_WAIT_AFTER_XFACTOR  */ {0,                      Execute_WaitAfterXFactor,  0,          ACTION_TRANSITIONS_ARMED | ACTION_TRANSITION(FUNCTION_ID_WAIT_FOR_DELIVERY) | ACTION_TRANSITION(FUNCTION_ID_SAVE_NEW_CARD)},
+    /* FUNCTION_ID_WAIT_FOR_DELIVERY   */ {Enter_WaitForDelivery,  Execute_WaitForDelivery,   0,          ACTION_TRANSITIONS_ARMED},
+    /* FUNCTION_ID_START_OF_DELIVERY   */ {Enter_StartOfDelivery,  Execute_StartOfDelivery,   0,          ACTION_TRANSITIONS_ARMED},
+    /* FUNCTION_ID_WAIT_FOR_RETRIEVAL  */ {0,                      Execute_WaitForRetrieval,  0,          ACTION_TRANSITIONS_ARMED},
+    /* FUNCTION_ID_WAIT_FOR_RETURN     */ {0,                      Execute_WaitForReturn,     0,          ACTION_TRANSITIONS_ARMED},
+    /* FUNCTION_ID_DROP_OFF            */ {0,                      Execute_DropOff,           0,          ACTION_TRANSITIONS_ARMED | ACTION_TRANSITION(FUNCTION_ID_WAIT_FOR_DELIVERY)},
+    /* FUNCTION_ID_UNLOCKED            */ {Enter_Unlocked,         Execute_Unlocked,          0,          ACTION_TRANSITIONS_ALWAYS | ACTION_TRANSITION(FUNCTION_ID_WAIT_FOR_DELIVERY) | ACTION_TRANSITION(FUNCTION_ID_SAVE_NEW_CARD)},
+    /* 7                               */ {0,                      0,                         0,          0},
+    /* 8                               */ {0,                      0,                         0,          0},
+    /* 9                               */ {0,                      0,                         0,          0},
+    /* 10                              */ {0,                      0,                         0,          0},
+    /* 11                              */ {0,                      0,                         0,          0},
+    /* FUNCTION_ID_ALARM               */ {0,                      Execute_Alarm,             Exit_Alarm, ACTION_TRANSITIONS_ALWAYS | ACTION_TRANSITION(FUNCTION_ID_UNLOCKED)},
+    /* FUNCTION_ID_ERROR               */ {Enter_Error,            Execute_Error,             0,          ACTION_TRANSITIONS_ALWAYS},
+    /* 14                              */ {0,                      0,                         0,          0},
+    /* FUNCTION_ID_END_OF_PROGRAM      */ {0,                      Execute_EndOfProgram,      0,          ACTION_TRANSITIONS_ALWAYS},
+    /* FUNCTION_ID_SAVE_NEW_CARD       */ {0,                      Execute_SaveNewEEPROMCard, 0,          ACTION_TRANSITIONS_ALWAYS | ACTION_TRANSITION(FUNCTION_ID_UNLOCKED)},
+};
 
-        case(FUNCTION_ID_UNLOCKED):
-            Execute_Unlocked();
-            break;
+/**
+ * @brief Returns the transition bit of every
+ * function ID that has an execution function,
+ * starting at the specified one.
+ */
+constexpr unsigned long UsedFunctionIDs(unsigned char functionID)
+{
+    return (functionID >= FUNCTION_ID_COUNT) ? 0 :
+           (((actionStates[functionID].onTick != 0) ? ACTION_TRANSITION(functionID) : 0) | UsedFunctionIDs(functionID + 1));
+}
 
-        case(FUNCTION_ID_DROP_OFF):
-            Execute_DropOff();
-            break;
+/**
+ * @brief Checks that the functions starting at
+ * the specified one can only go to functions
+ * that exist and can always report an error.
+ */
+constexpr bool TransitionsAreValid(unsigned char functionID)
+{
+    return (functionID >= FUNCTION_ID_COUNT) ? true :
+           (((actionStates[functionID].onTick == 0) ||
+             (((actionStates[functionID].allowedTransitions & ~UsedFunctionIDs(0)) == 0) &&
+              ((actionStates[functionID].allowedTransitions & ACTION_TRANSITION(FUNCTION_ID_ERROR)) != 0)))
+            && TransitionsAreValid(functionID + 1));
+}
 
-        case(FUNCTION_ID_WAIT_FOR_RETRIEVAL):
-            Execute_WaitForRetrieval();
-            break;
+static_assert(FUNCTION_ID_COUNT <= 32, "Function IDs must fit in Action_State allowedTransitions");
+static_assert(sizeof(actionStates) / sizeof(Action_State) == FUNCTION_ID_COUNT, "actionStates needs one row per function ID");
+static_assert(TransitionsAreValid(0), "actionStates allows a transition to an unused function ID or one that cannot report an error");
+static_assert(FUNCTION_ID_COUNT <= PROFILER_SLOT_LOOP, "Every function ID needs its own profiler slot");
+//#pragma endregion
 
-        case(FUNCTION_ID_WAIT_FOR_RETURN):
-            Execute_WaitForReturn();
-            break;
+//#pragma region [ACTION_HANDLERS]
+/**
+ * @brief Function periodically called in void
+ * loop. Executes the current execution / action
+ * function through its row of the state table.
+ * Its onExit and the new function's onEnter are
+ * executed first if the function changed since
+ * the last call. To specify that function, use
+ * @ref SetNewExecutionFunction using defines
+ * available in this header file.
+ */
+void Execute_CurrentFunction()
+{
+    // - VARIABLES - //
+    unsigned char tickedFunctionID = 0;
 
-        case(FUNCTION_ID_END_OF_PROGRAM):
-            Execute_EndOfProgram();
-            break;
+    if(enteredFunctionID != currentFunctionID)
+    {
+        if(enteredFunctionID != FUNCTION_ID_NONE && actionStates[enteredFunctionID].onExit != 0)
+        {
+            actionStates[enteredFunctionID].onExit();
+        }
 
-        default:
-            // The current function ID is not recognized.
-            // Error is executed by default.
-            Execute_Error();
-            return;
+        enteredFunctionID = currentFunctionID;
+        transitionCount++;
+
+        if(actionStates[currentFunctionID].onEnter != 0)
+        {
+            actionStates[currentFunctionID].onEnter();
+        }
+
+        // The entry work may have already set another function.
+        if(enteredFunctionID != currentFunctionID) return;
     }
-    // Successful execution //
+
+    // The tick may set another function. Its duration belongs to this one.
+    tickedFunctionID = currentFunctionID;
+
+    PROFILER_START();
+    actionStates[tickedFunctionID].onTick();
+    PROFILER_STOP(tickedFunctionID);
 }
 
 /**
@@ -117,32 +195,28 @@ void Execute_CurrentFunction()
  * to the new ID.
  * @return false:
  * Failed to change the execution function to the
- * new ID. May be out of range.
+ * new ID. May be out of range or not allowed
+ * from the current execution function.
  */
 bool SetNewExecutionFunction(unsigned char functionID)
 {
-    switch(currentFunctionID){
-
-        case(FUNCTION_ID_ALARM):
-        case(FUNCTION_ID_END_OF_PROGRAM):
-        case(FUNCTION_ID_ERROR):
-        case(FUNCTION_ID_START_OF_DELIVERY):
-        case(FUNCTION_ID_WAIT_FOR_DELIVERY):
-        case(FUNCTION_ID_UNLOCKED):
-        case(FUNCTION_ID_DROP_OFF):
-        case(FUNCTION_ID_WAIT_AFTER_XFACTOR):
-        case(FUNCTION_ID_WAIT_FOR_RETRIEVAL):
-        case(FUNCTION_ID_WAIT_FOR_RETURN):
-        case(FUNCTION_ID_SAVE_NEW_CARD):
-            // The specified function is indeed a valid function ID.
-            currentFunctionID = functionID;
-            return true;
-
-        default:
-            // The current function ID is not recognized.
-            // The function ID will therefor not be set.
-            return false;
+    if(functionID >= FUNCTION_ID_COUNT || actionStates[functionID].onTick == 0)
+    {
+        // The function ID is not recognized.
+        // The function ID will therefor not be set.
+        return false;
     }
+
+    if(functionID == currentFunctionID) return true;
+
+    if((actionStates[currentFunctionID].allowedTransitions & ACTION_TRANSITION(functionID)) == 0)
+    {
+        Debug_Error("Actions", "SetNewExecutionFunction", "Transition not allowed: " + String(currentFunctionID) + " -> " + String(functionID));
+        return false;
+    }
+
+    currentFunctionID = functionID;
+    return true;
 }
 
 /**
@@ -157,6 +231,20 @@ unsigned char GetCurrentExecutionFunction()
 {
     return currentFunctionID;
 }
+
+/**
+ * @brief
+ * Function that returns how many times a new
+ * execution function was entered by
+ * @ref Execute_CurrentFunction since the start
+ * of the program.
+ * @return unsigned long:
+ * Number of transitions.
+ */
+unsigned long GetExecutionTransitionCount()
+{
+    return transitionCount;
+}
 //#pragma endregion
 
 //#pragma region [ACTION_FUNCTIONS]
@@ -318,13 +406,6 @@ void Execute_WaitAfterXFactor()
  */
 void Execute_WaitForDelivery()
 {
-    // CHECKS IF ITS THE FIRST EXECUTION
-    if(SafeBox_GetStatus() != SafeBox_Status::WaitingForDelivery)
-    {
-        Debug_Information("Actions", "Execute_WaitForDelivery", "Start of wait for delivery");
-        SafeBox_SetNewStatus(SafeBox_Status::WaitingForDelivery);
-    }
-
     if(!Lid_IsClosed())
     {
         Debug_Warning("Actions", "Execute_WaitForDelivery", "LID IS NO LONGER CLOSED");
@@ -397,11 +478,6 @@ void Execute_WaitForDelivery()
  */
 void Execute_StartOfDelivery()
 {
-    if(SafeBox_GetStatus() != SafeBox_Status::WaitingForRetrieval)
-    {
-        XFactor_SetNewStatus(XFactor_Status::WaitingForDelivery);
-    }
-
     if(!Lid_IsClosed())
     {
         Debug_Warning("Actions", "Execute_WaitForDelivery", "LID IS NO LONGER CLOSED");
@@ -577,11 +653,6 @@ void Execute_DropOff()
  */
 void Execute_Unlocked()
 {
-    if(SafeBox_GetStatus() != SafeBox_Status::Unlocked)
-    {
-        XFactor_SetNewStatus(XFactor_Status::Unlocked);
-    }
-
     if(!Garage_Open())
     {
         Debug_Error("Actions", "Execute_Unlocked", "Failed to close garage door");
@@ -710,9 +781,6 @@ void Execute_Alarm()
  */
 void Execute_Error()
 {
-    Debug_Warning("Actions", "Execute_Error", "ERROR REACHED. DEBUG STOPPED");
-    Debug_Stop();
-
     // - VARIABLES - //
     static bool mustBeOn = false; // everything is closed
 
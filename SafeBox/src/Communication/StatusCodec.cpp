@@ -0,0 +1,166 @@
+/**
+ * @file StatusCodec.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * File containing the functions that turn XFactor's and SafeBox's
+ * status into the single byte sent over
+ * Bluetooth and back. The code of a status is
+ * the value of its enum, which never changes,
+ * and a table of the valid codes rejects
+ * anything else in a single lookup.
+ *
+ * @attention
+ * This file is shared by XFactor and SafeBox.
+ * Both copies must stay identical.
+ * @version 0.1
+ * @date 2023-12-01
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Communication/StatusCodec.hpp"
+
+/**
+ * @brief
+ * One bit per possible code, set if an
+ * @ref XFactor_Status has that value. Bit 0 of
+ * byte 0 is code 0. Valid codes are 0 to 18,
+ * 50, 51, 253 and 255. MUST be updated along
+ * with the enum.
+ */
+const unsigned char _xfactorStatusCodes[32] PROGMEM = {
+    0xFF, 0xFF, 0x07, 0x00, 0x00, 0x00, 0x0C, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xA0,
+};
+
+/**
+ * @brief
+ * One bit per possible code, set if a
+ * @ref SafeBox_Status has that value. Bit 0 of
+ * byte 0 is code 0. Valid codes are 0 to 5, 10,
+ * 50, 51, 253, 254 and 255. MUST be updated
+ * along with the enum.
+ */
+const unsigned char _safeBoxStatusCodes[32] PROGMEM = {
+    0x3F, 0x04, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xE0,
+};
+
+/**
+ * @brief
+ * Checks if a code is set in one of the tables
+ * of valid codes.
+ * @param table
+ * @ref _xfactorStatusCodes or
+ * @ref _safeBoxStatusCodes
+ * @param code
+ * The code to check.
+ * @return true:
+ * The code is valid.
+ * @return false:
+ * The code is not valid.
+ */
+bool IsValidCode(const unsigned char* table, unsigned char code)
+{
+    return (pgm_read_byte(&table[code >> 3]) & (1 << (code & 0x07))) != 0;
+}
+
+/**
+ * @brief
+ * Gets the code sent over Bluetooth for one of
+ * XFactor's status.
+ * @param status
+ * The status to encode.
+ * @param code
+ * Where the code is written.
+ * @return true:
+ * The status was encoded.
+ * @return false:
+ * The status is not a valid @ref XFactor_Status
+ */
+bool StatusCodec_EncodeXFactor(XFactor_Status status, unsigned char* code)
+{
+    // - PRELIMINARY CHECKS - //
+    if(code == 0) return false;
+    if(!IsValidCode(_xfactorStatusCodes, (unsigned char)status)) return false;
+
+    // - FUNCTION EXECUTION - //
+    *code = (unsigned char)status;
+    return true;
+}
+
+/**
+ * @brief
+ * Gets XFactor's status out of a code received
+ * over Bluetooth.
+ * @param code
+ * The received code.
+ * @param status
+ * Where the status is written.
+ * @return true:
+ * The code was decoded.
+ * @return false:
+ * The code matches no @ref XFactor_Status
+ */
+bool StatusCodec_DecodeXFactor(unsigned char code, XFactor_Status* status)
+{
+    // - PRELIMINARY CHECKS - //
+    if(status == 0) return false;
+    if(!IsValidCode(_xfactorStatusCodes, code)) return false;
+
+    // - FUNCTION EXECUTION - //
+    *status = (XFactor_Status)code;
+    return true;
+}
+
+/**
+ * @brief
+ * Gets the code sent over Bluetooth for one of
+ * SafeBox's status.
+ * @param status
+ * The status to encode.
+ * @param code
+ * Where the code is written.
+ * @return true:
+ * The status was encoded.
+ * @return false:
+ * The status is not a valid @ref SafeBox_Status
+ */
+bool StatusCodec_EncodeSafeBox(SafeBox_Status status, unsigned char* code)
+{
+    // - PRELIMINARY CHECKS - //
+    if(code == 0) return false;
+    if(!IsValidCode(_safeBoxStatusCodes, (unsigned char)status)) return false;
+
+    // - FUNCTION EXECUTION - //
+    *code = (unsigned char)status;
+    return true;
+}
+
+/**
+ * @brief
+ * Gets SafeBox's status out of a code received
+ * over Bluetooth.
+ * @param code
+ * The received code.
+ * @param status
+ * Where the status is written.
+ * @return true:
+ * The code was decoded.
+ * @return false:
+ * The code matches no @ref SafeBox_Status
+ */
+bool StatusCodec_DecodeSafeBox(unsigned char code, SafeBox_Status* status)
+{
+    // - PRELIMINARY CHECKS - //
+    if(status == 0) return false;
+    if(!IsValidCode(_safeBoxStatusCodes, code)) return false;
+
+    // - FUNCTION EXECUTION - //
+    *status = (SafeBox_Status)code;
+    return true;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file Profiler.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * File containing the profiler that measures
+ * how long each execution function and each loop
+ * takes. Measurements are kept in fixed slots in
+ * RAM and printed on the debug serial port when
+ * 'p' is received on it.
+ *
+ * @attention
+ * The profiler only exists when PROFILER_ENABLED
+ * is defined in platformio.ini. Otherwise, its
+ * macros are empty and nothing is compiled.
+ * @version 0.1
+ * @date 2023-12-07
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Debug/Profiler.hpp"
+
+#ifdef PROFILER_ENABLED
+
+/// @brief Measurements of every slot. Indexed by execution function ID.
+Profiler_Slot _profilerSlots[PROFILER_SLOTS];
+/// @brief Makes the first @ref Profiler_Record clear the slots so that their minimums start high.
+bool _profilerIsReset = false;
+
+/**
+ * @brief
+ * Adds a duration to the measurements of a
+ * slot. Durations of slots that do not exist
+ * are ignored.
+ * @param slot
+ * Execution function ID or
+ * @ref PROFILER_SLOT_LOOP
+ * @param duration_us
+ * Measured duration in microseconds.
+ */
+void Profiler_Record(unsigned char slot, unsigned long duration_us)
+{
+    // - VARIABLES - //
+    Profiler_Slot* measurements = 0;
+    unsigned char bucket = 0;
+    unsigned long bucketLimit_us = PROFILER_FIRST_BUCKET_US;
+
+    // - PRELIMINARY CHECKS - //
+    if(slot >= PROFILER_SLOTS) return;
+    if(!_profilerIsReset) Profiler_Reset();
+
+    // - FUNCTION EXECUTION - //
+    measurements = &_profilerSlots[slot];
+    measurements->count++;
+    measurements->total_us += duration_us;
+    if(duration_us < measurements->min_us) measurements->min_us = duration_us;
+    if(duration_us > measurements->max_us) measurements->max_us = duration_us;
+
+    while(bucket < PROFILER_HISTOGRAM_BUCKETS - 1 && duration_us >= bucketLimit_us)
+    {
+        bucket++;
+        bucketLimit_us *= 4;
+    }
+    if(measurements->histogram[bucket] < 0xFFFF) measurements->histogram[bucket]++;
+}
+
+/**
+ * @brief
+ * Returns the measurements of a slot.
+ * @param slot
+ * Execution function ID or
+ * @ref PROFILER_SLOT_LOOP
+ * @return const Profiler_Slot*:
+ * The measurements or 0 if the slot does not
+ * exist.
+ */
+const Profiler_Slot* Profiler_GetSlot(unsigned char slot)
+{
+    if(slot >= PROFILER_SLOTS) return 0;
+    if(!_profilerIsReset) Profiler_Reset();
+    return &_profilerSlots[slot];
+}
+
+/**
+ * @brief
+ * Clears the measurements of every slot.
+ */
+void Profiler_Reset()
+{
+    memset(_profilerSlots, 0, sizeof(_profilerSlots));
+    for(unsigned char i = 0; i < PROFILER_SLOTS; i++)
+    {
+        _profilerSlots[i].min_us = 0xFFFFFFFFUL;
+    }
+    _profilerIsReset = true;
+}
+
+/**
+ * @brief
+ * Prints the count, min, mean, max and
+ * histogram of every slot that was measured.
+ */
+void Profiler_Print()
+{
+    // - VARIABLES - //
+    const Profiler_Slot* measurements = 0;
+    String name = "";
+    String histogram = "";
+    unsigned long bucketLimit_us = 0;
+
+    for(unsigned char slot = 0; slot < PROFILER_SLOTS; slot++)
+    {
+        measurements = Profiler_GetSlot(slot);
+        if(measurements->count == 0) continue;
+
+        name = (slot == PROFILER_SLOT_LOOP) ? String("Loop") : ("Function " + String(slot));
+        Debug_Information("Profiler", "Profiler_Print", name + " Calls: " + String(measurements->count) + " Min: " + String(measurements->min_us) + "us Mean: " + String((unsigned long)(measurements->total_us / measurements->count)) + "us Max: " + String(measurements->max_us) + "us");
+
+        histogram = "";
+        bucketLimit_us = PROFILER_FIRST_BUCKET_US;
+        for(unsigned char i = 0; i < PROFILER_HISTOGRAM_BUCKETS; i++)
+        {
+            if(i == PROFILER_HISTOGRAM_BUCKETS - 1) histogram += ">=" + String(bucketLimit_us / 4) + "us:";
+            else histogram += "<" + String(bucketLimit_us) + "us:";
+            histogram += String(measurements->histogram[i]) + " ";
+            bucketLimit_us *= 4;
+        }
+        Debug_Information("Profiler", "Profiler_Print", histogram);
+    }
+}
+
+/**
+ * @brief
+ * Reads the characters received on the debug
+ * serial port. @ref PROFILER_COMMAND_PRINT
+ * prints the measurements and
+ * @ref PROFILER_COMMAND_RESET clears them.
+ * Other characters are ignored.
+ */
+void Profiler_HandleCommands()
+{
+    // - VARIABLES - //
+    int command = 0;
+
+    while(DEBUG_SERIAL.available())
+    {
+        command = DEBUG_SERIAL.read();
+        if(command == PROFILER_COMMAND_PRINT) Profiler_Print();
+        else if(command == PROFILER_COMMAND_RESET) Profiler_Reset();
+    }
+}
+
+#endif
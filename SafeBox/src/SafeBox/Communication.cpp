@@ -13,144 +13,481 @@
 // - INCLUDES - //
 #include "SafeBox/Communication.hpp"
 
-// #pragma region [Command_Requests]
+// - GLOBAL LOCAL ACCESS - //
+/// @brief Sequence number of the command being executed. Its answer carries it.
+unsigned char _commandSequence = PROTOCOL_NO_SEQUENCE;
+/// @brief Opcode of the command being executed.
+unsigned char _commandOpcode = 0;
+/// @brief Last answer sent to XFactor. Sent again if XFactor retransmits its command.
+Protocol_Frame _lastAnswer = {0, PROTOCOL_NO_SEQUENCE, 0, {0}};
+/// @brief If the command being executed was answered. A command that was not gets @ref ANSWER_COMMAND_FAILED
+bool _commandIsAnswered = false;
+/// @brief millis() at which the garage must be open. See @ref SafeBox_UpdateScheduledGarage
+unsigned long _garageOpenTime_ms = 0;
+bool _garageOpenIsScheduled = false;
+/// @brief Session that XFactor told in its last status exchange. Changes each time XFactor boots.
+unsigned char _peerSession = 0;
+/// @brief Number of the last ring XFactor acknowledged. Stops the repetitions of @ref EVENT_DOORBELL_RANG
+unsigned char _acknowledgedDoorbellRing = 0;
 
 /**
  * @brief
- * When this function is called, it should check
- * if SafeBox has received any Bluetooth
- * messages. If a message was received, it
- * will be executed and a reply will be sent to
- * XFactor.
- *
- * @attention
- * This is the only function you should need to
- * call to execute whatever functions was
- * received by XFactor. Only use the global
- * status of XFactor to determine wether you need
- * to change Execution Functions. This wont tell
- * you.
+ * Sends an answer to the command being executed.
+ * The answer carries the sequence number of the
+ * command and is saved in case XFactor never
+ * gets it and retransmits its command.
+ * @param opcode
+ * One of the ANSWER_ defines.
+ * @param payload
+ * Bytes sent with the opcode. Can be 0 if
+ * length is 0.
+ * @param length
+ * How many bytes of payload there is.
  * @return true:
- * Successfully handled a request.
+ * The answer was sent successfully.
  * @return false:
- * Failed to handle a request / There was no
- * requests.
+ * Failed to send the answer.
  */
-bool SafeBox_CheckAndExecuteMessage()
+bool SendAnswer(unsigned char opcode, const unsigned char* payload, unsigned char length)
 {
-    // - VARIABLES - //
-    String latestMessage = "";
+    // - PRELIMINARY CHECKS - //
+    if(length > PROTOCOL_MAX_PAYLOAD_LENGTH || (length > 0 && payload == 0)) return false;
 
-    if(BT_MessagesAvailable() == 0)
+    // - FUNCTION EXECUTION - //
+    _commandIsAnswered = true;
+    _lastAnswer.opcode = opcode;
+    _lastAnswer.sequence = _commandSequence;
+    _lastAnswer.length = length;
+    if(length > 0) memcpy(_lastAnswer.payload, payload, length);
+
+    return BT_SendSequencedFrame(opcode, _commandSequence, payload, length);
+}
+
+// #pragma region [Command_Handlers]
+
+/**
+ * @brief
+ * Handles @ref COMMAND_LID_OPEN
+ * @param command
+ * The received command.
+ * @return true:
+ * Successfully handled the command.
+ * @return false:
+ * Failed to handle the command.
+ */
+bool HandleLidOpen(const Protocol_Frame* command)
+{
+    if(SafeBox_ChangeLidState(true)) {return true;}
+    Debug_Error("Communication", "HandleLidOpen", "Failed to execute ChangeLidState");
+    return false;
+}
+
+/**
+ * @brief
+ * Handles @ref COMMAND_LID_CLOSE
+ * @param command
+ * The received command.
+ * @return true:
+ * Successfully handled the command.
+ * @return false:
+ * Failed to handle the command.
+ */
+bool HandleLidClose(const Protocol_Frame* command)
+{
+    if(SafeBox_ChangeLidState(false)) {return true;}
+    Debug_Error("Communication", "HandleLidClose", "Failed to execute ChangeLidState");
+    return false;
+}
+
+/**
+ * @brief
+ * Handles @ref COMMAND_LID_GET
+ * @param command
+ * The received command.
+ * @return true:
+ * Successfully handled the command.
+ * @return false:
+ * Failed to handle the command.
+ */
+bool HandleLidGet(const Protocol_Frame* command)
+{
+    if(Lid_IsClosed())
     {
-        // There is no messages in the reception buffer
+        if(SendAnswer(ANSWER_LID_CLOSED, 0, 0)) return true;
+        Debug_Error("Communication", "HandleLidGet", "Failed to TX ANSWER_LID_CLOSED");
         return false;
     }
 
-    latestMessage = BT_GetLatestMessage();
+    if(SendAnswer(ANSWER_LID_OPEN, 0, 0)) return true;
+    Debug_Error("Communication", "HandleLidGet", "Failed to TX ANSWER_LID_OPEN");
+    return false;
+}
+
+/**
+ * @brief
+ * Handles @ref COMMAND_GARAGE_GET
+ * @param command
+ * The received command.
+ * @return true:
+ * Successfully handled the command.
+ * @return false:
+ * Failed to handle the command.
+ */
+bool HandleGarageGet(const Protocol_Frame* command)
+{
+    if(Garage_IsClosed())
+    {
+        if(SendAnswer(ANSWER_GARAGE_CLOSED, 0, 0)) return true;
+        Debug_Error("Communication", "HandleGarageGet", "Failed to TX ANSWER_GARAGE_CLOSED");
+        SafeBox_SetNewStatus(SafeBox_Status::CommunicationError);
+        return false;
+    }
+
+    if(SendAnswer(ANSWER_GARAGE_OPEN, 0, 0)) return true;
+    Debug_Error("Communication", "HandleGarageGet", "Failed to TX ANSWER_GARAGE_OPEN");
+    SafeBox_SetNewStatus(SafeBox_Status::CommunicationError);
+    return false;
+}
+
+/**
+ * @brief
+ * Handles @ref COMMAND_GARAGE_OPEN
+ * @param command
+ * The received command.
+ * @return true:
+ * Successfully handled the command.
+ * @return false:
+ * Failed to handle the command.
+ */
+bool HandleGarageOpen(const Protocol_Frame* command)
+{
+    if(SafeBox_ChangeGarageState(true)) {return true;}
+    Debug_Error("Communication", "HandleGarageOpen", "Failed to execute ChangeGarageState");
+    return false;
+}
+
+/**
+ * @brief
+ * Handles @ref COMMAND_GARAGE_CLOSE
+ * @param command
+ * The received command.
+ * @return true:
+ * Successfully handled the command.
+ * @return false:
+ * Failed to handle the command.
+ */
+bool HandleGarageClose(const Protocol_Frame* command)
+{
+    _garageOpenIsScheduled = false;
+    if(SafeBox_ChangeGarageState(false)) {return true;}
+    Debug_Error("Communication", "HandleGarageClose", "Failed to execute ChangeGarageState");
+    return false;
+}
 
-    if(latestMessage == BT_ERROR_MESSAGE)
+/**
+ * @brief
+ * Handles @ref COMMAND_GARAGE_OPEN_AT
+ * @param command
+ * The received command. Carries the time at
+ * which the garage must be open.
+ * @return true:
+ * Successfully handled the command.
+ * @return false:
+ * Failed to handle the command.
+ */
+bool HandleGarageOpenAt(const Protocol_Frame* command)
+{
+    if(command->length < CLOCKSYNC_ENCODED_TIME_LENGTH)
     {
-        Debug_Error("Communication", "SafeBox_CheckAndExecuteMessage", "Error message returned");
+        Debug_Error("Communication", "HandleGarageOpenAt", "Time is missing");
+        if(SendAnswer(ANSWER_GARAGE_FAILED, 0, 0)) return false;
+        SafeBox_SetNewStatus(SafeBox_Status::CommunicationError);
         return false;
     }
 
-    if(latestMessage == BT_NO_MESSAGE)
+    _garageOpenTime_ms = ClockSync_DecodeTime(command->payload);
+    _garageOpenIsScheduled = true;
+
+    if(SendAnswer(ANSWER_GARAGE_SUCCESS, 0, 0)) return true;
+    Debug_Error("Communication", "HandleGarageOpenAt", "Failed to TX ANSWER_GARAGE_SUCCESS");
+    SafeBox_SetNewStatus(SafeBox_Status::CommunicationError);
+    return false;
+}
+
+/**
+ * @brief
+ * Handles @ref COMMAND_CHECK_PACKAGE
+ * @param command
+ * The received command.
+ * @return true:
+ * Successfully handled the command.
+ * @return false:
+ * Failed to handle the command.
+ */
+bool HandleCheckPackage(const Protocol_Frame* command)
+{
+    if(SafeBox_ReplyToCheckIfPackageDeposited()) {return true;}
+    Debug_Error("Communication", "HandleCheckPackage", "Failed ReplyToCheckIfPackageDeposited");
+    return false;
+}
+
+/**
+ * @brief
+ * Handles @ref COMMAND_GET_PACKAGE_COUNT
+ * @param command
+ * The received command.
+ * @return true:
+ * Successfully handled the command.
+ * @return false:
+ * Failed to handle the command.
+ */
+bool HandleGetPackageCount(const Protocol_Frame* command)
+{
+    if(SafeBox_ReturnDepositedPackages()) {return true;}
+    Debug_Error("Communication", "HandleGetPackageCount", "Failed ReturnDepositedPackages");
+    return false;
+}
+
+/**
+ * @brief
+ * Handles @ref COMMAND_STATUS_EXCHANGE
+ * @param command
+ * The received command. Carries XFactor's
+ * status.
+ * @return true:
+ * Successfully handled the command.
+ * @return false:
+ * Failed to handle the command.
+ */
+bool HandleStatusExchange(const Protocol_Frame* command)
+{
+    if(SafeBox_ReplyStatus(command))
     {
+        if(SafeBox_SaveReceivedXFactorStatus(command)) {return true;};
+        Debug_Error("Communication", "HandleStatusExchange", "Failed to save received status");
         return false;
     }
 
-    // - ANSWER CHECK - //
-    if(latestMessage.endsWith(COMMAND_LID_OPEN))
+    if(SafeBox_SaveReceivedXFactorStatus(command))
     {
-        if(SafeBox_ChangeLidState(true)) {return true;}
-        Debug_Error("Communication", "SafeBox_CheckAndExecuteMessage", "Failed to execute ChangeLidState");
+        Debug_Warning("Communication", "HandleStatusExchange", "Saved new XFactor status but failed to reply SafeBox status");
         return false;
     }
+    Debug_Error("Communication", "HandleStatusExchange", "Failed to save received status & reply status to XFactor");
+    return false;
+}
 
-    if(latestMessage.endsWith(COMMAND_LID_CLOSE))
+/**
+ * @brief
+ * Handles @ref COMMAND_SNAPSHOT
+ * @param command
+ * The received command. Carries XFactor's
+ * status.
+ * @return true:
+ * Successfully handled the command.
+ * @return false:
+ * Failed to handle the command.
+ */
+bool HandleSnapshot(const Protocol_Frame* command)
+{
+    if(SafeBox_ReplySnapshot())
     {
-        if(SafeBox_ChangeLidState(false)) {return true;}
-        Debug_Error("Communication", "SafeBox_CheckAndExecuteMessage", "Failed to execute ChangeLidState");
+        if(SafeBox_SaveReceivedXFactorStatus(command)) {return true;};
+        Debug_Error("Communication", "HandleSnapshot", "Failed to save received status");
         return false;
     }
 
-    if(latestMessage.endsWith(COMMAND_GARAGE_GET))
+    if(SafeBox_SaveReceivedXFactorStatus(command))
     {
-        if(Garage_IsClosed())
-        {
-            if(BT_SendString(ANSWER_GARAGE_CLOSED)) return true;
-            Debug_Error("Communication", "SafeBox_ChangeLidState", "Failed to TX ANSWER_GARAGE_CLOSED");
-            SafeBox_SetNewStatus(SafeBox_Status::CommunicationError);
-            return false;
-        }
-        else
-        {
-            if(BT_SendString(ANSWER_GARAGE_OPEN)) return true;
-            Debug_Error("Communication", "SafeBox_ChangeLidState", "Failed to TX ANSWER_GARAGE_OPEN");
-            SafeBox_SetNewStatus(SafeBox_Status::CommunicationError);
-            return false;
-        } 
+        Debug_Warning("Communication", "HandleSnapshot", "Saved new XFactor status but failed to reply snapshot");
+        return false;
     }
+    Debug_Error("Communication", "HandleSnapshot", "Failed to save received status & reply snapshot to XFactor");
+    return false;
+}
+
+/**
+ * @brief
+ * Handles @ref COMMAND_LINK_STATS
+ * @param command
+ * The received command.
+ * @return true:
+ * Successfully handled the command.
+ * @return false:
+ * Failed to handle the command.
+ */
+bool HandleLinkStats(const Protocol_Frame* command)
+{
+    if(SafeBox_ReplyLinkStats()) {return true;}
+    Debug_Error("Communication", "HandleLinkStats", "Failed ReplyLinkStats");
+    return false;
+}
+
+/**
+ * @brief
+ * Handles @ref COMMAND_DOORBELL_GET
+ * @param command
+ * The received command.
+ * @return true:
+ * Successfully handled the command.
+ * @return false:
+ * Failed to handle the command.
+ */
+bool HandleDoorbellGet(const Protocol_Frame* command)
+{
+    if(SafeBox_GetDoorBellStatus()) {return true;}
+    Debug_Error("Communication", "HandleDoorbellGet", "Failed GetDoorBellStatus");
+    return false;
+}
 
-    if(latestMessage.endsWith(COMMAND_GARAGE_OPEN))
+/**
+ * @brief
+ * Handler of each command indexed by its
+ * opcode. 0 if SafeBox does not know the
+ * command. Add commands with
+ * @ref SafeBox_RegisterCommand
+ */
+SafeBox_CommandHandler _commandHandlers[SAFEBOX_COMMAND_TABLE_SIZE] = {
+    0,                      // 0x00
+    HandleLidOpen,          // COMMAND_LID_OPEN
+    HandleLidClose,         // COMMAND_LID_CLOSE
+    HandleLidGet,           // COMMAND_LID_GET
+    HandleGarageOpen,       // COMMAND_GARAGE_OPEN
+    HandleGarageClose,      // COMMAND_GARAGE_CLOSE
+    HandleGarageGet,        // COMMAND_GARAGE_GET
+    HandleDoorbellGet,      // COMMAND_DOORBELL_GET
+    HandleGetPackageCount,  // COMMAND_GET_PACKAGE_COUNT
+    HandleCheckPackage,     // COMMAND_CHECK_PACKAGE
+    HandleStatusExchange,   // COMMAND_STATUS_EXCHANGE
+    HandleSnapshot,         // COMMAND_SNAPSHOT
+    HandleLinkStats,        // COMMAND_LINK_STATS
+    HandleGarageOpenAt,     // COMMAND_GARAGE_OPEN_AT
+    0,
+    0,
+};
+
+// #pragma endregion
+
+// #pragma region [Command_Requests]
+
+/**
+ * @brief
+ * Sets the function that SafeBox calls when it
+ * receives the specified command. Replaces the
+ * command's current handler if it has one.
+ * @param opcode
+ * One of the COMMAND_ defines. Must be below
+ * @ref SAFEBOX_COMMAND_TABLE_SIZE
+ * @param handler
+ * Function that executes the command and sends
+ * its answer. 0 makes the command unknown.
+ * @return true:
+ * The handler was registered.
+ * @return false:
+ * The opcode does not fit in the table.
+ */
+bool SafeBox_RegisterCommand(unsigned char opcode, SafeBox_CommandHandler handler)
+{
+    if(opcode >= SAFEBOX_COMMAND_TABLE_SIZE)
     {
-        if(SafeBox_ChangeGarageState(true)) {return true;}
-        Debug_Error("Communication", "SafeBox_CheckAndExecuteMessage", "Failed to execute ChangeGarageState");
+        Debug_Error("Communication", "SafeBox_RegisterCommand", "Opcode is too large");
         return false;
     }
+    _commandHandlers[opcode] = handler;
+    return true;
+}
+
+/**
+ * @brief
+ * When this function is called, it should check
+ * if SafeBox has received any Bluetooth
+ * messages. If a message was received, it
+ * will be executed and a reply will be sent to
+ * XFactor.
+ * A command that XFactor retransmits because it
+ * did not get the reply is not executed twice.
+ * The same reply is sent again instead, unless
+ * a status exchange told that XFactor rebooted
+ * since.
+ * The command's handler is found directly from
+ * its opcode. See @ref SafeBox_RegisterCommand
+ * A command that SafeBox does not know is
+ * answered with @ref ANSWER_UNKNOWN_COMMAND and
+ * one whose handler failed without answering
+ * with @ref ANSWER_COMMAND_FAILED
+ *
+ * @attention
+ * This is the only function you should need to
+ * call to execute whatever functions was
+ * received by XFactor. Only use the global
+ * status of XFactor to determine wether you need
+ * to change Execution Functions. This wont tell
+ * you.
+ * @return true:
+ * Successfully handled a request.
+ * @return false:
+ * Failed to handle a request / There was no
+ * requests.
+ */
+bool SafeBox_CheckAndExecuteMessage()
+{
+    // - VARIABLES - //
+    Protocol_Frame latestMessage;
 
-    if(latestMessage.endsWith(COMMAND_GARAGE_CLOSE))
+    if(BT_MessagesAvailable() == 0)
     {
-        if(SafeBox_ChangeGarageState(false)) {return true;}
-        Debug_Error("Communication", "SafeBox_CheckAndExecuteMessage", "Failed to execute ChangeGarageState");
+        // There is no messages in the reception buffer
         return false;
     }
 
-    if(latestMessage.endsWith(COMMAND_CHECK_PACKAGE))
+    if(!BT_GetLatestFrame(&latestMessage))
     {
-        if(SafeBox_ReplyToCheckIfPackageDeposited()) {return true;}
-        Debug_Error("Communication", "SafeBox_CheckAndExecuteMessage", "Failed ReplyToCheckIfPackageDeposited");
         return false;
     }
 
-    if(latestMessage.endsWith(COMMAND_GET_PACKAGE_COUNT))
+    // - TELEMETRY - //
+    if(latestMessage.opcode >= PROTOCOL_FIRST_TELEMETRY_OPCODE && latestMessage.opcode < PROTOCOL_FIRST_EVENT_OPCODE)
     {
-        if(SafeBox_ReturnDepositedPackages()) {return true;}
-        Debug_Error("Communication", "SafeBox_CheckAndExecuteMessage", "Failed ReturnDepositedPackages");
+        // Streamed by XFactor for whoever listens. Never answered.
         return false;
     }
 
-    if(latestMessage.startsWith(COMMAND_STATUS_EXCHANGE))
+    // - PEER SESSION - //
+    if(latestMessage.opcode == COMMAND_STATUS_EXCHANGE && latestMessage.length >= STATUS_EXCHANGE_COMMAND_LENGTH && latestMessage.payload[STATUS_EXCHANGE_PAYLOAD_SESSION] != _peerSession)
     {
-        if(SafeBox_ReplyStatus())
-        {
-            if(SafeBox_SaveReceivedXFactorStatus(latestMessage)) {return true;};
-            Debug_Error("Communication", "SafeBox_CheckAndExecuteMessage", "Failed to save received status");
-            return false;
-        }
+        // XFactor rebooted. Its sequence numbers started over and the last answer was for its previous boot.
+        _peerSession = latestMessage.payload[STATUS_EXCHANGE_PAYLOAD_SESSION];
+        _lastAnswer.sequence = PROTOCOL_NO_SEQUENCE;
+    }
 
-        if(SafeBox_SaveReceivedXFactorStatus(latestMessage))
-        {
-            Debug_Warning("Communication", "SafeBox_CheckAndExecuteMessage", "Saved new XFactor status but failed to reply SafeBox status");
-            return false;
-        }
-        Debug_Error("Communication", "SafeBox_CheckAndExecuteMessage", "Failed to save received status & reply status to XFactor");
+    // - DUPLICATE CHECK - //
+    if(latestMessage.sequence != PROTOCOL_NO_SEQUENCE && latestMessage.sequence == _lastAnswer.sequence && latestMessage.opcode == _commandOpcode)
+    {
+        // XFactor never got our answer. Send it again without executing the command twice.
+        if(BT_SendSequencedFrame(_lastAnswer.opcode, _lastAnswer.sequence, _lastAnswer.payload, _lastAnswer.length)) return true;
+        Debug_Error("Communication", "SafeBox_CheckAndExecuteMessage", "Failed to TX the answer again");
         return false;
     }
 
-    if(latestMessage.endsWith(COMMAND_DOORBELL_GET))
+    _commandSequence = latestMessage.sequence;
+    _commandOpcode = latestMessage.opcode;
+    _lastAnswer.sequence = PROTOCOL_NO_SEQUENCE;
+
+    _commandIsAnswered = false;
+
+    // - DISPATCH - //
+    if(latestMessage.opcode >= SAFEBOX_COMMAND_TABLE_SIZE || _commandHandlers[latestMessage.opcode] == 0)
     {
-        if(SafeBox_GetDoorBellStatus())
-        {
-            return true;
-        }
-        Debug_Error("Communication", "SafeBox_CheckAndExecuteMessage", "Failed GetDoorBellStatus");
+        Debug_Error("Communication", "SafeBox_CheckAndExecuteMessage", "Unknown command received");
+        Debug_Error("Communication", "SafeBox_CheckAndExecuteMessage", String(latestMessage.opcode));
+        // Tells XFactor right away instead of letting it retransmit until it times out.
+        SendAnswer(ANSWER_UNKNOWN_COMMAND, &latestMessage.opcode, 1);
         return false;
     }
+    if(_commandHandlers[latestMessage.opcode](&latestMessage)) return true;
 
-    Debug_Error("Communication", "SafeBox_CheckAndExecuteMessage", "Unknown command received");
-    Debug_Error("Communication", "SafeBox_CheckAndExecuteMessage", latestMessage);
+    // The handler failed before it could answer. XFactor must still hear about it.
+    if(!_commandIsAnswered) SendAnswer(ANSWER_COMMAND_FAILED, &latestMessage.opcode, 1);
     return false;
 }
 
@@ -174,14 +511,14 @@ bool SafeBox_ChangeLidState(bool wantedState)
     {
         if(Lid_Open())
         {
-            if(BT_SendString(ANSWER_LID_SUCCESS)) return true;
+            if(SendAnswer(ANSWER_LID_SUCCESS, 0, 0)) return true;
             Debug_Error("Communication", "SafeBox_ChangeLidState", "Failed RX lid open success");
             SafeBox_SetNewStatus(SafeBox_Status::CommunicationError);
             return false;
         }
         Debug_Error("Communication", "SafeBox_ChangeLidState", "Lid opening failure");
 
-        if(BT_SendString(ANSWER_LID_FAILED)) return false;
+        if(SendAnswer(ANSWER_LID_FAILED, 0, 0)) return false;
         Debug_Error("Communication", "SafeBox_ChangeLidState", "Failed RX lid failure");
         SafeBox_SetNewStatus(SafeBox_Status::CommunicationError);
         return false;      
@@ -190,14 +527,14 @@ bool SafeBox_ChangeLidState(bool wantedState)
     {
         if(Lid_Close())
         {
-            if(BT_SendString(ANSWER_LID_SUCCESS)) return true;
+            if(SendAnswer(ANSWER_LID_SUCCESS, 0, 0)) return true;
             Debug_Error("Communication", "SafeBox_ChangeLidState", "Failed RX lid close success");
             SafeBox_SetNewStatus(SafeBox_Status::CommunicationError);
             return false;
         }
         Debug_Error("Communication", "SafeBox_ChangeLidState", "Lid closing failure");
 
-        if(BT_SendString(ANSWER_LID_FAILED)) return false;
+        if(SendAnswer(ANSWER_LID_FAILED, 0, 0)) return false;
         Debug_Error("Communication", "SafeBox_ChangeLidState", "Failed RX lid failure");
         SafeBox_SetNewStatus(SafeBox_Status::CommunicationError);
         return false;  
@@ -224,14 +561,14 @@ bool SafeBox_ChangeGarageState(bool wantedState)
     {
         if(Garage_Open())
         {
-            if(BT_SendString(ANSWER_GARAGE_SUCCESS)) return true;
+            if(SendAnswer(ANSWER_GARAGE_SUCCESS, 0, 0)) return true;
             Debug_Error("Communication", "SafeBox_ChangeGarageState", "Failed RX garage open success");
             SafeBox_SetNewStatus(SafeBox_Status::CommunicationError);
             return false;
         }
         Debug_Error("Communication", "SafeBox_ChangeGarageState", "Garage opening failure");
 
-        if(BT_SendString(ANSWER_GARAGE_FAILED)) return false;
+        if(SendAnswer(ANSWER_GARAGE_FAILED, 0, 0)) return false;
         Debug_Error("Communication", "SafeBox_ChangeGarageState", "Failed RX garage failure");
         SafeBox_SetNewStatus(SafeBox_Status::CommunicationError);
         return false;
@@ -240,14 +577,14 @@ bool SafeBox_ChangeGarageState(bool wantedState)
     {
         if(Garage_Close())
         {
-            if(BT_SendString(ANSWER_GARAGE_SUCCESS)) return true;
+            if(SendAnswer(ANSWER_GARAGE_SUCCESS, 0, 0)) return true;
             Debug_Error("Communication", "SafeBox_ChangeGarageState", "Failed RX garage close success");
             SafeBox_SetNewStatus(SafeBox_Status::CommunicationError);
             return false;
         }
         Debug_Error("Communication", "SafeBox_ChangeGarageState", "Garage closing failure");
 
-        if(BT_SendString(ANSWER_GARAGE_FAILED)) return false;
+        if(SendAnswer(ANSWER_GARAGE_FAILED, 0, 0)) return false;
         Debug_Error("Communication", "SafeBox_ChangeGarageState", "Failed RX garage failure");
         SafeBox_SetNewStatus(SafeBox_Status::CommunicationError);
         return false; 
@@ -262,52 +599,38 @@ bool SafeBox_ChangeGarageState(bool wantedState)
  * through Bluetooth in the getter setter
  * functions.
  * @param command
- * The string received through Bluetooth
+ * The frame received through Bluetooth
  * @return true:
  * Successfully saved the status of XFactor.
  * @return false:
  * Failed to save the status of XFactor.
  */
-bool SafeBox_SaveReceivedXFactorStatus(String command)
+bool SafeBox_SaveReceivedXFactorStatus(const Protocol_Frame* command)
 {
-    if(command == BT_NO_MESSAGE)
+    // - VARIABLES - //
+    XFactor_Status status = XFactor_Status::Off;
+
+    if((command->opcode != COMMAND_STATUS_EXCHANGE && command->opcode != COMMAND_SNAPSHOT) || command->length == 0)
     {
         Debug_Error("Communication", "SafeBox_SaveReceivedXFactorStatus", "Empty message");
         return false;
     }
 
-    if(command == BT_ERROR_MESSAGE)
+    if(!StatusCodec_DecodeXFactor(command->payload[0], &status))
     {
-        Debug_Error("Communication", "SafeBox_SaveReceivedXFactorStatus", "Error message");
+        Debug_Error("Communication", "SafeBox_SaveReceivedXFactorStatus", "Unknown XFactor status");
+        Debug_Error("Communication", "SafeBox_SaveReceivedXFactorStatus", String(command->payload[0]));
         return false;
     }
 
-    if(command.endsWith("A"))       {XFactor_SetNewStatus(XFactor_Status::Alarm);                       return true;}
-    if(command.endsWith("CRH"))     {XFactor_SetNewStatus(XFactor_Status::CalculatingRouteHome);        return true;}
-    if(command.endsWith("CE"))      {XFactor_SetNewStatus(XFactor_Status::CommunicationError);          return true;}
-    if(command.endsWith("CDO"))     {XFactor_SetNewStatus(XFactor_Status::ConfirmingDropOff);           return true;}
-    if(command.endsWith("DO"))      {XFactor_SetNewStatus(XFactor_Status::DroppingOff);                 return true;}
-    if(command.endsWith("ESB"))     {XFactor_SetNewStatus(XFactor_Status::EnteringSafeBox);             return true;}
-    if(command.endsWith("E"))       {XFactor_SetNewStatus(XFactor_Status::Error);                       return true;}
-    if(command.endsWith("EAP"))     {XFactor_SetNewStatus(XFactor_Status::ExaminatingAPackage);         return true;}
-    if(command.endsWith("LSB"))     {XFactor_SetNewStatus(XFactor_Status::LeavingSafeBox);              return true;}
-    if(command.endsWith("M"))       {XFactor_SetNewStatus(XFactor_Status::Maintenance);                 return true;}
-    if(command.endsWith("NPF"))     {XFactor_SetNewStatus(XFactor_Status::NoPackageFound);              return true;}
-    if(command.endsWith("O"))       {XFactor_SetNewStatus(XFactor_Status::Off);                         return true;}
-    if(command.endsWith("PDOF"))    {XFactor_SetNewStatus(XFactor_Status::PackageDropOffFailed);        return true;}
-    if(command.endsWith("PEF"))     {XFactor_SetNewStatus(XFactor_Status::PackageExaminationFailed);    return true;}
-    if(command.endsWith("PPUF"))    {XFactor_SetNewStatus(XFactor_Status::PackagePickUpFailed);         return true;}
-    if(command.endsWith("PFDO"))    {XFactor_SetNewStatus(XFactor_Status::PackageDropOffFailed);        return true;}
-    if(command.endsWith("PFTS"))    {XFactor_SetNewStatus(XFactor_Status::PreparingForTheSearch);       return true;}
-    if(command.endsWith("RH"))      {XFactor_SetNewStatus(XFactor_Status::ReturningHome);               return true;}
-    if(command.endsWith("SFAP"))    {XFactor_SetNewStatus(XFactor_Status::SearchingForAPackage);        return true;}
-    if(command.endsWith("WFD"))     {XFactor_SetNewStatus(XFactor_Status::WaitingForDelivery);          return true;}
-    if(command.endsWith("WASB"))    {XFactor_SetNewStatus(XFactor_Status::WaitingAfterSafeBox);         return true;}
-    if(command.endsWith("U"))       {XFactor_SetNewStatus(XFactor_Status::Unlocked);                    return true;}
-
-    Debug_Error("Communication", "SafeBox_SaveReceivedXFactorStatus", "Unknown XFactor status");
-    Debug_Error("Communication", "SafeBox_SaveReceivedXFactorStatus", command);
-    return false;
+    XFactor_SetNewStatus(status);
+
+    if(command->opcode == COMMAND_STATUS_EXCHANGE && command->length >= STATUS_EXCHANGE_COMMAND_LENGTH)
+    {
+        ClockSync_SetFromPeer((long)ClockSync_DecodeTime(&command->payload[STATUS_EXCHANGE_PAYLOAD_OFFSET]), command->payload[STATUS_EXCHANGE_PAYLOAD_ACCURACY] | (command->payload[STATUS_EXCHANGE_PAYLOAD_ACCURACY + 1] << 8));
+        _acknowledgedDoorbellRing = command->payload[STATUS_EXCHANGE_PAYLOAD_DOORBELL_RING];
+    }
+    return true;
 }
 
 /**
@@ -322,42 +645,37 @@ bool SafeBox_SaveReceivedXFactorStatus(String command)
  * represents if the status was successfully
  * handled or not, and if the function managed to
  * reply to XFactor or not.
+ * @param command
+ * The received status exchange. Its clock is
+ * sent back along with SafeBox's so that XFactor
+ * can sync them.
  * @return true:
  * Successfully stored the status and
  * @return false:
  * Failed to handle the status or exchange our own.
  */
-bool SafeBox_ReplyStatus()
+bool SafeBox_ReplyStatus(const Protocol_Frame* command)
 {
     // - VARIABLES - //
-    String answer = ANSWER_STATUS_EXCHANGE;
-    String statusEnding = "";
-    SafeBox_Status currentStatus = SafeBox_GetStatus();
+    unsigned char payload[STATUS_EXCHANGE_ANSWER_LENGTH];
+    unsigned char length = 1;
 
-    // - Get the command ending.
-    switch(currentStatus)
-    {
-        case(SafeBox_Status::CommunicationError):   statusEnding = "CE";    break;
-        case(SafeBox_Status::Off):                  statusEnding = "O";     break;
-        case(SafeBox_Status::WaitingForDelivery):   statusEnding = "WFD";   break;
-        case(SafeBox_Status::WaitingForRetrieval):  statusEnding = "WFRI";  break;
-        case(SafeBox_Status::WaitingForReturn):     statusEnding = "WFR";   break;
-        case(SafeBox_Status::WaitingForXFactor):    statusEnding = "RFDO";  break;
-        case(SafeBox_Status::ReadyForDropOff):      statusEnding = "RFDO";  break;
-        case(SafeBox_Status::Unlocked):             statusEnding = "U";     break;
-        case(SafeBox_Status::DroppingOff):          statusEnding = "DO";    break;
-        case(SafeBox_Status::Maintenance):          statusEnding = "M";     break;
-        case(SafeBox_Status::Error):                statusEnding = "E";     break;
-        case(SafeBox_Status::Alarm):                statusEnding = "A";     break;
-
-        default:
-            Debug_Error("Communication", "SafeBox_ReplyStatus", "Unknown SafeBox status");
-            return false;
+    if(!StatusCodec_EncodeSafeBox(SafeBox_GetStatus(), &payload[0]))
+    {
+        Debug_Error("Communication", "SafeBox_ReplyStatus", "Unknown SafeBox status");
+        return false;
     }
 
-    // - Build command string and send it
-    answer.concat(statusEnding);
-    if(!BT_SendString(answer))
+    // - Send XFactor's clock back with ours so that it can sync them
+    if(command->length >= STATUS_EXCHANGE_PAYLOAD_TIME + CLOCKSYNC_ENCODED_TIME_LENGTH)
+    {
+        memcpy(&payload[STATUS_EXCHANGE_PAYLOAD_TIME], &command->payload[STATUS_EXCHANGE_PAYLOAD_TIME], CLOCKSYNC_ENCODED_TIME_LENGTH);
+        ClockSync_EncodeTime(millis(), &payload[STATUS_EXCHANGE_PAYLOAD_PEER_TIME]);
+        length = STATUS_EXCHANGE_ANSWER_LENGTH;
+    }
+
+    // - Send the status as the answer's payload
+    if(!SendAnswer(ANSWER_STATUS_EXCHANGE, payload, length))
     {
         Debug_Error("Communication", "SafeBox_ReplyStatus", "Status TX failed");
         return false;
@@ -366,6 +684,44 @@ bool SafeBox_ReplyStatus()
     return true;
 }
 
+/**
+ * @brief
+ * Replies to XFactor's snapshot request with
+ * everything XFactor needs to know about SafeBox
+ * in a single answer: its status, garage, lid,
+ * doorbell and packages. See the
+ * SNAPSHOT_PAYLOAD_ defines.
+ * @return true:
+ * Successfully sent the snapshot.
+ * @return false:
+ * Failed to build or send the snapshot.
+ */
+bool SafeBox_ReplySnapshot()
+{
+    // - VARIABLES - //
+    unsigned char payload[SNAPSHOT_PAYLOAD_STATUS + 1];
+
+    if(!StatusCodec_EncodeSafeBox(SafeBox_GetStatus(), &payload[SNAPSHOT_PAYLOAD_STATUS]))
+    {
+        Debug_Error("Communication", "SafeBox_ReplySnapshot", "Unknown SafeBox status");
+        return false;
+    }
+
+    // - Build the snapshot
+    payload[SNAPSHOT_PAYLOAD_GARAGE] = Garage_IsClosed() ? 0 : 1;
+    payload[SNAPSHOT_PAYLOAD_LID] = Lid_IsClosed() ? 0 : 1;
+    payload[SNAPSHOT_PAYLOAD_DOORBELL] = Doorbell_GetState() ? 1 : 0;
+    // The package sensor can only tell if there is one.
+    payload[SNAPSHOT_PAYLOAD_PACKAGES] = Package_IsDeposited() ? 1 : 0;
+
+    if(!SendAnswer(ANSWER_SNAPSHOT, payload, sizeof(payload)))
+    {
+        Debug_Error("Communication", "SafeBox_ReplySnapshot", "Snapshot TX failed");
+        return false;
+    }
+    return true;
+}
+
 /**
  * @brief
  * Function that verifies if there is a new
@@ -387,13 +743,13 @@ bool SafeBox_ReplyToCheckIfPackageDeposited()
 {
     if(Package_IsDeposited())
     {
-        if(BT_SendString(ANSWER_PACKAGE_CHECK_SUCCESS)) return true;
+        if(SendAnswer(ANSWER_PACKAGE_CHECK_SUCCESS, 0, 0)) return true;
         Debug_Error("Communication", "SafeBox_ReplyToCheckIfPackageDeposited", "Failed TX BT SUCCESS");
         return false;
     }
     else
     {
-        if(BT_SendString(ANSWER_PACKAGE_CHECK_FAILED)) return true;
+        if(SendAnswer(ANSWER_PACKAGE_CHECK_FAILED, 0, 0)) return true;
         Debug_Error("Communication", "SafeBox_ReplyToCheckIfPackageDeposited", "Failed TX BT FAIL");
         return false;
     }
@@ -418,6 +774,12 @@ bool SafeBox_ReplyToCheckIfPackageDeposited()
  */
 bool SafeBox_ReturnDepositedPackages()
 {
+    // - VARIABLES - //
+    // The package sensor can only tell if there is one.
+    unsigned char packageCount = Package_IsDeposited() ? 1 : 0;
+
+    if(SendAnswer(ANSWER_PACKAGE_COUNT, &packageCount, 1)) return true;
+    Debug_Error("Communication", "SafeBox_ReturnDepositedPackages", "Failed TX BT PACKAGE COUNT");
     return false;
 }
 
@@ -439,17 +801,177 @@ bool SafeBox_GetDoorBellStatus()
 {
     if(Doorbell_GetState())
     {
-        if(BT_SendString(ANSWER_DOORBELL_RANG)) return true;
+        if(SendAnswer(ANSWER_DOORBELL_RANG, 0, 0)) return true;
         Debug_Error("Communication", "SafeBox_GetDoorBellStatus", "Failed TX BT RANG");
         return false;
     }
     else
     {
-        if(BT_SendString(ANSWER_DOORBELL_NOT_RANG)) return true;
+        if(SendAnswer(ANSWER_DOORBELL_NOT_RANG, 0, 0)) return true;
         Debug_Error("Communication", "SafeBox_GetDoorBellStatus", "Failed TX BT UNRANG");
         return false;
     }
 
     return false;
 }
-// #pragma endregion
\ No newline at end of file
+// #pragma endregion
+
+// #pragma region [Scheduled_Garage]
+
+/**
+ * @brief
+ * Opens the garage once the time scheduled by
+ * @ref COMMAND_GARAGE_OPEN_AT is less than
+ * @ref GARAGE_OPENING_TIME_MS away, so that it
+ * is fully open when XFactor arrives. Does
+ * nothing if no opening is scheduled.
+ *
+ * @attention
+ * This must be called periodically from loop.
+ */
+void SafeBox_UpdateScheduledGarage()
+{
+    if(!_garageOpenIsScheduled) return;
+
+    // Time differences handle millis() wrapping around.
+    if((long)(millis() + GARAGE_OPENING_TIME_MS - _garageOpenTime_ms) < 0) return;
+
+    _garageOpenIsScheduled = false;
+    if(!Garage_Open())
+    {
+        Debug_Error("Communication", "SafeBox_UpdateScheduledGarage", "Failed to open the garage");
+    }
+}
+
+// #pragma endregion
+
+// #pragma region [Statistics]
+
+/**
+ * @brief
+ * Replies to XFactor with SafeBox's Bluetooth
+ * statistics. See @ref BT_EncodeStats
+ * @return true:
+ * Successfully sent the statistics.
+ * @return false:
+ * Failed to send the statistics.
+ */
+bool SafeBox_ReplyLinkStats()
+{
+    // - VARIABLES - //
+    unsigned char payload[BT_STATS_ENCODED_LENGTH];
+    unsigned char length = BT_EncodeStats(payload, sizeof(payload));
+
+    if(!SendAnswer(ANSWER_LINK_STATS, payload, length))
+    {
+        Debug_Error("Communication", "SafeBox_ReplyLinkStats", "Statistics TX failed");
+        return false;
+    }
+    return true;
+}
+
+// #pragma endregion
+
+// #pragma region [Events]
+
+/**
+ * @brief
+ * Checks if the doorbell started ringing, if the
+ * alarm started, if the lid moved or if the
+ * status changed since the last call and sends
+ * the matching event to XFactor without waiting
+ * to be asked. XFactor thus learns about them
+ * right away instead of polling SafeBox for
+ * them. The status is also sent every
+ * @ref STATUS_SYNC_HEARTBEAT_MS
+ *
+ * A ring is the only event that XFactor would
+ * miss for good if it was lost. It is sent again
+ * every @ref EVENT_DOORBELL_REPEAT_MS until a
+ * status exchange from XFactor carries its
+ * number.
+ *
+ * @attention
+ * This must be called periodically from loop.
+ * The first call only saves the current states.
+ */
+void SafeBox_CheckAndSendEvents()
+{
+    // - VARIABLES - //
+    static bool firstCall = true;
+    static bool previousDoorbellState = false;
+    static bool doorbellIsPending = false;
+    static unsigned char doorbellRing = 0;
+    static unsigned long doorbellSentTime_ms = 0;
+    static bool previousLidClosed = true;
+    static SafeBox_Status previousStatus = SafeBox_Status::Off;
+    static unsigned long statusSentTime_ms = 0;
+
+    bool doorbellState = Doorbell_GetState();
+    bool lidClosed = Lid_IsClosed();
+    SafeBox_Status currentStatus = SafeBox_GetStatus();
+    unsigned char lidOpened = lidClosed ? 0 : 1;
+    unsigned char statusCode = 0;
+
+    if(firstCall)
+    {
+        firstCall = false;
+        previousDoorbellState = doorbellState;
+        previousLidClosed = lidClosed;
+        previousStatus = currentStatus;
+        return;
+    }
+
+    // - FUNCTION EXECUTION - //
+    if(doorbellState && !previousDoorbellState)
+    {
+        // 0 is what XFactor remembers before the first ring.
+        if(++doorbellRing == 0) doorbellRing = 1;
+        doorbellIsPending = true;
+        doorbellSentTime_ms = millis() - EVENT_DOORBELL_REPEAT_MS;
+    }
+    else if(doorbellIsPending && _acknowledgedDoorbellRing == doorbellRing)
+    {
+        doorbellIsPending = false;
+    }
+
+    if(doorbellIsPending && (millis() - doorbellSentTime_ms) >= EVENT_DOORBELL_REPEAT_MS)
+    {
+        doorbellSentTime_ms = millis();
+        if(!BT_SendFrame(EVENT_DOORBELL_RANG, &doorbellRing, 1))
+        {
+            Debug_Error("Communication", "SafeBox_CheckAndSendEvents", "Failed TX EVENT_DOORBELL_RANG");
+        }
+    }
+
+    if(currentStatus == SafeBox_Status::Alarm && previousStatus != SafeBox_Status::Alarm)
+    {
+        if(!BT_SendFrame(EVENT_ALARM_STARTED, 0, 0))
+        {
+            Debug_Error("Communication", "SafeBox_CheckAndSendEvents", "Failed TX EVENT_ALARM_STARTED");
+        }
+    }
+
+    if(lidClosed != previousLidClosed)
+    {
+        if(!BT_SendFrame(EVENT_LID_CHANGED, &lidOpened, 1))
+        {
+            Debug_Error("Communication", "SafeBox_CheckAndSendEvents", "Failed TX EVENT_LID_CHANGED");
+        }
+    }
+
+    if(currentStatus != previousStatus || (millis() - statusSentTime_ms) >= STATUS_SYNC_HEARTBEAT_MS)
+    {
+        statusSentTime_ms = millis();
+        if(!StatusCodec_EncodeSafeBox(currentStatus, &statusCode) || !BT_SendFrame(EVENT_STATUS_CHANGED, &statusCode, 1))
+        {
+            Debug_Error("Communication", "SafeBox_CheckAndSendEvents", "Failed TX EVENT_STATUS_CHANGED");
+        }
+    }
+
+    previousDoorbellState = doorbellState;
+    previousLidClosed = lidClosed;
+    previousStatus = currentStatus;
+}
+
+// #pragma endregion
@@ -15,6 +15,17 @@
 
 // - DEFINES - //
 
+/// @brief Status exchanges received during the self-test.
+unsigned long _statusExchanges = 0;
+/// @brief Status exchanges whose XFactor status could not be decoded.
+unsigned long _badXFactorCodes = 0;
+/// @brief One bit per XFactor status code received. Bit 0 of byte 0 is code 0.
+unsigned char _receivedXFactorCodes[32];
+/// @brief Code of SafeBox's status when the self-test started. It is restored once every status was sent.
+unsigned char _initialSafeBoxCode = 0;
+unsigned char _previousXFactorCode = 0;
+bool _statusCycleIsDone = false;
+
 // - FUNCTIONS - //
 
 void ContinuouslyAnswerXFactor()
@@ -24,19 +35,201 @@ void ContinuouslyAnswerXFactor()
 
 /**
  * @brief
+ * Moves SafeBox's status to the next valid
+ * code until it is back to the one it had when
+ * the self-test started.
+ */
+void AdvanceSelfTestStatus()
+{
+    // - VARIABLES - //
+    unsigned char code = 0;
+    SafeBox_Status status = SafeBox_Status::Off;
+
+    if(_statusCycleIsDone) return;
+
+    StatusCodec_EncodeSafeBox(SafeBox_GetStatus(), &code);
+    do
+    {
+        code++;
+    }
+    while(!StatusCodec_DecodeSafeBox(code, &status));
+
+    if(code == _initialSafeBoxCode) _statusCycleIsDone = true;
+    SafeBox_SetNewStatus(status);
+}
+
+/**
+ * @brief
+ * Handles @ref COMMAND_STATUS_EXCHANGE during
+ * the self-test. Counts XFactor's status and
+ * answers with the next status of SafeBox when
+ * XFactor's status changed.
+ * @param command
+ * The received command.
+ * @return true:
+ * Successfully handled the command.
+ * @return false:
+ * Failed to handle the command.
+ */
+bool HandleSelfTestStatusExchange(const Protocol_Frame* command)
+{
+    // - VARIABLES - //
+    XFactor_Status status = XFactor_Status::Off;
+
+    _statusExchanges++;
+    if(command->length == 0 || !StatusCodec_DecodeXFactor(command->payload[0], &status))
+    {
+        _badXFactorCodes++;
+    }
+    else
+    {
+        _receivedXFactorCodes[command->payload[0] >> 3] |= (1 << (command->payload[0] & 0x07));
+        if(command->payload[0] != _previousXFactorCode) AdvanceSelfTestStatus();
+        _previousXFactorCode = command->payload[0];
+    }
+
+    if(!SafeBox_ReplyStatus(command))
+    {
+        Debug_Error("TEST", "HandleSelfTestStatusExchange", "Failed to reply status");
+        return false;
+    }
+    return SafeBox_SaveReceivedXFactorStatus(command);
+}
+
+/**
+ * @brief 
  * Call this in main.cpp to test communications
- * between XFactor and SafeBox.
+ * between XFactor and SafeBox. Answers XFactor's
+ * self-test and moves SafeBox's status to the
+ * next one each time XFactor's status changes,
+ * until every status was sent back once. What
+ * was received is reported every
+ * @ref SELF_TEST_REPORT_MS
+ *
+ * @attention
+ * SafeBox's status is saved in EEPROM each time
+ * it changes. It is back to what it was once
+ * every status was sent.
  */
 void TestGoodCommunications()
 {
+    // - VARIABLES - //
+    static bool firstCall = true;
+    static unsigned long reportTime_ms = 0;
+
+    if(firstCall)
+    {
+        firstCall = false;
+        reportTime_ms = millis();
+        StatusCodec_EncodeSafeBox(SafeBox_GetStatus(), &_initialSafeBoxCode);
+        StatusCodec_EncodeXFactor(XFactor_GetStatus(), &_previousXFactorCode);
+        SafeBox_RegisterCommand(COMMAND_STATUS_EXCHANGE, HandleSelfTestStatusExchange);
+        BT_ResetStats();
+    }
 
+    ContinuouslyAnswerXFactor();
+
+    if(millis() - reportTime_ms < SELF_TEST_REPORT_MS) return;
+    reportTime_ms = millis();
+
+    Debug_Information("TEST", "RESULT", "Status exchanges: " + String(_statusExchanges) + " Bad XFactor status: " + String(_badXFactorCodes));
+    TestAllStatusCommunications();
+    BT_PrintStats(BT_GetStats());
 }
 
+/**
+ * @brief
+ * Checks that one of XFactor's status was
+ * received during the self-test.
+ * @param testNumber
+ * Number printed if the test fails.
+ * @param status
+ * The status that XFactor should have sent.
+ * @return true:
+ * The status was received.
+ * @return false:
+ * The status was never received.
+ */
 bool TestOneStatus(int testNumber, XFactor_Status status)
 {
+    // - VARIABLES - //
+    unsigned char code = 0;
+
+    if(StatusCodec_EncodeXFactor(status, &code) && (_receivedXFactorCodes[code >> 3] & (1 << (code & 0x07))))
+    {
+        return true;
+    }
+    Debug_Warning("TEST", "NOT RECEIVED", String(testNumber));
     return false;
 }
 
+/**
+ * @brief
+ * Calls @ref TestOneStatus with every valid
+ * @ref XFactor_Status and prints how many were
+ * received.
+ */
 void TestAllStatusCommunications()
 {
-}
\ No newline at end of file
+    // - VARIABLES - //
+    XFactor_Status status = XFactor_Status::Off;
+    int testNumber = 0;
+    int received = 0;
+
+    for(unsigned int code = 0; code < 256; code++)
+    {
+        if(!StatusCodec_DecodeXFactor((unsigned char)code, &status)) continue;
+        if(TestOneStatus(testNumber++, status)) received++;
+    }
+
+    Debug_Information("TEST", "RESULT", "XFactor status received: " + String(received) + "/" + String(testNumber));
+}
+
+/**
+ * @brief
+ * Tells if every status of SafeBox was sent
+ * back to XFactor once.
+ * @return true:
+ * SafeBox's status is back to what it was.
+ */
+bool SelfTestIsDone()
+{
+    return _statusCycleIsDone;
+}
+
+/**
+ * @brief
+ * Returns how many status exchanges were
+ * received during the self-test.
+ */
+unsigned long GetSelfTestStatusExchanges()
+{
+    return _statusExchanges;
+}
+
+/**
+ * @brief
+ * Returns how many status exchanges held a
+ * status that XFactor does not have.
+ */
+unsigned long GetSelfTestErrors()
+{
+    return _badXFactorCodes;
+}
+
+/**
+ * @brief
+ * Returns how many different status of XFactor
+ * were received during the self-test.
+ */
+unsigned int GetSelfTestReceivedStatus()
+{
+    // - VARIABLES - //
+    unsigned int received = 0;
+
+    for(unsigned int code = 0; code < 256; code++)
+    {
+        if(_receivedXFactorCodes[code >> 3] & (1 << (code & 0x07))) received++;
+    }
+    return received;
+}
@@ -11,6 +11,7 @@
 // - INCLUDES -//
 #include "Actions/Actions.hpp"
 #include "SafeBox/Init.hpp"
+#include "SafeBox/CommunicationTest.hpp"
 
 /// @brief Arduino's initialisation function.
 void setup()
@@ -21,8 +22,21 @@ void setup()
 /// @brief Arduino's while(1) function.
 void loop()
 {
+  PROFILER_START();
+
+#ifdef COMMUNICATION_SELF_TEST
+  TestGoodCommunications();
+  SafeBox_CheckAndSendEvents();
+  SafeBox_UpdateScheduledGarage();
+#else
   Execute_CurrentFunction();
+  SafeBox_CheckAndSendEvents();
+  SafeBox_UpdateScheduledGarage();
   Garage_ShowDebugLight();
+#endif
+
+  PROFILER_STOP(PROFILER_SLOT_LOOP);
+  PROFILER_HANDLE_COMMANDS();
 
   //Debug_Information("-", "-", String(Lid_IsClosed()));
 }
\ No newline at end of file
@@ -22,6 +22,10 @@
 #include "Movements/Movements.hpp"
 #include "Package/Package.hpp"
 #include "Actions/Utils.hpp"
+#include "SafeBox/CommunicationTest.hpp"
+#include "Scheduler/Scheduler.hpp"
+#include "Scheduler/Coroutine.hpp"
+#include "Debug/Profiler.hpp"
 
 //#pragma region [OTHER] // WILL BE CHANGED WHEN MORE OF EM SHOW UP
 
@@ -30,6 +34,17 @@
 
 //#pragma endregion
 
+//#pragma region [TASKS]
+
+/// @brief Sensors of the alarm while XFactor moves.
+#define TASK_SENSORS_PERIOD_US 5000
+#define TASK_SENSORS_BUDGET_US 2000
+/// @brief Pending SafeBox commands and the status exchange.
+#define TASK_COMMS_PERIOD_US 2000
+#define TASK_COMMS_BUDGET_US 1000
+
+//#pragma endregion
+
 //#pragma region DISTANCES // WILL BE MIGRATED TO MOVEMENTS
 
 #define STRAIGHT 0.0f
@@ -43,15 +58,48 @@
 
 //#pragma endregion
 
+//#pragma region [STATES]
+
+/// @brief Bit of a function ID inside @ref Action_State allowedTransitions
+#define ACTION_TRANSITION(functionID) (1UL << (functionID))
+
+/// @brief Hook of an execution function. 0 when the function has nothing to do at that moment.
+typedef void (*Action_Hook)();
+
+/**
+ * @brief
+ * Row of the state table of the execution
+ * functions, indexed by function ID.
+ * @ref Execute_CurrentFunction calls onExit of
+ * the previous function and onEnter of the new
+ * one once per transition, then onTick each
+ * time it is called.
+ */
+typedef struct
+{
+    Action_Hook onEnter;
+    /// @brief The execution function itself. 0 for IDs that are not used.
+    Action_Hook onTick;
+    Action_Hook onExit;
+    /// @brief @ref ACTION_TRANSITION of each function ID that this function can go to.
+    unsigned long allowedTransitions;
+} Action_State;
+
+//#pragma endregion
+
 //#pragma region [ACTION_HANDLERS]
 /**
  * @brief Function periodically called in void
- * loop. This function is a massive switch case
- * that checks which execution / action function
- * should currently be executed by XFactor. To
- * specify that function, use
+ * loop. Registers XFactor's tasks on its first
+ * call and then runs the scheduler. The sensors
+ * and communication tasks run at fixed rates.
+ * The last task executes the current execution
+ * / action function through its row of the
+ * state table. To specify that function, use
  * @ref SetNewExecutionFunction using defines
  * available in this header file.
+ * Each pass of the scheduler is the loop slot
+ * of the profiler.
  */
 void Execute_CurrentFunction();
 
@@ -78,7 +126,8 @@ void Execute_CurrentFunction();
  * to the new ID.
  * @return false:
  * Failed to change the execution function to the
- * new ID. May be out of range.
+ * new ID. May be out of range or not allowed
+ * from the current execution function.
  */
 bool SetNewExecutionFunction(unsigned char functionID);
 
@@ -91,6 +140,17 @@ bool SetNewExecutionFunction(unsigned char functionID);
  * function ID
  */
 unsigned char GetCurrentExecutionFunction();
+
+/**
+ * @brief
+ * Function that returns how many times a new
+ * execution function was entered by
+ * @ref Execute_CurrentFunction since the start
+ * of the program.
+ * @return unsigned long:
+ * Number of transitions.
+ */
+unsigned long GetExecutionTransitionCount();
 //#pragma endregion
 
 //#pragma region [ACTION_FUNCTIONS]
@@ -297,6 +357,10 @@ void Execute_PickUpPackage();
  * vector, XFactor must simply redo all the saved
  * vectors in reverse until its back to the start
  *
+ * @note
+ * SafeBox is told when XFactor should arrive so
+ * that the garage is already open by then.
+ *
  * @warning
  * A status exchange must be performed each 5
  * vectors to ensure that communication with
@@ -38,6 +38,11 @@
 #define FUNCTION_ID_UNLOCKED 16
 #define FUNCTION_ID_CALIBRATE_COLOUR 17
 
+/// @brief How many function IDs there are. IDs go from 0 to this minus 1.
+#define FUNCTION_ID_COUNT 18
+/// @brief No function. Used before the first function is entered.
+#define FUNCTION_ID_NONE 255
+
 //#pragma endregion
 
 /**
@@ -58,7 +63,8 @@ void ExecutionUtils_ForceAStatusExchange();
  * is currently saved for SafeBox. This prevents
  * the program from automatically changing the
  * execution function back to an unwanted
- * execution function automatically.
+ * execution function automatically. Called by
+ * the onEnter hook of the state.
  * 
  * @param wantedStatus
  * The status that XFactor should hold while in
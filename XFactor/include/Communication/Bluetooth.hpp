@@ -17,24 +17,145 @@
 // - INCLUDES - //
 #include "Debug/Debug.hpp"
 #include "Arduino.h"
+#include <EEPROM.h>
+#include "Communication/Protocol.hpp"    //// Used to encode and decode the frames sent over Bluetooth
 
 // - DEFINES - //
-/// @brief The baudrate of the Serial port which talks to the HC-05 module.
+/// @brief The baudrate of the Serial port which talks to the HC-05 module. Used when no faster baudrate could be negotiated.
 #define BT_HC05_BAUDRATE 19200
-/// @brief Serial port used on an Arduino Mega. Where the HC-05 BT module will be connected.
+/// @brief Baudrate that @ref BT_Init tries to move the HC-05 to when BT_NEGOTIATE_BAUDRATE is defined.
+#define BT_HC05_FAST_BAUDRATE 115200
+/// @brief AT command that moves the HC-05 to @ref BT_HC05_FAST_BAUDRATE once it is reset.
+#define BT_HC05_FAST_BAUDRATE_COMMAND "AT+UART=115200,0,0"
+/// @brief Pin wired to the KEY pin of the HC-05. While it is high, the module answers AT commands at its current baudrate.
+#define BT_HC05_KEY_PIN 40
+/// @brief How long to wait after the HC-05's answer to an AT command.
+#define BT_AT_TIMEOUT_MS 300
+/// @brief How long the HC-05 takes to restart after AT+RESET.
+#define BT_HC05_RESET_DELAY_MS 1000
+/// @brief Where the negotiated baudrate is saved in the EEPROM. Saved in units of 1200 bauds to fit in a byte.
+#define BT_BAUDRATE_EEPROM_ADDRESS (EEPROM.length()-80)
+/// @brief Serial port used on an Arduino Mega. Where the HC-05 BT module will be connected. Can be defined as a build flag to use a simulated port instead.
+#ifndef BT_SERIAL
 #define BT_SERIAL Serial1
+#endif
 /// @brieg Serial event called by Arduino when a character is received. MUST BE LINKED WITH @ref BT_SERIAL
+#ifndef BT_SERIAL_EVENT
 #define BT_SERIAL_EVENT void serialEvent1()
+#endif
+/// @brief Pin wired to the HC-05's STATE output. High while paired. Only read when BT_USE_STATE_PIN is defined.
+#define BT_HC05_STATE_PIN 41
+#ifndef BT_READ_STATE_PIN
+/// @brief How the HC-05's STATE output is read. Can be replaced to simulate the pin.
+#define BT_READ_STATE_PIN() digitalRead(BT_HC05_STATE_PIN)
+#endif
+#ifndef BT_LINK_SILENCE_MS
+/// @brief Without BT_USE_STATE_PIN, the link is considered down when nothing was received for this long.
+#define BT_LINK_SILENCE_MS 3000
+#endif
 /// @brief How big in bytes can a message be until its discarded for being gibberish?
-#define BT_MAX_MESSAGE_LENGTH 200
-/// @brief How many strings can the message buffer receive before it overflows?
+#define BT_MAX_MESSAGE_LENGTH PROTOCOL_MAX_PAYLOAD_LENGTH
+/// @brief How many frames can the message buffer receive before it overflows?
 #define BT_SIZE_OF_MESSAGE_BUFFER 4
+/// @brief Size in bytes of the reception ring buffer fed by @ref BT_SERIAL_EVENT. MUST be a power of 2.
+#define BT_RX_RING_BUFFER_SIZE 128
+/// @brief Size in bytes of the transmission ring buffer emptied into the UART without blocking. MUST be a power of 2.
+#define BT_TX_RING_BUFFER_SIZE 128
+/// @brief Size of the ring buffer in which telemetry frames wait to be sent. Must be a power of 2.
+#define BT_TELEMETRY_RING_BUFFER_SIZE 64
+/// @brief How many logical channels share the link. See @ref BT_Channel
+#define BT_CHANNEL_COUNT 2
 /// @brief Returned by BT_GetMessage functions to indicate that there was no message to get.
 #define BT_NO_MESSAGE "%_NAN_%"
 /// @brief Returned whenever an error occur in a function that returns and handles communications.
 #define BT_ERROR_MESSAGE "%_ERROR_%"
 
 #define BT_NEVER_RECEIVED_MESSAGE "%_ARDUINO_SUCKS_W_MEMORY%"
+/// @brief How many buckets the round trip time histogram of @ref BT_Stats has.
+#define BT_STATS_ROUND_TRIP_BUCKETS 8
+/// @brief Round trip times below this many milliseconds go in the first bucket of the histogram.
+#define BT_STATS_FIRST_BUCKET_MS 4
+/// @brief How many command opcodes @ref BT_Stats tracks separately. Commands go from 0x01 to 0x0F.
+#define BT_STATS_COMMAND_SLOTS 16
+/// @brief Size in bytes of the statistics encoded by @ref BT_EncodeStats
+#define BT_STATS_ENCODED_LENGTH (4 * 4 + BT_STATS_ROUND_TRIP_BUCKETS * 2)
+
+/**
+ * @brief
+ * Enumeration of the logical channels that share
+ * the link. Each one has its own transmission
+ * queue. Control frames are always sent before
+ * queued telemetry.
+ */
+enum class BT_Channel {
+
+    /// @brief Commands, answers, events and status sync. Never dropped.
+    Control = 0,
+
+    /// @brief Telemetry frames. Dropped when the link is saturated.
+    Telemetry = 1
+};
+
+/**
+ * @brief
+ * What is known about the commands of one
+ * opcode. Only the device that sends the
+ * commands fills these.
+ */
+typedef struct
+{
+    /// @brief Commands that got their answer.
+    unsigned int completed;
+    /// @brief Retransmissions of commands that were not answered in time.
+    unsigned int retries;
+    /// @brief Commands that never got their answer.
+    unsigned int timeouts;
+} BT_CommandStats;
+
+/**
+ * @brief
+ * Statistics of the Bluetooth link since boot or
+ * since @ref BT_ResetStats. Get them with
+ * @ref BT_GetStats
+ */
+typedef struct
+{
+    /// @brief Frames queued for transmission.
+    unsigned long framesSent;
+    /// @brief Frames received with a valid CRC.
+    unsigned long framesReceived;
+    /// @brief Frames discarded because of their CRC or length.
+    unsigned long framesRejected;
+    /// @brief Valid frames lost because the frame buffer was full.
+    unsigned long framesDropped;
+    /// @brief Bytes queued on each channel. Indexed by @ref BT_Channel
+    unsigned long channelBytes[BT_CHANNEL_COUNT];
+    /// @brief Telemetry frames dropped because the link was saturated or down.
+    unsigned long telemetryDropped;
+    /// @brief Round trip times of commands. Bucket 0 is below 4 ms and each bucket after doubles. The last one holds everything above.
+    unsigned int roundTripHistogram[BT_STATS_ROUND_TRIP_BUCKETS];
+    /// @brief Statistics per command. Indexed by opcode. Index 0 holds opcodes that do not fit.
+    BT_CommandStats commands[BT_STATS_COMMAND_SLOTS];
+} BT_Stats;
+
+/**
+ * @brief
+ * Moves every byte that the UART has received
+ * into the reception ring buffer and then hands
+ * them to the frame decoder. Any complete frame
+ * with a valid CRC is saved in the frame buffer.
+ * Queued bytes are then moved from the
+ * transmission ring buffer to the UART as long
+ * as it has space for them.
+ * This never blocks and never uses the heap.
+ *
+ * @attention
+ * Arduino automatically calls this through
+ * @ref BT_SERIAL_EVENT in between loops. Any
+ * function that waits after a message must
+ * call it itself while it waits.
+ */
+void BT_Poll();
 
 /**
  * @brief Function that initialises Bluetooth on
@@ -48,6 +169,17 @@
  * program inside of the setup function or
  * inside of a wider initialisation function.
  *
+ * @note
+ * When BT_NEGOTIATE_BAUDRATE is defined, the
+ * HC-05 is moved to @ref BT_HC05_FAST_BAUDRATE
+ * through its AT commands. If the module does not
+ * answer at the new baudrate,
+ * @ref BT_HC05_BAUDRATE is used. The selected
+ * baudrate is saved in the EEPROM so that the
+ * next boot tries it first. The HC-05's
+ * baudrate only concerns its UART so each
+ * device negotiates with its own module.
+ *
  * @return true:
  * Bluetooth was successfully initialised
  * @return false:
@@ -55,20 +187,145 @@
  */
 bool BT_Init();
 
+/**
+ * @brief
+ * Returns the baudrate that @ref BT_Init
+ * selected for the HC-05.
+ * @return unsigned long:
+ * 0 if Bluetooth is not initialised.
+ */
+unsigned long BT_GetBaudRate();
+
+/**
+ * @brief
+ * Sends an AT command to an HC-05 whose KEY pin
+ * is high and waits for its OK. Works on any
+ * Stream so that a simulated module can answer.
+ * @param port
+ * Stream to which the HC-05 is connected.
+ * @param command
+ * The AT command, without its line ending.
+ * @param millisecondsTimeOut
+ * How long to wait for the answer.
+ * @return true:
+ * The module answered OK.
+ * @return false:
+ * The module answered ERROR or did not answer.
+ */
+bool BT_SendATCommand(Stream& port, const char* command, unsigned long millisecondsTimeOut);
+
+/**
+ * @brief Simple function that sends a frame
+ * through UART to the initialised Bluetooth
+ * module with a sequence number. Commands carry
+ * their own sequence number and answers carry
+ * the one of the command they answer.
+ * The frame is queued and sent in the
+ * background so this never waits after the
+ * UART. See @ref BT_Flush
+ * @param opcode
+ * One of the COMMAND_ or ANSWER_ defines.
+ * @param sequence
+ * Sequence number of the frame or
+ * @ref PROTOCOL_NO_SEQUENCE
+ * @param payload
+ * Bytes sent with the opcode. Can be 0 if
+ * length is 0.
+ * @param length
+ * How many bytes of payload there is.
+ * @return true:
+ * The frame was queued successfully.
+ * @return false:
+ * Failed to queue the frame.
+ */
+bool BT_SendSequencedFrame(unsigned char opcode, unsigned char sequence, const unsigned char* payload, unsigned char length);
+
+/**
+ * @brief Simple function that sends a frame
+ * through UART to the initialised Bluetooth
+ * module without a sequence number. Used for
+ * events and text frames.
+ * @param opcode
+ * One of the COMMAND_ or ANSWER_ defines.
+ * @param payload
+ * Bytes sent with the opcode. Can be 0 if
+ * length is 0.
+ * @param length
+ * How many bytes of payload there is.
+ * @return true:
+ * The frame was queued successfully.
+ * @return false:
+ * Failed to queue the frame.
+ */
+bool BT_SendFrame(unsigned char opcode, const unsigned char* payload, unsigned char length);
+
+/**
+ * @brief
+ * Same as @ref BT_SendFrame but the payload is
+ * read from flash. Lets constant payloads be
+ * sent without ever being copied in RAM.
+ * @param opcode
+ * One of the COMMAND_, ANSWER_ or EVENT_ defines.
+ * @param payload
+ * PROGMEM bytes sent with the opcode. Can be 0 if
+ * length is 0.
+ * @param length
+ * How many bytes of payload there is.
+ * @return true:
+ * The frame was queued successfully.
+ * @return false:
+ * Failed to queue the frame.
+ */
+bool BT_SendFrame_P(unsigned char opcode, const unsigned char* payload, unsigned char length);
+
+/**
+ * @brief
+ * Blocks until every queued byte has been sent
+ * by the UART. Only needed when something must
+ * be sent before going on, such as before
+ * changing the UART's baudrate.
+ */
+void BT_Flush();
+
+/**
+ * @brief
+ * Sends a telemetry frame on
+ * @ref BT_Channel::Telemetry. It is only sent
+ * once no control frame is waiting. When its
+ * queue is full, the link is saturated and the
+ * frame is dropped instead of delaying anything.
+ * @param opcode
+ * A telemetry opcode, from
+ * @ref PROTOCOL_FIRST_TELEMETRY_OPCODE up to
+ * @ref PROTOCOL_FIRST_EVENT_OPCODE
+ * @param payload
+ * Bytes sent with the opcode. Can be 0 if
+ * length is 0.
+ * @param length
+ * How many bytes of payload there is.
+ * @return true:
+ * The frame was queued.
+ * @return false:
+ * The opcode is not a telemetry one or the
+ * frame was dropped.
+ */
+bool BT_SendTelemetry(unsigned char opcode, const unsigned char* payload, unsigned char length);
+
 /**
  * @brief Simple function that sends a string
  * through UART to the initialised Bluetooth
- * module to be sent to SafeBox.
+ * module as a @ref PROTOCOL_OPCODE_TEXT frame.
+ * Commands and answers should be sent with
+ * @ref BT_SendFrame instead.
  * @param message
  * A string containing the message that needs
- * to be sent to SafeBox. All messages must be
- * stored as DEFINES.
+ * to be sent.
  * @return true:
  * The message was sent successfully.
  * @return false:
  * Failed to send the message.
  */
-bool BT_SendString(String message);
+bool BT_SendString(const String& message);
 
 /**
  * @brief Simple function that checks how many
@@ -111,65 +368,21 @@ bool BT_ClearAllMessages();
  */
 bool BT_WaitForAMessage(int millisecondsTimeOut);
 
-/**
- * @brief Returns a string which corresponds to
- * the oldest message stored in the reception
- * buffer of the device. If there is no messages
- * available, the string will be empty
- *
- * @attention
- * It is preferred that @ref BT_MessagesAvailable
- * is called before you call this function.
- *
- * @return string: The oldest message stored in
- * the reception buffer.
- */
-String BT_GetLatestMessage();
-
-/**
- * @brief Function that firstly clears the UART
- * buffer to empty it of any messages, then sends
- * a specified message to the UART Bluetooth
- * module. Once that is done, the function waits
- * for a message to be received to return it or
- * waits for the timeout to reach its specified
- * value.
- *
- * @attention
- * Its recommended to use this function rather
- * than the other BT functions as this one
- * handles everything there is to handle.
- *
- * @warning
- * This function automatically calls
- * @ref BT_BeforeCommsEvent
- * @ref BT_CommsSuccessEvent
- * @ref BT_CommsFailedEvent
- *
- * @param message
- * A string containing the message that needs
- * to be sent to SafeBox. All messages must be
- * stored as DEFINES.
- * @param millisecondsTimeOut
- * How long should the program wait for a message
- * @return string: The received message from
- * SafeBox.
- */
-String BT_MessageExchange(String message, int millisecondsTimeOut);
-
 /**
  * @brief
- * This function used to be the function that
- * allowed interrupts to read from the serial
- * port. But as we know it, Arduino's string
- * classes as well as stack managaement sucks
- * ass. This function is called whenever we
- * perform a message exchange to make sure that
- * message was gathered correctly.
- * @return String:
- * "SWEET_FUCK_ALL": No message were found.
+ * Copies the oldest complete frame stored in the
+ * frame buffer inside of the specified frame
+ * and removes it from the frame buffer. This
+ * does not use any String nor the heap.
+ *
+ * @param frame
+ * Frame in which the oldest frame is copied.
+ * @return true:
+ * A frame was copied.
+ * @return false:
+ * There was no frame to get.
  */
-String GetMessage();
+bool BT_GetLatestFrame(Protocol_Frame* frame);
 
 /**
  * @brief
@@ -191,3 +404,127 @@ String GetMessage();
  */
 String MessageBuffer(String newMessage, unsigned char bufferIndex, int action);
 
+// #pragma region [Link_State]
+
+/**
+ * @brief
+ * Tells if the HC-05 is paired with the other
+ * device. When BT_USE_STATE_PIN is defined, this
+ * is the module's STATE output. Otherwise the
+ * link is considered down when nothing was
+ * received for @ref BT_LINK_SILENCE_MS.
+ * Updated by @ref BT_Poll.
+ * @return true:
+ * The link is up.
+ * @return false:
+ * The link is down. Anything sent is lost.
+ */
+bool BT_LinkIsUp();
+
+/**
+ * @brief
+ * Tells once that the link went up or down since
+ * the last call. Use @ref BT_LinkIsUp to know
+ * which one.
+ * @return true:
+ * The link state changed.
+ * @return false:
+ * The link state did not change.
+ */
+bool BT_LinkStateChanged();
+
+// #pragma endregion
+
+// #pragma region [Statistics]
+
+/**
+ * @brief
+ * Returns the statistics of the Bluetooth link.
+ * @return const BT_Stats*:
+ * Always valid. Updated as the link is used.
+ */
+const BT_Stats* BT_GetStats();
+
+/**
+ * @brief
+ * Sets every statistic of the Bluetooth link
+ * back to 0.
+ */
+void BT_ResetStats();
+
+/**
+ * @brief
+ * Saves that a command got its answer and how
+ * long it took in the statistics.
+ * @param opcode
+ * One of the COMMAND_ defines.
+ * @param roundTrip_ms
+ * Time from when the command was first sent to
+ * when its answer was received.
+ */
+void BT_RecordRoundTrip(unsigned char opcode, unsigned long roundTrip_ms);
+
+/**
+ * @brief
+ * Saves that a command was retransmitted in the
+ * statistics.
+ * @param opcode
+ * One of the COMMAND_ defines.
+ */
+void BT_RecordRetry(unsigned char opcode);
+
+/**
+ * @brief
+ * Saves that a command never got its answer in
+ * the statistics.
+ * @param opcode
+ * One of the COMMAND_ defines.
+ */
+void BT_RecordTimeout(unsigned char opcode);
+
+/**
+ * @brief
+ * Encodes the link counters and the round trip
+ * time histogram so that they can be sent as a
+ * payload. Counters take 4 bytes and histogram
+ * buckets take 2, least significant byte first.
+ * @param buffer
+ * Where the statistics are encoded.
+ * @param bufferSize
+ * Size in bytes of the buffer.
+ * @return unsigned char:
+ * How many bytes were encoded. 0 if the buffer
+ * is too small.
+ */
+unsigned char BT_EncodeStats(unsigned char* buffer, unsigned char bufferSize);
+
+/**
+ * @brief
+ * Decodes statistics encoded by
+ * @ref BT_EncodeStats. The statistics per
+ * command are not encoded and are set to 0.
+ * @param buffer
+ * The encoded statistics.
+ * @param length
+ * How many bytes there is in the buffer.
+ * @param stats
+ * Where the statistics are decoded.
+ * @return true:
+ * The statistics were decoded.
+ * @return false:
+ * The buffer is too short.
+ */
+bool BT_DecodeStats(const unsigned char* buffer, unsigned char length, BT_Stats* stats);
+
+/**
+ * @brief
+ * Prints statistics of the Bluetooth link on the
+ * debug serial port. Only the commands that were
+ * used are printed.
+ * @param stats
+ * Statistics to print. Usually
+ * @ref BT_GetStats
+ */
+void BT_PrintStats(const BT_Stats* stats);
+
+// #pragma endregion
@@ -0,0 +1,163 @@
+/**
+ * @file ClockSync.hpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Header file containing the definitions of the
+ * functions that estimate the offset and drift
+ * in between XFactor's and SafeBox's millis()
+ * clocks, the same way NTP does. Samples are taken from the
+ * timestamps carried by the status exchange.
+ * Out of the last few samples, the one with the
+ * shortest round trip is trusted since its
+ * delays are the least asymmetric.
+ *
+ * @attention
+ * This file is shared by XFactor and SafeBox.
+ * Both copies must stay identical.
+ * @version 0.1
+ * @date 2023-12-03
+ * @copyright Copyright (c) 2023
+ */
+
+#pragma once
+
+// - INCLUDES - //
+#include "Arduino.h"
+
+// - DEFINES - //
+/// @brief How many of the latest samples are kept to pick the one with the shortest round trip.
+#define CLOCKSYNC_SAMPLES 4
+/// @brief The drift is only measured in between samples taken at least this far apart.
+#define CLOCKSYNC_MIN_DRIFT_INTERVAL_MS 10000
+/// @brief Accuracy returned while the clocks are not synced.
+#define CLOCKSYNC_UNKNOWN_ACCURACY 0xFFFF
+/// @brief How many bytes a time takes once encoded. See @ref ClockSync_EncodeTime
+#define CLOCKSYNC_ENCODED_TIME_LENGTH 4
+/// @brief Samples with a longer round trip are ignored. They come from a stale or corrupted answer.
+#define CLOCKSYNC_MAX_ROUND_TRIP_MS 10000UL
+
+/**
+ * @brief
+ * One measured offset and the round trip it was
+ * measured with.
+ */
+typedef struct
+{
+    long offset_ms;
+    unsigned long roundTrip_ms;
+    unsigned long time_ms;
+} ClockSync_Sample;
+
+/**
+ * @brief
+ * Writes a millis() time in 4 bytes, least
+ * significant byte first.
+ * @param time_ms
+ * The time to encode.
+ * @param buffer
+ * Where the 4 bytes are written.
+ */
+void ClockSync_EncodeTime(unsigned long time_ms, unsigned char* buffer);
+
+/**
+ * @brief
+ * Reads a millis() time written by
+ * @ref ClockSync_EncodeTime
+ * @param buffer
+ * The 4 encoded bytes.
+ * @return unsigned long:
+ * The decoded time.
+ */
+unsigned long ClockSync_DecodeTime(const unsigned char* buffer);
+
+/**
+ * @brief
+ * Adds a round trip to the estimate. The peer
+ * is assumed to have read its clock half way
+ * through the round trip. Round trips longer
+ * than @ref CLOCKSYNC_MAX_ROUND_TRIP_MS are
+ * ignored.
+ * @param localSent_ms
+ * Local millis() when the request was sent.
+ * @param peer_ms
+ * The peer's millis() when it answered.
+ * @param localReceived_ms
+ * Local millis() when the answer was received.
+ */
+void ClockSync_SaveSample(unsigned long localSent_ms, unsigned long peer_ms, unsigned long localReceived_ms);
+
+/**
+ * @brief
+ * Uses the estimate that the peer made of the
+ * offset instead of measuring it. Used by the
+ * device that only answers the exchanges.
+ * @param peerOffset_ms
+ * The peer's estimate of this device's millis()
+ * minus its own.
+ * @param peerAccuracy_ms
+ * The accuracy of the peer's estimate or
+ * @ref CLOCKSYNC_UNKNOWN_ACCURACY
+ */
+void ClockSync_SetFromPeer(long peerOffset_ms, unsigned int peerAccuracy_ms);
+
+/**
+ * @brief
+ * Forgets every sample. The clocks are no
+ * longer synced until new samples are saved.
+ */
+void ClockSync_Reset();
+
+/**
+ * @brief
+ * Tells if the offset in between the clocks is
+ * known.
+ * @return true:
+ * The conversions can be used.
+ * @return false:
+ * No samples were saved yet.
+ */
+bool ClockSync_IsSynced();
+
+/**
+ * @brief
+ * Returns the current estimate of the peer's
+ * millis() minus the local millis(), drift
+ * included.
+ * @return long:
+ * Offset in milliseconds. 0 if not synced.
+ */
+long ClockSync_GetOffset();
+
+/**
+ * @brief
+ * Returns how far off the offset can be. Half
+ * the round trip of the trusted sample plus what
+ * the drift could have added since.
+ * @return unsigned int:
+ * Accuracy in milliseconds or
+ * @ref CLOCKSYNC_UNKNOWN_ACCURACY if not synced.
+ */
+unsigned int ClockSync_GetAccuracy();
+
+/**
+ * @brief
+ * Converts a time read on the peer's millis()
+ * into the local millis().
+ * @param peer_ms
+ * The peer's time.
+ * @return unsigned long:
+ * The same instant on the local clock.
+ */
+unsigned long Peer_MillisToLocal(unsigned long peer_ms);
+
+/**
+ * @brief
+ * Converts a time read on the local millis()
+ * into the peer's millis(). Lets a command ask
+ * the peer to do something at a given instant.
+ * @param local_ms
+ * The local time.
+ * @return unsigned long:
+ * The same instant on the peer's clock.
+ */
+unsigned long Local_MillisToPeer(unsigned long local_ms);
@@ -0,0 +1,207 @@
+/**
+ * @file Requests.hpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Header file containing the definitions of the
+ * non blocking Bluetooth requests. A request is
+ * submitted, a handle is returned and the
+ * program keeps running while the answer is in
+ * flight. The handle is then polled from loop
+ * until the request is completed or timed out.
+ * Each request carries a sequence number and is
+ * retransmitted until SafeBox answers it.
+ * @version 0.1
+ * @date 2023-11-28
+ * @copyright Copyright (c) 2023
+ */
+
+#pragma once
+
+// - INCLUDES - //
+#include "Debug/Debug.hpp"
+#include "Communication/Bluetooth.hpp"  //// Used to send requests and receive their answers
+
+// - DEFINES - //
+/// @brief How many requests can be submitted at the same time.
+#define BT_MAX_PENDING_REQUESTS 4
+/// @brief Returned by @ref BT_SubmitRequest when no request could be submitted.
+#define BT_INVALID_REQUEST 255
+/// @brief How long to wait before retransmitting a request while no round trip was measured yet.
+#define BT_INITIAL_RETRANSMIT_MS 250
+#ifndef BT_MIN_RETRANSMIT_MS
+/// @brief Requests are never retransmitted sooner than this after being sent. Can be set as a build flag.
+#define BT_MIN_RETRANSMIT_MS 50
+#endif
+#ifndef BT_MAX_RETRANSMIT_MS
+/// @brief Retransmissions back off up to this delay in between each other. Can be set as a build flag.
+#define BT_MAX_RETRANSMIT_MS 1000
+#endif
+/// @brief Where the session of the last boot is saved. See @ref BT_InitRequests
+#define BT_SESSION_EEPROM_ADDRESS (EEPROM.length()-81)
+/// @brief Distance in between the first sequence numbers of two consecutive sessions. Odd so that all 255 are used.
+#define BT_SESSION_SEQUENCE_STRIDE 97
+#ifndef BT_MAX_RETRANSMISSIONS
+/// @brief A request still unanswered after this many retransmissions times out. Can be set as a build flag.
+#define BT_MAX_RETRANSMISSIONS 2
+#endif
+
+/**
+ * @brief
+ * Enumeration of all the states that a request
+ * can be in. Requests are sent one at a time in
+ * the order they were submitted.
+ */
+enum class BT_RequestState {
+
+    /// @brief The handle is not used by any request.
+    Free = 0,
+
+    /// @brief The request waits for the requests submitted before it to be answered.
+    Queued = 1,
+
+    /// @brief The request was sent and its answer is awaited. It is retransmitted until answered.
+    WaitingForAnswer = 2,
+
+    /// @brief The answer was received. Get it with @ref BT_GetRequestAnswer
+    Completed = 3,
+
+    /// @brief No answer was received after @ref BT_MAX_RETRANSMISSIONS or before the request's time out.
+    TimedOut = 4,
+
+    /// @brief The request could not be sent or the link went down. See @ref BT_LinkIsUp
+    Failed = 5
+};
+
+/**
+ * @brief
+ * Starts a new session of requests. Each boot
+ * gets its own session number, saved in the
+ * EEPROM, and starts its sequence numbers from
+ * a different place. Status exchanges tell the
+ * session to SafeBox so that it never takes a
+ * command of this boot for a retransmission of
+ * the previous one.
+ * @return true:
+ * Successfully started the session.
+ * @return false:
+ * Failed to start the session.
+ */
+bool BT_InitRequests();
+
+/**
+ * @brief
+ * Returns the session started by
+ * @ref BT_InitRequests
+ * @return unsigned char:
+ * Session number. Never 0 once started.
+ */
+unsigned char BT_GetSession();
+
+/**
+ * @brief
+ * Submits a new request to be sent to the other
+ * device as soon as the requests submitted
+ * before it are done. This never blocks.
+ *
+ * @param opcode
+ * One of the COMMAND_ defines.
+ * @param payload
+ * Bytes sent with the opcode. Can be 0 if
+ * length is 0.
+ * @param length
+ * How many bytes of payload there is.
+ * @param millisecondsTimeOut
+ * The longest the answer can be awaited once the
+ * request is sent. The request usually times
+ * out sooner, once it was retransmitted
+ * @ref BT_MAX_RETRANSMISSIONS times.
+ * @return unsigned char:
+ * Handle of the request or
+ * @ref BT_INVALID_REQUEST if all the handles are
+ * used or the payload is too long.
+ */
+unsigned char BT_SubmitRequest(unsigned char opcode, const unsigned char* payload, unsigned char length, unsigned long millisecondsTimeOut);
+
+/**
+ * @brief
+ * Sends queued requests, receives answers,
+ * retransmits requests that were not answered
+ * in time and times out requests that waited for
+ * too long. Answers whose sequence number is not
+ * the one of the awaited request are dropped.
+ * Events received in the meantime are handed to
+ * @ref BT_MessageReceivedEvent. Requests fail
+ * right away while the link is down and
+ * @ref BT_LinkChangedEvent is called when it
+ * goes up or down. This never blocks.
+ *
+ * @attention
+ * This must be called periodically from loop
+ * for requests to progress.
+ */
+void BT_UpdateRequests();
+
+/**
+ * @brief
+ * Returns the current state of a request.
+ * @param handle
+ * Handle returned by @ref BT_SubmitRequest
+ * @return BT_RequestState:
+ * @ref BT_RequestState::Free if the handle is
+ * not valid.
+ */
+BT_RequestState BT_GetRequestState(unsigned char handle);
+
+/**
+ * @brief
+ * Copies the answer of a completed request in
+ * the specified frame.
+ * @param handle
+ * Handle returned by @ref BT_SubmitRequest
+ * @param answer
+ * Frame in which the answer is copied.
+ * @return true:
+ * The answer was copied.
+ * @return false:
+ * The request is not completed.
+ */
+bool BT_GetRequestAnswer(unsigned char handle, Protocol_Frame* answer);
+
+/**
+ * @brief
+ * Frees the handle of a request so that it can
+ * be reused. A request that is still queued or
+ * awaited is cancelled.
+ * @param handle
+ * Handle returned by @ref BT_SubmitRequest
+ */
+void BT_ReleaseRequest(unsigned char handle);
+
+/**
+ * @brief
+ * Blocks until the specified request is no
+ * longer queued or awaited. This is what the
+ * blocking communication functions are built on.
+ * The other tasks of the scheduler run while it
+ * waits.
+ * @param handle
+ * Handle returned by @ref BT_SubmitRequest
+ * @return BT_RequestState:
+ * The final state of the request.
+ */
+BT_RequestState BT_WaitForRequest(unsigned char handle);
+
+/**
+ * @brief
+ * Returns how long to wait after sending a
+ * request before retransmitting it. It is
+ * derived from the smoothed round trip time and
+ * its variance and doubles each time a request
+ * times out. Also used to space out retries of
+ * failed requests.
+ * @return unsigned long:
+ * Delay in milliseconds, in between
+ * @ref BT_MIN_RETRANSMIT_MS and
+ * @ref BT_MAX_RETRANSMIT_MS
+ */
+unsigned long BT_GetRetransmitTimeout();
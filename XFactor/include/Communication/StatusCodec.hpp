@@ -0,0 +1,86 @@
+/**
+ * @file StatusCodec.hpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Header file containing the definitions of the
+ * functions that turn XFactor's and SafeBox's
+ * status into the single byte sent over
+ * Bluetooth and back. The code of a status is
+ * the value of its enum, which never changes,
+ * and a table of the valid codes rejects
+ * anything else in a single lookup.
+ *
+ * @attention
+ * This file is shared by XFactor and SafeBox.
+ * Both copies must stay identical.
+ * @version 0.1
+ * @date 2023-12-01
+ * @copyright Copyright (c) 2023
+ */
+
+#pragma once
+
+// - INCLUDES - //
+#include "Arduino.h"
+#include "XFactor/Status.hpp"
+#include "SafeBox/Status.hpp"
+
+/**
+ * @brief
+ * Gets the code sent over Bluetooth for one of
+ * XFactor's status.
+ * @param status
+ * The status to encode.
+ * @param code
+ * Where the code is written.
+ * @return true:
+ * The status was encoded.
+ * @return false:
+ * The status is not a valid @ref XFactor_Status
+ */
+bool StatusCodec_EncodeXFactor(XFactor_Status status, unsigned char* code);
+
+/**
+ * @brief
+ * Gets XFactor's status out of a code received
+ * over Bluetooth.
+ * @param code
+ * The received code.
+ * @param status
+ * Where the status is written.
+ * @return true:
+ * The code was decoded.
+ * @return false:
+ * The code matches no @ref XFactor_Status
+ */
+bool StatusCodec_DecodeXFactor(unsigned char code, XFactor_Status* status);
+
+/**
+ * @brief
+ * Gets the code sent over Bluetooth for one of
+ * SafeBox's status.
+ * @param status
+ * The status to encode.
+ * @param code
+ * Where the code is written.
+ * @return true:
+ * The status was encoded.
+ * @return false:
+ * The status is not a valid @ref SafeBox_Status
+ */
+bool StatusCodec_EncodeSafeBox(SafeBox_Status status, unsigned char* code);
+
+/**
+ * @brief
+ * Gets SafeBox's status out of a code received
+ * over Bluetooth.
+ * @param code
+ * The received code.
+ * @param status
+ * Where the status is written.
+ * @return true:
+ * The code was decoded.
+ * @return false:
+ * The code matches no @ref SafeBox_Status
+ */
+bool StatusCodec_DecodeSafeBox(unsigned char code, SafeBox_Status* status);
@@ -0,0 +1,120 @@
+/**
+ * @file Profiler.hpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Header file containing the definitions of the
+ * profiler that measures how long each execution
+ * function and each loop takes. Measurements are
+ * kept in fixed slots in RAM and printed on the
+ * debug serial port when 'p' is received on it.
+ *
+ * @attention
+ * The profiler only exists when PROFILER_ENABLED
+ * is defined in platformio.ini. Otherwise, its
+ * macros are empty and nothing is compiled.
+ * @version 0.1
+ * @date 2023-12-07
+ * @copyright Copyright (c) 2023
+ */
+
+#pragma once
+
+// - INCLUDES - //
+#include "Arduino.h"
+#include "Debug/Debug.hpp"
+
+// - DEFINES - //
+/// @brief How many slots are measured. One per execution function ID plus the loop.
+#define PROFILER_SLOTS 20
+/// @brief Slot used to measure loop iterations. Execution function IDs must be below it.
+#define PROFILER_SLOT_LOOP (PROFILER_SLOTS - 1)
+/// @brief How many buckets the duration histogram of each slot has.
+#define PROFILER_HISTOGRAM_BUCKETS 8
+/// @brief Durations below this many microseconds go in the first bucket. Each bucket is 4 times wider.
+#define PROFILER_FIRST_BUCKET_US 64UL
+/// @brief Character received on the debug serial port that prints the measurements.
+#define PROFILER_COMMAND_PRINT 'p'
+/// @brief Character received on the debug serial port that clears the measurements.
+#define PROFILER_COMMAND_RESET 'r'
+
+#ifdef PROFILER_ENABLED
+    /// @brief Starts measuring the code that follows until @ref PROFILER_STOP in the same scope.
+    #define PROFILER_START() unsigned long profilerStart_us = micros()
+    /// @brief Records the time since @ref PROFILER_START in the specified slot.
+    #define PROFILER_STOP(slot) Profiler_Record((slot), micros() - profilerStart_us)
+    /// @brief Prints or clears the measurements if asked to on the debug serial port.
+    #define PROFILER_HANDLE_COMMANDS() Profiler_HandleCommands()
+#else
+    #define PROFILER_START()
+    #define PROFILER_STOP(slot)
+    #define PROFILER_HANDLE_COMMANDS()
+#endif
+
+/**
+ * @brief
+ * Measurements of one slot since the start of
+ * the program or since @ref Profiler_Reset
+ */
+typedef struct
+{
+    unsigned long count;
+    unsigned long min_us;
+    unsigned long max_us;
+    /// @brief Sum of the durations. Divide by count for the mean.
+    unsigned long long total_us;
+    /// @brief Saturates instead of wrapping around.
+    unsigned short histogram[PROFILER_HISTOGRAM_BUCKETS];
+} Profiler_Slot;
+
+// - FUNCTIONS - //
+#ifdef PROFILER_ENABLED
+
+/**
+ * @brief
+ * Adds a duration to the measurements of a
+ * slot. Durations of slots that do not exist
+ * are ignored.
+ * @param slot
+ * Execution function ID or
+ * @ref PROFILER_SLOT_LOOP
+ * @param duration_us
+ * Measured duration in microseconds.
+ */
+void Profiler_Record(unsigned char slot, unsigned long duration_us);
+
+/**
+ * @brief
+ * Returns the measurements of a slot.
+ * @param slot
+ * Execution function ID or
+ * @ref PROFILER_SLOT_LOOP
+ * @return const Profiler_Slot*:
+ * The measurements or 0 if the slot does not
+ * exist.
+ */
+const Profiler_Slot* Profiler_GetSlot(unsigned char slot);
+
+/**
+ * @brief
+ * Clears the measurements of every slot.
+ */
+void Profiler_Reset();
+
+/**
+ * @brief
+ * Prints the count, min, mean, max and
+ * histogram of every slot that was measured.
+ */
+void Profiler_Print();
+
+/**
+ * @brief
+ * Reads the characters received on the debug
+ * serial port. @ref PROFILER_COMMAND_PRINT
+ * prints the measurements and
+ * @ref PROFILER_COMMAND_RESET clears them.
+ * Other characters are ignored.
+ */
+void Profiler_HandleCommands();
+
+#endif
@@ -16,6 +16,7 @@
 #pragma once
 
 #include "Arduino.h" //// For string returns and parameters
+#include "Communication/Protocol.hpp" //// For the frames received over Bluetooth
 
 //These allow the movement execute functions to break if there is another execute that needs to take over
 #include "Alarm/Alarm.hpp"
@@ -165,22 +166,40 @@ bool BT_WaitingForMessageEvent(float executionRatio);
 bool BT_MessageExchangeSuccessEvent(String messageSent, String messageReceived);
 
 /**
- * @brief Event that is called once when a
- * message is received by XFactor. This allows
- * the program to change LED color or perform
- * other necessary actions depending on the
- * received message from SafeBox
+ * @brief Event that is called once when an
+ * event is received by XFactor. SafeBox sends
+ * events without being asked whenever its
+ * doorbell rings, its alarm starts or its lid
+ * moves. This allows the program to react to
+ * them right away instead of polling SafeBox.
  *
  * @param receivedMessage
- * A string corresponding to the message that was
- * received from SafeBox as an answer to the
- * message that was sent.
+ * The event frame received from SafeBox. Its
+ * opcode is one of the EVENT_ defines.
+ * @return true:
+ * The event was handled successfully.
+ * @return false:
+ * The event failed to be handled.
+ */
+bool BT_MessageReceivedEvent(const Protocol_Frame* receivedMessage);
+
+/**
+ * @brief Event called once whenever the
+ * Bluetooth link goes up or down. See
+ * @ref BT_LinkIsUp. Once reconnected, everything
+ * saved about SafeBox and its clock is synced
+ * again since it may have changed in the
+ * meantime.
+ *
+ * @param linkIsUp
+ * true if the link just went up, false if it
+ * just went down.
  * @return true:
  * The event was handled successfully.
  * @return false:
  * The event failed to be handled.
  */
-bool BT_MessageReceivedEvent(String receivedMessage);
+bool BT_LinkChangedEvent(bool linkIsUp);
 
 /**
  * @brief Event called once whenever the BT
@@ -34,7 +34,7 @@
 
 #define BACKTRACE_VECTOR backtraceVector.rotation_rad, backtraceVector.distance_cm, false, DONT_CHECK_SENSORS, true, false, SPEED_MAX
 
-#define SEARCH_PATTERN_VECTOR searchPatternVectors[i].rotation_rad, searchPatternVectors[i].distance_cm, true, CHECK_SENSORS, true, false, 0.4f
+#define SEARCH_PATTERN_VECTOR searchPatternVectors[searchVectorIndex].rotation_rad, searchPatternVectors[searchVectorIndex].distance_cm, true, CHECK_SENSORS, true, false, 0.4f
 #define GO_TO_DETECTED_OBJECT_FRONT_VECTOR STRAIGHT, Package_GetDetectedDistance() + (DISTANCE_SENSOR_DIFF_BETWEEN_SIDE_AND_FRONT_CM / 2), true, DONT_CHECK_SENSORS, true, false, 0.2f
 #define GO_TO_DETECTED_OBJECT_LEFT_VECTOR TURN_90_LEFT - (PI / 90), Package_GetDetectedDistance(), true, DONT_CHECK_SENSORS, true, false, 0.2f
 #define GO_TO_DETECTED_OBJECT_RIGHT_VECTOR TURN_90_RIGHT + (PI / 90), Package_GetDetectedDistance(), true, DONT_CHECK_SENSORS, true, false,0.2f
@@ -44,6 +44,10 @@
 #define EXAMINE_PACKAGE_CLOSEUP_VECTOR STRAIGHT, Package_GetDetectedDistance(), true, false, true, true, 0.2f
 
 #define RETURN_HOME_VECTOR returnVector.rotation_rad, returnVector.distance_cm, true, false, true, false, 0.4f
+/// @brief Average ground speed of XFactor while following @ref RETURN_HOME_VECTOR. Used to tell SafeBox when XFactor arrives.
+#define RETURN_HOME_SPEED_CM_PER_S 20.0f
+/// @brief Time taken by the turns in between the end of @ref RETURN_HOME_VECTOR and the garage.
+#define RETURN_HOME_FINAL_TURN_MS 1500
 
 #define PICK_UP_PACKAGE_VECTOR STRAIGHT, PACKAGE_BACK_MOVEMENT, true, DONT_CHECK_SENSORS, false, false, 0.2f
 #define ALIGN_WITH_SAFEBOX_VECTOR PI/2, 0, false, DONT_CHECK_SENSORS, true, false, 0.2f
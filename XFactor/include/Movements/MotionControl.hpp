@@ -0,0 +1,216 @@
+/**
+ * @file MotionControl.hpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Header file containing the definitions of the
+ * motion control step. The encoders are sampled
+ * and the PID and acceleration are updated from
+ * a timer interrupt at a fixed rate. Movements
+ * only start a movement with its targets and
+ * read how much of it is completed.
+ *
+ * @attention
+ * The interrupt is Timer0's compare match A.
+ * Timer0 keeps running as Arduino's millis()
+ * timer and is not reconfigured. Pin 13 must
+ * not be used with analogWrite.
+ * @version 0.1
+ * @date 2023-12-05
+ * @copyright Copyright (c) 2023
+ */
+
+#pragma once
+
+// - INCLUDES - //
+#include "Arduino.h"
+#include "Debug/Debug.hpp"
+#include "Movements/PID.hpp"
+
+// - DEFINES - //
+/// @brief Time in between two ticks. Timer0 overflows every 64*256 clock cycles at 16MHz.
+#define MOTION_CONTROL_TICK_US 1024UL
+/// @brief Ticks in between two steps. The closest to PID_INTERVAL_MS, which the PID was tuned for.
+#define MOTION_CONTROL_TICKS_PER_STEP 10
+/// @brief Nominal time in between two steps. Jitter is measured against this.
+#define MOTION_CONTROL_PERIOD_US (MOTION_CONTROL_TICK_US * MOTION_CONTROL_TICKS_PER_STEP)
+
+//First 3 variables for the PID, Kp, Ki and Kd.
+//#define PID_MOVEMENT 0.0016f, 0.0002f, 0.0005f
+#define PID_MOVEMENT 0.0064f, 0.0016f, 0.0020f
+
+/**
+ * @brief
+ * Everything a step needs to compute the speed
+ * of the motors. The targets are set by
+ * @ref MotionControl_Start and the rest is
+ * updated by each step.
+ */
+typedef struct
+{
+    /// @brief Encoder ticks of the right wheel at which the movement is completed.
+    float targetTicks;
+    float maximumSpeed;
+    /// @brief 1 or -1. Multiplies the speed of both motors.
+    int direction;
+    /// @brief 1 when moving straight, -1 when turning on itself.
+    float leftDirection;
+
+    int32_t previousLeftPulse;
+    int32_t previousRightPulse;
+    /// @brief Right wheel's ticks over @ref targetTicks. The movement is done at 1.
+    float completionRatio;
+    float leftSpeed;
+    float rightSpeed;
+    /// @brief Corrects the left motor so that it keeps up with the right one.
+    PID_State pid;
+} MotionControl_State;
+
+// - FUNCTIONS - //
+
+/**
+ * @brief Calculate the wanted speed factor depending on how much
+ * distance is left to move to reach its wanted destination.
+ * This allows the robot to perform an acceleration when starting
+ * its movement and a de acceleration when its nearing the end of
+ * its distance.
+ *
+ * This is important to make the robot go faster than an instant
+ * acceleration that would otherwise cause slip and potential
+ * drifting, meaning loss in accuracy.
+ * @param completionRatio
+ * ratio going from 0 to 1 representing how much of the chosen
+ * movement the robot has completed. Used to represent the x in
+ * the parabolic function.
+ * @param maximumSpeed
+ * a ratio from 0 to 1 that indicates the maximum speed of
+ * the wheels.
+ * @return float
+ * Ratio from 0 to 1 that should be multiplied to the
+ * current PID value
+ */
+float Accelerate(float completionRatio, float maximumSpeed);
+
+/**
+ * @brief
+ * Sets the targets of a movement and clears
+ * what its steps computed, including the PID.
+ * @param state
+ * State of the movement to set.
+ * @param targetTicks
+ * Ticks of the right encoder at which the
+ * movement is completed.
+ * @param maximumSpeed
+ * Speed reached in the middle of the movement.
+ * @param direction
+ * 1 or -1.
+ * @param leftDirection
+ * 1 when moving straight, -1 when turning.
+ */
+void MotionControl_InitState(MotionControl_State* state, float targetTicks, float maximumSpeed, int direction, float leftDirection);
+
+/**
+ * @brief
+ * Computes one step of the acceleration and of
+ * the PID from the absolute encoder readings.
+ * Does not touch any hardware so that it can be
+ * executed on its own.
+ * @param state
+ * State of the movement. Its completion ratio
+ * and motor speeds are updated.
+ * @param leftPulse
+ * Absolute ticks read on the left encoder.
+ * @param rightPulse
+ * Absolute ticks read on the right encoder.
+ */
+void MotionControl_ComputeStep(MotionControl_State* state, int32_t leftPulse, int32_t rightPulse);
+
+/**
+ * @brief
+ * Enables the timer interrupt that calls
+ * @ref MotionControl_Tick
+ * @return true:
+ * Successfully enabled the interrupt.
+ * @return false:
+ * Failed to enable the interrupt.
+ */
+bool MotionControl_Init();
+
+/**
+ * @brief
+ * Called by the timer interrupt every
+ * @ref MOTION_CONTROL_TICK_US. Every
+ * @ref MOTION_CONTROL_TICKS_PER_STEP ticks, the
+ * encoders are read, a step is computed and the
+ * motors are set if a movement is active.
+ *
+ * @attention
+ * Interrupts are enabled during the step so that
+ * no encoder tick is missed.
+ */
+void MotionControl_Tick();
+
+/**
+ * @brief
+ * Starts controlling a movement. The encoders
+ * must have been reset beforehand.
+ * @param targetTicks
+ * Ticks of the right encoder at which the
+ * movement is completed.
+ * @param maximumSpeed
+ * Speed reached in the middle of the movement.
+ * @param direction
+ * 1 or -1.
+ * @param leftDirection
+ * 1 when moving straight, -1 when turning.
+ */
+void MotionControl_Start(float targetTicks, float maximumSpeed, int direction, float leftDirection);
+
+/**
+ * @brief
+ * Stops controlling the motors. No step sets
+ * the motors once this returns.
+ */
+void MotionControl_Stop();
+
+/**
+ * @brief
+ * Returns how much of the current movement is
+ * completed, as updated by the last step.
+ * @return float:
+ * 0 at the start, 1 once completed.
+ */
+float MotionControl_GetCompletionRatio();
+
+/**
+ * @brief
+ * Returns the largest difference measured in
+ * between the time separating two steps and
+ * @ref MOTION_CONTROL_PERIOD_US
+ * @return unsigned long:
+ * Largest jitter in microseconds.
+ */
+unsigned long MotionControl_GetMaxJitter();
+
+/**
+ * @brief
+ * Returns the average difference measured in
+ * between the time separating two steps and
+ * @ref MOTION_CONTROL_PERIOD_US
+ * @return unsigned long:
+ * Average jitter in microseconds.
+ */
+unsigned long MotionControl_GetAverageJitter();
+
+/**
+ * @brief
+ * Clears the step and jitter statistics.
+ */
+void MotionControl_ResetStats();
+
+/**
+ * @brief
+ * Prints the steps executed, the steps skipped
+ * because the previous one was not done yet,
+ * the jitter and the longest step.
+ */
+void MotionControl_PrintStats();
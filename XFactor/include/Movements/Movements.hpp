@@ -19,12 +19,10 @@
 #include "Events/Events.hpp"            //// Allows the Execute movement functions to interrupt when a set goal is reached.
 #include "Distances.hpp"                //// Distance constants useful for movement
 #include "LED/LED.hpp"
+#include "Scheduler/Scheduler.hpp"      //// Lets the other tasks run while the robot moves.
+#include "Movements/MotionControl.hpp"  //// Runs the PID from a timer while the robot moves.
 
 
-//First 3 variables for the PID, Kp, Ki and Kd.
-//#define PID_MOVEMENT 0.0016f, 0.0002f, 0.0005f
-#define PID_MOVEMENT 0.0064f, 0.0016f, 0.0020f
-
 #define PID_MOVEMENT_VALUE_P 0.0016f
 #define PID_MOVEMENT_VALUE_I 0.0002f
 #define PID_MOVEMENT_VALUE_D 0.0000f
@@ -154,31 +152,6 @@ bool TurnInRadians(float radians);
  */
 bool MoveStraight(float distance);
 
-/**
- * @brief Calculate the wanted speed factor depending on how much
- * distance is left to move to reach its wanted destination.
- * This allows the robot to perform an acceleration when starting
- * its movement and a de acceleration when its nearing the end of
- * its distance.
- *
- * This is important to make the robot go faster than an instant
- * acceleration that would otherwise cause slip and potential
- * drifting, meaning loss in accuracy.
- * @param distanceLeft
- * How much rotation or distance is left to make
- * @param totalDistance
- * How much total distance or total rotation is needed
- * to reach the end of the moving sequence. This is
- * used to make a ratio from 0 to 1.
- * @param maximumSpeed
- * a ratio from 0 to 1 that indicates the maximum speed of
- * the wheels.
- * @return float
- * Ratio from 0 to 1 that should be multiplied to the
- * current PID value
- */
-float Accelerate(float distanceLeft, float totalDistance, float maximumSpeed);
-
 /**
  * @brief Stops the robot no matter what.
  * This function should simply stop
@@ -194,7 +167,8 @@ bool Stop();
  * @brief Function that must be called
  * before the robot starts to execute
  * its movements. It will reset the
- * PID as well as encoders. It should
+ * encoders. The PID is reset by
+ * @ref MotionControl_Start. It should
  * also reset current rotation and
  * distance.
  * @return true:
@@ -217,6 +191,23 @@ bool ResetMovements();
 bool ResetParameters();
 //#pragma endregion
 
+//#pragma region [Tasks]
+
+/**
+ * @brief Samples the sensors of the alarm while
+ * a movement that checks the alarm is done.
+ * Straight movements stop checking once 85% of
+ * the way is done.
+ *
+ * @attention
+ * Registered as a task so that the alarm is
+ * sampled at the same rate no matter how fast
+ * the movement loops spin.
+ */
+void Movements_SensorStep();
+
+//#pragma endregion
+
 //#pragma region [Execution_Functions]
 
 /**
@@ -17,6 +17,19 @@
 #include "Debug/Debug.hpp"
 
 #define SPEED_MAX 0.4f
+
+/**
+ * @brief
+ * What @ref PID remembers in between two calls.
+ * Each use of the PID has its own so that they
+ * do not disturb each other.
+ */
+typedef struct
+{
+    float previousValue;
+    float errorSum;
+} PID_State;
+
 /**
  * @brief Basic PID function that returns an
  * adjusted value over time based on a wanted
@@ -29,8 +42,11 @@
  * you would first get the difference between
  * the 2, knowing you want it to be 0, and
  * then call he function as following:
- * speedCorrection = PID(p, i, d, difference, 0);
+ * speedCorrection = PID(&state, p, i, d, difference, 0);
  *
+ * @param state
+ * What the PID remembered from its previous
+ * calls. Updated by this call.
  * @param proportional
  * the P value of the PID. The increase of the
  * number the further it is from wanted value.
@@ -55,7 +71,7 @@
  * at 0.
  * @return float
  */
-float PID(float proportional, float integral, float derivative, float currentValue, float wantedValue, float startingValue);
+float PID(PID_State* state, float proportional, float integral, float derivative, float currentValue, float wantedValue, float startingValue);
 
 /**
  * @brief Resets @ref PID
@@ -63,9 +79,11 @@ float PID(float proportional, float integral, float derivative, float currentVal
  * use the @ref PID function. this
  * allows it to reset its previous
  * variables and sum of errors.
+ * @param state
+ * The state to reset.
  * @return true:
  * Successfully reset the PID.
  * @return false:
  * Failed to reset the PID.
  */
-bool ResetPID();
\ No newline at end of file
+bool ResetPID(PID_State* state);
\ No newline at end of file
@@ -16,6 +16,7 @@
 // - INCLUDES - //
 #include "Outputs/Motors/Servo/S3003.hpp" //// Used to make the claw move. 2 servo motors should be used.
 #include "Debug/Debug.hpp"
+#include "Scheduler/Scheduler.hpp" //// Used to wait for the servo motors without stopping the other tasks.
 
 // #pragma region [DEFINES]
 #define CLAWS_SQUEEZE_DISTANCE 10
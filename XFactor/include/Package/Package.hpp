@@ -19,11 +19,14 @@
 #include "Movements/Movements.hpp"
 #include "Colour/Colour.hpp"
 #include "Sensors/Distance/GP2D12.hpp"
+#include "Scheduler/Coroutine.hpp"
 
 // #pragma region [DEFINES]
 #define PACKAGE_CLAW_GRABBER_POSITION_TRANSPORT 0
 #define PACKAGE_CLAW_HEIGHT_POSITION_TRANSPORT 70
 #define PACKAGE_BACK_MOVEMENT -10.0f
+/// @brief How many times @ref Package_PickUp tries to close the claw on the package.
+#define PACKAGE_PICK_UP_ATTEMPTS 5
 
 #define NOTHING_DETECTED 0
 #define PACKAGE_DETECTED 1
@@ -69,20 +72,33 @@ bool Package_Release();
 
 /**
  * @brief
- * Function that automatically picks up a package
- * that is right where the claw is. This function
- * will deploy the claw if not already done.
+ * Coroutine that automatically picks up a
+ * package that is right where the claw is. This
+ * function will deploy the claw if not already
+ * done. It returns while waiting after the claw
+ * and must be called until it no longer returns
+ * @ref COROUTINE_RUNNING
  *
  * @attention
  * The robot must already be facing the package
  * correctly before this function is executed.
  *
- * @return true:
+ * @return COROUTINE_RUNNING:
+ * Still picking up the package.
+ * @return COROUTINE_SUCCEEDED:
  * Successfully picked up a package
- * @return false:
+ * @return COROUTINE_FAILED:
  * Failed to pick up a package, try again.
  */
-bool Package_PickUp();
+unsigned char Package_PickUp();
+
+/**
+ * @brief
+ * Makes the next call of @ref Package_PickUp
+ * start a new pick up instead of resuming the
+ * one in progress.
+ */
+void Package_CancelPickUp();
 
 /**
  * @brief Function that aligns XFactor's claw
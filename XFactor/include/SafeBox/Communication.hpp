@@ -17,39 +17,269 @@
 #include "SafeBox/Status.hpp"           //// Used to store the status of SafeBox and get the enumeration of its possible values
 #include "XFactor/Status.hpp"           //// Used to get the enumeration of XFactor status possible values
 #include "Communication/Bluetooth.hpp"  //// Used to communicate information and receive information from SafeBox
+#include "Communication/Requests.hpp"   //// Used to send commands to SafeBox without blocking
+#include "Communication/StatusCodec.hpp"    //// Used to turn status into the codes sent over Bluetooth
+#include "Communication/ClockSync.hpp"      //// Used to sync the clocks through the status exchange
+#include "Scheduler/Scheduler.hpp"          //// Used to let the other tasks run while an answer is awaited
 
 // - DEFINES - //
 #define COMMS_TIMEOUT_MS 2000
+/// @brief For how long the last snapshot of SafeBox is read from memory by the getters before it is asked again.
+#define SNAPSHOT_MAX_AGE_MS 100
+#ifndef STATUS_SYNC_HEARTBEAT_MS
+/// @brief How often XFactor's status is sent to SafeBox when it does not change. Can be set as a build flag.
+#define STATUS_SYNC_HEARTBEAT_MS 1000
+#endif
+/// @brief SafeBox's status is no longer considered synced when nothing told it for this long.
+#define STATUS_SYNC_MAX_AGE_MS (STATUS_SYNC_HEARTBEAT_MS * 3)
 
-#define COMMAND_LID_OPEN  "C_LID_O"
-#define COMMAND_LID_CLOSE "C_LID_C"
-#define COMMAND_LID_GET "C_LID_G"
-#define COMMAND_GARAGE_OPEN   "C_GAR_O"
-#define COMMAND_GARAGE_CLOSE  "C_GAR_C"
-#define COMMAND_GARAGE_GET  "C_GAR_G"
-#define COMMAND_DOORBELL_GET  "C_DRB_G"
-#define COMMAND_GET_PACKAGE_COUNT "C_PCK_G"
-#define COMMAND_CHECK_PACKAGE     "C_PCK_C"
-#define COMMAND_STATUS_EXCHANGE   "C_STE_"
+/// @brief Opcodes of the frames exchanged with SafeBox. Commands are sent by XFactor and answered by SafeBox. MUST match SafeBox's.
+#define COMMAND_LID_OPEN          0x01
+#define COMMAND_LID_CLOSE         0x02
+#define COMMAND_LID_GET           0x03
+#define COMMAND_GARAGE_OPEN       0x04
+#define COMMAND_GARAGE_CLOSE      0x05
+#define COMMAND_GARAGE_GET        0x06
+#define COMMAND_DOORBELL_GET      0x07
+#define COMMAND_GET_PACKAGE_COUNT 0x08
+#define COMMAND_CHECK_PACKAGE     0x09
+/// @brief Payload is the status code of XFactor followed by its clock. See the STATUS_EXCHANGE_PAYLOAD_ defines.
+#define COMMAND_STATUS_EXCHANGE   0x0A
+/// @brief Payload is the status code of XFactor. Answered with @ref ANSWER_SNAPSHOT
+#define COMMAND_SNAPSHOT          0x0B
+/// @brief Answered with @ref ANSWER_LINK_STATS
+#define COMMAND_LINK_STATS        0x0C
+/// @brief Payload is SafeBox's millis() at which its garage must be open. See @ref ClockSync_EncodeTime. Answered with @ref ANSWER_GARAGE_SUCCESS or @ref ANSWER_GARAGE_FAILED
+#define COMMAND_GARAGE_OPEN_AT    0x0D
 
-#define ANSWER_LID_OPEN      "A_LID_O"
-#define ANSWER_LID_CLOSED    "A_LID_C"
-#define ANSWER_LID_SUCCESS   "A_LID_S"
-#define ANSWER_LID_FAILED    "A_LID_S"
+#define ANSWER_LID_OPEN      0x81
+#define ANSWER_LID_CLOSED    0x82
+#define ANSWER_LID_SUCCESS   0x83
+#define ANSWER_LID_FAILED    0x84
 
-#define ANSWER_GARAGE_OPEN      "A_GAR_O"
-#define ANSWER_GARAGE_CLOSED    "A_GAR_C"
-#define ANSWER_GARAGE_SUCCESS   "A_GAR_S"
-#define ANSWER_GARAGE_FAILED    "A_GAR_S"
+#define ANSWER_GARAGE_OPEN      0x85
+#define ANSWER_GARAGE_CLOSED    0x86
+#define ANSWER_GARAGE_SUCCESS   0x87
+#define ANSWER_GARAGE_FAILED    0x88
 
-#define ANSWER_DOORBELL_RANG     "A_DRB_R"
-#define ANSWER_DOORBELL_NOT_RANG "A_DRB_N"
+#define ANSWER_DOORBELL_RANG     0x89
+#define ANSWER_DOORBELL_NOT_RANG 0x8A
 
-#define ANSWER_PACKAGE_COUNT         "A_PCK_C"
-#define ANSWER_PACKAGE_CHECK_SUCCESS "A_PCK_S"
-#define ANSWER_PACKAGE_CHECK_FAILED  "A_PCK_F"
+/// @brief Payload is the amount of packages inside of SafeBox.
+#define ANSWER_PACKAGE_COUNT         0x8B
+#define ANSWER_PACKAGE_CHECK_SUCCESS 0x8C
+#define ANSWER_PACKAGE_CHECK_FAILED  0x8D
 
-#define ANSWER_STATUS_EXCHANGE       "A_STE_"
+/// @brief Payload is the status code of SafeBox followed by the clocks. See the STATUS_EXCHANGE_PAYLOAD_ defines.
+#define ANSWER_STATUS_EXCHANGE       0x8E
+/// @brief Index in a status exchange's payload of the millis() of XFactor when it sent the command. The answer carries it back. See @ref ClockSync_EncodeTime
+#define STATUS_EXCHANGE_PAYLOAD_TIME      1
+/// @brief Index in a status exchange command's payload of XFactor's estimate of SafeBox's clock minus its own. See @ref ClockSync_GetOffset
+#define STATUS_EXCHANGE_PAYLOAD_OFFSET    5
+/// @brief Index in a status exchange command's payload of the accuracy of the offset. 2 bytes.
+#define STATUS_EXCHANGE_PAYLOAD_ACCURACY  9
+/// @brief Index in a status exchange command's payload of the number of the last ring XFactor got. Acknowledges @ref EVENT_DOORBELL_RANG
+#define STATUS_EXCHANGE_PAYLOAD_DOORBELL_RING 11
+/// @brief Index in a status exchange command's payload of XFactor's session. Changes each time XFactor boots. See @ref BT_InitRequests
+#define STATUS_EXCHANGE_PAYLOAD_SESSION   12
+/// @brief How long a status exchange command with timestamps is.
+#define STATUS_EXCHANGE_COMMAND_LENGTH    13
+/// @brief Index in a status exchange answer's payload of the millis() of SafeBox when it answered.
+#define STATUS_EXCHANGE_PAYLOAD_PEER_TIME 5
+/// @brief How long a status exchange answer with timestamps is.
+#define STATUS_EXCHANGE_ANSWER_LENGTH     9
+
+/// @brief Everything XFactor needs to know about SafeBox in one answer. See the SNAPSHOT_PAYLOAD_ defines.
+#define ANSWER_SNAPSHOT              0x8F
+/// @brief Index in a snapshot's payload of the garage state. 1 is opened.
+#define SNAPSHOT_PAYLOAD_GARAGE   0
+/// @brief Index in a snapshot's payload of the lid state. 1 is opened.
+#define SNAPSHOT_PAYLOAD_LID      1
+/// @brief Index in a snapshot's payload of the doorbell latch. 1 is rang.
+#define SNAPSHOT_PAYLOAD_DOORBELL 2
+/// @brief Index in a snapshot's payload of how many packages are inside of SafeBox.
+#define SNAPSHOT_PAYLOAD_PACKAGES 3
+/// @brief Index in a snapshot's payload of SafeBox's status code.
+#define SNAPSHOT_PAYLOAD_STATUS   4
+
+/// @brief Payload is SafeBox's Bluetooth statistics. See @ref BT_EncodeStats
+#define ANSWER_LINK_STATS            0x90
+/// @brief Sent instead of an answer when SafeBox does not know the command. Payload is the command's opcode.
+#define ANSWER_UNKNOWN_COMMAND       0x91
+/// @brief Sent instead of an answer when SafeBox failed to execute the command. Payload is the command's opcode.
+#define ANSWER_COMMAND_FAILED        0x92
+
+/// @brief Sent by SafeBox without being asked when its doorbell starts ringing. Payload is the ring's number. Repeated until a status exchange acknowledges it.
+#define EVENT_DOORBELL_RANG   0xC0
+/// @brief Sent by SafeBox without being asked when it enters its alarm.
+#define EVENT_ALARM_STARTED   0xC1
+/// @brief Sent by SafeBox without being asked when its lid opens or closes. Payload is 1 if opened.
+#define EVENT_LID_CHANGED     0xC2
+/// @brief Sent by SafeBox without being asked when its status changes and every STATUS_SYNC_HEARTBEAT_MS. Payload is its status code.
+#define EVENT_STATUS_CHANGED  0xC3
+
+// #pragma region [Asynchronous_Commands]
+
+/**
+ * @brief
+ * Submits a command to be sent to SafeBox
+ * without waiting after its answer. Poll the
+ * returned handle with @ref SafeBox_PollCommand
+ * from loop while the program keeps running.
+ *
+ * @param command
+ * One of the COMMAND_ defines.
+ * @return unsigned char:
+ * Handle of the command or
+ * @ref BT_INVALID_REQUEST on failure.
+ */
+unsigned char SafeBox_SubmitCommand(unsigned char command);
+
+/**
+ * @brief
+ * Submits a status exchange built from
+ * XFactor's current status without waiting
+ * after SafeBox's answer. It also carries the
+ * clocks so that @ref ClockSync_SaveSample is
+ * fed by the answer.
+ * @return unsigned char:
+ * Handle of the command or
+ * @ref BT_INVALID_REQUEST on failure.
+ */
+unsigned char SafeBox_SubmitStatusExchange();
+
+/**
+ * @brief
+ * Submits a snapshot request carrying XFactor's
+ * current status without waiting after SafeBox's
+ * answer. Once answered, the getters read
+ * SafeBox's status, garage, lid, doorbell and
+ * packages from it.
+ * @return unsigned char:
+ * Handle of the command or
+ * @ref BT_INVALID_REQUEST on failure.
+ */
+unsigned char SafeBox_SubmitSnapshot();
+
+/**
+ * @brief
+ * Checks if a submitted command is done. Once it
+ * is, its answer is parsed so that the getters
+ * and SafeBox's status are updated, and the
+ * handle is released. A command that SafeBox
+ * did not know or failed to execute is
+ * @ref BT_RequestState::Failed
+ *
+ * @warning
+ * Stop polling a handle once this returns
+ * something other than
+ * @ref BT_RequestState::Queued or
+ * @ref BT_RequestState::WaitingForAnswer.
+ *
+ * @param handle
+ * Handle returned by @ref SafeBox_SubmitCommand
+ * @param answer
+ * Optional frame in which the answer is copied
+ * when the command completes. Can be 0.
+ * @return BT_RequestState:
+ * Current state of the command.
+ */
+BT_RequestState SafeBox_PollCommand(unsigned char handle, Protocol_Frame* answer);
+
+/**
+ * @brief
+ * Blocks until a submitted command is done and
+ * returns its final state. This is what the
+ * blocking functions below are built on.
+ *
+ * @param handle
+ * Handle returned by @ref SafeBox_SubmitCommand
+ * @param answer
+ * Optional frame in which the answer is copied
+ * when the command completes. Can be 0.
+ * @return BT_RequestState:
+ * Final state of the command.
+ */
+BT_RequestState SafeBox_WaitForCommand(unsigned char handle, Protocol_Frame* answer);
+
+// #pragma endregion
+
+// #pragma region [Snapshot]
+
+/**
+ * @brief
+ * Tells if the last snapshot of SafeBox can
+ * still be used instead of asking SafeBox again.
+ * It is recent if it was received less than
+ * @ref SNAPSHOT_MAX_AGE_MS ago and XFactor's
+ * status did not change since it was sent.
+ * @return true:
+ * The getters can read from memory.
+ * @return false:
+ * A new snapshot must be asked.
+ */
+bool SafeBox_SnapshotIsRecent();
+
+/**
+ * @brief
+ * Asks SafeBox for everything XFactor needs to
+ * know about it in a single round trip. XFactor's
+ * status is exchanged at the same time.
+ * @return true:
+ * Successfully received a snapshot.
+ * @return false:
+ * Failed to receive a snapshot.
+ */
+bool SafeBox_RefreshSnapshot();
+
+/**
+ * @brief
+ * Saves what an event sent by SafeBox tells
+ * about it so that the getters return it right
+ * away. A rang doorbell is remembered until
+ * @ref SafeBox_GetDoorBellStatus returns it.
+ * Repetitions of the same ring are ignored.
+ * @param event
+ * The event frame received from SafeBox.
+ * @return true:
+ * The event was saved.
+ * @return false:
+ * Unknown event.
+ */
+bool SafeBox_SaveReceivedEvent(const Protocol_Frame* event);
+
+// #pragma endregion
+
+// #pragma region [Status_Sync]
+
+/**
+ * @brief
+ * Sends XFactor's status to SafeBox when
+ * @ref XFactor_SetNewStatus changed it or when
+ * @ref STATUS_SYNC_HEARTBEAT_MS went by since it
+ * was last sent. SafeBox's answer updates
+ * @ref SafeBox_GetStatus. This never blocks.
+ *
+ * @attention
+ * This must be called periodically from loop.
+ */
+void SafeBox_UpdateStatusSync();
+
+/**
+ * @brief
+ * Tells if the status of SafeBox saved in
+ * memory can be trusted. It is synced if SafeBox
+ * acknowledged XFactor's current status and told
+ * its own less than
+ * @ref STATUS_SYNC_MAX_AGE_MS ago.
+ * @return true:
+ * @ref SafeBox_GetStatus is up to date.
+ * @return false:
+ * The statuses are not synced yet.
+ */
+bool SafeBox_StatusIsSynced();
+
+// #pragma endregion
 
 // #pragma region [Command_Requests]
 
@@ -98,12 +328,59 @@ bool SafeBox_ChangeLidState(bool wantedState);
  */
 bool SafeBox_ChangeGarageState(bool wantedState);
 
+/**
+ * @brief Asks SafeBox to have its garage open
+ * when XFactor arrives instead of waiting for
+ * XFactor to be in front of it. SafeBox starts
+ * opening it early enough for its servo to be
+ * done by then.
+ *
+ * @param arrivalTime_ms
+ * XFactor's millis() at which it expects to be
+ * in front of the garage.
+ * @return true:
+ * SafeBox scheduled the opening.
+ * @return false:
+ * The clocks are not synced or SafeBox did not
+ * acknowledge it.
+ */
+bool SafeBox_ScheduleGarageOpening(unsigned long arrivalTime_ms);
+
+/**
+ * @brief Tells if the garage opening scheduled
+ * with @ref SafeBox_ScheduleGarageOpening is
+ * done. SafeBox should have opened the garage
+ * by now. Confirm it with
+ * @ref SafeBox_GetGarageState before driving in.
+ * @return true:
+ * The garage should be open.
+ * @return false:
+ * No opening was scheduled or it is not done
+ * yet.
+ */
+bool SafeBox_GarageOpeningIsDone();
+
+/**
+ * @brief Tells if a garage opening scheduled
+ * with @ref SafeBox_ScheduleGarageOpening is
+ * still to come. Asking SafeBox to open the
+ * garage is then not needed.
+ * @return true:
+ * SafeBox has not opened the garage yet.
+ * @return false:
+ * No opening was scheduled or it is done.
+ */
+bool SafeBox_GarageOpeningIsPending();
+
 /**
  * @brief Asks SafeBox to identify if a package
  * was recently deposited inside of it. The
  * returned parameter tells if a package was
  * deposited or not.
  *
+ * @note
+ * Read from the last snapshot of SafeBox while
+ * it is recent. See @ref SafeBox_SnapshotIsRecent
  * @return true:
  * A package was successfully deposited inside.
  * @return false:
@@ -112,24 +389,25 @@ bool SafeBox_ChangeGarageState(bool wantedState);
 bool SafeBox_CheckIfPackageDeposited();
 
 /**
- * @brief Asks SafeBox to return its current
- * status. This is used when an alarm is
- * detected for example and allows both SafeBox
- * and XFactor to exchange their current status at
- * any time. Use Status functions to set and
- * compare their status. This one is only used to
- * exchange the status.
- *
- * @attention
- * This function needs to be called at roughly
- * periodic intervals or whenever a significant
- * event happens. XFactor is the one to initiate
- * this handshake, not SafeBox.
+ * @brief Makes sure that SafeBox and XFactor
+ * know each other's current status. This is used
+ * when an alarm is detected for example. Use
+ * Status functions to set and compare their
+ * status. This one is only used to exchange the
+ * status.
  *
+ * @note
+ * The status are kept synced by
+ * @ref SafeBox_UpdateStatusSync, which the
+ * communication task calls. This never blocks.
+ * It only tells if the status saved in memory
+ * can be used. Call it again on the next pass
+ * if it cannot. See @ref SafeBox_StatusIsSynced
  * @return true:
- * Successfully exchanged the status.
+ * The status are exchanged.
  * @return false:
- * Failed to exchange the status.
+ * The sync is not done yet or SafeBox went
+ * quiet.
  */
 bool SafeBox_ExchangeStatus();
 
@@ -139,6 +417,9 @@ bool SafeBox_ExchangeStatus();
 /**
  * @brief Asks SafeBox to give XFactor its
  * current package lid state.
+ * @note
+ * Read from the last snapshot of SafeBox while
+ * it is recent. See @ref SafeBox_SnapshotIsRecent
  * @return true: The lid is opened
  * @return false: The lid is closed
  */
@@ -147,6 +428,9 @@ bool SafeBox_GetLidState();
 /**
  * @brief Asks SafeBox to give XFactor its
  * current garage status.
+ * @note
+ * Read from the last snapshot of SafeBox while
+ * it is recent. See @ref SafeBox_SnapshotIsRecent
  * @return true: The garage is opened
  * @return false: The garage is closed
  */
@@ -155,6 +439,9 @@ bool SafeBox_GetGarageState();
 /**
  * @brief Asks SafeBox to tell XFactor how many
  * packages are currently deposited inside of it
+ * @note
+ * Read from the last snapshot of SafeBox while
+ * it is recent. See @ref SafeBox_SnapshotIsRecent
  * @return int: How many packages are currently
  * deposited.
  */
@@ -165,9 +452,29 @@ int SafeBox_GetPackagesDeposited();
  * current Doorbell status. This allowed it to
  * know if it should start the package retrieval
  * or not.
+ * @note
+ * SafeBox sends @ref EVENT_DOORBELL_RANG when it
+ * rings, so this does not ask SafeBox. It reads
+ * the last snapshot otherwise.
  * @return true: The doorbell was activated.
  * @return false: The doorbell wasn't activated.
  */
 bool SafeBox_GetDoorBellStatus();
 
-// #pragma endregion
\ No newline at end of file
+// #pragma endregion
+
+// #pragma region [Statistics]
+
+/**
+ * @brief
+ * Prints XFactor's Bluetooth statistics on the
+ * debug serial port, then asks SafeBox for its
+ * own and prints them too.
+ * @return true:
+ * Both statistics were printed.
+ * @return false:
+ * SafeBox did not send its statistics.
+ */
+bool SafeBox_PrintLinkStats();
+
+// #pragma endregion
@@ -5,6 +5,12 @@
  * File containing the definition of functions
  * and defines used to linearly test
  * communications between SafeBox and XFactor
+ *
+ * @note
+ * Build with COMMUNICATION_SELF_TEST for
+ * @ref Execute_CurrentFunction to run the
+ * self-test instead of XFactor's actions.
+ * SafeBox must be built with it too.
  * @version 0.1
  * @date 2023-11-16
  * @copyright Copyright (c) 2023
@@ -19,14 +25,97 @@
 #include "XFactor/Status.hpp"
 
 // - DEFINES - //
+#ifndef SELF_TEST_BENCHMARK_EXCHANGES
+/// @brief How many status exchanges the benchmark of @ref TestGoodCommunications times. Can be set as a build flag.
+#define SELF_TEST_BENCHMARK_EXCHANGES 200
+#endif
+/// @brief Round trips are counted per millisecond up to this many. Slower ones all land in the last slot.
+#define SELF_TEST_ROUND_TRIP_SLOTS 128
 
 // - FUNCTIONS - //
 
 /**
  * @brief
  * Call this in main.cpp to test communications
- * between XFactor and SafeBox.
+ * between XFactor and SafeBox. Exchanges every
+ * status code, sends every command once and
+ * then times @ref SELF_TEST_BENCHMARK_EXCHANGES
+ * status exchanges. The round trip min, average
+ * and p99, the exchanges per second and the
+ * error counts are then reported along with the
+ * link statistics of both devices. Runs once.
  */
 void TestGoodCommunications();
+
+/**
+ * @brief
+ * Exchanges one of XFactor's status with
+ * SafeBox and checks that SafeBox answered with
+ * a valid status of its own.
+ * @param testNumber
+ * Number printed if the test fails.
+ * @param status
+ * The status sent to SafeBox.
+ * @return true:
+ * SafeBox answered with a valid status.
+ * @return false:
+ * No answer or an invalid one was received.
+ */
 bool TestOneStatus(int testNumber, XFactor_Status status);
-void TestAllStatusCommunications();
\ No newline at end of file
+
+/**
+ * @brief
+ * Calls @ref TestOneStatus with every valid
+ * @ref XFactor_Status
+ */
+void TestAllStatusCommunications();
+
+/**
+ * @brief
+ * Tells if @ref TestGoodCommunications is done
+ * and printed its results.
+ * @return true:
+ * The getters below return the final results.
+ */
+bool SelfTestIsDone();
+
+/**
+ * @brief
+ * Returns how many commands and status
+ * exchanges were answered during the self-test.
+ */
+unsigned long GetSelfTestRoundTrips();
+
+/**
+ * @brief
+ * Gets the round trip that 99% of the measured
+ * ones did not exceed.
+ * @return unsigned long:
+ * p99 in milliseconds. Saturates at
+ * @ref SELF_TEST_ROUND_TRIP_SLOTS minus 1.
+ */
+unsigned long GetSelfTestRoundTripP99();
+
+/**
+ * @brief
+ * Returns how many commands and status
+ * exchanges were not answered or answered with
+ * something invalid.
+ */
+unsigned long GetSelfTestErrors();
+
+/**
+ * @brief
+ * Returns how many of the benchmark's status
+ * exchanges were done per second.
+ * @return float:
+ * 0 until the benchmark is done.
+ */
+float GetSelfTestExchangesPerSecond();
+
+/**
+ * @brief
+ * Returns how many different status codes
+ * SafeBox answered with during the self-test.
+ */
+unsigned int GetSelfTestReceivedStatus();
@@ -0,0 +1,89 @@
+/**
+ * @file Coroutine.hpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Header file containing stackless coroutines
+ * in the style of protothreads. A coroutine is
+ * a function that executes a sequence of steps
+ * across several calls. It returns in between
+ * steps instead of waiting so that the
+ * scheduler keeps running the other tasks and
+ * resumes where it left off on its next call.
+ *
+ * @attention
+ * Local variables are lost each time a
+ * coroutine returns. Anything that must be kept
+ * in between steps has to be static or global.
+ * A coroutine cannot wait from inside a switch
+ * of its own and can only wait once per line.
+ * @version 0.1
+ * @date 2023-12-06
+ * @copyright Copyright (c) 2023
+ */
+
+#pragma once
+
+// - INCLUDES - //
+#include "Arduino.h"
+
+// - DEFINES - //
+/// @brief Returned by a coroutine that has steps left to execute.
+#define COROUTINE_RUNNING 0
+/// @brief Returned by a coroutine that executed all of its steps.
+#define COROUTINE_SUCCEEDED 1
+/// @brief Returned by a coroutine that stopped before executing all of its steps.
+#define COROUTINE_FAILED 2
+
+/**
+ * @brief
+ * Where a coroutine resumes on its next call.
+ * Must be static or global and reset with
+ * @ref COROUTINE_RESET to start over.
+ */
+typedef struct
+{
+    /// @brief Line of the step to resume at. 0 is the start of the coroutine.
+    unsigned short line;
+    /// @brief millis() at which the current @ref COROUTINE_SLEEP started.
+    unsigned long sleepStart_ms;
+    unsigned long sleepDuration_ms;
+} Coroutine;
+
+/// @brief Makes the coroutine start from its first step on its next call.
+#define COROUTINE_RESET(coroutine) do { (coroutine)->line = 0; } while(0)
+
+/// @brief Starts the steps of a coroutine. Must be followed by @ref COROUTINE_END
+#define COROUTINE_BEGIN(coroutine) switch((coroutine)->line) { case 0:
+
+/// @brief Ends the steps of a coroutine. It then starts over and returns @ref COROUTINE_SUCCEEDED
+#define COROUTINE_END(coroutine) } (coroutine)->line = 0; return COROUTINE_SUCCEEDED
+
+/// @brief Returns @ref COROUTINE_RUNNING and resumes after this on the next call.
+#define COROUTINE_YIELD(coroutine)                  \
+    do {                                            \
+        (coroutine)->line = __LINE__;               \
+        return COROUTINE_RUNNING;                   \
+        case __LINE__:;                             \
+    } while(0)
+
+/// @brief Returns @ref COROUTINE_RUNNING on each call until the condition is true.
+#define COROUTINE_WAIT_UNTIL(coroutine, condition)  \
+    do {                                            \
+        (coroutine)->line = __LINE__;               \
+        case __LINE__:                              \
+        if(!(condition)) return COROUTINE_RUNNING;  \
+    } while(0)
+
+/// @brief Returns @ref COROUTINE_RUNNING on each call until the specified milliseconds have passed.
+#define COROUTINE_SLEEP(coroutine, milliseconds)                                                        \
+    do {                                                                                                \
+        (coroutine)->sleepStart_ms = millis();                                                          \
+        (coroutine)->sleepDuration_ms = (milliseconds);                                                 \
+        COROUTINE_WAIT_UNTIL(coroutine, millis() - (coroutine)->sleepStart_ms >= (coroutine)->sleepDuration_ms); \
+    } while(0)
+
+/// @brief Stops the coroutine. It then starts over and returns @ref COROUTINE_FAILED
+#define COROUTINE_FAIL(coroutine) do { (coroutine)->line = 0; return COROUTINE_FAILED; } while(0)
+
+/// @brief Stops the coroutine early. It then starts over and returns @ref COROUTINE_SUCCEEDED
+#define COROUTINE_SUCCEED(coroutine) do { (coroutine)->line = 0; return COROUTINE_SUCCEEDED; } while(0)
@@ -0,0 +1,155 @@
+/**
+ * @file Scheduler.hpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * Header file containing the definitions of the
+ * cooperative scheduler that runs XFactor's
+ * periodic tasks. Tasks are plain functions
+ * registered with a period and a time budget.
+ * They run to completion in the order they were
+ * registered. Code that has to wait, such as a
+ * movement, calls @ref Scheduler_Yield so that
+ * the other tasks keep running meanwhile.
+ * @version 0.1
+ * @date 2023-12-04
+ * @copyright Copyright (c) 2023
+ */
+
+#pragma once
+
+// - INCLUDES - //
+#include "Arduino.h"
+#include "Debug/Debug.hpp"
+
+// - DEFINES - //
+/// @brief How many tasks can be registered.
+#define SCHEDULER_MAX_TASKS 8
+/// @brief Returned by @ref Scheduler_AddTask when the task could not be registered.
+#define SCHEDULER_INVALID_TASK 255
+/// @brief Period of tasks that run each time the scheduler runs.
+#define SCHEDULER_EVERY_PASS 0
+/// @brief Budget of tasks whose run time is not checked. Used by tasks that yield.
+#define SCHEDULER_NO_BUDGET 0
+
+/// @brief Function executed by a task. It must return as soon as its work is done.
+typedef void (*Scheduler_TaskFunction)();
+
+/**
+ * @brief
+ * A registered task along with the statistics
+ * of its runs since it was registered or since
+ * @ref Scheduler_ResetStats
+ */
+typedef struct
+{
+    /// @brief Printed by @ref Scheduler_PrintStats
+    const char* name;
+    Scheduler_TaskFunction function;
+    /// @brief Time in between the start of two runs or @ref SCHEDULER_EVERY_PASS
+    unsigned long period_us;
+    /// @brief Runs that take longer than this are overruns. @ref SCHEDULER_NO_BUDGET disables the check.
+    unsigned long budget_us;
+    /// @brief micros() at which the task is due.
+    unsigned long due_us;
+    /// @brief Set while the task runs so that it is not run again from @ref Scheduler_Yield
+    bool isRunning;
+    unsigned long runs;
+    /// @brief Runs that took longer than the budget.
+    unsigned long overruns;
+    /// @brief Periods that were skipped entirely because the task started a whole period late.
+    unsigned long missedPeriods;
+    /// @brief Longest delay in between when the task was due and when it started.
+    unsigned long maxJitter_us;
+    /// @brief Sum of those delays. Divide by runs for the average.
+    unsigned long totalJitter_us;
+    /// @brief Longest run of the task.
+    unsigned long maxDuration_us;
+} Scheduler_Task;
+
+// - FUNCTIONS - //
+
+/**
+ * @brief
+ * Registers a new task. Tasks run in the order
+ * they are registered, which makes the first
+ * ones the most important. Periodic tasks are
+ * first due one period after being registered.
+ * @param name
+ * Name of the task printed in its statistics.
+ * @param function
+ * Function executed each time the task runs.
+ * @param period_us
+ * Time in microseconds in between the start of
+ * two runs or @ref SCHEDULER_EVERY_PASS
+ * @param budget_us
+ * Longest that a run should take or
+ * @ref SCHEDULER_NO_BUDGET
+ * @return unsigned char:
+ * ID of the task or @ref SCHEDULER_INVALID_TASK
+ * if the table is full.
+ */
+unsigned char Scheduler_AddTask(const char* name, Scheduler_TaskFunction function, unsigned long period_us, unsigned long budget_us);
+
+/**
+ * @brief
+ * Runs each task that is due once, in the order
+ * they were registered. A late periodic task
+ * runs once and then catches up on its period
+ * instead of running for each missed period.
+ *
+ * @attention
+ * This must be called from loop.
+ */
+void Scheduler_Run();
+
+/**
+ * @brief
+ * Lets the tasks that are due run while the
+ * calling task waits. Tasks that are already
+ * running, such as the caller, are skipped.
+ * Call this in every loop that waits after
+ * something.
+ */
+void Scheduler_Yield();
+
+/**
+ * @brief
+ * Waits for the specified time while letting
+ * the other tasks run. Replaces delay() in
+ * tasks.
+ * @param milliseconds
+ * How long to wait.
+ */
+void Scheduler_Delay(unsigned long milliseconds);
+
+/**
+ * @brief
+ * Returns a registered task and its statistics.
+ * @param taskID
+ * ID returned by @ref Scheduler_AddTask
+ * @return const Scheduler_Task*:
+ * The task or 0 if the ID is not valid.
+ */
+const Scheduler_Task* Scheduler_GetTask(unsigned char taskID);
+
+/**
+ * @brief
+ * Returns how many tasks are registered. Their
+ * IDs go from 0 to this minus 1.
+ * @return unsigned char:
+ * Number of registered tasks.
+ */
+unsigned char Scheduler_GetTaskCount();
+
+/**
+ * @brief
+ * Clears the statistics of every task.
+ */
+void Scheduler_ResetStats();
+
+/**
+ * @brief
+ * Prints the runs, overruns, missed periods,
+ * jitter and longest run of every task.
+ */
+void Scheduler_PrintStats();
@@ -30,98 +30,296 @@
  */
 static unsigned char currentFunctionID = 0;
 
-//#pragma region [ACTION_HANDLERS]
+/// @brief Function whose onEnter was last executed by @ref RunCurrentFunction
+static unsigned char enteredFunctionID = FUNCTION_ID_NONE;
+static unsigned long transitionCount = 0;
+
+/// @brief Where the sequences of the execution functions resume. Reset by their onEnter.
+static Coroutine searchForPackageCoroutine;
+static Coroutine pickUpPackageCoroutine;
+static Coroutine packageDropOffCoroutine;
+/// @brief Kept in between the steps of the sequences.
+static int searchVectorIndex = 0;
+static int pickUpAttempt = 1;
+
+//#pragma region [STATE_HOOKS]
 /**
- * @brief Function periodically called in void
- * loop. This function is a massive switch case
- * that checks which execution / action function
- * should currently be executed by XFactor. To
- * specify that function, use
- * @ref SetNewExecutionFunction using defines
- * available in this header file.
-*/
-void Execute_CurrentFunction(){
-    switch(currentFunctionID){
+ * @brief Entry work of each execution function.
+ * Executed once when XFactor enters the function
+ * instead of on every execution.
+ */
+void Enter_WaitAfterSafeBox()
+{
+  ExecutionUtils_HandleFirstExecution(XFactor_Status::WaitingAfterSafeBox);
+  LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_WAITING_FOR_COMMS);
+}
+
+void Enter_WaitForDelivery()
+{
+  ExecutionUtils_HandleFirstExecution(XFactor_Status::WaitingForDelivery);
+  ExecutionUtils_ForceAStatusExchange();
+  LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_WAITFORDELIVERY);
+}
+
+void Enter_GettingOutOfGarage()
+{
+  ExecutionUtils_HandleFirstExecution(XFactor_Status::LeavingSafeBox);
+  ExecutionUtils_ForceAStatusExchange();
+  LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_ARMED);
+}
+
+void Enter_SearchPreparations()
+{
+  ExecutionUtils_HandleFirstExecution(XFactor_Status::PreparingForTheSearch);
+  ResetVectors();
+  ExecutionUtils_ForceAStatusExchange();
+  LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_ARMED);
+}
+
+void Enter_SearchForPackage()
+{
+  ExecutionUtils_HandleFirstExecution(XFactor_Status::SearchingForAPackage);
+  COROUTINE_RESET(&searchForPackageCoroutine);
+  ExecutionUtils_ForceAStatusExchange();
+  LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_ARMED);
+}
+
+void Enter_ExamineFoundPackage()
+{
+  ExecutionUtils_HandleFirstExecution(XFactor_Status::ExaminatingAPackage);
+  ExecutionUtils_ForceAStatusExchange();
+  LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_ARMED);
+}
+
+void Enter_PickUpPackage()
+{
+  ExecutionUtils_HandleFirstExecution(XFactor_Status::PickingUpAPackage);
+  COROUTINE_RESET(&pickUpPackageCoroutine);
+  Package_CancelPickUp();
+  ExecutionUtils_ForceAStatusExchange();
+  LEDS_SetColor(LED_ID_STATUS_INDICATOR, 32, 32, 128);
+}
+
+void Enter_ReturnHome()
+{
+  ExecutionUtils_HandleFirstExecution(XFactor_Status::ReturningHome);
+  ExecutionUtils_ForceAStatusExchange();
+  LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_ARMED);
+}
 
-        case(FUNCTION_ID_ALARM):
-            Execute_Alarm();
-            break;
+void Enter_PreparingForDropOff()
+{
+  ExecutionUtils_HandleFirstExecution(XFactor_Status::PreparingForDropOff);
+  ResetVectors();
+  ResetMovements();
+  ExecutionUtils_ForceAStatusExchange();
+  LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_ARMED);
+}
+
+void Enter_PackageDropOff()
+{
+  ExecutionUtils_HandleFirstExecution(XFactor_Status::DroppingOff);
+  COROUTINE_RESET(&packageDropOffCoroutine);
+  LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_ARMED);
+  ExecutionUtils_ForceAStatusExchange();
+}
+
+void Enter_ConfirmDropOff()
+{
+  ExecutionUtils_HandleFirstExecution(XFactor_Status::ConfirmingDropOff);
+  ExecutionUtils_ForceAStatusExchange();
+  LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_ARMED);
+}
+
+void Enter_Alarm()
+{
+  XFactor_SetNewStatus(XFactor_Status::Alarm);
+  Stop();
+}
+
+void Exit_Alarm()
+{
+  AX_BuzzerOFF();
+}
 
-        case(FUNCTION_ID_AVOID_OBSTACLE):
-            Execute_AvoidObstacle();
-            break;
+void Enter_Error()
+{
+  Debug_Warning("Actions", "Execute_Error", "ERROR REACHED. DEBUG STOPPED");
+  Debug_Stop();
+  Stop();
+  XFactor_SetNewStatus(XFactor_Status::Error);
+}
 
-        case(FUNCTION_ID_CONFIRM_DROP_OFF):
-            Execute_ConfirmDropOff();
-            break;
+void Enter_ReturnInsideGarage()
+{
+  XFactor_SetNewStatus(XFactor_Status::EnteringSafeBox);
+}
 
-        case(FUNCTION_ID_END_OF_PROGRAM):
-            Execute_EndOfProgram();
-            break;
+void Enter_EndOfProgram()
+{
+  LEDS_SetColor(LED_ID_STATUS_INDICATOR, 16, 32, 64);
+}
 
-        case(FUNCTION_ID_ERROR):
-            Execute_Error();
-            break;
+void Enter_Unlocked()
+{
+  XFactor_SetNewStatus(XFactor_Status::Unlocked);
+  LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_DISARMED);
+  Stop();
+  Package_Release();
+  Package_StoreClaw();
+}
+
+/// @brief Functions that XFactor can always go to, whatever SafeBox tells it.
+#define ACTION_TRANSITIONS_ALWAYS (ACTION_TRANSITION(FUNCTION_ID_ALARM) | ACTION_TRANSITION(FUNCTION_ID_ERROR) | ACTION_TRANSITION(FUNCTION_ID_UNLOCKED))
+/// @brief Functions that @ref ExecutionUtils_StatusCheck can return on top of the ones above.
+#define ACTION_TRANSITIONS_STATUS_CHECK (ACTION_TRANSITIONS_ALWAYS | ACTION_TRANSITION(FUNCTION_ID_WAIT_FOR_DELIVERY))
 
-        case(FUNCTION_ID_EXAMINE_FOUND_PACKAGE):
-            Execute_ExamineFoundPackage();
-            break;
+/**
+ * @brief
+ * State table of XFactor's execution functions,
+ * indexed by function ID.
+ */
+constexpr Action_State actionStates[] =
+{
+  /* FUNCTION_ID_WAIT_AFTER_SAFEBOX      */ {Enter_WaitAfterSafeBox,     Execute_WaitAfterSafeBox,          0,          ACTION_TRANSITIONS_ALWAYS},
+  /* FUNCTION_ID_WAIT_FOR_DELIVERY       */ {Enter_WaitForDelivery,      Execute_WaitForDelivery,           0,          ACTION_TRANSITIONS_STATUS_CHECK | ACTION_TRANSITION(FUNCTION_ID_GETTING_OUT_OF_GARAGE)},
+  /* FUNCTION_ID_GETTING_OUT_OF_GARAGE   */ {Enter_GettingOutOfGarage,   Execute_GettingOutOfGarage,        0,          ACTION_TRANSITIONS_STATUS_CHECK | ACTION_TRANSITION(FUNCTION_ID_SEARCH_PREPARATIONS)},
+  /* FUNCTION_ID_SEARCH_PREPARATIONS     */ {Enter_SearchPreparations,   Execute_SearchPreparations,        0,          ACTION_TRANSITIONS_STATUS_CHECK | ACTION_TRANSITION(FUNCTION_ID_SEARCH_FOR_PACKAGE)},
+  /* FUNCTION_ID_SEARCH_FOR_PACKAGE      */ {Enter_SearchForPackage,     Execute_SearchForPackage,          0,          ACTION_TRANSITIONS_STATUS_CHECK | ACTION_TRANSITION(FUNCTION_ID_EXAMINE_FOUND_PACKAGE) | ACTION_TRANSITION(FUNCTION_ID_PICK_UP_PACKAGE) | ACTION_TRANSITION(FUNCTION_ID_RETURN_HOME)},
+  /* FUNCTION_ID_AVOID_OBSTACLE          */ {0,                          Execute_AvoidObstacle,             0,          ACTION_TRANSITIONS_ALWAYS},
+  /* FUNCTION_ID_EXAMINE_FOUND_PACKAGE   */ {Enter_ExamineFoundPackage,  Execute_ExamineFoundPackage,       0,          ACTION_TRANSITIONS_ALWAYS | ACTION_TRANSITION(FUNCTION_ID_PICK_UP_PACKAGE)},
+  /* FUNCTION_ID_PICK_UP_PACKAGE         */ {Enter_PickUpPackage,        Execute_PickUpPackage,             0,          ACTION_TRANSITIONS_ALWAYS | ACTION_TRANSITION(FUNCTION_ID_RETURN_HOME)},
+  /* FUNCTION_ID_RETURN_HOME             */ {Enter_ReturnHome,           Execute_ReturnHome,                0,          ACTION_TRANSITIONS_ALWAYS | ACTION_TRANSITION(FUNCTION_ID_RETURN_INSIDE_GARAGE)},
+  /* FUNCTION_ID_PREPARING_FOR_DROP_OFF  */ {Enter_PreparingForDropOff,  Execute_PreparingForDropOff,       0,          ACTION_TRANSITIONS_ALWAYS | ACTION_TRANSITION(FUNCTION_ID_PACKAGE_DROP_OFF)},
+  /* FUNCTION_ID_PACKAGE_DROP_OFF        */ {Enter_PackageDropOff,       Execute_PackageDropOff,            0,          ACTION_TRANSITIONS_ALWAYS | ACTION_TRANSITION(FUNCTION_ID_CONFIRM_DROP_OFF)},
+  /* FUNCTION_ID_CONFIRM_DROP_OFF        */ {Enter_ConfirmDropOff,       Execute_ConfirmDropOff,            0,          ACTION_TRANSITIONS_ALWAYS | ACTION_TRANSITION(FUNCTION_ID_END_OF_PROGRAM)},
+  /* FUNCTION_ID_ALARM                   */ {Enter_Alarm,                Execute_Alarm,                     Exit_Alarm, ACTION_TRANSITIONS_STATUS_CHECK},
+  /* FUNCTION_ID_ERROR                   */ {Enter_Error,                Execute_Error,                     0,          ACTION_TRANSITION(FUNCTION_ID_ERROR)},
+  /* FUNCTION_ID_RETURN_INSIDE_GARAGE    */ {Enter_ReturnInsideGarage,   Execute_ReturnInsideGarage,        0,          ACTION_TRANSITIONS_STATUS_CHECK | ACTION_TRANSITION(FUNCTION_ID_PREPARING_FOR_DROP_OFF)},
+  /* FUNCTION_ID_END_OF_PROGRAM          */ {Enter_EndOfProgram,         Execute_EndOfProgram,              0,          ACTION_TRANSITIONS_STATUS_CHECK},
+  /* FUNCTION_ID_UNLOCKED                */ {Enter_Unlocked,             Execute_Unlocked,                  0,          ACTION_TRANSITIONS_STATUS_CHECK | ACTION_TRANSITION(FUNCTION_ID_CALIBRATE_COLOUR)},
+  /* FUNCTION_ID_CALIBRATE_COLOUR        */ {0,                          Execute_CalibratePackageDetection, 0,          ACTION_TRANSITIONS_ALWAYS},
+};
+
+/**
+ * @brief Returns the transition bit of every
+ * function ID that has an execution function,
+ * starting at the specified one.
+ */
+constexpr unsigned long UsedFunctionIDs(unsigned char functionID)
+{
+  return (functionID >= FUNCTION_ID_COUNT) ? 0 :
+         (((actionStates[functionID].onTick != 0) ? ACTION_TRANSITION(functionID) : 0) | UsedFunctionIDs(functionID + 1));
+}
 
-        case(FUNCTION_ID_GETTING_OUT_OF_GARAGE):
-            Execute_GettingOutOfGarage();
-            break;
+/**
+ * @brief Checks that the functions starting at
+ * the specified one can only go to functions
+ * that exist and can always report an error.
+ */
+constexpr bool TransitionsAreValid(unsigned char functionID)
+{
+  return (functionID >= FUNCTION_ID_COUNT) ? true :
+         (((actionStates[functionID].onTick == 0) ||
+           (((actionStates[functionID].allowedTransitions & ~UsedFunctionIDs(0)) == 0) &&
+            ((actionStates[functionID].allowedTransitions & ACTION_TRANSITION(FUNCTION_ID_ERROR)) != 0)))
+          && TransitionsAreValid(functionID + 1));
+}
 
-        case(FUNCTION_ID_PACKAGE_DROP_OFF):
-            Execute_PackageDropOff();
-            break;
+static_assert(FUNCTION_ID_COUNT <= 32, "Function IDs must fit in Action_State allowedTransitions");
+static_assert(sizeof(actionStates) / sizeof(Action_State) == FUNCTION_ID_COUNT, "actionStates needs one row per function ID");
+static_assert(TransitionsAreValid(0), "actionStates allows a transition to an unused function ID or one that cannot report an error");
+static_assert(FUNCTION_ID_COUNT <= PROFILER_SLOT_LOOP, "Every function ID needs its own profiler slot");
+//#pragma endregion
 
-        case(FUNCTION_ID_PICK_UP_PACKAGE):
-            Execute_PickUpPackage();
-            break;
+//#pragma region [TASKS]
+/**
+ * @brief Task that lets submitted SafeBox
+ * commands progress and keeps XFactor's status
+ * exchanged with SafeBox, whatever XFactor is
+ * doing.
+ */
+void UpdateCommunication()
+{
+    BT_UpdateRequests();
+    SafeBox_UpdateStatusSync();
+}
 
-        case(FUNCTION_ID_PREPARING_FOR_DROP_OFF):
-            Execute_PreparingForDropOff();
-            break;
+/**
+ * @brief Task that executes the current
+ * execution / action function. Its onExit and
+ * the new function's onEnter are executed first
+ * if the function changed since the last time.
+ */
+void RunCurrentFunction()
+{
+    // - VARIABLES - //
+    unsigned char tickedFunctionID = 0;
 
-        case(FUNCTION_ID_RETURN_HOME):
-            Execute_ReturnHome();
-            break;
+    if(enteredFunctionID != currentFunctionID)
+    {
+        if(enteredFunctionID != FUNCTION_ID_NONE && actionStates[enteredFunctionID].onExit != 0)
+        {
+            actionStates[enteredFunctionID].onExit();
+        }
 
-        case(FUNCTION_ID_RETURN_INSIDE_GARAGE):
-            Execute_ReturnInsideGarage();
-            break;
+        enteredFunctionID = currentFunctionID;
+        transitionCount++;
 
-        case(FUNCTION_ID_SEARCH_FOR_PACKAGE):
-            Execute_SearchForPackage();
-            break;
+        if(actionStates[currentFunctionID].onEnter != 0)
+        {
+            actionStates[currentFunctionID].onEnter();
+        }
 
-        case(FUNCTION_ID_CALIBRATE_COLOUR):
-            Execute_CalibratePackageDetection();
-            break;
+        // The entry work may have already set another function.
+        if(enteredFunctionID != currentFunctionID) return;
+    }
 
-        case(FUNCTION_ID_SEARCH_PREPARATIONS):
-            Execute_SearchPreparations();
-            break;
+    // The tick may set another function. Its duration belongs to this one.
+    tickedFunctionID = currentFunctionID;
 
-        case(FUNCTION_ID_UNLOCKED):
-            Execute_Unlocked();
-            break;
+    PROFILER_START();
+    actionStates[tickedFunctionID].onTick();
+    PROFILER_STOP(tickedFunctionID);
+}
+//#pragma endregion
 
-        case(FUNCTION_ID_WAIT_AFTER_SAFEBOX):
-            Execute_WaitAfterSafeBox();
-            break;
+//#pragma region [ACTION_HANDLERS]
+/**
+ * @brief Function periodically called in void
+ * loop. Registers XFactor's tasks on its first
+ * call and then runs the scheduler. The sensors
+ * and communication tasks run at fixed rates.
+ * The last task executes the current execution
+ * / action function through its row of the
+ * state table. To specify that function, use
+ * @ref SetNewExecutionFunction using defines
+ * available in this header file.
+ * Each pass of the scheduler is the loop slot
+ * of the profiler.
+*/
+void Execute_CurrentFunction(){
+#ifdef COMMUNICATION_SELF_TEST
+    // XFactor stays still while its link with SafeBox is tested.
+    TestGoodCommunications();
+    return;
+#endif
 
-        case(FUNCTION_ID_WAIT_FOR_DELIVERY):
-            Execute_WaitForDelivery();
-            break;
+    static bool firstCall = true;
 
-        default:
-            // The current function ID is not recognized.
-            // Error is executed by default.
-            Execute_Error();
-            return;
+    if(firstCall)
+    {
+        firstCall = false;
+        // Registered by priority. Actions yield while they wait, so the others keep their rates.
+        Scheduler_AddTask("Sensors", Movements_SensorStep, TASK_SENSORS_PERIOD_US, TASK_SENSORS_BUDGET_US);
+        Scheduler_AddTask("Comms", UpdateCommunication, TASK_COMMS_PERIOD_US, TASK_COMMS_BUDGET_US);
+        Scheduler_AddTask("Actions", RunCurrentFunction, SCHEDULER_EVERY_PASS, SCHEDULER_NO_BUDGET);
     }
-    // Successful execution //
+
+    PROFILER_START();
+    Scheduler_Run();
+    PROFILER_STOP(PROFILER_SLOT_LOOP);
+    PROFILER_HANDLE_COMMANDS();
 }
 
 /**
@@ -147,39 +345,28 @@ void Execute_CurrentFunction(){
  * to the new ID.
  * @return false:
  * Failed to change the execution function to the
- * new ID. May be out of range.
+ * new ID. May be out of range or not allowed
+ * from the current execution function.
  */
 bool SetNewExecutionFunction(unsigned char functionID)
 {
-    switch(currentFunctionID){
-
-        case(FUNCTION_ID_ALARM):
-        case(FUNCTION_ID_AVOID_OBSTACLE):
-        case(FUNCTION_ID_CONFIRM_DROP_OFF):
-        case(FUNCTION_ID_END_OF_PROGRAM):
-        case(FUNCTION_ID_ERROR):
-        case(FUNCTION_ID_EXAMINE_FOUND_PACKAGE):
-        case(FUNCTION_ID_GETTING_OUT_OF_GARAGE):
-        case(FUNCTION_ID_PACKAGE_DROP_OFF):
-        case(FUNCTION_ID_PICK_UP_PACKAGE):
-        case(FUNCTION_ID_PREPARING_FOR_DROP_OFF):
-        case(FUNCTION_ID_RETURN_HOME):
-        case(FUNCTION_ID_RETURN_INSIDE_GARAGE):
-        case(FUNCTION_ID_SEARCH_FOR_PACKAGE):
-        case(FUNCTION_ID_SEARCH_PREPARATIONS):
-        case(FUNCTION_ID_UNLOCKED):
-        case(FUNCTION_ID_WAIT_AFTER_SAFEBOX):
-        case(FUNCTION_ID_WAIT_FOR_DELIVERY):
-        case(FUNCTION_ID_CALIBRATE_COLOUR):
-            // The specified function is indeed a valid function ID.
-            currentFunctionID = functionID;
-            return true;
-
-        default:
-            // The current function ID is not recognized.
-            // The function ID will therefor not be set.
-            return false;
+    if(functionID >= FUNCTION_ID_COUNT || actionStates[functionID].onTick == 0)
+    {
+        // The function ID is not recognized.
+        // The function ID will therefor not be set.
+        return false;
+    }
+
+    if(functionID == currentFunctionID) return true;
+
+    if((actionStates[currentFunctionID].allowedTransitions & ACTION_TRANSITION(functionID)) == 0)
+    {
+        Debug_Error("Actions", "SetNewExecutionFunction", "Transition not allowed: " + String(currentFunctionID) + " -> " + String(functionID));
+        return false;
     }
+
+    currentFunctionID = functionID;
+    return true;
 }
 
 /**
@@ -194,6 +381,20 @@ unsigned char GetCurrentExecutionFunction()
 {
     return currentFunctionID;
 }
+
+/**
+ * @brief
+ * Function that returns how many times a new
+ * execution function was entered by
+ * @ref Execute_CurrentFunction since the start
+ * of the program.
+ * @return unsigned long:
+ * Number of transitions.
+ */
+unsigned long GetExecutionTransitionCount()
+{
+    return transitionCount;
+}
 //#pragma endregion
 
 //#pragma region [ACTION_FUNCTIONS]
@@ -216,13 +417,6 @@ unsigned char GetCurrentExecutionFunction()
 void Execute_WaitAfterSafeBox()
 {
   Debug_Start("Execute_WaitAfterSafeBox");
-  
-  // - Reset previously seen SafeBox status.
-  ExecutionUtils_HandleFirstExecution(XFactor_Status::WaitingAfterSafeBox);
-
-  // - Forces status exchange until a new one is received.
-  //ExecutionUtils_ForceAStatusExchange();
-  LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_WAITING_FOR_COMMS);
 
   // Attempt to perform a status exchange with SafeBox.
   if (SafeBox_ExchangeStatus())
@@ -262,15 +456,7 @@ void Execute_WaitForDelivery()
 {
   Debug_Start("Execute_WaitForDelivery");
 
-  // - Handling indicators and previous executions
-  ExecutionUtils_HandleFirstExecution(XFactor_Status::WaitingForDelivery);
-
-  // - Forces status exchange until a new one is received.
-  ExecutionUtils_ForceAStatusExchange();
-  LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_WAITFORDELIVERY);
-
   // - Perform status exchange with SafeBox
-  SafeBox_ExchangeStatus();
   int checkFunctionId = ExecutionUtils_StatusCheck(FUNCTION_ID_WAIT_FOR_DELIVERY);
   if (checkFunctionId != FUNCTION_ID_WAIT_FOR_DELIVERY)
   {
@@ -313,15 +499,8 @@ void Execute_WaitForDelivery()
 void Execute_GettingOutOfGarage()
 {
   int movementStatus;
-  // - First execution handling.
-  ExecutionUtils_HandleFirstExecution(XFactor_Status::LeavingSafeBox);
-
-  // - Forces status exchange until a new one is received.
-  ExecutionUtils_ForceAStatusExchange();
-  LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_ARMED);
 
   // - Perform status exchange with SafeBox
-  SafeBox_ExchangeStatus();
   int checkFunctionId = ExecutionUtils_StatusCheck(FUNCTION_ID_GETTING_OUT_OF_GARAGE);
   if (checkFunctionId != FUNCTION_ID_GETTING_OUT_OF_GARAGE)
   {
@@ -380,14 +559,6 @@ void Execute_GettingOutOfGarage()
  */
 void Execute_SearchPreparations()
 {
-  // - First execution handling.
-  ExecutionUtils_HandleFirstExecution(XFactor_Status::PreparingForTheSearch);
-  ResetVectors();
-
-  // - Forces status exchange until a new one is received.
-  ExecutionUtils_ForceAStatusExchange();
-  LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_ARMED);
-
   // - Perform status exchange with SafeBox
   int checkFunctionId = ExecutionUtils_StatusCheck(FUNCTION_ID_SEARCH_PREPARATIONS);
   if (checkFunctionId != FUNCTION_ID_SEARCH_PREPARATIONS)
@@ -401,10 +572,6 @@ void Execute_SearchPreparations()
   // - Close the garage until it does.
   if (!SafeBox_GetGarageState())
   {
-    SafeBox_ChangeGarageState(false);
-    delay(250);
-    SafeBox_ChangeGarageState(false);
-    delay(250);
     SafeBox_ChangeGarageState(false);
     SetNewExecutionFunction(FUNCTION_ID_SEARCH_FOR_PACKAGE);
   }
@@ -416,46 +583,22 @@ void Execute_SearchPreparations()
 }
 
 /**
- * @brief This function makes XFactor move in
- * zig-zag search pattern throughout the searching
- * zone until a package or obstacle is detected.
- * Movements are done through the use of Vectors
- * which are saved in memory so that XFactor can
- * return home later.
- * Each 5 vectors, XFactor must perform a status
- * exchange with SafeBox to know if both can
- * still communicate and talk to each other.
- *
- * @attention
- * If XFactor cannot establish a communication
- * with SafeBox, XFactor must try again for 5
- * attempts after which it needs to enter
- * @ref Execute_Alarm.
- *
- * @warning
- * If an obstacle is detected that is not a
- * potential package,
- * @ref Execute_AvoidObstacle must be called.
- * Otherwise, @ref Execute_ExamineFoundPackage
- * must be called instead. If the vector buffer
- * becomes full, @ref Execute_NoPackageFound must
- * be called.
+ * @brief
+ * Coroutine executing the search pattern of
+ * @ref Execute_SearchForPackage one vector per
+ * call so that communications and alarms are
+ * handled in between vectors.
+ * @return unsigned char:
+ * @ref COROUTINE_RUNNING until a new execution
+ * function is set.
  */
-void Execute_SearchForPackage()
+unsigned char SearchForPackage()
 {
   // - VARIABLES - //
   int checkFunctionId = 0;
   int movementStatus = 0;
-  float strafeDistance_cm = 0;
   int currentIndex = 0;
 
-  // - First execution handling.
-  ExecutionUtils_HandleFirstExecution(XFactor_Status::SearchingForAPackage);
-
-  // - Forces status exchange until a new one is received.
-  ExecutionUtils_ForceAStatusExchange(); // UNCOMMENT LATER IMPORTANT
-  LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_ARMED);
-  
   MovementVector searchPatternVectors[VECTOR_BUFFER_SIZE];
 
   for (int vectorBufferIndex = 0; vectorBufferIndex < VECTOR_BUFFER_SIZE; vectorBufferIndex++)
@@ -478,35 +621,37 @@ void Execute_SearchForPackage()
 
   currentIndex = 5; //Number of vectors "hard coded" into the vector buffer for the search pattern
 
+  COROUTINE_BEGIN(&searchForPackageCoroutine);
+
   if (currentIndex >= VECTOR_BUFFER_SIZE)
   {
     Debug_Error("Actions.cpp", "Execute_SearchForPackages", "There is not enough space in the vector buffer to try the search");
     SetNewExecutionFunction(FUNCTION_ID_ERROR);
-    return;
+    COROUTINE_FAIL(&searchForPackageCoroutine);
   }
 
-  for (int i = 0; i < VECTOR_BUFFER_SIZE; i++)
+  for (searchVectorIndex = 0; searchVectorIndex < VECTOR_BUFFER_SIZE; searchVectorIndex++)
   {
-    if (searchPatternVectors[i].rotation_rad == 0.0f && searchPatternVectors[i].distance_cm == 0.0f)
+    if (searchPatternVectors[searchVectorIndex].rotation_rad == 0.0f && searchPatternVectors[searchVectorIndex].distance_cm == 0.0f)
     {
       break; // has reach end of populated vector buffer
     }
-    
+
     movementStatus = MoveFromVector(SEARCH_PATTERN_VECTOR);
     checkFunctionId = ExecutionUtils_ComputeMovementResults(FUNCTION_ID_SEARCH_FOR_PACKAGE, movementStatus);
 
     if (checkFunctionId != FUNCTION_ID_SEARCH_FOR_PACKAGE)
     {
       SetNewExecutionFunction(checkFunctionId);
-      return;
+      COROUTINE_FAIL(&searchForPackageCoroutine);
     }
-    
+
     checkFunctionId = ExecutionUtils_CommunicationCheck(FUNCTION_ID_SEARCH_FOR_PACKAGE, MAX_COMMUNICATION_ATTEMPTS, true);
 
     if (checkFunctionId != FUNCTION_ID_SEARCH_FOR_PACKAGE)
     {
       SetNewExecutionFunction(checkFunctionId);
-      return;
+      COROUTINE_FAIL(&searchForPackageCoroutine);
     }
 
     checkFunctionId = ExecutionUtils_StatusCheck(FUNCTION_ID_SEARCH_FOR_PACKAGE);
@@ -514,13 +659,13 @@ void Execute_SearchForPackage()
     if (checkFunctionId == FUNCTION_ID_UNLOCKED || checkFunctionId == FUNCTION_ID_ERROR || checkFunctionId == FUNCTION_ID_ALARM)
     {
       SetNewExecutionFunction(checkFunctionId);
-      return;
+      COROUTINE_FAIL(&searchForPackageCoroutine);
     }
 
     switch (movementStatus)
     {
       case MOVEMENT_COMPLETED:
-        SetNewExecutionFunction(FUNCTION_ID_PICK_UP_PACKAGE);
+        // Nothing was detected along this vector. The search goes on with the next one.
         break;
       case OBJECT_LOCATED_FRONT:
         movementStatus = MoveFromVector(GO_TO_DETECTED_OBJECT_FRONT_VECTOR);
@@ -529,11 +674,11 @@ void Execute_SearchForPackage()
         if (checkFunctionId != FUNCTION_ID_SEARCH_FOR_PACKAGE)
         {
           SetNewExecutionFunction(checkFunctionId);
-          return;
+          COROUTINE_FAIL(&searchForPackageCoroutine);
         }
 
         SetNewExecutionFunction(FUNCTION_ID_EXAMINE_FOUND_PACKAGE);
-        return;
+        COROUTINE_SUCCEED(&searchForPackageCoroutine);
       case OBJECT_LOCATED_LEFT:
         movementStatus = MoveFromVector(GO_TO_DETECTED_OBJECT_LEFT_VECTOR);
         checkFunctionId = ExecutionUtils_ComputeMovementResults(FUNCTION_ID_SEARCH_FOR_PACKAGE, movementStatus);
@@ -541,11 +686,11 @@ void Execute_SearchForPackage()
         if (checkFunctionId != FUNCTION_ID_SEARCH_FOR_PACKAGE)
         {
           SetNewExecutionFunction(checkFunctionId);
-          return;
+          COROUTINE_FAIL(&searchForPackageCoroutine);
         }
 
         SetNewExecutionFunction(FUNCTION_ID_EXAMINE_FOUND_PACKAGE);
-        return;
+        COROUTINE_SUCCEED(&searchForPackageCoroutine);
       case OBJECT_LOCATED_RIGHT:
         movementStatus = MoveFromVector(GO_TO_DETECTED_OBJECT_RIGHT_VECTOR);
         checkFunctionId = ExecutionUtils_ComputeMovementResults(FUNCTION_ID_SEARCH_FOR_PACKAGE, movementStatus);
@@ -553,22 +698,57 @@ void Execute_SearchForPackage()
         if (checkFunctionId != FUNCTION_ID_SEARCH_FOR_PACKAGE)
         {
           SetNewExecutionFunction(checkFunctionId);
-          return;
+          COROUTINE_FAIL(&searchForPackageCoroutine);
         }
 
         SetNewExecutionFunction(FUNCTION_ID_EXAMINE_FOUND_PACKAGE);
-        return;
+        COROUTINE_SUCCEED(&searchForPackageCoroutine);
     }
+
+    // Lets the other tasks run in between two vectors of the pattern.
+    COROUTINE_YIELD(&searchForPackageCoroutine);
   }
 
   if(!XFactor_SetNewStatus(XFactor_Status::NoPackageFound))
   {
     Debug_Error("Actions", "Execute_SearchForPackage", "Failed to set status");
     SetNewExecutionFunction(FUNCTION_ID_ERROR);
-    return;
+    COROUTINE_FAIL(&searchForPackageCoroutine);
   }
 
   SetNewExecutionFunction(FUNCTION_ID_RETURN_HOME);
+  COROUTINE_END(&searchForPackageCoroutine);
+}
+
+/**
+ * @brief This function makes XFactor move in
+ * zig-zag search pattern throughout the searching
+ * zone until a package or obstacle is detected.
+ * Movements are done through the use of Vectors
+ * which are saved in memory so that XFactor can
+ * return home later.
+ * Each 5 vectors, XFactor must perform a status
+ * exchange with SafeBox to know if both can
+ * still communicate and talk to each other.
+ *
+ * @attention
+ * If XFactor cannot establish a communication
+ * with SafeBox, XFactor must try again for 5
+ * attempts after which it needs to enter
+ * @ref Execute_Alarm.
+ *
+ * @warning
+ * If an obstacle is detected that is not a
+ * potential package,
+ * @ref Execute_AvoidObstacle must be called.
+ * Otherwise, @ref Execute_ExamineFoundPackage
+ * must be called instead. If the vector buffer
+ * becomes full, @ref Execute_NoPackageFound must
+ * be called.
+ */
+void Execute_SearchForPackage()
+{
+  SearchForPackage();
 }
 
 /**
@@ -622,13 +802,6 @@ void Execute_ExamineFoundPackage()
   int checkFunctionId = 0;
   int movementStatus;
 
-  // - First execution handling.
-  ExecutionUtils_HandleFirstExecution(XFactor_Status::ExaminatingAPackage);
-
-  // - Forces status exchange until a new one is received.
-  ExecutionUtils_ForceAStatusExchange();
-  LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_ARMED);
-
   for (;;)
   {
     movementStatus = MoveFromVector(EXAMINE_PACKAGE_LEFT_SWIPE_VECTOR);
@@ -699,39 +872,22 @@ void Execute_ExamineFoundPackage()
 
 /**
  * @brief
- * Action function that makes XFactor pick up a
- * found package. This action function must
- * change XFactor's status and perform a status
- * exchange with SafeBox to tell it that it has
- * found a package and its about to pick it up.
- *
- * If XFactor fails to pick up the package after
- * 5 attempts, @ref Execute_Error must be called
- * but the alarm must not be activated unless
- * XFactor is tempered with.
- *
-* @attention
- * If the vector buffer becomes full, XFactor
- * must tell SafeBox about it through a status
- * exchange and XFactor must begin its return
- * home process. If communication cannot be
- * established after 5 attempts, XFactor must
- * enter alarm mode and continue to try to talk
- * with SafeBox.
+ * Coroutine executing the pick up attempts of
+ * @ref Execute_PickUpPackage. Returns while
+ * @ref Package_PickUp waits after the claw.
+ * @return unsigned char:
+ * @ref COROUTINE_RUNNING until a new execution
+ * function is set.
  */
-void Execute_PickUpPackage()
+unsigned char PickUpPackage()
 {
   // - VARIABLES - //
-  int pickUpAttempt = 1;
   int checkFunctionId = 0;
-  bool errorOccured = false;
+  unsigned char pickUpResult = COROUTINE_RUNNING;
 
-  // - First execution handling.
-  ExecutionUtils_HandleFirstExecution(XFactor_Status::PickingUpAPackage);
+  COROUTINE_BEGIN(&pickUpPackageCoroutine);
 
-  // - Forces status exchange until a new one is received.
-  ExecutionUtils_ForceAStatusExchange();
-  LEDS_SetColor(LED_ID_STATUS_INDICATOR, 32, 32, 128);
+  pickUpAttempt = 1;
 
   // - Check if claw really picked up the package
   while(!Claws_GetSwitchStatus())
@@ -741,8 +897,7 @@ void Execute_PickUpPackage()
       // If we have time, undo the last vectors then redo ExamineFoundPackage
       Debug_Error("Actions", "Execute_PickUpPackage", "Max attempts reached.");
       SetNewExecutionFunction(FUNCTION_ID_RETURN_HOME);
-      errorOccured = true;
-      return;
+      COROUTINE_FAIL(&pickUpPackageCoroutine);
     }
     pickUpAttempt++;
 
@@ -751,13 +906,13 @@ void Execute_PickUpPackage()
     {
       Debug_Warning("Actions", "Execute_PickUpPackage", "New execution function set prematurely");
       SetNewExecutionFunction(checkFunctionId);
-      errorOccured = true;
-      return;
+      COROUTINE_FAIL(&pickUpPackageCoroutine);
     }
 
-    if(!Package_PickUp())
+    COROUTINE_WAIT_UNTIL(&pickUpPackageCoroutine, (pickUpResult = Package_PickUp()) != COROUTINE_RUNNING);
+    if(pickUpResult == COROUTINE_FAILED)
     {
-      Debug_Warning("Actions", "Execute_PickUpPackage", "Pick up attempt failed");      
+      Debug_Warning("Actions", "Execute_PickUpPackage", "Pick up attempt failed");
     }
   }
 
@@ -767,6 +922,34 @@ void Execute_PickUpPackage()
   }
 
   SetNewExecutionFunction(FUNCTION_ID_RETURN_HOME);
+  COROUTINE_END(&pickUpPackageCoroutine);
+}
+
+/**
+ * @brief
+ * Action function that makes XFactor pick up a
+ * found package. This action function must
+ * change XFactor's status and perform a status
+ * exchange with SafeBox to tell it that it has
+ * found a package and its about to pick it up.
+ *
+ * If XFactor fails to pick up the package after
+ * 5 attempts, @ref Execute_Error must be called
+ * but the alarm must not be activated unless
+ * XFactor is tempered with.
+ *
+* @attention
+ * If the vector buffer becomes full, XFactor
+ * must tell SafeBox about it through a status
+ * exchange and XFactor must begin its return
+ * home process. If communication cannot be
+ * established after 5 attempts, XFactor must
+ * enter alarm mode and continue to try to talk
+ * with SafeBox.
+ */
+void Execute_PickUpPackage()
+{
+  PickUpPackage();
 }
 
 /**
@@ -786,6 +969,10 @@ void Execute_PickUpPackage()
  * vector, XFactor must simply redo all the saved
  * vectors in reverse until its back to the start
  *
+ * @note
+ * SafeBox is told when XFactor should arrive so
+ * that the garage is already open by then.
+ *
  * @warning
  * A status exchange must be performed each 5
  * vectors to ensure that communication with
@@ -796,19 +983,20 @@ void Execute_ReturnHome()
   // - VARIABLES - //
   int checkFunctionId;
   int movementStatus;
-
-  // - First execution handling.
-  ExecutionUtils_HandleFirstExecution(XFactor_Status::ReturningHome);
-
-  // - Forces status exchange until a new one is received. (IF ITS THE FIRST EXECUTION)
-  ExecutionUtils_ForceAStatusExchange();
-  LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_ARMED);
+  unsigned long arrivalTime_ms;
 
   MovementVector returnVector = GetReturnVector();
 
   Debug_Information("Actions", "Execute_ReturnHome", "Return Vector Rotation : " + String(returnVector.rotation_rad));
   Debug_Information("Actions", "Execute_ReturnHome", "Return Vector Distance : " + String(returnVector.distance_cm));
 
+  // - Lets SafeBox have the garage open by the time XFactor gets there.
+  arrivalTime_ms = millis() + (unsigned long)(returnVector.distance_cm / RETURN_HOME_SPEED_CM_PER_S * 1000.0f) + RETURN_HOME_FINAL_TURN_MS;
+  if (!SafeBox_ScheduleGarageOpening(arrivalTime_ms))
+  {
+    Debug_Warning("Actions", "Execute_ReturnHome", "Garage opening not scheduled");
+  }
+
   movementStatus = MoveFromVector(RETURN_HOME_VECTOR);
   checkFunctionId = ExecutionUtils_ComputeMovementResults(FUNCTION_ID_RETURN_HOME, movementStatus);
 
@@ -865,15 +1053,6 @@ void Execute_PreparingForDropOff()
   // - VARIABLES - //
   int checkFunctionId = 0;
 
-  // - First execution handling.
-  ExecutionUtils_HandleFirstExecution(XFactor_Status::PreparingForDropOff);
-  ResetVectors();
-  ResetMovements();
-
-  // - Forces status exchange until a new one is received. (IF ITS THE FIRST EXECUTION)
-  ExecutionUtils_ForceAStatusExchange();
-  LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_ARMED);
-
   checkFunctionId = ExecutionUtils_CommunicationCheck(FUNCTION_ID_PREPARING_FOR_DROP_OFF, MAX_COMMUNICATION_ATTEMPTS, true);
   if (checkFunctionId != FUNCTION_ID_PREPARING_FOR_DROP_OFF)
   {
@@ -896,6 +1075,77 @@ void Execute_PreparingForDropOff()
   }
 }
 
+/**
+ * @brief
+ * Coroutine executing the steps of
+ * @ref Execute_PackageDropOff. Returns after
+ * releasing the package and while waiting for
+ * it to fall.
+ * @return unsigned char:
+ * @ref COROUTINE_RUNNING until a new execution
+ * function is set.
+ */
+unsigned char PackageDropOff()
+{
+  // - VARIABLES - //
+  int checkFunctionId;
+  int movementStatus;
+
+  COROUTINE_BEGIN(&packageDropOffCoroutine);
+
+  checkFunctionId = ExecutionUtils_CommunicationCheck(FUNCTION_ID_PACKAGE_DROP_OFF, MAX_COMMUNICATION_ATTEMPTS, true);
+  if (checkFunctionId != FUNCTION_ID_PACKAGE_DROP_OFF)
+  {
+    SetNewExecutionFunction(checkFunctionId);
+    COROUTINE_FAIL(&packageDropOffCoroutine);
+  }
+
+  movementStatus = MoveFromVector(TURN_90_LEFT, 0.0f, false, DONT_CHECK_SENSORS, true, false, 0.2f);
+  checkFunctionId = ExecutionUtils_ComputeMovementResults(FUNCTION_ID_PACKAGE_DROP_OFF, movementStatus);
+
+  if (checkFunctionId != FUNCTION_ID_PACKAGE_DROP_OFF)
+  {
+    SetNewExecutionFunction(checkFunctionId);
+    COROUTINE_FAIL(&packageDropOffCoroutine);
+  }
+
+  if (!Package_Release())
+  {
+    SetNewExecutionFunction(FUNCTION_ID_ERROR);
+    COROUTINE_FAIL(&packageDropOffCoroutine);
+  }
+
+  COROUTINE_YIELD(&packageDropOffCoroutine);
+
+  checkFunctionId = ExecutionUtils_CommunicationCheck(FUNCTION_ID_PACKAGE_DROP_OFF, MAX_COMMUNICATION_ATTEMPTS, true);
+  if (checkFunctionId != FUNCTION_ID_PACKAGE_DROP_OFF)
+  {
+    SetNewExecutionFunction(checkFunctionId);
+    COROUTINE_FAIL(&packageDropOffCoroutine);
+  }
+
+  // Gives the package time to fall before the claw moves.
+  COROUTINE_SLEEP(&packageDropOffCoroutine, 500);
+
+  if (!Package_StoreClaw())
+  {
+    SetNewExecutionFunction(FUNCTION_ID_ERROR);
+    COROUTINE_FAIL(&packageDropOffCoroutine);
+  }
+
+  movementStatus = MoveFromVector(TURN_90_LEFT, 0.0f, false, DONT_CHECK_SENSORS, false, false, 0.2f);
+  checkFunctionId = ExecutionUtils_ComputeMovementResults(FUNCTION_ID_PACKAGE_DROP_OFF, movementStatus);
+
+  if (checkFunctionId != FUNCTION_ID_PACKAGE_DROP_OFF)
+  {
+    SetNewExecutionFunction(checkFunctionId);
+    COROUTINE_FAIL(&packageDropOffCoroutine);
+  }
+
+  SetNewExecutionFunction(FUNCTION_ID_CONFIRM_DROP_OFF);
+  COROUTINE_END(&packageDropOffCoroutine);
+}
+
 /**
  * @brief
  * Action function that firstly asks SafeBox to
@@ -918,75 +1168,7 @@ void Execute_PreparingForDropOff()
  */
 void Execute_PackageDropOff()
 {
-  static int step = 0;
-  int checkFunctionId;
-  int movementStatus;
-
-  // - First execution handling.
-  ExecutionUtils_HandleFirstExecution(XFactor_Status::DroppingOff);
-  LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_ARMED);
-
-  // - Forces status exchange until a new one is received. (IF ITS THE FIRST EXECUTION)
-  ExecutionUtils_ForceAStatusExchange();
-
-  checkFunctionId = ExecutionUtils_CommunicationCheck(FUNCTION_ID_PACKAGE_DROP_OFF, MAX_COMMUNICATION_ATTEMPTS, true);
-  if (checkFunctionId != FUNCTION_ID_PACKAGE_DROP_OFF)
-  {
-    SetNewExecutionFunction(checkFunctionId);
-    return;
-  }
-
-  switch (step)
-  {
-    case 0:
-      movementStatus = MoveFromVector(TURN_90_LEFT, 0.0f, false, DONT_CHECK_SENSORS, true, false, 0.2f);
-      checkFunctionId = ExecutionUtils_ComputeMovementResults(FUNCTION_ID_PACKAGE_DROP_OFF, movementStatus);
-
-      if (checkFunctionId != FUNCTION_ID_PACKAGE_DROP_OFF)
-      {
-        SetNewExecutionFunction(checkFunctionId);
-        return;
-      }
-
-      if (Package_Release())
-      {
-        step++;
-      }
-      else
-      {
-        SetNewExecutionFunction(FUNCTION_ID_ERROR);
-        return;
-      }
-      break;
-    case 1:
-      delay(500);
-      if (Package_StoreClaw())
-      {
-        step++;
-      }
-      else
-      {
-        SetNewExecutionFunction(FUNCTION_ID_ERROR);
-        return;
-      }
-    case 2:
-      movementStatus = MoveFromVector(TURN_90_LEFT, 0.0f, false, DONT_CHECK_SENSORS, false, false, 0.2f);
-      checkFunctionId = ExecutionUtils_ComputeMovementResults(FUNCTION_ID_PACKAGE_DROP_OFF, movementStatus);
-
-      if (checkFunctionId != FUNCTION_ID_PACKAGE_DROP_OFF)
-      {
-        SetNewExecutionFunction(checkFunctionId);
-        return;
-      }
-      step++;
-    case 3:
-      SetNewExecutionFunction(FUNCTION_ID_CONFIRM_DROP_OFF);
-      step++;
-    case 4:
-      step = 0;
-    default:
-      break;
-  }
+  PackageDropOff();
 }
 
 /**
@@ -1011,13 +1193,6 @@ void Execute_ConfirmDropOff()
   // - VARIABLES - //
   int checkFunctionId = 0;
 
-  // - First execution handling.
-  ExecutionUtils_HandleFirstExecution(XFactor_Status::ConfirmingDropOff);
-
-  // - Forces status exchange until a new one is received. (IF ITS THE FIRST EXECUTION)
-  ExecutionUtils_ForceAStatusExchange();
-  LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_ARMED);
-
   checkFunctionId = ExecutionUtils_CommunicationCheck(FUNCTION_ID_CONFIRM_DROP_OFF, MAX_COMMUNICATION_ATTEMPTS, true);
   if (checkFunctionId != FUNCTION_ID_CONFIRM_DROP_OFF)
   {
@@ -1052,13 +1227,10 @@ void Execute_Alarm()
 {
   // - VARIABLES - //
   static bool mustBeOn = false;
-  XFactor_SetNewStatus(XFactor_Status::Alarm);
-  Stop();
 
   int checkFunctionId = ExecutionUtils_StatusCheck(FUNCTION_ID_ALARM);
   if (checkFunctionId != FUNCTION_ID_ALARM)
   {
-    AX_BuzzerOFF();
     SetNewExecutionFunction(checkFunctionId);
     return;
   }
@@ -1069,7 +1241,6 @@ void Execute_Alarm()
       mustBeOn = !mustBeOn;
       if(mustBeOn)
       {
-          SafeBox_ExchangeStatus();
           LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_ALARM);
           AX_BuzzerON();
       }
@@ -1103,17 +1274,10 @@ void Execute_Alarm()
  */
 void Execute_Error()
 {
-  Debug_Warning("Actions", "Execute_Error", "ERROR REACHED. DEBUG STOPPED");
-  Debug_Stop();
-  Stop();
-
-
   // - VARIABLES - //
   static bool mustBeOn = false; // everything is closed
 
   // - PROGRAM - //
-  XFactor_SetNewStatus(XFactor_Status::Error);
-
   if(ExecutionUtils_LedBlinker(1000))
   {
       mustBeOn = !mustBeOn;
@@ -1155,8 +1319,6 @@ void Execute_ReturnInsideGarage()
 {
   int checkFunctionId;
   int movementStatus;
-  
-  XFactor_SetNewStatus(XFactor_Status::EnteringSafeBox);
 
   checkFunctionId = ExecutionUtils_StatusCheck(FUNCTION_ID_RETURN_INSIDE_GARAGE);
 
@@ -1166,7 +1328,8 @@ void Execute_ReturnInsideGarage()
     return;
   }
 
-  if (SafeBox_GetGarageState())
+  // Only a snapshot can tell that the garage really opened, even once the opening scheduled by Execute_ReturnHome is done.
+  if (SafeBox_GetGarageState() && SafeBox_SnapshotIsRecent())
   {
     movementStatus = MoveFromVector(GETTING_BACK_INTO_GARAGE_VECTOR);
     checkFunctionId = ExecutionUtils_ComputeMovementResults(FUNCTION_ID_RETURN_INSIDE_GARAGE, movementStatus);
@@ -1177,17 +1340,19 @@ void Execute_ReturnInsideGarage()
       return;
     }
 
-    SafeBox_ChangeGarageState(false);
-    delay(250);
-    SafeBox_ChangeGarageState(false);
-    delay(250);
     SafeBox_ChangeGarageState(false);
 
     SetNewExecutionFunction(FUNCTION_ID_PREPARING_FOR_DROP_OFF);
     return;
   }
+  else if (SafeBox_GarageOpeningIsPending())
+  {
+    // SafeBox is about to open it. Checked again on the next pass.
+    return;
+  }
   else
   {
+    // Not scheduled, or SafeBox failed to open it on time. Asked explicitly.
     if(!SafeBox_ChangeGarageState(true))
     {
       Debug_Warning("Actions", "Execute_GettingOutOfGarage", "Failed to change garage state");
@@ -1210,7 +1375,6 @@ void Execute_EndOfProgram()
 {
   int checkFunctionId;
 
-  LEDS_SetColor(LED_ID_STATUS_INDICATOR, 16, 32, 64);
   checkFunctionId = ExecutionUtils_StatusCheck(FUNCTION_ID_END_OF_PROGRAM);
 
   if (checkFunctionId != FUNCTION_ID_END_OF_PROGRAM)
@@ -1230,13 +1394,6 @@ void Execute_EndOfProgram()
 void Execute_Unlocked()
 {
   int checkFunctionId;
-  XFactor_SetNewStatus(XFactor_Status::Unlocked);
-
-  LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_DISARMED);
-  Stop();
-  
-  Package_Release();
-  Package_StoreClaw();
 
   if(digitalRead(PACKAGE_CALIBRATE_COLOUR_PIN))
   {
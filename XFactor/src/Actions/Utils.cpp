@@ -26,7 +26,8 @@ void ExecutionUtils_ForceAStatusExchange()
     ResetSavedParameters();
     LEDS_SetColor(LED_ID_STATUS_INDICATOR, LED_COLOR_COMMUNICATING);
     SafeBox_ExchangeStatus();
-    delay(500);
+    // Backs off with the link instead of a fixed delay.
+    Scheduler_Delay(BT_GetRetransmitTimeout());
   }
 }
 
@@ -39,7 +40,8 @@ void ExecutionUtils_ForceAStatusExchange()
  * is currently saved for SafeBox. This prevents
  * the program from automatically changing the
  * execution function back to an unwanted
- * execution function automatically.
+ * execution function automatically. Called by
+ * the onEnter hook of the state.
  * 
  * @param wantedStatus
  * The status that XFactor should hold while in
@@ -47,17 +49,8 @@ void ExecutionUtils_ForceAStatusExchange()
  */
 void ExecutionUtils_HandleFirstExecution(XFactor_Status wantedStatus)
 {
-  // - Variables - //
-  XFactor_Status currentStatus = XFactor_GetStatus();
-
-  if (currentStatus != wantedStatus)
-  {
-    // First time that this status is set.
-    // SafeBox's status will be automatically
-    // reset.
-    SafeBox_SetNewStatus(SafeBox_Status::CommunicationError);
-  }
-
+  // SafeBox's status will be automatically reset.
+  SafeBox_SetNewStatus(SafeBox_Status::CommunicationError);
   XFactor_SetNewStatus(wantedStatus);
 }
 
@@ -92,10 +85,7 @@ int ExecutionUtils_StatusCheck(int currentExecutionFunctionId)
         return currentExecutionFunctionId;
     }
   }
-  else
-  {
-    Debug_Error("Utils","ExecutionUtils_StatusCheck", "Status exchange failed");
-  }
+  // Not synced yet. Checked again on the next pass.
   return currentExecutionFunctionId;
 }
 
@@ -18,6 +18,322 @@
 // - GLOBAL LOCAL ACCESS - //
 bool _messageReceived = false;
 
+/// @brief Baudrate selected by @ref BT_Init. 0 until Bluetooth is initialised.
+unsigned long _baudRate = 0;
+
+/**
+ * @brief
+ * Ring buffer in which the bytes received by
+ * the UART are stored until they are framed.
+ * Head is only written when bytes are received
+ * and tail is only written when they are framed.
+ */
+volatile unsigned char _rxRingBuffer[BT_RX_RING_BUFFER_SIZE];
+volatile unsigned char _rxRingHead = 0;
+volatile unsigned char _rxRingTail = 0;
+
+/**
+ * @brief
+ * Ring buffer in which encoded frames wait to be
+ * moved to the UART's own 64 bytes buffer, whose
+ * interrupt sends them. Senders thus never wait
+ * after the UART.
+ */
+unsigned char _txRingBuffer[BT_TX_RING_BUFFER_SIZE];
+unsigned char _txRingHead = 0;
+unsigned char _txRingTail = 0;
+
+/**
+ * @brief
+ * Ring buffer of @ref BT_Channel::Telemetry. Its
+ * bytes are only moved to the UART while the
+ * control ring buffer is empty. Once a telemetry
+ * frame started to be sent, it is finished first
+ * so that frames never interleave.
+ */
+unsigned char _telemetryRingBuffer[BT_TELEMETRY_RING_BUFFER_SIZE];
+unsigned char _telemetryRingHead = 0;
+unsigned char _telemetryRingTail = 0;
+/// @brief Bytes of the telemetry frame being sent that are not in the UART yet.
+unsigned char _telemetryFrameRemaining = 0;
+
+/// @brief State of the link saved by @ref UpdateLinkState
+bool _linkIsUp = true;
+bool _linkStateChanged = false;
+/// @brief When bytes were last received. Used to detect a silent link.
+unsigned long _lastReceivedTime_ms = 0;
+
+/**
+ * @brief
+ * Decoder that assembles frames out of the bytes
+ * taken from the ring buffer.
+ */
+Protocol_Decoder _rxDecoder = {Protocol_DecoderState::WaitingForSync, 0, 0, {0, 0, 0, {0}}, 0};
+
+/**
+ * @brief
+ * Statistics of the link. framesRejected is
+ * copied from @ref _rxDecoder when they are read.
+ */
+BT_Stats _stats;
+
+/**
+ * @brief
+ * FIFO of complete frames waiting to be read by
+ * @ref BT_GetLatestFrame.
+ */
+Protocol_Frame _rxFrames[BT_SIZE_OF_MESSAGE_BUFFER];
+unsigned char _rxFramesOldest = 0;
+unsigned char _rxFramesCount = 0;
+
+/**
+ * @brief
+ * Arduino calls this in between each loop when
+ * the UART has received bytes. The UART's RX
+ * interrupt fills its own 64 bytes buffer which
+ * is emptied into @ref _rxRingBuffer here.
+ */
+BT_SERIAL_EVENT
+{
+    BT_Poll();
+}
+
+/**
+ * @brief
+ * Saves the frame that the decoder just completed
+ * at the end of the frame FIFO. If the FIFO is
+ * full the oldest frame is dropped to make space.
+ */
+void SaveCurrentFrame()
+{
+    unsigned char newestIndex = 0;
+
+    if(_rxFramesCount >= BT_SIZE_OF_MESSAGE_BUFFER)
+    {
+        // Oh shit... Whos spamming? Oldest frame is lost.
+        _stats.framesDropped++;
+        _rxFramesOldest = (_rxFramesOldest + 1) % BT_SIZE_OF_MESSAGE_BUFFER;
+        _rxFramesCount--;
+    }
+
+    newestIndex = (_rxFramesOldest + _rxFramesCount) % BT_SIZE_OF_MESSAGE_BUFFER;
+    memcpy(&_rxFrames[newestIndex], &_rxDecoder.frame, sizeof(Protocol_Frame));
+    _rxFramesCount++;
+    _stats.framesReceived++;
+    _messageReceived = true;
+}
+
+/**
+ * @brief
+ * Saves if the link is up and latches any
+ * change for @ref BT_LinkStateChanged
+ */
+void UpdateLinkState()
+{
+    // - VARIABLES - //
+    bool linkIsUp = false;
+
+#ifdef BT_USE_STATE_PIN
+    linkIsUp = (BT_READ_STATE_PIN() == HIGH);
+#else
+    linkIsUp = (millis() - _lastReceivedTime_ms) < BT_LINK_SILENCE_MS;
+#endif
+
+    if(linkIsUp == _linkIsUp) return;
+    _linkIsUp = linkIsUp;
+    _linkStateChanged = true;
+}
+
+/**
+ * @brief
+ * Moves as many queued bytes as the UART's
+ * buffer can take without blocking. Control
+ * bytes go first.
+ */
+void SendQueuedBytes()
+{
+    while(BT_SERIAL.availableForWrite() > 0)
+    {
+        if(_telemetryFrameRemaining == 0 && _txRingTail != _txRingHead)
+        {
+            BT_SERIAL.write(_txRingBuffer[_txRingTail]);
+            _txRingTail = (_txRingTail + 1) & (BT_TX_RING_BUFFER_SIZE - 1);
+            continue;
+        }
+
+        if(_telemetryRingTail == _telemetryRingHead) return;
+
+        if(_telemetryFrameRemaining == 0)
+        {
+            // Start of a frame. Its length byte tells how long it is.
+            _telemetryFrameRemaining = _telemetryRingBuffer[(_telemetryRingTail + PROTOCOL_HEADER_LENGTH - 1) & (BT_TELEMETRY_RING_BUFFER_SIZE - 1)] + PROTOCOL_FRAME_OVERHEAD;
+        }
+        BT_SERIAL.write(_telemetryRingBuffer[_telemetryRingTail]);
+        _telemetryRingTail = (_telemetryRingTail + 1) & (BT_TELEMETRY_RING_BUFFER_SIZE - 1);
+        _telemetryFrameRemaining--;
+    }
+}
+
+/**
+ * @brief
+ * Returns how many bytes can still be queued in
+ * the transmission ring buffer of a channel.
+ * @param channel
+ * The channel whose queue is checked.
+ * @return unsigned char:
+ * Free space in bytes.
+ */
+unsigned char GetQueueFreeSpace(BT_Channel channel)
+{
+    if(channel == BT_Channel::Telemetry)
+    {
+        return (BT_TELEMETRY_RING_BUFFER_SIZE - 1) - ((_telemetryRingHead - _telemetryRingTail) & (BT_TELEMETRY_RING_BUFFER_SIZE - 1));
+    }
+    return (BT_TX_RING_BUFFER_SIZE - 1) - ((_txRingHead - _txRingTail) & (BT_TX_RING_BUFFER_SIZE - 1));
+}
+
+/**
+ * @brief
+ * Adds a byte at the end of the transmission
+ * ring buffer of a channel. The space must have
+ * been checked.
+ * @param channel
+ * The channel whose queue receives the byte.
+ * @param data
+ * The byte to queue.
+ */
+void QueueByte(BT_Channel channel, unsigned char data)
+{
+    if(channel == BT_Channel::Telemetry)
+    {
+        _telemetryRingBuffer[_telemetryRingHead] = data;
+        _telemetryRingHead = (_telemetryRingHead + 1) & (BT_TELEMETRY_RING_BUFFER_SIZE - 1);
+        return;
+    }
+    _txRingBuffer[_txRingHead] = data;
+    _txRingHead = (_txRingHead + 1) & (BT_TX_RING_BUFFER_SIZE - 1);
+}
+
+/**
+ * @brief
+ * Encodes a frame straight into the transmission
+ * ring buffer of a channel. The payload is read
+ * where it is, in RAM or in flash, without being
+ * copied.
+ * @param channel
+ * The channel on which the frame is sent.
+ * @param opcode
+ * One of the COMMAND_ or ANSWER_ defines.
+ * @param sequence
+ * Sequence number of the frame or
+ * @ref PROTOCOL_NO_SEQUENCE
+ * @param payload
+ * Bytes sent with the opcode. Can be 0 if
+ * length is 0.
+ * @param length
+ * How many bytes of payload there is.
+ * @param payloadInFlash
+ * true if payload points to PROGMEM.
+ * @return true:
+ * The frame was queued.
+ * @return false:
+ * The payload is too large or the queue is full.
+ */
+bool QueueFrame(BT_Channel channel, unsigned char opcode, unsigned char sequence, const unsigned char* payload, unsigned char length, bool payloadInFlash)
+{
+    // - VARIABLES - //
+    unsigned char header[PROTOCOL_HEADER_LENGTH];
+    unsigned char crc = 0;
+    unsigned char data = 0;
+
+    // - PRELIMINARY CHECKS - //
+    if(length > PROTOCOL_MAX_PAYLOAD_LENGTH || (length > 0 && payload == 0))
+    {
+        Debug_Error("Bluetooth", "QueueFrame", "Payload is too large.");
+        return false;
+    }
+
+    SendQueuedBytes();
+    if(GetQueueFreeSpace(channel) < (length + PROTOCOL_FRAME_OVERHEAD))
+    {
+        // A full telemetry queue is expected when the link is saturated.
+        if(channel == BT_Channel::Control) Debug_Error("Bluetooth", "QueueFrame", "TX queue is full");
+        return false;
+    }
+
+    // - FUNCTION EXECUTION - //
+    crc = Protocol_EncodeHeader(opcode, sequence, length, header);
+    for(unsigned char i = 0; i < PROTOCOL_HEADER_LENGTH; i++) QueueByte(channel, header[i]);
+
+    for(unsigned char i = 0; i < length; i++)
+    {
+        data = payloadInFlash ? pgm_read_byte(&payload[i]) : payload[i];
+        QueueByte(channel, data);
+        crc = Protocol_CRC8(crc, data);
+    }
+    QueueByte(channel, crc);
+    _stats.framesSent++;
+    _stats.channelBytes[(unsigned char)channel] += length + PROTOCOL_FRAME_OVERHEAD;
+
+    SendQueuedBytes();
+    return true;
+}
+
+/**
+ * @brief
+ * Moves every byte that the UART has received
+ * into the reception ring buffer and then hands
+ * them to the frame decoder. Any complete frame
+ * with a valid CRC is saved in the frame buffer.
+ * Queued bytes are then moved from the
+ * transmission ring buffer to the UART as long
+ * as it has space for them.
+ * This never blocks and never uses the heap.
+ *
+ * @attention
+ * Arduino automatically calls this through
+ * @ref BT_SERIAL_EVENT in between loops. Any
+ * function that waits after a message must
+ * call it itself while it waits.
+ */
+void BT_Poll()
+{
+    // - VARIABLES - //
+    unsigned char nextHead = 0;
+    unsigned char receivedByte = 0;
+
+    // - FILL THE RING BUFFER - //
+    while(BT_SERIAL.available())
+    {
+        nextHead = (_rxRingHead + 1) & (BT_RX_RING_BUFFER_SIZE - 1);
+        if(nextHead == _rxRingTail)
+        {
+            // Ring buffer full. Bytes stay in the UART until framed.
+            break;
+        }
+        _rxRingBuffer[_rxRingHead] = (unsigned char)BT_SERIAL.read();
+        _rxRingHead = nextHead;
+        _lastReceivedTime_ms = millis();
+    }
+
+    // - FRAME THE RING BUFFER - //
+    while(_rxRingTail != _rxRingHead)
+    {
+        receivedByte = _rxRingBuffer[_rxRingTail];
+        _rxRingTail = (_rxRingTail + 1) & (BT_RX_RING_BUFFER_SIZE - 1);
+
+        if(Protocol_DecodeByte(&_rxDecoder, receivedByte))
+        {
+            SaveCurrentFrame();
+        }
+    }
+
+    // - EMPTY THE TX QUEUE - //
+    SendQueuedBytes();
+
+    UpdateLinkState();
+}
+
 /**
  * @deprecated
  * Arduino sucks with stack and memory management.
@@ -50,67 +366,140 @@ String MessageBuffer(String newMessage, unsigned char bufferIndex, int action)
 
 /**
  * @brief
- * This function used to be the function that
- * allowed interrupts to read from the serial
- * port. But as we know it, Arduino's string
- * classes as well as stack managaement sucks
- * ass. This function is called whenever we
- * perform a message exchange to make sure that
- * message was gathered correctly.
- * @return String:
- * "SWEET_FUCK_ALL": No message were found.
+ * Sends an AT command to an HC-05 whose KEY pin
+ * is high and waits for its OK. Works on any
+ * Stream so that a simulated module can answer.
+ * @param port
+ * Stream to which the HC-05 is connected.
+ * @param command
+ * The AT command, without its line ending.
+ * @param millisecondsTimeOut
+ * How long to wait for the answer.
+ * @return true:
+ * The module answered OK.
+ * @return false:
+ * The module answered ERROR or did not answer.
+ */
+bool BT_SendATCommand(Stream& port, const char* command, unsigned long millisecondsTimeOut)
+{
+    // - VARIABLES - //
+    unsigned long startTime = 0;
+    int receivedCharacter = 0;
+    int previousCharacter = 0;
+
+    // - PRELIMINARY CHECKS - //
+    if(command == 0) return false;
+
+    // - FUNCTION EXECUTION - //
+    // Whatever was received before is not the answer.
+    while(port.available()) port.read();
+
+    port.print(command);
+    port.print("\r\n");
+
+    startTime = millis();
+    while((millis() - startTime) < millisecondsTimeOut)
+    {
+        receivedCharacter = port.read();
+        if(receivedCharacter < 0) continue;
+
+        if(previousCharacter == 'O' && receivedCharacter == 'K') return true;
+        if(previousCharacter == 'E' && receivedCharacter == 'R') return false;
+        previousCharacter = receivedCharacter;
+    }
+    return false;
+}
+
+/**
+ * @brief
+ * Opens @ref BT_SERIAL at the specified baudrate
+ * and checks if the HC-05 answers AT commands at
+ * that baudrate. Its KEY pin must be high.
+ * @param baudRate
+ * The baudrate to try.
+ * @return true:
+ * The HC-05 uses that baudrate.
+ * @return false:
+ * The HC-05 did not answer.
  */
-String GetMessage(int millisecondsTimeOut)
+bool TryBaudRate(unsigned long baudRate)
+{
+    BT_SERIAL.begin(baudRate);
+    return BT_SendATCommand(BT_SERIAL, "AT", BT_AT_TIMEOUT_MS);
+}
+
+/**
+ * @brief
+ * Finds the HC-05's current baudrate and moves
+ * it to @ref BT_HC05_FAST_BAUDRATE. The new
+ * baudrate is verified once the module restarts.
+ * @ref BT_SERIAL is left opened at the selected
+ * baudrate and the selected baudrate is saved in
+ * the EEPROM.
+ * @return unsigned long:
+ * The selected baudrate. @ref BT_HC05_BAUDRATE if
+ * anything failed.
+ */
+unsigned long NegotiateBaudRate()
 {
     // - VARIABLES - //
-    char receivedCharacter = 0;
-    bool hasReceivedMessage = false;
+    unsigned long currentBaudRate = 0;
+    unsigned long savedBaudRate = (unsigned long)EEPROM.read(BT_BAUDRATE_EEPROM_ADDRESS) * 1200;
 
-    unsigned long currentTime = millis();
-    unsigned long oldTime = millis();
+    pinMode(BT_HC05_KEY_PIN, OUTPUT);
+    digitalWrite(BT_HC05_KEY_PIN, HIGH);
 
-    String _currentMessage = "";
+    // - FIND THE CURRENT BAUDRATE - //
+    // The baudrate saved last time is most likely still the right one.
+    if(savedBaudRate == BT_HC05_FAST_BAUDRATE || savedBaudRate == BT_HC05_BAUDRATE)
+    {
+        if(TryBaudRate(savedBaudRate)) currentBaudRate = savedBaudRate;
+    }
+    if(currentBaudRate == 0 && TryBaudRate(BT_HC05_FAST_BAUDRATE)) currentBaudRate = BT_HC05_FAST_BAUDRATE;
+    if(currentBaudRate == 0 && TryBaudRate(BT_HC05_BAUDRATE)) currentBaudRate = BT_HC05_BAUDRATE;
 
-    while ((currentTime-oldTime) < millisecondsTimeOut)
+    if(currentBaudRate == 0)
     {
-        currentTime = millis();
-        // Empty the internal buffer
-        while(BT_SERIAL.available())
+        Debug_Warning("Bluetooth", "NegotiateBaudRate", "HC-05 does not answer AT commands");
+        digitalWrite(BT_HC05_KEY_PIN, LOW);
+        BT_SERIAL.begin(BT_HC05_BAUDRATE);
+        return BT_HC05_BAUDRATE;
+    }
+
+    // - MOVE TO THE FAST BAUDRATE - //
+    if(currentBaudRate != BT_HC05_FAST_BAUDRATE)
+    {
+        if(BT_SendATCommand(BT_SERIAL, BT_HC05_FAST_BAUDRATE_COMMAND, BT_AT_TIMEOUT_MS) &&
+           BT_SendATCommand(BT_SERIAL, "AT+RESET", BT_AT_TIMEOUT_MS))
         {
-            hasReceivedMessage = true;
-            receivedCharacter = (char)BT_SERIAL.read();
-            if(receivedCharacter >= 32 && receivedCharacter <= 126)
-            {
-                _currentMessage += receivedCharacter;
-            }
+            // KEY must be low while it restarts or it restarts in full AT mode.
+            digitalWrite(BT_HC05_KEY_PIN, LOW);
+            delay(BT_HC05_RESET_DELAY_MS);
+            digitalWrite(BT_HC05_KEY_PIN, HIGH);
+
+            if(TryBaudRate(BT_HC05_FAST_BAUDRATE)) currentBaudRate = BT_HC05_FAST_BAUDRATE;
+            else if(TryBaudRate(BT_HC05_BAUDRATE)) currentBaudRate = BT_HC05_BAUDRATE;
             else
             {
-                // END OF STRING
-                if(receivedCharacter == '\n')
-                {
-                    return _currentMessage;
-                }
-                else
-                {
-                    if(receivedCharacter == '\r')
-                    {
-                        // Expected. Disregarded
-                    }
-                    else
-                    {
-                        Debug_Warning("Bluetooth", "BT_SERIAL_EVENT", "Unknown character");
-                    }
-                }
+                Debug_Warning("Bluetooth", "NegotiateBaudRate", "HC-05 lost after reset");
+                currentBaudRate = BT_HC05_BAUDRATE;
+                BT_SERIAL.begin(BT_HC05_BAUDRATE);
             }
-            delay(10);
+        }
+        else
+        {
+            Debug_Warning("Bluetooth", "NegotiateBaudRate", "HC-05 refused the new baudrate");
         }
     }
 
-    if(hasReceivedMessage)
+    digitalWrite(BT_HC05_KEY_PIN, LOW);
+
+    // - SAVE IT - //
+    if(savedBaudRate != currentBaudRate)
     {
-        return _currentMessage;
+        EEPROM.write(BT_BAUDRATE_EEPROM_ADDRESS, (unsigned char)(currentBaudRate / 1200));
     }
-    return BT_NO_MESSAGE;
+    return currentBaudRate;
 }
 
 /**
@@ -125,6 +514,17 @@ String GetMessage(int millisecondsTimeOut)
  * program inside of the setup function or
  * inside of a wider initialisation function.
  *
+ * @note
+ * When BT_NEGOTIATE_BAUDRATE is defined, the
+ * HC-05 is moved to @ref BT_HC05_FAST_BAUDRATE
+ * through its AT commands. If the module does not
+ * answer at the new baudrate,
+ * @ref BT_HC05_BAUDRATE is used. The selected
+ * baudrate is saved in the EEPROM so that the
+ * next boot tries it first. The HC-05's
+ * baudrate only concerns its UART so each
+ * device negotiates with its own module.
+ *
  * @return true:
  * Bluetooth was successfully initialised
  * @return false:
@@ -132,24 +532,179 @@ String GetMessage(int millisecondsTimeOut)
  */
 bool BT_Init()
 {
-    BT_SERIAL.begin(BT_HC05_BAUDRATE);
+#ifdef BT_NEGOTIATE_BAUDRATE
+    _baudRate = NegotiateBaudRate();
+#else
+    _baudRate = BT_HC05_BAUDRATE;
+    BT_SERIAL.begin(_baudRate);
+#endif
+    Debug_Information("Bluetooth", "BT_Init", "Baudrate: " + String(_baudRate));
+
+#ifdef BT_USE_STATE_PIN
+    pinMode(BT_HC05_STATE_PIN, INPUT);
+#endif
+    // The other device gets a full silence period to be heard from.
+    _lastReceivedTime_ms = millis();
+    return true;
+}
+
+/**
+ * @brief
+ * Returns the baudrate that @ref BT_Init
+ * selected for the HC-05.
+ * @return unsigned long:
+ * 0 if Bluetooth is not initialised.
+ */
+unsigned long BT_GetBaudRate()
+{
+    return _baudRate;
+}
+
+/**
+ * @brief Simple function that sends a frame
+ * through UART to the initialised Bluetooth
+ * module with a sequence number. Commands carry
+ * their own sequence number and answers carry
+ * the one of the command they answer.
+ * The frame is queued and sent in the
+ * background so this never waits after the
+ * UART. See @ref BT_Flush
+ * @param opcode
+ * One of the COMMAND_ or ANSWER_ defines.
+ * @param sequence
+ * Sequence number of the frame or
+ * @ref PROTOCOL_NO_SEQUENCE
+ * @param payload
+ * Bytes sent with the opcode. Can be 0 if
+ * length is 0.
+ * @param length
+ * How many bytes of payload there is.
+ * @return true:
+ * The frame was queued successfully.
+ * @return false:
+ * Failed to queue the frame.
+ */
+bool BT_SendSequencedFrame(unsigned char opcode, unsigned char sequence, const unsigned char* payload, unsigned char length)
+{
+    return QueueFrame(BT_Channel::Control, opcode, sequence, payload, length, false);
+}
+
+/**
+ * @brief Simple function that sends a frame
+ * through UART to the initialised Bluetooth
+ * module without a sequence number. Used for
+ * events and text frames.
+ * @param opcode
+ * One of the COMMAND_ or ANSWER_ defines.
+ * @param payload
+ * Bytes sent with the opcode. Can be 0 if
+ * length is 0.
+ * @param length
+ * How many bytes of payload there is.
+ * @return true:
+ * The frame was queued successfully.
+ * @return false:
+ * Failed to queue the frame.
+ */
+bool BT_SendFrame(unsigned char opcode, const unsigned char* payload, unsigned char length)
+{
+    return BT_SendSequencedFrame(opcode, PROTOCOL_NO_SEQUENCE, payload, length);
+}
+
+/**
+ * @brief
+ * Same as @ref BT_SendFrame but the payload is
+ * read from flash. Lets constant payloads be
+ * sent without ever being copied in RAM.
+ * @param opcode
+ * One of the COMMAND_, ANSWER_ or EVENT_ defines.
+ * @param payload
+ * PROGMEM bytes sent with the opcode. Can be 0 if
+ * length is 0.
+ * @param length
+ * How many bytes of payload there is.
+ * @return true:
+ * The frame was queued successfully.
+ * @return false:
+ * Failed to queue the frame.
+ */
+bool BT_SendFrame_P(unsigned char opcode, const unsigned char* payload, unsigned char length)
+{
+    return QueueFrame(BT_Channel::Control, opcode, PROTOCOL_NO_SEQUENCE, payload, length, true);
+}
+
+/**
+ * @brief
+ * Blocks until every queued byte has been sent
+ * by the UART. Only needed when something must
+ * be sent before going on, such as before
+ * changing the UART's baudrate.
+ */
+void BT_Flush()
+{
+    while(_txRingTail != _txRingHead || _telemetryRingTail != _telemetryRingHead)
+    {
+        SendQueuedBytes();
+    }
+    BT_SERIAL.flush();
+}
+
+/**
+ * @brief
+ * Sends a telemetry frame on
+ * @ref BT_Channel::Telemetry. It is only sent
+ * once no control frame is waiting. When its
+ * queue is full, the link is saturated and the
+ * frame is dropped instead of delaying anything.
+ * @param opcode
+ * A telemetry opcode, from
+ * @ref PROTOCOL_FIRST_TELEMETRY_OPCODE up to
+ * @ref PROTOCOL_FIRST_EVENT_OPCODE
+ * @param payload
+ * Bytes sent with the opcode. Can be 0 if
+ * length is 0.
+ * @param length
+ * How many bytes of payload there is.
+ * @return true:
+ * The frame was queued.
+ * @return false:
+ * The opcode is not a telemetry one or the
+ * frame was dropped.
+ */
+bool BT_SendTelemetry(unsigned char opcode, const unsigned char* payload, unsigned char length)
+{
+    // - PRELIMINARY CHECKS - //
+    // Telemetry is dropped and never answered. Commands, answers and events must not go through here.
+    if(opcode < PROTOCOL_FIRST_TELEMETRY_OPCODE || opcode >= PROTOCOL_FIRST_EVENT_OPCODE)
+    {
+        Debug_Error("Bluetooth", "BT_SendTelemetry", "Not a telemetry opcode: " + String(opcode));
+        return false;
+    }
+
+    // - FUNCTION EXECUTION - //
+    if(!BT_LinkIsUp() || !QueueFrame(BT_Channel::Telemetry, opcode, PROTOCOL_NO_SEQUENCE, payload, length, false))
+    {
+        _stats.telemetryDropped++;
+        return false;
+    }
     return true;
 }
 
 /**
  * @brief Simple function that sends a string
  * through UART to the initialised Bluetooth
- * module to be sent to SafeBox.
+ * module as a @ref PROTOCOL_OPCODE_TEXT frame.
+ * Commands and answers should be sent with
+ * @ref BT_SendFrame instead.
  * @param message
  * A string containing the message that needs
- * to be sent to SafeBox. All messages must be
- * stored as DEFINES.
+ * to be sent.
  * @return true:
  * The message was sent successfully.
  * @return false:
  * Failed to send the message.
  */
-bool BT_SendString(String message)
+bool BT_SendString(const String& message)
 {
     Debug_Start("BT_SendString");
     // - PRELIMINARY CHECKS - //
@@ -162,13 +717,9 @@ bool BT_SendString(String message)
 
     // - FUNCTION EXECUTION - //
     Debug_Information("Bluetooth", "BT_SendString", message);
-    unsigned int byteSent = BT_SERIAL.println(message);
-    BT_SERIAL.flush();
-
-    // - AFTERMATH CHECKS - //
-    if (byteSent < message.length())
+    if(!BT_SendFrame(PROTOCOL_OPCODE_TEXT, (const unsigned char*)message.c_str(), message.length()))
     {
-        Debug_Error("Bluetooth", "BT_SendString", "Not enough bytes sent");
+        Debug_Error("Bluetooth", "BT_SendString", "Failed to send text frame");
         Debug_End();
         return false;
     }
@@ -177,12 +728,6 @@ bool BT_SendString(String message)
 }
 
 /**
- * @deprecated
- * Arduino sucks with stack and memory management.
- * It fails to tell us whenever it runs out of
- * memory. Coordially, screw you Arduino. I wish
- * you were an STM. 
- * 
  * @brief Simple function that checks how many
  * messages are currently available for reading
  * and parsing inside of the UART buffer where
@@ -192,24 +737,8 @@ bool BT_SendString(String message)
  */
 int BT_MessagesAvailable()
 {
-    unsigned char messageCount = 0;
-
-    // ARDUINO CANT HANDLE ITS MEMORY FOR SHIT
-    return 1;
-
-    for (unsigned char messageIndex=0; messageIndex<BT_SIZE_OF_MESSAGE_BUFFER; messageIndex++)
-    {
-        if(MessageBuffer("", messageIndex, 2) == String("F"))
-        {
-            messageCount++;
-        }
-        else
-        {
-            // Buffer is no longer full. No point in continuing to check other indexes.
-            return messageCount;
-        }
-    }
-    return 1;
+    BT_Poll();
+    return _rxFramesCount;
 }
 
 /**
@@ -225,31 +754,20 @@ int BT_MessagesAvailable()
  */
 bool BT_ClearAllMessages()
 {
+    BT_Poll();
+    _rxFramesCount = 0;
+    _rxFramesOldest = 0;
+    _messageReceived = false;
     return true;
 }
 
 /**
- * @deprecated
- * Arduino sucks with stack and memory management.
- * It fails to tell us whenever it runs out of
- * memory. Coordially, screw you Arduino. I wish
- * you were an STM.
- * 
  * @brief Will block the program for a specified
  * amount of milliseconds unless a Bluetooth
  * message is received during the specified time
  * reception window. If no messages is detected,
  * the function will return a fail.
  *
- * @bug
- * If the program runs for ~49 days, there is a
- * small window where, if this function is called
- * it will immediately timeout because the millis
- * value + the timeout in milliseconds will be
- * bigger than the max value of an unsigned long.
- * This is not fixed because it can't happen for
- * our project.
- *
  * @param millisecondsTimeOut
  * How long should the program wait for a message
  * @return true:
@@ -263,135 +781,315 @@ bool BT_WaitForAMessage(int millisecondsTimeOut)
 {
     Debug_Start("BT_WaitForAMessage");
     // - VARIABLES - //
-    unsigned long currentTime = millis();
-    unsigned long timeOutTime = currentTime + millisecondsTimeOut;
-    int messagesReceived = BT_MessagesAvailable();
+    unsigned long startTime = millis();
 
-    // - PRELIMINARY CHECKS - //
-    if(messagesReceived > 0)
+    do
     {
-        // Why wait for a message when there is already some waiting for you?
-        Debug_End();
-        return true;
-    }
-
-    if(timeOutTime < currentTime)
-    {
-        Debug_Error("Bluetooth", "BT_WaitForAMessage", "Time out millis overflow. (How tf did you manage that?)");
-        Debug_End();
-        return false;
-    }
-
-    while(currentTime < timeOutTime)
-    {
-        currentTime = millis();
-        messagesReceived = BT_MessagesAvailable();
-        if(messagesReceived > 0)
-        {
-            // Less go, we finally got some messages fr
-            Debug_End();
-            return true;
-        }
-
-        if(_messageReceived)
+        if(BT_MessagesAvailable() > 0)
         {
-            // FOUND MESSAGE LESS GO
-            Debug_Information("Bluetooth", "BT_WaitForAMessage", "Flag raised");
             Debug_End();
             return true;
         }
     }
+    while((millis() - startTime) < (unsigned long)millisecondsTimeOut);
+
     Debug_Warning("Bluetooth", "BT_WaitForAMessage", "Timedout");
     Debug_End();
     return false;
 }
 
 /**
- * @brief Returns a string which corresponds to
- * the oldest message stored in the reception
- * buffer of the device. If there is no messages
- * available, the string will be empty
- *
- * @attention
- * This function calls @ref BT_MessagesAvailable
- * and returns @ref BT_NO_MESSAGE if there is no
- * available message to return.
- *
- * @warning
- * THIS WILL AUTOMATICALLY CLEAR THE BUFFER
- * OF THE LATEST MESSAGE.
+ * @brief
+ * Copies the oldest complete frame stored in the
+ * frame buffer inside of the specified frame
+ * and removes it from the frame buffer. This
+ * does not use any String nor the heap.
  *
- * @return string: The oldest message stored in
- * the reception buffer.
+ * @param frame
+ * Frame in which the oldest frame is copied.
+ * @return true:
+ * A frame was copied.
+ * @return false:
+ * There was no frame to get.
+ */
+bool BT_GetLatestFrame(Protocol_Frame* frame)
+{
+    // - PRELIMINARY CHECKS - //
+    if(frame == 0) return false;
+    if(_rxFramesCount == 0) return false;
+
+    // - FUNCTION EXECUTION - //
+    memcpy(frame, &_rxFrames[_rxFramesOldest], sizeof(Protocol_Frame));
+
+    _rxFramesOldest = (_rxFramesOldest + 1) % BT_SIZE_OF_MESSAGE_BUFFER;
+    _rxFramesCount--;
+    if(_rxFramesCount == 0) _messageReceived = false;
+    return true;
+}
+
+// #pragma region [Link_State]
+
+/**
+ * @brief
+ * Tells if the HC-05 is paired with the other
+ * device. When BT_USE_STATE_PIN is defined, this
+ * is the module's STATE output. Otherwise the
+ * link is considered down when nothing was
+ * received for @ref BT_LINK_SILENCE_MS.
+ * Updated by @ref BT_Poll.
+ * @return true:
+ * The link is up.
+ * @return false:
+ * The link is down. Anything sent is lost.
+ */
+bool BT_LinkIsUp()
+{
+    return _linkIsUp;
+}
+
+/**
+ * @brief
+ * Tells once that the link went up or down since
+ * the last call. Use @ref BT_LinkIsUp to know
+ * which one.
+ * @return true:
+ * The link state changed.
+ * @return false:
+ * The link state did not change.
  */
-String BT_GetLatestMessage()
+bool BT_LinkStateChanged()
+{
+    if(!_linkStateChanged) return false;
+    _linkStateChanged = false;
+    return true;
+}
+
+// #pragma endregion
+
+// #pragma region [Statistics]
+
+/**
+ * @brief
+ * Returns the statistics of the specified
+ * command's opcode.
+ * @param opcode
+ * One of the COMMAND_ defines.
+ * @return BT_CommandStats*:
+ * Slot 0 if the opcode does not have its own.
+ */
+BT_CommandStats* GetCommandStats(unsigned char opcode)
+{
+    if(opcode >= BT_STATS_COMMAND_SLOTS) opcode = 0;
+    return &_stats.commands[opcode];
+}
+
+/**
+ * @brief
+ * Returns the statistics of the Bluetooth link.
+ * @return const BT_Stats*:
+ * Always valid. Updated as the link is used.
+ */
+const BT_Stats* BT_GetStats()
+{
+    _stats.framesRejected = _rxDecoder.rejectedFrames;
+    return &_stats;
+}
+
+/**
+ * @brief
+ * Sets every statistic of the Bluetooth link
+ * back to 0.
+ */
+void BT_ResetStats()
+{
+    memset(&_stats, 0, sizeof(BT_Stats));
+    _rxDecoder.rejectedFrames = 0;
+}
+
+/**
+ * @brief
+ * Saves that a command got its answer and how
+ * long it took in the statistics.
+ * @param opcode
+ * One of the COMMAND_ defines.
+ * @param roundTrip_ms
+ * Time from when the command was first sent to
+ * when its answer was received.
+ */
+void BT_RecordRoundTrip(unsigned char opcode, unsigned long roundTrip_ms)
+{
+    // - VARIABLES - //
+    unsigned char bucket = 0;
+    unsigned long scaledRoundTrip = roundTrip_ms / BT_STATS_FIRST_BUCKET_MS;
+
+    // - FUNCTION EXECUTION - //
+    while(scaledRoundTrip > 0 && bucket < (BT_STATS_ROUND_TRIP_BUCKETS - 1))
+    {
+        scaledRoundTrip >>= 1;
+        bucket++;
+    }
+
+    if(_stats.roundTripHistogram[bucket] < 0xFFFF) _stats.roundTripHistogram[bucket]++;
+    GetCommandStats(opcode)->completed++;
+}
+
+/**
+ * @brief
+ * Saves that a command was retransmitted in the
+ * statistics.
+ * @param opcode
+ * One of the COMMAND_ defines.
+ */
+void BT_RecordRetry(unsigned char opcode)
+{
+    GetCommandStats(opcode)->retries++;
+}
+
+/**
+ * @brief
+ * Saves that a command never got its answer in
+ * the statistics.
+ * @param opcode
+ * One of the COMMAND_ defines.
+ */
+void BT_RecordTimeout(unsigned char opcode)
+{
+    GetCommandStats(opcode)->timeouts++;
+}
+
+/**
+ * @brief
+ * Encodes the link counters and the round trip
+ * time histogram so that they can be sent as a
+ * payload. Counters take 4 bytes and histogram
+ * buckets take 2, least significant byte first.
+ * @param buffer
+ * Where the statistics are encoded.
+ * @param bufferSize
+ * Size in bytes of the buffer.
+ * @return unsigned char:
+ * How many bytes were encoded. 0 if the buffer
+ * is too small.
+ */
+unsigned char BT_EncodeStats(unsigned char* buffer, unsigned char bufferSize)
 {
     // - VARIABLES - //
-    int availableMessages = 0;
-    String oldestMessage = BT_NO_MESSAGE;
+    unsigned char index = 0;
+    unsigned long counters[4];
 
     // - PRELIMINARY CHECKS - //
-    availableMessages = BT_MessagesAvailable();
-    if(availableMessages == 0) return BT_NO_MESSAGE;
+    if(buffer == 0 || bufferSize < BT_STATS_ENCODED_LENGTH) return 0;
 
     // - FUNCTION EXECUTION - //
-    oldestMessage = GetMessage(500);
-    return oldestMessage;
+    BT_GetStats();
+    counters[0] = _stats.framesSent;
+    counters[1] = _stats.framesReceived;
+    counters[2] = _stats.framesRejected;
+    counters[3] = _stats.framesDropped;
+
+    for(unsigned char i = 0; i < 4; i++)
+    {
+        for(unsigned char shift = 0; shift < 32; shift += 8)
+        {
+            buffer[index++] = (unsigned char)(counters[i] >> shift);
+        }
+    }
+
+    for(unsigned char i = 0; i < BT_STATS_ROUND_TRIP_BUCKETS; i++)
+    {
+        buffer[index++] = (unsigned char)(_stats.roundTripHistogram[i]);
+        buffer[index++] = (unsigned char)(_stats.roundTripHistogram[i] >> 8);
+    }
+    return index;
 }
 
 /**
- * @brief Function that firstly clears the UART
- * buffer to empty it of any messages, then sends
- * a specified message to the UART Bluetooth
- * module. Once that is done, the function waits
- * for a message to be received to return it or
- * waits for the timeout to reach its specified
- * value.
- *
- * @attention
- * Its recommended to use this function rather
- * than the other BT functions as this one
- * handles everything there is to handle.
- *
- * @warning
- * This function automatically calls
- * @ref BT_BeforeCommsEvent
- * @ref BT_CommsSuccessEvent
- * @ref BT_CommsFailedEvent
- *
- * @param message
- * A string containing the message that needs
- * to be sent to SafeBox. All messages must be
- * stored as DEFINES.
- * @param millisecondsTimeOut
- * How long should the program wait for a message
- * @return string: The received message from
- * SafeBox.
+ * @brief
+ * Decodes statistics encoded by
+ * @ref BT_EncodeStats. The statistics per
+ * command are not encoded and are set to 0.
+ * @param buffer
+ * The encoded statistics.
+ * @param length
+ * How many bytes there is in the buffer.
+ * @param stats
+ * Where the statistics are decoded.
+ * @return true:
+ * The statistics were decoded.
+ * @return false:
+ * The buffer is too short.
  */
-String BT_MessageExchange(String message, int millisecondsTimeOut)
+bool BT_DecodeStats(const unsigned char* buffer, unsigned char length, BT_Stats* stats)
 {
-    Debug_Start("BT_MessageExchange");
-    // Firstly send the message.
-    _messageReceived = false;
-    if(!BT_SendString(message))
+    // - VARIABLES - //
+    unsigned char index = 0;
+    unsigned long counters[4];
+
+    // - PRELIMINARY CHECKS - //
+    if(buffer == 0 || stats == 0 || length < BT_STATS_ENCODED_LENGTH) return false;
+
+    // - FUNCTION EXECUTION - //
+    memset(stats, 0, sizeof(BT_Stats));
+
+    for(unsigned char i = 0; i < 4; i++)
     {
-        Debug_Error("Bluetooth", "BT_MessageExchange", "TX failure");
-        Debug_End();
-        return BT_ERROR_MESSAGE;
+        counters[i] = 0;
+        for(unsigned char shift = 0; shift < 32; shift += 8)
+        {
+            counters[i] |= ((unsigned long)buffer[index++]) << shift;
+        }
     }
+    stats->framesSent = counters[0];
+    stats->framesReceived = counters[1];
+    stats->framesRejected = counters[2];
+    stats->framesDropped = counters[3];
+
+    for(unsigned char i = 0; i < BT_STATS_ROUND_TRIP_BUCKETS; i++)
+    {
+        stats->roundTripHistogram[i] = buffer[index] | (buffer[index + 1] << 8);
+        index += 2;
+    }
+    return true;
+}
+
+/**
+ * @brief
+ * Prints statistics of the Bluetooth link on the
+ * debug serial port. Only the commands that were
+ * used are printed.
+ * @param stats
+ * Statistics to print. Usually
+ * @ref BT_GetStats
+ */
+void BT_PrintStats(const BT_Stats* stats)
+{
+    // - VARIABLES - //
+    String histogram = "";
+    unsigned long bucketLimit = BT_STATS_FIRST_BUCKET_MS;
+    const BT_CommandStats* command = 0;
+
+    // - PRELIMINARY CHECKS - //
+    if(stats == 0) return;
 
-    String receivedBTMessage = GetMessage(millisecondsTimeOut);
+    // - FUNCTION EXECUTION - //
+    Debug_Information("Bluetooth", "BT_PrintStats", "TX: " + String(stats->framesSent) + " RX: " + String(stats->framesReceived) + " Rejected: " + String(stats->framesRejected) + " Dropped: " + String(stats->framesDropped));
+    Debug_Information("Bluetooth", "BT_PrintStats", "Control: " + String(stats->channelBytes[(unsigned char)BT_Channel::Control]) + "B Telemetry: " + String(stats->channelBytes[(unsigned char)BT_Channel::Telemetry]) + "B Telemetry dropped: " + String(stats->telemetryDropped));
 
-    // WARNING: Could already be a message in the buffer. Be careful to check for that.
-    if(receivedBTMessage == BT_NEVER_RECEIVED_MESSAGE)
+    for(unsigned char i = 0; i < BT_STATS_ROUND_TRIP_BUCKETS; i++)
     {
-        Debug_Warning("Bluetooth", "BT_MessageExchange", "Failed to get a reply");
-        Debug_End();
-        return BT_ERROR_MESSAGE;
+        if(i == BT_STATS_ROUND_TRIP_BUCKETS - 1) histogram += ">=" + String(bucketLimit / 2) + "ms:";
+        else histogram += "<" + String(bucketLimit) + "ms:";
+        histogram += String(stats->roundTripHistogram[i]) + " ";
+        bucketLimit *= 2;
     }
-    else
+    Debug_Information("Bluetooth", "BT_PrintStats", histogram);
+
+    for(unsigned char opcode = 0; opcode < BT_STATS_COMMAND_SLOTS; opcode++)
     {
-        Debug_End();
-        return receivedBTMessage;
+        command = &stats->commands[opcode];
+        if(command->completed == 0 && command->retries == 0 && command->timeouts == 0) continue;
+        Debug_Information("Bluetooth", "BT_PrintStats", "Command " + String(opcode) + " OK: " + String(command->completed) + " Retries: " + String(command->retries) + " Timeouts: " + String(command->timeouts));
     }
 }
+
+// #pragma endregion
@@ -0,0 +1,252 @@
+/**
+ * @file ClockSync.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * File containing the functions that estimate
+ * the offset and drift in between XFactor's and
+ * SafeBox's millis() clocks, the same way NTP
+ * does. Samples are taken from the
+ * timestamps carried by the status exchange.
+ * Out of the last few samples, the one with the
+ * shortest round trip is trusted since its
+ * delays are the least asymmetric.
+ *
+ * @attention
+ * This file is shared by XFactor and SafeBox.
+ * Both copies must stay identical.
+ * @version 0.1
+ * @date 2023-12-03
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Communication/ClockSync.hpp"
+
+// - GLOBAL LOCAL ACCESS - //
+/// @brief Latest samples. Overwritten oldest first.
+ClockSync_Sample _samples[CLOCKSYNC_SAMPLES];
+unsigned char _sampleCount = 0;
+unsigned char _nextSample = 0;
+
+/// @brief Sample that the offset is currently read from.
+ClockSync_Sample _trusted = {0, 0, 0};
+unsigned int _trustedAccuracy_ms = CLOCKSYNC_UNKNOWN_ACCURACY;
+bool _isSynced = false;
+
+/// @brief Sample that the next drift measurement is compared with.
+ClockSync_Sample _driftReference = {0, 0, 0};
+/// @brief How many milliseconds the offset changes by per local millisecond.
+float _drift = 0;
+bool _driftIsKnown = false;
+
+/**
+ * @brief
+ * Writes a millis() time in 4 bytes, least
+ * significant byte first.
+ * @param time_ms
+ * The time to encode.
+ * @param buffer
+ * Where the 4 bytes are written.
+ */
+void ClockSync_EncodeTime(unsigned long time_ms, unsigned char* buffer)
+{
+    for(unsigned char i = 0; i < CLOCKSYNC_ENCODED_TIME_LENGTH; i++)
+    {
+        buffer[i] = (unsigned char)(time_ms >> (i * 8));
+    }
+}
+
+/**
+ * @brief
+ * Reads a millis() time written by
+ * @ref ClockSync_EncodeTime
+ * @param buffer
+ * The 4 encoded bytes.
+ * @return unsigned long:
+ * The decoded time.
+ */
+unsigned long ClockSync_DecodeTime(const unsigned char* buffer)
+{
+    // - VARIABLES - //
+    unsigned long time_ms = 0;
+
+    for(unsigned char i = 0; i < CLOCKSYNC_ENCODED_TIME_LENGTH; i++)
+    {
+        time_ms |= ((unsigned long)buffer[i]) << (i * 8);
+    }
+    return time_ms;
+}
+
+/**
+ * @brief
+ * Adds a round trip to the estimate. The peer
+ * is assumed to have read its clock half way
+ * through the round trip. Round trips longer
+ * than @ref CLOCKSYNC_MAX_ROUND_TRIP_MS are
+ * ignored.
+ * @param localSent_ms
+ * Local millis() when the request was sent.
+ * @param peer_ms
+ * The peer's millis() when it answered.
+ * @param localReceived_ms
+ * Local millis() when the answer was received.
+ */
+void ClockSync_SaveSample(unsigned long localSent_ms, unsigned long peer_ms, unsigned long localReceived_ms)
+{
+    // - VARIABLES - //
+    ClockSync_Sample* sample = &_samples[_nextSample];
+    const ClockSync_Sample* trusted = 0;
+    float measuredDrift = 0;
+
+    // - PRELIMINARY CHECKS - //
+    if(localReceived_ms - localSent_ms > CLOCKSYNC_MAX_ROUND_TRIP_MS) return;
+
+    // - SAVE THE SAMPLE - //
+    // Computed unsigned so that clocks far apart wrap around instead of overflowing.
+    sample->roundTrip_ms = localReceived_ms - localSent_ms;
+    sample->offset_ms = (long)(peer_ms - localSent_ms - sample->roundTrip_ms / 2);
+    sample->time_ms = localReceived_ms;
+    _nextSample = (_nextSample + 1) % CLOCKSYNC_SAMPLES;
+    if(_sampleCount < CLOCKSYNC_SAMPLES) _sampleCount++;
+
+    // - PICK THE TRUSTED SAMPLE - //
+    trusted = &_samples[0];
+    for(unsigned char i = 1; i < _sampleCount; i++)
+    {
+        if(_samples[i].roundTrip_ms < trusted->roundTrip_ms) trusted = &_samples[i];
+    }
+
+    // - DRIFT - //
+    if(!_isSynced)
+    {
+        _driftReference = *trusted;
+    }
+    else if((trusted->time_ms - _driftReference.time_ms) >= CLOCKSYNC_MIN_DRIFT_INTERVAL_MS)
+    {
+        measuredDrift = (float)(long)((unsigned long)trusted->offset_ms - (unsigned long)_driftReference.offset_ms) / (float)(trusted->time_ms - _driftReference.time_ms);
+        _drift = _driftIsKnown ? (_drift * 7 + measuredDrift) / 8 : measuredDrift;
+        _driftIsKnown = true;
+        _driftReference = *trusted;
+    }
+
+    _trusted = *trusted;
+    _trustedAccuracy_ms = trusted->roundTrip_ms / 2;
+    _isSynced = true;
+}
+
+/**
+ * @brief
+ * Uses the estimate that the peer made of the
+ * offset instead of measuring it. Used by the
+ * device that only answers the exchanges.
+ * @param peerOffset_ms
+ * The peer's estimate of this device's millis()
+ * minus its own.
+ * @param peerAccuracy_ms
+ * The accuracy of the peer's estimate or
+ * @ref CLOCKSYNC_UNKNOWN_ACCURACY
+ */
+void ClockSync_SetFromPeer(long peerOffset_ms, unsigned int peerAccuracy_ms)
+{
+    if(peerAccuracy_ms == CLOCKSYNC_UNKNOWN_ACCURACY) return;
+
+    _trusted.offset_ms = (long)(0UL - (unsigned long)peerOffset_ms);
+    _trusted.roundTrip_ms = 0;
+    _trusted.time_ms = millis();
+    _trustedAccuracy_ms = peerAccuracy_ms;
+    // The peer follows the drift and sends its estimate often.
+    _drift = 0;
+    _isSynced = true;
+}
+
+/**
+ * @brief
+ * Forgets every sample. The clocks are no
+ * longer synced until new samples are saved.
+ */
+void ClockSync_Reset()
+{
+    _sampleCount = 0;
+    _nextSample = 0;
+    _drift = 0;
+    _driftIsKnown = false;
+    _isSynced = false;
+}
+
+/**
+ * @brief
+ * Tells if the offset in between the clocks is
+ * known.
+ * @return true:
+ * The conversions can be used.
+ * @return false:
+ * No samples were saved yet.
+ */
+bool ClockSync_IsSynced()
+{
+    return _isSynced;
+}
+
+/**
+ * @brief
+ * Returns the current estimate of the peer's
+ * millis() minus the local millis(), drift
+ * included.
+ * @return long:
+ * Offset in milliseconds. 0 if not synced.
+ */
+long ClockSync_GetOffset()
+{
+    if(!_isSynced) return 0;
+    return _trusted.offset_ms + (long)(_drift * (float)(millis() - _trusted.time_ms));
+}
+
+/**
+ * @brief
+ * Returns how far off the offset can be. Half
+ * the round trip of the trusted sample plus what
+ * the drift could have added since.
+ * @return unsigned int:
+ * Accuracy in milliseconds or
+ * @ref CLOCKSYNC_UNKNOWN_ACCURACY if not synced.
+ */
+unsigned int ClockSync_GetAccuracy()
+{
+    // - VARIABLES - //
+    float accuracy_ms = 0;
+
+    if(!_isSynced) return CLOCKSYNC_UNKNOWN_ACCURACY;
+
+    accuracy_ms = _trustedAccuracy_ms + fabs(_drift) * (float)(millis() - _trusted.time_ms);
+    if(accuracy_ms >= CLOCKSYNC_UNKNOWN_ACCURACY) return CLOCKSYNC_UNKNOWN_ACCURACY - 1;
+    return (unsigned int)accuracy_ms;
+}
+
+/**
+ * @brief
+ * Converts a time read on the peer's millis()
+ * into the local millis().
+ * @param peer_ms
+ * The peer's time.
+ * @return unsigned long:
+ * The same instant on the local clock.
+ */
+unsigned long Peer_MillisToLocal(unsigned long peer_ms)
+{
+    return peer_ms - (unsigned long)ClockSync_GetOffset();
+}
+
+/**
+ * @brief
+ * Converts a time read on the local millis()
+ * into the peer's millis(). Lets a command ask
+ * the peer to do something at a given instant.
+ * @param local_ms
+ * The local time.
+ * @return unsigned long:
+ * The same instant on the peer's clock.
+ */
+unsigned long Local_MillisToPeer(unsigned long local_ms)
+{
+    return local_ms + (unsigned long)ClockSync_GetOffset();
+}
@@ -0,0 +1,306 @@
+/**
+ * @file Protocol.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * File containing the encoder and decoder of the
+ * binary frames sent between XFactor and SafeBox
+ * over Bluetooth. A frame is made of a sync byte,
+ * an opcode, a sequence number, the length of
+ * its payload, the payload itself and a CRC-8 of
+ * everything but the sync byte.
+ *
+ * @attention
+ * This file is shared by XFactor and SafeBox.
+ * Both copies must stay identical.
+ * @version 0.1
+ * @date 2023-11-29
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Communication/Protocol.hpp"
+
+/**
+ * @brief
+ * CRC-8 of every possible byte with polynomial
+ * 0x07. Stored in flash so that computing a
+ * frame's CRC costs a single lookup per byte.
+ */
+const unsigned char _crc8Table[256] PROGMEM = {
+    0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15, 0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D,
+    0x70, 0x77, 0x7E, 0x79, 0x6C, 0x6B, 0x62, 0x65, 0x48, 0x4F, 0x46, 0x41, 0x54, 0x53, 0x5A, 0x5D,
+    0xE0, 0xE7, 0xEE, 0xE9, 0xFC, 0xFB, 0xF2, 0xF5, 0xD8, 0xDF, 0xD6, 0xD1, 0xC4, 0xC3, 0xCA, 0xCD,
+    0x90, 0x97, 0x9E, 0x99, 0x8C, 0x8B, 0x82, 0x85, 0xA8, 0xAF, 0xA6, 0xA1, 0xB4, 0xB3, 0xBA, 0xBD,
+    0xC7, 0xC0, 0xC9, 0xCE, 0xDB, 0xDC, 0xD5, 0xD2, 0xFF, 0xF8, 0xF1, 0xF6, 0xE3, 0xE4, 0xED, 0xEA,
+    0xB7, 0xB0, 0xB9, 0xBE, 0xAB, 0xAC, 0xA5, 0xA2, 0x8F, 0x88, 0x81, 0x86, 0x93, 0x94, 0x9D, 0x9A,
+    0x27, 0x20, 0x29, 0x2E, 0x3B, 0x3C, 0x35, 0x32, 0x1F, 0x18, 0x11, 0x16, 0x03, 0x04, 0x0D, 0x0A,
+    0x57, 0x50, 0x59, 0x5E, 0x4B, 0x4C, 0x45, 0x42, 0x6F, 0x68, 0x61, 0x66, 0x73, 0x74, 0x7D, 0x7A,
+    0x89, 0x8E, 0x87, 0x80, 0x95, 0x92, 0x9B, 0x9C, 0xB1, 0xB6, 0xBF, 0xB8, 0xAD, 0xAA, 0xA3, 0xA4,
+    0xF9, 0xFE, 0xF7, 0xF0, 0xE5, 0xE2, 0xEB, 0xEC, 0xC1, 0xC6, 0xCF, 0xC8, 0xDD, 0xDA, 0xD3, 0xD4,
+    0x69, 0x6E, 0x67, 0x60, 0x75, 0x72, 0x7B, 0x7C, 0x51, 0x56, 0x5F, 0x58, 0x4D, 0x4A, 0x43, 0x44,
+    0x19, 0x1E, 0x17, 0x10, 0x05, 0x02, 0x0B, 0x0C, 0x21, 0x26, 0x2F, 0x28, 0x3D, 0x3A, 0x33, 0x34,
+    0x4E, 0x49, 0x40, 0x47, 0x52, 0x55, 0x5C, 0x5B, 0x76, 0x71, 0x78, 0x7F, 0x6A, 0x6D, 0x64, 0x63,
+    0x3E, 0x39, 0x30, 0x37, 0x22, 0x25, 0x2C, 0x2B, 0x06, 0x01, 0x08, 0x0F, 0x1A, 0x1D, 0x14, 0x13,
+    0xAE, 0xA9, 0xA0, 0xA7, 0xB2, 0xB5, 0xBC, 0xBB, 0x96, 0x91, 0x98, 0x9F, 0x8A, 0x8D, 0x84, 0x83,
+    0xDE, 0xD9, 0xD0, 0xD7, 0xC2, 0xC5, 0xCC, 0xCB, 0xE6, 0xE1, 0xE8, 0xEF, 0xFA, 0xFD, 0xF4, 0xF3,
+};
+
+/**
+ * @brief
+ * Adds a byte to a running CRC-8 (polynomial
+ * 0x07). The CRC of a frame starts at 0.
+ * @param crc
+ * CRC of the bytes before this one.
+ * @param data
+ * Byte to add to the CRC.
+ * @return unsigned char:
+ * The new CRC.
+ */
+unsigned char Protocol_CRC8(unsigned char crc, unsigned char data)
+{
+    return pgm_read_byte(&_crc8Table[crc ^ data]);
+}
+
+/**
+ * @brief
+ * Encodes the bytes that come before the payload
+ * of a frame. Used by @ref Protocol_Encode and by
+ * whatever encodes frames somewhere else than in
+ * a buffer, like a ring buffer.
+ * @param opcode
+ * One of the COMMAND_ or ANSWER_ defines.
+ * @param sequence
+ * Sequence number of the frame or
+ * @ref PROTOCOL_NO_SEQUENCE
+ * @param length
+ * How many bytes of payload follow.
+ * @param header
+ * Buffer of @ref PROTOCOL_HEADER_LENGTH bytes in
+ * which the header is encoded.
+ * @return unsigned char:
+ * CRC of the header. Add each payload byte to it
+ * with @ref Protocol_CRC8 and send it last.
+ */
+unsigned char Protocol_EncodeHeader(unsigned char opcode, unsigned char sequence, unsigned char length, unsigned char* header)
+{
+    // - VARIABLES - //
+    unsigned char crc = 0;
+
+    // - FUNCTION EXECUTION - //
+    header[0] = PROTOCOL_SYNC_BYTE;
+    header[1] = opcode;
+    header[2] = sequence;
+    header[3] = length;
+    crc = Protocol_CRC8(crc, opcode);
+    crc = Protocol_CRC8(crc, sequence);
+    crc = Protocol_CRC8(crc, length);
+    return crc;
+}
+
+/**
+ * @brief
+ * Encodes a frame in the specified buffer so
+ * that it can be sent as is.
+ *
+ * @param opcode
+ * One of the COMMAND_ or ANSWER_ defines.
+ * @param sequence
+ * Sequence number of the frame or
+ * @ref PROTOCOL_NO_SEQUENCE
+ * @param payload
+ * Bytes sent with the opcode. Can be 0 if
+ * length is 0.
+ * @param length
+ * How many bytes of payload there is.
+ * @param buffer
+ * Buffer in which the frame is encoded.
+ * @param bufferSize
+ * Size in bytes of the specified buffer.
+ * @return unsigned char:
+ * How many bytes were encoded. 0 if the payload
+ * or the buffer were too small.
+ */
+unsigned char Protocol_Encode(unsigned char opcode, unsigned char sequence, const unsigned char* payload, unsigned char length, unsigned char* buffer, unsigned char bufferSize)
+{
+    // - VARIABLES - //
+    unsigned char crc = 0;
+    unsigned char index = 0;
+
+    // - PRELIMINARY CHECKS - //
+    if(length > PROTOCOL_MAX_PAYLOAD_LENGTH) return 0;
+    if(length > 0 && payload == 0) return 0;
+    if(buffer == 0 || bufferSize < (length + PROTOCOL_FRAME_OVERHEAD)) return 0;
+
+    // - FUNCTION EXECUTION - //
+    crc = Protocol_EncodeHeader(opcode, sequence, length, buffer);
+    index = PROTOCOL_HEADER_LENGTH;
+
+    for(unsigned char i = 0; i < length; i++)
+    {
+        buffer[index++] = payload[i];
+        crc = Protocol_CRC8(crc, payload[i]);
+    }
+
+    buffer[index++] = crc;
+    return index;
+}
+
+/**
+ * @brief
+ * Puts a decoder back in a state where it waits
+ * for the start of a new frame.
+ * @param decoder
+ * The decoder to reset.
+ */
+void Protocol_ResetDecoder(Protocol_Decoder* decoder)
+{
+    decoder->state = Protocol_DecoderState::WaitingForSync;
+    decoder->received = 0;
+    decoder->crc = 0;
+}
+
+/**
+ * @brief
+ * Feeds a received byte to a decoder without
+ * looking for a frame in the bytes it discards.
+ * See @ref Protocol_DecodeByte
+ * @param decoder
+ * The decoder that receives the byte.
+ * @param receivedByte
+ * The byte received.
+ * @return true:
+ * A valid frame was completed by this byte.
+ * @return false:
+ * No frame is ready yet.
+ */
+bool DecodeStep(Protocol_Decoder* decoder, unsigned char receivedByte)
+{
+    switch(decoder->state)
+    {
+        case(Protocol_DecoderState::WaitingForSync):
+            if(receivedByte == PROTOCOL_SYNC_BYTE)
+            {
+                decoder->crc = 0;
+                decoder->state = Protocol_DecoderState::WaitingForOpcode;
+            }
+            return false;
+
+        case(Protocol_DecoderState::WaitingForOpcode):
+            decoder->frame.opcode = receivedByte;
+            decoder->crc = Protocol_CRC8(decoder->crc, receivedByte);
+            decoder->state = Protocol_DecoderState::WaitingForSequence;
+            return false;
+
+        case(Protocol_DecoderState::WaitingForSequence):
+            decoder->frame.sequence = receivedByte;
+            decoder->crc = Protocol_CRC8(decoder->crc, receivedByte);
+            decoder->state = Protocol_DecoderState::WaitingForLength;
+            return false;
+
+        case(Protocol_DecoderState::WaitingForLength):
+            if(receivedByte > PROTOCOL_MAX_PAYLOAD_LENGTH)
+            {
+                // Gibberish. Wait for the next frame.
+                decoder->rejectedFrames++;
+                Protocol_ResetDecoder(decoder);
+                return false;
+            }
+            decoder->frame.length = receivedByte;
+            decoder->received = 0;
+            decoder->crc = Protocol_CRC8(decoder->crc, receivedByte);
+            decoder->state = (receivedByte == 0) ? Protocol_DecoderState::WaitingForCRC : Protocol_DecoderState::ReceivingPayload;
+            return false;
+
+        case(Protocol_DecoderState::ReceivingPayload):
+            decoder->frame.payload[decoder->received++] = receivedByte;
+            decoder->crc = Protocol_CRC8(decoder->crc, receivedByte);
+            if(decoder->received >= decoder->frame.length)
+            {
+                decoder->state = Protocol_DecoderState::WaitingForCRC;
+            }
+            return false;
+
+        case(Protocol_DecoderState::WaitingForCRC):
+            decoder->frame.payload[decoder->frame.length] = 0;
+            if(receivedByte != decoder->crc)
+            {
+                decoder->rejectedFrames++;
+                Protocol_ResetDecoder(decoder);
+                return false;
+            }
+            Protocol_ResetDecoder(decoder);
+            return true;
+
+        default:
+            Protocol_ResetDecoder(decoder);
+            return false;
+    }
+}
+
+/**
+ * @brief
+ * Feeds a received byte to a decoder. Once a
+ * whole frame with a valid CRC is received, it
+ * is available in the decoder's frame until the
+ * next byte is fed. Frames with an invalid CRC
+ * or length are discarded and counted in the
+ * decoder's rejectedFrames.
+ * A lost byte makes a frame swallow the start of
+ * the next one. The bytes of a discarded frame
+ * are thus searched for a sync byte, and the
+ * decoder continues from the first one that
+ * starts a frame.
+ *
+ * @param decoder
+ * The decoder that receives the byte.
+ * @param receivedByte
+ * The byte received.
+ * @return true:
+ * A valid frame was completed by this byte.
+ * @return false:
+ * No frame is ready yet.
+ */
+bool Protocol_DecodeByte(Protocol_Decoder* decoder, unsigned char receivedByte)
+{
+    // - VARIABLES - //
+    Protocol_DecoderState state = decoder->state;
+    unsigned long rejectedFrames = decoder->rejectedFrames;
+    unsigned char discarded[PROTOCOL_MAX_FRAME_LENGTH];
+    unsigned char count = 0;
+
+    if(DecodeStep(decoder, receivedByte)) return true;
+    if(decoder->rejectedFrames == rejectedFrames) return false;
+
+    // - DISCARDED BYTES - //
+    // Everything received after the frame's sync byte.
+    discarded[count++] = decoder->frame.opcode;
+    discarded[count++] = decoder->frame.sequence;
+    if(state == Protocol_DecoderState::WaitingForCRC)
+    {
+        discarded[count++] = decoder->frame.length;
+        memcpy(&discarded[count], decoder->frame.payload, decoder->frame.length);
+        count += decoder->frame.length;
+    }
+    discarded[count++] = receivedByte;
+
+    // - RESYNCHRONISATION - //
+    rejectedFrames = decoder->rejectedFrames;
+    for(unsigned char start = 0; start < count; start++)
+    {
+        if(discarded[start] != PROTOCOL_SYNC_BYTE) continue;
+
+        DecodeStep(decoder, PROTOCOL_SYNC_BYTE);
+        for(unsigned char i = start + 1; i < count && decoder->rejectedFrames == rejectedFrames; i++)
+        {
+            // The bytes left after a frame found in there are lost.
+            if(DecodeStep(decoder, discarded[i])) return true;
+        }
+
+        // Still receiving the frame that starts there.
+        if(decoder->rejectedFrames == rejectedFrames) return false;
+
+        // That sync byte was part of the discarded frame. Only the frame itself counts as rejected.
+        decoder->rejectedFrames = rejectedFrames;
+    }
+    return false;
+}
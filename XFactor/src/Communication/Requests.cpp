@@ -0,0 +1,471 @@
+/**
+ * @file Requests.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * File containing the non blocking Bluetooth
+ * requests. A request is submitted, a handle is
+ * returned and the program keeps running while
+ * the answer is in flight. The handle is then
+ * polled from loop until the request is
+ * completed or timed out.
+ * Each request carries a sequence number and is
+ * retransmitted until SafeBox answers it.
+ * @version 0.1
+ * @date 2023-11-28
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Communication/Requests.hpp"
+#include "Events/Events.hpp"    //// Events received from the other device are handed to the event hooks
+#include "Scheduler/Scheduler.hpp"
+
+/**
+ * @brief
+ * Everything there is to know about a submitted
+ * request. The same frame holds the command
+ * until it is answered and then its answer.
+ */
+typedef struct
+{
+    BT_RequestState state;
+    unsigned int ticket;
+    unsigned char sequence;
+    unsigned char retransmissions;
+    unsigned long timeOut_ms;
+    unsigned long sentTime_ms;
+    unsigned long lastSentTime_ms;
+    unsigned long retransmitDelay_ms;
+    Protocol_Frame frame;
+} BT_Request;
+
+// - GLOBAL LOCAL ACCESS - //
+BT_Request _requests[BT_MAX_PENDING_REQUESTS];
+
+/// @brief Handle of the request that was sent and whose answer is awaited.
+unsigned char _requestInFlight = BT_INVALID_REQUEST;
+
+/// @brief Given to each submitted request so that they are sent in order.
+unsigned int _nextRequestTicket = 0;
+
+/// @brief Sequence number given to the next submitted request. Never @ref PROTOCOL_NO_SEQUENCE
+unsigned char _nextRequestSequence = 1;
+
+/// @brief Session started by @ref BT_InitRequests. 0 until then.
+unsigned char _session = 0;
+
+/// @brief Smoothed round trip time of requests answered on their first try. 0 until one is measured.
+unsigned long _smoothedRoundTrip_ms = 0;
+
+/// @brief Smoothed mean deviation of the measured round trip times.
+unsigned long _roundTripVariance_ms = 0;
+
+/// @brief Current delay before retransmitting a request. See @ref BT_GetRetransmitTimeout
+unsigned long _retransmitTimeout_ms = BT_INITIAL_RETRANSMIT_MS;
+
+/**
+ * @brief
+ * Returns the handle of the request that was
+ * submitted the earliest and is still queued.
+ * @return unsigned char:
+ * @ref BT_INVALID_REQUEST if none are queued.
+ */
+unsigned char GetOldestQueuedRequest()
+{
+    unsigned char oldestHandle = BT_INVALID_REQUEST;
+
+    for(unsigned char handle = 0; handle < BT_MAX_PENDING_REQUESTS; handle++)
+    {
+        if(_requests[handle].state != BT_RequestState::Queued) continue;
+
+        if(oldestHandle == BT_INVALID_REQUEST)
+        {
+            oldestHandle = handle;
+            continue;
+        }
+
+        // Tickets wrap around. Their difference tells which one is older.
+        if((int)(_requests[handle].ticket - _requests[oldestHandle].ticket) < 0)
+        {
+            oldestHandle = handle;
+        }
+    }
+    return oldestHandle;
+}
+
+/**
+ * @brief
+ * Keeps a delay in between the retransmission
+ * bounds.
+ * @param delay_ms
+ * Delay in milliseconds.
+ * @return unsigned long:
+ * The bounded delay.
+ */
+unsigned long ClampRetransmitDelay(unsigned long delay_ms)
+{
+    if(delay_ms < BT_MIN_RETRANSMIT_MS) return BT_MIN_RETRANSMIT_MS;
+    if(delay_ms > BT_MAX_RETRANSMIT_MS) return BT_MAX_RETRANSMIT_MS;
+    return delay_ms;
+}
+
+/**
+ * @brief
+ * Adds a measured round trip time to the
+ * smoothed round trip time and its variance,
+ * then derives the retransmission delay from
+ * them the same way TCP does (Jacobson/Karels).
+ * @param roundTrip_ms
+ * Time between sending a request and receiving
+ * its answer. Only requests answered on their
+ * first try are measured since the answer of a
+ * retransmitted request cannot be matched to one
+ * of its transmissions.
+ */
+void SaveRoundTrip(unsigned long roundTrip_ms)
+{
+    // - VARIABLES - //
+    unsigned long deviation_ms = 0;
+
+    if(_smoothedRoundTrip_ms == 0)
+    {
+        _smoothedRoundTrip_ms = roundTrip_ms;
+        _roundTripVariance_ms = roundTrip_ms / 2;
+    }
+    else
+    {
+        deviation_ms = (roundTrip_ms > _smoothedRoundTrip_ms) ? (roundTrip_ms - _smoothedRoundTrip_ms) : (_smoothedRoundTrip_ms - roundTrip_ms);
+        _roundTripVariance_ms = (_roundTripVariance_ms * 3 + deviation_ms) / 4;
+        _smoothedRoundTrip_ms = (_smoothedRoundTrip_ms * 7 + roundTrip_ms) / 8;
+    }
+    _retransmitTimeout_ms = ClampRetransmitDelay(_smoothedRoundTrip_ms + _roundTripVariance_ms * 4);
+}
+
+/**
+ * @brief
+ * Starts a new session of requests. Each boot
+ * gets its own session number, saved in the
+ * EEPROM, and starts its sequence numbers from
+ * a different place. Status exchanges tell the
+ * session to SafeBox so that it never takes a
+ * command of this boot for a retransmission of
+ * the previous one.
+ * @return true:
+ * Successfully started the session.
+ * @return false:
+ * Failed to start the session.
+ */
+bool BT_InitRequests()
+{
+    // An erased EEPROM reads 0xFF. 0 is never a session.
+    _session = EEPROM.read(BT_SESSION_EEPROM_ADDRESS) + 1;
+    if(_session == 0) _session = 1;
+    EEPROM.write(BT_SESSION_EEPROM_ADDRESS, _session);
+
+    _nextRequestSequence = (unsigned char)(_session * BT_SESSION_SEQUENCE_STRIDE);
+    if(_nextRequestSequence == PROTOCOL_NO_SEQUENCE) _nextRequestSequence++;
+
+    Debug_Information("Requests", "BT_InitRequests", "Session: " + String(_session));
+    return true;
+}
+
+/**
+ * @brief
+ * Returns the session started by
+ * @ref BT_InitRequests
+ * @return unsigned char:
+ * Session number. Never 0 once started.
+ */
+unsigned char BT_GetSession()
+{
+    return _session;
+}
+
+/**
+ * @brief
+ * Submits a new request to be sent to the other
+ * device as soon as the requests submitted
+ * before it are done. This never blocks.
+ *
+ * @param opcode
+ * One of the COMMAND_ defines.
+ * @param payload
+ * Bytes sent with the opcode. Can be 0 if
+ * length is 0.
+ * @param length
+ * How many bytes of payload there is.
+ * @param millisecondsTimeOut
+ * The longest the answer can be awaited once the
+ * request is sent. The request usually times
+ * out sooner, once it was retransmitted
+ * @ref BT_MAX_RETRANSMISSIONS times.
+ * @return unsigned char:
+ * Handle of the request or
+ * @ref BT_INVALID_REQUEST if all the handles are
+ * used or the payload is too long.
+ */
+unsigned char BT_SubmitRequest(unsigned char opcode, const unsigned char* payload, unsigned char length, unsigned long millisecondsTimeOut)
+{
+    // - PRELIMINARY CHECKS - //
+    if(length > PROTOCOL_MAX_PAYLOAD_LENGTH || (length > 0 && payload == 0))
+    {
+        Debug_Error("Requests", "BT_SubmitRequest", "Payload is too large.");
+        return BT_INVALID_REQUEST;
+    }
+
+    // - FUNCTION EXECUTION - //
+    for(unsigned char handle = 0; handle < BT_MAX_PENDING_REQUESTS; handle++)
+    {
+        if(_requests[handle].state != BT_RequestState::Free) continue;
+
+        _requests[handle].frame.opcode = opcode;
+        _requests[handle].frame.length = length;
+        if(length > 0) memcpy(_requests[handle].frame.payload, payload, length);
+        _requests[handle].frame.payload[length] = 0;
+        _requests[handle].timeOut_ms = millisecondsTimeOut;
+        _requests[handle].sentTime_ms = 0;
+        _requests[handle].lastSentTime_ms = 0;
+        _requests[handle].retransmissions = 0;
+        _requests[handle].ticket = _nextRequestTicket++;
+        _requests[handle].sequence = _nextRequestSequence++;
+        if(_nextRequestSequence == PROTOCOL_NO_SEQUENCE) _nextRequestSequence++;
+        _requests[handle].state = BT_RequestState::Queued;
+        return handle;
+    }
+
+    Debug_Error("Requests", "BT_SubmitRequest", "No free handles");
+    return BT_INVALID_REQUEST;
+}
+
+/**
+ * @brief
+ * Sends queued requests, receives answers,
+ * retransmits requests that were not answered
+ * in time and times out requests that waited for
+ * too long. Answers whose sequence number is not
+ * the one of the awaited request are dropped.
+ * Events received in the meantime are handed to
+ * @ref BT_MessageReceivedEvent. Requests fail
+ * right away while the link is down and
+ * @ref BT_LinkChangedEvent is called when it
+ * goes up or down. This never blocks.
+ *
+ * @attention
+ * This must be called periodically from loop
+ * for requests to progress.
+ */
+void BT_UpdateRequests()
+{
+    // - VARIABLES - //
+    BT_Request* request = 0;
+    Protocol_Frame receivedFrame;
+
+    BT_Poll();
+
+    // - LINK STATE - //
+    if(BT_LinkStateChanged())
+    {
+        BT_LinkChangedEvent(BT_LinkIsUp());
+    }
+
+    // - RECEIVED FRAMES - //
+    while(BT_GetLatestFrame(&receivedFrame))
+    {
+        if(receivedFrame.opcode >= PROTOCOL_FIRST_EVENT_OPCODE)
+        {
+            BT_MessageReceivedEvent(&receivedFrame);
+            continue;
+        }
+
+        if(_requestInFlight == BT_INVALID_REQUEST)
+        {
+            // Nobody is waiting after it. Old answer of a request that timed out.
+            continue;
+        }
+
+        request = &_requests[_requestInFlight];
+        if(receivedFrame.sequence != request->sequence)
+        {
+            // Answer to a retransmission of an older request.
+            continue;
+        }
+
+        if(request->state == BT_RequestState::WaitingForAnswer)
+        {
+            if(request->retransmissions == 0) SaveRoundTrip(millis() - request->sentTime_ms);
+            BT_RecordRoundTrip(request->frame.opcode, millis() - request->sentTime_ms);
+            memcpy(&request->frame, &receivedFrame, sizeof(Protocol_Frame));
+            request->state = BT_RequestState::Completed;
+        }
+        // Otherwise it was released while in flight. Its answer is meaningless.
+        _requestInFlight = BT_INVALID_REQUEST;
+    }
+
+    // - AWAITED ANSWER - //
+    if(_requestInFlight != BT_INVALID_REQUEST)
+    {
+        request = &_requests[_requestInFlight];
+
+        if(request->state != BT_RequestState::WaitingForAnswer)
+        {
+            // Released while in flight. Its answer, if any, is meaningless.
+            _requestInFlight = BT_INVALID_REQUEST;
+        }
+        else if(!BT_LinkIsUp())
+        {
+            // No answer can come back. No need to wait after it.
+            Debug_Warning("Requests", "BT_UpdateRequests", "Link is down");
+            BT_RecordTimeout(request->frame.opcode);
+            request->state = BT_RequestState::Failed;
+            _requestInFlight = BT_INVALID_REQUEST;
+        }
+        else if((millis() - request->sentTime_ms) >= request->timeOut_ms ||
+                (request->retransmissions >= BT_MAX_RETRANSMISSIONS && (millis() - request->lastSentTime_ms) >= request->retransmitDelay_ms))
+        {
+            Debug_Warning("Requests", "BT_UpdateRequests", "Timedout");
+            BT_RecordTimeout(request->frame.opcode);
+            // The link got slower or SafeBox is gone. Back off until an answer is measured again.
+            _retransmitTimeout_ms = ClampRetransmitDelay(_retransmitTimeout_ms * 2);
+            request->state = BT_RequestState::TimedOut;
+            _requestInFlight = BT_INVALID_REQUEST;
+        }
+        else
+        {
+            if((millis() - request->lastSentTime_ms) >= request->retransmitDelay_ms)
+            {
+                // Same sequence number. SafeBox answers it again without executing it twice.
+                BT_SendSequencedFrame(request->frame.opcode, request->sequence, request->frame.payload, request->frame.length);
+                request->lastSentTime_ms = millis();
+                request->retransmissions++;
+                BT_RecordRetry(request->frame.opcode);
+                request->retransmitDelay_ms = ClampRetransmitDelay(request->retransmitDelay_ms * 2);
+            }
+            // Still waiting after its answer.
+            return;
+        }
+    }
+
+    // - NEXT REQUEST - //
+    _requestInFlight = GetOldestQueuedRequest();
+    if(_requestInFlight == BT_INVALID_REQUEST) return;
+
+    request = &_requests[_requestInFlight];
+
+    if(!BT_LinkIsUp())
+    {
+        // Fails right away instead of being sent to nobody and timing out.
+        request->state = BT_RequestState::Failed;
+        _requestInFlight = BT_INVALID_REQUEST;
+        return;
+    }
+
+    if(!BT_SendSequencedFrame(request->frame.opcode, request->sequence, request->frame.payload, request->frame.length))
+    {
+        Debug_Error("Requests", "BT_UpdateRequests", "TX failure");
+        request->state = BT_RequestState::Failed;
+        _requestInFlight = BT_INVALID_REQUEST;
+        return;
+    }
+    request->sentTime_ms = millis();
+    request->lastSentTime_ms = request->sentTime_ms;
+    request->retransmitDelay_ms = _retransmitTimeout_ms;
+    request->state = BT_RequestState::WaitingForAnswer;
+}
+
+/**
+ * @brief
+ * Returns the current state of a request.
+ * @param handle
+ * Handle returned by @ref BT_SubmitRequest
+ * @return BT_RequestState:
+ * @ref BT_RequestState::Free if the handle is
+ * not valid.
+ */
+BT_RequestState BT_GetRequestState(unsigned char handle)
+{
+    if(handle >= BT_MAX_PENDING_REQUESTS) return BT_RequestState::Free;
+    return _requests[handle].state;
+}
+
+/**
+ * @brief
+ * Copies the answer of a completed request in
+ * the specified frame.
+ * @param handle
+ * Handle returned by @ref BT_SubmitRequest
+ * @param answer
+ * Frame in which the answer is copied.
+ * @return true:
+ * The answer was copied.
+ * @return false:
+ * The request is not completed.
+ */
+bool BT_GetRequestAnswer(unsigned char handle, Protocol_Frame* answer)
+{
+    // - PRELIMINARY CHECKS - //
+    if(answer == 0) return false;
+    if(BT_GetRequestState(handle) != BT_RequestState::Completed) return false;
+
+    // - FUNCTION EXECUTION - //
+    memcpy(answer, &_requests[handle].frame, sizeof(Protocol_Frame));
+    return true;
+}
+
+/**
+ * @brief
+ * Frees the handle of a request so that it can
+ * be reused. A request that is still queued or
+ * awaited is cancelled.
+ * @param handle
+ * Handle returned by @ref BT_SubmitRequest
+ */
+void BT_ReleaseRequest(unsigned char handle)
+{
+    if(handle >= BT_MAX_PENDING_REQUESTS) return;
+    _requests[handle].state = BT_RequestState::Free;
+}
+
+/**
+ * @brief
+ * Blocks until the specified request is no
+ * longer queued or awaited. This is what the
+ * blocking communication functions are built on.
+ * The other tasks of the scheduler run while it
+ * waits.
+ * @param handle
+ * Handle returned by @ref BT_SubmitRequest
+ * @return BT_RequestState:
+ * The final state of the request.
+ */
+BT_RequestState BT_WaitForRequest(unsigned char handle)
+{
+    // - VARIABLES - //
+    BT_RequestState state = BT_GetRequestState(handle);
+
+    while(state == BT_RequestState::Queued || state == BT_RequestState::WaitingForAnswer)
+    {
+        BT_UpdateRequests();
+        state = BT_GetRequestState(handle);
+        // The other tasks keep running while the answer is awaited.
+        Scheduler_Yield();
+    }
+    return state;
+}
+
+/**
+ * @brief
+ * Returns how long to wait after sending a
+ * request before retransmitting it. It is
+ * derived from the smoothed round trip time and
+ * its variance and doubles each time a request
+ * times out. Also used to space out retries of
+ * failed requests.
+ * @return unsigned long:
+ * Delay in milliseconds, in between
+ * @ref BT_MIN_RETRANSMIT_MS and
+ * @ref BT_MAX_RETRANSMIT_MS
+ */
+unsigned long BT_GetRetransmitTimeout()
+{
+    return _retransmitTimeout_ms;
+}
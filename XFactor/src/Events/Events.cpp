@@ -14,6 +14,7 @@
 
 // - INCLUDE - //
 #include "Events/Events.hpp"
+#include "SafeBox/Communication.hpp"    //// Events received from SafeBox are saved with its other states
 
 // #pragma region [Movement_Related]
 
@@ -176,24 +177,54 @@ bool BT_MessageExchangeSuccessEvent(String messageSent, String messageReceived)
 }
 
 /**
- * @brief Event that is called once when a
- * message is received by XFactor. This allows
- * the program to change LED color or perform
- * other necessary actions depending on the
- * received message from SafeBox
+ * @brief Event that is called once when an
+ * event is received by XFactor. SafeBox sends
+ * events without being asked whenever its
+ * doorbell rings, its alarm starts or its lid
+ * moves. This allows the program to react to
+ * them right away instead of polling SafeBox.
  *
  * @param receivedMessage
- * A string corresponding to the message that was
- * received from SafeBox as an answer to the
- * message that was sent.
+ * The event frame received from SafeBox. Its
+ * opcode is one of the EVENT_ defines.
  * @return true:
  * The event was handled successfully.
  * @return false:
  * The event failed to be handled.
  */
-bool BT_MessageReceivedEvent(String receivedMessage)
+bool BT_MessageReceivedEvent(const Protocol_Frame* receivedMessage)
 {
-    return false;
+    return SafeBox_SaveReceivedEvent(receivedMessage);
+}
+
+/**
+ * @brief Event called once whenever the
+ * Bluetooth link goes up or down. See
+ * @ref BT_LinkIsUp. Once reconnected, everything
+ * saved about SafeBox and its clock is synced
+ * again since it may have changed in the
+ * meantime.
+ *
+ * @param linkIsUp
+ * true if the link just went up, false if it
+ * just went down.
+ * @return true:
+ * The event was handled successfully.
+ * @return false:
+ * The event failed to be handled.
+ */
+bool BT_LinkChangedEvent(bool linkIsUp)
+{
+    if(!linkIsUp)
+    {
+        Debug_Warning("Events", "BT_LinkChangedEvent", "Bluetooth link is down");
+        return true;
+    }
+
+    Debug_Information("Events", "BT_LinkChangedEvent", "Bluetooth link is up");
+    // SafeBox may have rebooted. Its clock cannot be trusted anymore.
+    ClockSync_Reset();
+    return ResetSavedParameters();
 }
 
 /**
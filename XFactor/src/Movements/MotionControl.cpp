@@ -0,0 +1,371 @@
+/**
+ * @file MotionControl.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * File containing the motion control step. The
+ * encoders are sampled and the PID and
+ * acceleration are updated from a timer
+ * interrupt at a fixed rate. Movements only
+ * start a movement with its targets and read
+ * how much of it is completed.
+ *
+ * @attention
+ * The interrupt is Timer0's compare match A.
+ * Timer0 keeps running as Arduino's millis()
+ * timer and is not reconfigured. Pin 13 must
+ * not be used with analogWrite.
+ * @version 0.1
+ * @date 2023-12-05
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Movements/MotionControl.hpp"
+#include "Outputs/Motors/DC/Motors.hpp"
+
+// - GLOBAL VARIABLES - //
+/// @brief Movement being controlled. Only read or written with interrupts disabled outside of steps.
+MotionControl_State _motion;
+volatile bool _motionIsActive = false;
+/// @brief Set during a step so that a late step is skipped instead of nested.
+volatile bool _motionIsStepping = false;
+volatile unsigned char _motionTicks = 0;
+
+volatile unsigned long _previousStep_us = 0;
+volatile unsigned long _steps = 0;
+volatile unsigned long _skippedSteps = 0;
+volatile unsigned long _maxJitter_us = 0;
+volatile unsigned long _totalJitter_us = 0;
+volatile unsigned long _maxStepDuration_us = 0;
+
+#if defined(__AVR__)
+/**
+ * @brief
+ * Timer0's compare match interrupt. Fires once
+ * per Timer0 overflow, half a period after the
+ * one Arduino uses for millis().
+ */
+ISR(TIMER0_COMPA_vect, ISR_NOBLOCK)
+{
+    MotionControl_Tick();
+}
+#endif
+
+/**
+ * @brief Calculate the wanted speed factor depending on how much
+ * distance is left to move to reach its wanted destination.
+ * This allows the robot to perform an acceleration when starting
+ * its movement and a de acceleration when its nearing the end of
+ * its distance.
+ *
+ * This is important to make the robot go faster than an instant
+ * acceleration that would otherwise cause slip and potential
+ * drifting, meaning loss in accuracy.
+ * @param completionRatio
+ * ratio going from 0 to 1 representing how much of the chosen
+ * movement the robot has completed. Used to represent the x in
+ * the parabolic function.
+ * @param maximumSpeed
+ * a ratio from 0 to 1 that indicates the maximum speed of
+ * the wheels.
+ * @return float
+ * Ratio from 0 to 1 that should be multiplied to the
+ * current PID value
+ */
+float Accelerate(float completionRatio, float maximumSpeed)
+{
+    double neededSpeed = 0;
+    if ((completionRatio >= 0) && completionRatio <= 100)
+    {
+        neededSpeed = (pow(sin(completionRatio * 3.14),2) * maximumSpeed)+0.1;
+        if(neededSpeed>maximumSpeed) neededSpeed = maximumSpeed;
+        return neededSpeed;
+    }
+    else 
+    {
+        Debug_Error("MotionControl", "Accelerate", "Ratio is out of bounds: " + String(completionRatio, 2));
+        return 0.0f;
+    }
+    return 0.0f;
+}
+
+/**
+ * @brief
+ * Sets the targets of a movement and clears
+ * what its steps computed, including the PID.
+ * @param state
+ * State of the movement to set.
+ * @param targetTicks
+ * Ticks of the right encoder at which the
+ * movement is completed.
+ * @param maximumSpeed
+ * Speed reached in the middle of the movement.
+ * @param direction
+ * 1 or -1.
+ * @param leftDirection
+ * 1 when moving straight, -1 when turning.
+ */
+void MotionControl_InitState(MotionControl_State* state, float targetTicks, float maximumSpeed, int direction, float leftDirection)
+{
+    state->targetTicks = targetTicks;
+    state->maximumSpeed = maximumSpeed;
+    state->direction = direction;
+    state->leftDirection = leftDirection;
+    state->previousLeftPulse = 0;
+    state->previousRightPulse = 0;
+    state->completionRatio = 0.0f;
+    state->leftSpeed = 0.0f;
+    state->rightSpeed = 0.0f;
+    ResetPID(&state->pid);
+}
+
+/**
+ * @brief
+ * Computes one step of the acceleration and of
+ * the PID from the absolute encoder readings.
+ * Does not touch any hardware so that it can be
+ * executed on its own.
+ * @param state
+ * State of the movement. Its completion ratio
+ * and motor speeds are updated.
+ * @param leftPulse
+ * Absolute ticks read on the left encoder.
+ * @param rightPulse
+ * Absolute ticks read on the right encoder.
+ */
+void MotionControl_ComputeStep(MotionControl_State* state, int32_t leftPulse, int32_t rightPulse)
+{
+    // - VARIABLES - //
+    float currentSpeed = 0.0f;
+    float speedLeft = 0.0f;
+
+    state->completionRatio = ((float)rightPulse)/state->targetTicks;
+
+    currentSpeed = Accelerate(state->completionRatio, state->maximumSpeed);
+
+    speedLeft = PID(&state->pid, PID_MOVEMENT,
+                    leftPulse-state->previousLeftPulse,
+                    rightPulse-state->previousRightPulse,
+                    currentSpeed);
+
+    state->leftSpeed  = (float)state->direction*state->leftDirection*speedLeft;
+    state->rightSpeed = (float)state->direction*currentSpeed;
+
+    state->previousLeftPulse  = leftPulse;
+    state->previousRightPulse = rightPulse;
+}
+
+/**
+ * @brief
+ * Enables the timer interrupt that calls
+ * @ref MotionControl_Tick
+ * @return true:
+ * Successfully enabled the interrupt.
+ * @return false:
+ * Failed to enable the interrupt.
+ */
+bool MotionControl_Init()
+{
+    _motionIsActive = false;
+    _motionTicks = 0;
+    MotionControl_ResetStats();
+
+#if defined(__AVR__)
+    // Timer0 counts from 0 to 255. Matching in the middle keeps away from millis()' overflow interrupt.
+    OCR0A = 0x80;
+    TIMSK0 |= _BV(OCIE0A);
+#endif
+    return true;
+}
+
+/**
+ * @brief
+ * Called by the timer interrupt every
+ * @ref MOTION_CONTROL_TICK_US. Every
+ * @ref MOTION_CONTROL_TICKS_PER_STEP ticks, the
+ * encoders are read, a step is computed and the
+ * motors are set if a movement is active.
+ *
+ * @attention
+ * Interrupts are enabled during the step so that
+ * no encoder tick is missed.
+ */
+void MotionControl_Tick()
+{
+    // - VARIABLES - //
+    unsigned long now_us = 0;
+    unsigned long period_us = 0;
+    unsigned long jitter_us = 0;
+    int32_t rightPulse = 0;
+    int32_t leftPulse = 0;
+
+    // - PRELIMINARY CHECKS - //
+    if(++_motionTicks < MOTION_CONTROL_TICKS_PER_STEP) return;
+    _motionTicks = 0;
+
+    if(_motionIsStepping)
+    {
+        _skippedSteps++;
+        return;
+    }
+
+    // - FUNCTION EXECUTION - //
+    _motionIsStepping = true;
+    now_us = micros();
+
+    if(_steps != 0)
+    {
+        period_us = now_us - _previousStep_us;
+        jitter_us = (period_us > MOTION_CONTROL_PERIOD_US) ? (period_us - MOTION_CONTROL_PERIOD_US) : (MOTION_CONTROL_PERIOD_US - period_us);
+        if(jitter_us > _maxJitter_us) _maxJitter_us = jitter_us;
+        _totalJitter_us += jitter_us;
+    }
+    _previousStep_us = now_us;
+    _steps++;
+
+    if(_motionIsActive)
+    {
+        rightPulse = abs(ENCODER_Read(RIGHT));
+        leftPulse  = abs(ENCODER_Read(LEFT));
+
+        MotionControl_ComputeStep(&_motion, leftPulse, rightPulse);
+
+        SetMotorSpeed(LEFT, _motion.leftSpeed);
+        SetMotorSpeed(RIGHT, _motion.rightSpeed);
+    }
+
+    period_us = micros() - now_us;
+    if(period_us > _maxStepDuration_us) _maxStepDuration_us = period_us;
+    _motionIsStepping = false;
+}
+
+/**
+ * @brief
+ * Starts controlling a movement. The encoders
+ * must have been reset beforehand.
+ * @param targetTicks
+ * Ticks of the right encoder at which the
+ * movement is completed.
+ * @param maximumSpeed
+ * Speed reached in the middle of the movement.
+ * @param direction
+ * 1 or -1.
+ * @param leftDirection
+ * 1 when moving straight, -1 when turning.
+ */
+void MotionControl_Start(float targetTicks, float maximumSpeed, int direction, float leftDirection)
+{
+    noInterrupts();
+    MotionControl_InitState(&_motion, targetTicks, maximumSpeed, direction, leftDirection);
+    _motionIsActive = true;
+    interrupts();
+}
+
+/**
+ * @brief
+ * Stops controlling the motors. No step sets
+ * the motors once this returns.
+ */
+void MotionControl_Stop()
+{
+    // Steps interrupt this code and finish before it resumes. None can be midway once this is written.
+    _motionIsActive = false;
+}
+
+/**
+ * @brief
+ * Returns how much of the current movement is
+ * completed, as updated by the last step.
+ * @return float:
+ * 0 at the start, 1 once completed.
+ */
+float MotionControl_GetCompletionRatio()
+{
+    // - VARIABLES - //
+    float completionRatio = 0.0f;
+
+    noInterrupts();
+    completionRatio = _motion.completionRatio;
+    interrupts();
+    return completionRatio;
+}
+
+/**
+ * @brief
+ * Returns the largest difference measured in
+ * between the time separating two steps and
+ * @ref MOTION_CONTROL_PERIOD_US
+ * @return unsigned long:
+ * Largest jitter in microseconds.
+ */
+unsigned long MotionControl_GetMaxJitter()
+{
+    // - VARIABLES - //
+    unsigned long maxJitter_us = 0;
+
+    noInterrupts();
+    maxJitter_us = _maxJitter_us;
+    interrupts();
+    return maxJitter_us;
+}
+
+/**
+ * @brief
+ * Returns the average difference measured in
+ * between the time separating two steps and
+ * @ref MOTION_CONTROL_PERIOD_US
+ * @return unsigned long:
+ * Average jitter in microseconds.
+ */
+unsigned long MotionControl_GetAverageJitter()
+{
+    // - VARIABLES - //
+    unsigned long totalJitter_us = 0;
+    unsigned long steps = 0;
+
+    noInterrupts();
+    totalJitter_us = _totalJitter_us;
+    steps = _steps;
+    interrupts();
+
+    // The first step has no period to measure.
+    if(steps < 2) return 0;
+    return totalJitter_us / (steps - 1);
+}
+
+/**
+ * @brief
+ * Clears the step and jitter statistics.
+ */
+void MotionControl_ResetStats()
+{
+    noInterrupts();
+    _steps = 0;
+    _skippedSteps = 0;
+    _maxJitter_us = 0;
+    _totalJitter_us = 0;
+    _maxStepDuration_us = 0;
+    interrupts();
+}
+
+/**
+ * @brief
+ * Prints the steps executed, the steps skipped
+ * because the previous one was not done yet,
+ * the jitter and the longest step.
+ */
+void MotionControl_PrintStats()
+{
+    // - VARIABLES - //
+    unsigned long steps = 0;
+    unsigned long skippedSteps = 0;
+    unsigned long maxStepDuration_us = 0;
+
+    noInterrupts();
+    steps = _steps;
+    skippedSteps = _skippedSteps;
+    maxStepDuration_us = _maxStepDuration_us;
+    interrupts();
+
+    Debug_Information("MotionControl", "MotionControl_PrintStats", "Steps: " + String(steps) + " Skipped: " + String(skippedSteps) + " Period: " + String(MOTION_CONTROL_PERIOD_US) + "us Jitter avg: " + String(MotionControl_GetAverageJitter()) + "us max: " + String(MotionControl_GetMaxJitter()) + "us Longest: " + String(maxStepDuration_us) + "us");
+}
@@ -16,10 +16,7 @@
 
 
 // - GLOBAL VARIABLES - //
-int32_t rightPulse = 0;
-int32_t leftPulse  = 0;
-int32_t previousRightPulse = 0;
-int32_t previousLeftPulse  = 0;
+/// @brief Copied from @ref MotionControl_GetCompletionRatio each time the movement loops check it.
 double completionRatio = 0.0;
 
 float gMaxSpeed = SPEED_MAX;
@@ -31,9 +28,12 @@ int direction = 0;
 float targetTicks = 0;
 
 float currentSpeed = 0.0f;
-float speedLeft    = 0.0f;
 
-unsigned long previousInterval_ms = 0;
+/// @brief Set while Execute_Turning or Execute_Moving waits for the timer's steps to complete the movement.
+bool movementIsActive = false;
+bool movementIsTurning = false;
+/// @brief Latched by @ref Movements_SensorStep when the alarm's sensors detected something during the movement.
+bool movementAlarmTriggered = false;
 
 bool checkForSensors = true;
 bool checkAlarmEnabled = true;
@@ -216,13 +216,7 @@ bool BacktraceSomeVectors(int AmountOfVectorsToBacktrace)
 bool TurnInRadians(float radians)
 {
     Debug_Start("TurnInRadians");
-    if (!ResetPID())
-    {
-        Debug_Error("Movements", "TurnInRadians", "Failed to reset PID");
-        Debug_End();
-        return false;
-    }
-    else if (!ResetAllEncoders())
+    if (!ResetAllEncoders())
     {
         Debug_Error("Movements", "TurnInRadians", "Failed to reset encoders");
         Debug_End();
@@ -260,13 +254,7 @@ bool TurnInRadians(float radians)
 bool MoveStraight(float distance)
 {
     Debug_Start("MoveStraight");
-    if (!ResetPID())
-    {
-        Debug_Error("Movements", "MoveStraight", "Failed to reset PID");
-        Debug_End();
-        return false;
-    }
-    else if (!ResetAllEncoders())
+    if (!ResetAllEncoders())
     {
         Debug_Error("Movements", "MoveStraight", "Failed to reset all encoders");
         Debug_End();
@@ -288,44 +276,6 @@ bool MoveStraight(float distance)
     return true;
 }
 
-/**
- * @brief Calculate the wanted speed factor depending on how much
- * distance is left to move to reach its wanted destination.
- * This allows the robot to perform an acceleration when starting
- * its movement and a de acceleration when its nearing the end of
- * its distance.
- *
- * This is important to make the robot go faster than an instant
- * acceleration that would otherwise cause slip and potential
- * drifting, meaning loss in accuracy.
- * @param completionRatio
- * ratio going from 0 to 1 representing how much of the chosen
- * movement the robot has completed. Used to represent the x in
- * the parabolic function.
- * @param maximumSpeed
- * a ratio from 0 to 1 that indicates the maximum speed of
- * the wheels.
- * @return float
- * Ratio from 0 to 1 that should be multiplied to the
- * current PID value
- */
-float Accelerate(float completionRatio, float maximumSpeed)
-{
-    double neededSpeed = 0;
-    if ((completionRatio >= 0) && completionRatio <= 100)
-    {
-        neededSpeed = (pow(sin(completionRatio * 3.14),2) * maximumSpeed)+0.1;
-        if(neededSpeed>maximumSpeed) neededSpeed = maximumSpeed;
-        return neededSpeed;
-    }
-    else 
-    {
-        Debug_Error("Movements", "Accelerate", "Ratio is out of bounds: " + String(completionRatio, 2));
-        return 0.0f;
-    }
-    return 0.0f;
-}
-
 /**
  * @brief Stops the robot no matter what.
  * This function should simply stop
@@ -351,7 +301,8 @@ bool Stop()
  * @brief Function that must be called
  * before the robot starts to execute
  * its movements. It will reset the
- * PID as well as encoders. It should
+ * encoders. The PID is reset by
+ * @ref MotionControl_Start. It should
  * also reset current rotation and
  * distance.
  * @return true:
@@ -361,14 +312,9 @@ bool Stop()
  */
 bool ResetMovements()
 {
-    if (ResetAllEncoders()){
-        if (ResetPID()){
-            return true;
-        }
-        else Debug_Error("Movements", "ResetMovements", "Failed to reset PID");
-    }
-    else Debug_Error("Movements", "ResetMovements", "Failed to reset encoders");
-    return false;    
+    if (ResetAllEncoders()) return true;
+    Debug_Error("Movements", "ResetMovements", "Failed to reset encoders");
+    return false;
 }
 
 /**
@@ -383,23 +329,41 @@ bool ResetMovements()
  */
 bool ResetParameters()
 {
-    rightPulse = 0;
-    leftPulse  = 0;
-    previousRightPulse = 0;
-    previousLeftPulse  = 0;
     completionRatio = 0.0;
 
     direction = 0;
     targetTicks = 0;
 
     currentSpeed = 0.0f;
-    speedLeft    = 0.0f;
 
-    previousInterval_ms = 0;
+    movementAlarmTriggered = false;
     return true;    
 }
 //#pragma endregion
 
+//#pragma region Tasks
+
+/**
+ * @brief Samples the sensors of the alarm while
+ * a movement that checks the alarm is done.
+ * Straight movements stop checking once 85% of
+ * the way is done.
+ *
+ * @attention
+ * Registered as a task so that the alarm is
+ * sampled at the same rate no matter how fast
+ * the movement loops spin.
+ */
+void Movements_SensorStep()
+{
+    if(!movementIsActive || !checkAlarmEnabled) return;
+    if(!movementIsTurning && completionRatio > 0.85f) return;
+
+    if(Alarm_VerifySensors()) movementAlarmTriggered = true;
+}
+
+//#pragma endregion
+
 //#pragma region Execution_Functions
 
 /**
@@ -426,7 +390,6 @@ bool ResetParameters()
  */
 int Execute_Turning(float targetRadians)
 {
-    int32_t absoluteOfRightPulse = 0;
     if (!TurnInRadians(targetRadians))
     {
         Debug_Error("Movements", "Execute_Turning", "Could not get the target movement");
@@ -439,33 +402,22 @@ int Execute_Turning(float targetRadians)
     
     SetMotorSpeed(LEFT, (float)direction*-1.0f*currentSpeed);
     SetMotorSpeed(RIGHT, (float)direction*currentSpeed);
-    
-    while(completionRatio <= 1){
-        if((millis()-previousInterval_ms)>PID_INTERVAL_MS){
-            rightPulse = abs(ENCODER_Read(RIGHT));
-            leftPulse  = abs(ENCODER_Read(LEFT));
-
-            absoluteOfRightPulse = abs(rightPulse);
-            completionRatio = ((float)absoluteOfRightPulse)/targetTicks;
 
-            currentSpeed = Accelerate(completionRatio, gMaxSpeed / 2);
+    // The PID runs from the timer. The alarm's sensors are run by their task in between each check.
+    movementIsTurning = true;
+    movementIsActive = true;
+    MotionControl_Start(targetTicks, gMaxSpeed / 2, direction, -1.0f);
 
-            speedLeft = PID(PID_MOVEMENT, (leftPulse-previousLeftPulse), (rightPulse-previousRightPulse), currentSpeed);
+    while(completionRatio <= 1){
+        Scheduler_Yield();
+        completionRatio = MotionControl_GetCompletionRatio();
 
-            SetMotorSpeed(LEFT, (float)direction*-1.0f*speedLeft);
-            SetMotorSpeed(RIGHT, (float)direction*currentSpeed);
-            previousLeftPulse  = leftPulse;
-            previousRightPulse = rightPulse;
-            previousInterval_ms = millis();
-        }
-    
-        if (checkAlarmEnabled)
+        if (movementAlarmTriggered)
         {
-            if (Alarm_VerifySensors())
-            {
-                Debug_Information("Movements.cpp", "Execute_Turning", "STATUS_ALARM_TRIGGERED");
-                return ALARM_TRIGGERED;
-            }
+            Debug_Information("Movements.cpp", "Execute_Turning", "STATUS_ALARM_TRIGGERED");
+            MotionControl_Stop();
+            movementIsActive = false;
+            return ALARM_TRIGGERED;
         }
 
         if (checkForSensors)
@@ -510,6 +462,8 @@ int Execute_Turning(float targetRadians)
         }
             
     }
+    MotionControl_Stop();
+    movementIsActive = false;
 
     rotationMovement = -(EncoderToCentimeters((float)ENCODER_Read(RIGHT)))*ARC_TICK_TO_CM; // TO LOOK AT
 
@@ -548,7 +502,6 @@ int Execute_Turning(float targetRadians)
 int Execute_Moving(float targetDistance, float targetRadians)
 {
     Debug_Start("Execute_Moving");
-    int32_t absoluteOfRightPulse = 0;
 
     if (!MoveStraight(targetDistance))
     {
@@ -563,30 +516,15 @@ int Execute_Moving(float targetDistance, float targetRadians)
 
     SetMotorSpeed(LEFT, (float)direction*currentSpeed);
     SetMotorSpeed(RIGHT, (float)direction*currentSpeed);
-    
-    while(completionRatio<1){
-        // PID called each 10 milliseconds
-        if((millis()-previousInterval_ms)>PID_INTERVAL_MS){
-            rightPulse = abs(ENCODER_Read(RIGHT));
-            leftPulse  = abs(ENCODER_Read(LEFT));
-
-            absoluteOfRightPulse = abs(rightPulse);
-            completionRatio = ((float)absoluteOfRightPulse)/targetTicks;
 
-            currentSpeed = Accelerate(completionRatio, gMaxSpeed);
+    // The PID runs from the timer. The alarm's sensors are run by their task in between each check.
+    movementIsTurning = false;
+    movementIsActive = true;
+    MotionControl_Start(targetTicks, gMaxSpeed, direction, 1.0f);
 
-            speedLeft = PID(PID_MOVEMENT,
-                            leftPulse-previousLeftPulse, 
-                            rightPulse-previousRightPulse, 
-                            currentSpeed);
-            
-            SetMotorSpeed(LEFT, (float)direction*speedLeft);
-            SetMotorSpeed(RIGHT, (float)direction*currentSpeed);
-            
-            previousLeftPulse  = leftPulse;
-            previousRightPulse = rightPulse;
-            previousInterval_ms = millis();
-        }
+    while(completionRatio<1){
+        Scheduler_Yield();
+        completionRatio = MotionControl_GetCompletionRatio();
 
         if (checkForSensors)
         {
@@ -628,16 +566,15 @@ int Execute_Moving(float targetDistance, float targetRadians)
             }
         }
 
-        if (checkAlarmEnabled)
+        if (movementAlarmTriggered)
         {
-            if (completionRatio <= 0.85f && Alarm_VerifySensors())
-            {
-                Debug_Information("Movements.cpp", "Execute_Moving", "STATUS_ALARM_TRIGGERED");
-                status = ALARM_TRIGGERED;
-                break;
-            }
+            Debug_Information("Movements.cpp", "Execute_Moving", "STATUS_ALARM_TRIGGERED");
+            status = ALARM_TRIGGERED;
+            break;
         }
     }
+    MotionControl_Stop();
+    movementIsActive = false;
     Debug_Information("Movements", "Execute_Moving", "Exited while loop");
     rightMovement = EncoderToCentimeters(abs((float)ENCODER_Read(RIGHT)));
 
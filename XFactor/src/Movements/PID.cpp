@@ -13,10 +13,6 @@
 // - INCLUDE - //
 #include "Movements/PID.hpp"
 
-// - VARIABLES - //
-float previousValue = 0.0f;
-float errorSum = 0.0f;
-
 /**
  * @brief Basic PID function that returns an
  * adjusted value over time based on a wanted
@@ -29,8 +25,11 @@ float errorSum = 0.0f;
  * you would first get the difference between
  * the 2, knowing you want it to be 0, and
  * then call he function as following:
- * speedCorrection = PID(p, i, d, difference, 0);
+ * speedCorrection = PID(&state, p, i, d, difference, 0);
  *
+ * @param state
+ * What the PID remembered from its previous
+ * calls. Updated by this call.
  * @param proportional
  * the P value of the PID. The increase of the
  * number the further it is from wanted value.
@@ -55,15 +54,15 @@ float errorSum = 0.0f;
  * at 0.
  * @return float
  */
-float PID(float proportional, float integral, float derivative, float currentValue, float wantedValue, float startingValue)
+float PID(PID_State* state, float proportional, float integral, float derivative, float currentValue, float wantedValue, float startingValue)
 {
     float error = wantedValue-currentValue;
-    float derivativeError = currentValue-(previousValue);
-    errorSum += error;
+    float derivativeError = currentValue-(state->previousValue);
+    state->errorSum += error;
 
-    float PID = startingValue + proportional*error + integral*(errorSum) + derivative*(derivativeError);
+    float PID = startingValue + proportional*error + integral*(state->errorSum) + derivative*(derivativeError);
 
-    previousValue = currentValue;
+    state->previousValue = currentValue;
 
     if (PID > SPEED_MAX + 0.05f) PID = SPEED_MAX + 0.05f;
     if (PID < -SPEED_MAX - 0.05f) PID = -SPEED_MAX - 0.05f;
@@ -76,16 +75,18 @@ float PID(float proportional, float integral, float derivative, float currentVal
  * use the @ref PID function. this
  * allows it to reset its previous
  * variables and sum of errors.
+ * @param state
+ * The state to reset.
  * @return true:
  * Successfully reset the PID.
  * @return false:
  * Failed to reset the PID.
  */
-bool ResetPID()
+bool ResetPID(PID_State* state)
 {
-    previousValue = 0.0f;
-    errorSum = 0.0f;
-    
-    if (previousValue == 0 && errorSum == 0) return true;
-    else return false;
+    if (state == 0) return false;
+
+    state->previousValue = 0.0f;
+    state->errorSum = 0.0f;
+    return true;
 }
\ No newline at end of file
@@ -140,7 +140,7 @@ bool Claws_SetHeight(unsigned char pourcent)
     {
         oldAngle = oldAngle + ratio;
         S3003_SetPosition(CLAWS_PINS_HEIGHT, oldAngle);
-        delay(50);
+        Scheduler_Delay(50);
     }
     oldAngle = wantedAngle;
     return true;
@@ -294,7 +294,7 @@ bool Claws_CloseUntilDetection()
     }
 
     //NECESSARY FOR DEBOUNCE ; WILL BE REPLACED IF WE HAVE TIME
-    delay(5);
+    Scheduler_Delay(5);
 
     if(Claws_GetSwitchStatus())
     {
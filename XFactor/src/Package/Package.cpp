@@ -18,6 +18,11 @@
 bool package_setUp = false;
 bool pickup = false;
 
+/// @brief Where @ref Package_PickUp resumes.
+Coroutine _pickUpCoroutine;
+/// @brief Kept in between the steps of @ref Package_PickUp
+int _pickUpAttempt = 0;
+
 unsigned short distanceDetected_cm;
 
 /**
@@ -87,32 +92,36 @@ bool Package_Release()
 
 /**
  * @brief
- * Function that automatically picks up a package
- * that is right where the claw is. This function
- * will deploy the claw if not already done.
+ * Coroutine that automatically picks up a
+ * package that is right where the claw is. This
+ * function will deploy the claw if not already
+ * done. It returns while waiting after the claw
+ * and must be called until it no longer returns
+ * @ref COROUTINE_RUNNING
  *
  * @attention
  * The robot must already be facing the package
  * correctly before this function is executed.
  *
- * @return true:
+ * @return COROUTINE_RUNNING:
+ * Still picking up the package.
+ * @return COROUTINE_SUCCEEDED:
  * Successfully picked up a package
- * @return false:
+ * @return COROUTINE_FAILED:
  * Failed to pick up a package, try again.
  */
 
-bool Package_PickUp()
+unsigned char Package_PickUp()
 {
-    Debug_Start("Package_PickUp");
+    COROUTINE_BEGIN(&_pickUpCoroutine);
 
     if(!Package_DeployClaw())
     {
         Debug_Error("Package", "Package_PickUp", "Failed to deploy the claw");
-        Debug_End();
-        return false;
+        COROUTINE_FAIL(&_pickUpCoroutine);
     }
 
-    for (int i = 0; i < 5; i++)
+    for (_pickUpAttempt = 0; _pickUpAttempt < PACKAGE_PICK_UP_ATTEMPTS; _pickUpAttempt++)
     {
         if (!pickup)
         {
@@ -120,36 +129,45 @@ bool Package_PickUp()
 
             if (pickup)
             {
-                delay(500);
+                COROUTINE_SLEEP(&_pickUpCoroutine, 500);
                 if (Claws_GetSwitchStatus())
                 {
                     if(!Claws_SetHeight(PACKAGE_CLAW_HEIGHT_POSITION_TRANSPORT))
                     {
                         Debug_Error("Package", "Package_PickUp", "Failed to set height of the claw");
-                        Debug_End();
-                        return false;
+                        COROUTINE_FAIL(&_pickUpCoroutine);
                     }
                     Debug_Information("Package", "Package_PickUp", "Successfully picked up the package");
-                    Debug_End();
                     Package_SetStatus(true);
-                    return true;
+                    COROUTINE_SUCCEED(&_pickUpCoroutine);
                 }
                 continue;
             }
         }
-        delay(500);
+        COROUTINE_SLEEP(&_pickUpCoroutine, 500);
     }
 
     if(!MoveFromVector(PICK_UP_PACKAGE_VECTOR))
     {
         Debug_Error("Package", "Package_PickUp", "Failed to move from vector");
-        Debug_End();
-        return false;
+        COROUTINE_FAIL(&_pickUpCoroutine);
     }
 
     Debug_Error("Package", "Package_PickUp", "Failed to pick up the package");
-    Debug_End();
-    return false;
+    COROUTINE_FAIL(&_pickUpCoroutine);
+
+    COROUTINE_END(&_pickUpCoroutine);
+}
+
+/**
+ * @brief
+ * Makes the next call of @ref Package_PickUp
+ * start a new pick up instead of resuming the
+ * one in progress.
+ */
+void Package_CancelPickUp()
+{
+    COROUTINE_RESET(&_pickUpCoroutine);
 }
 
 /**
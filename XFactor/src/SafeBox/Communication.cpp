@@ -20,6 +20,34 @@ bool currentLidState = false;
 bool currentGarageState = false;
 bool currentDoorBellState = false;
 bool currentPackageCheckState = false;
+unsigned char currentPackageCount = 0;
+/// @brief Set by @ref EVENT_DOORBELL_RANG until @ref SafeBox_GetDoorBellStatus returns it.
+bool doorbellEventLatched = false;
+/// @brief Number of the last ring told by @ref EVENT_DOORBELL_RANG. Its repetitions are ignored. 0 before the first.
+unsigned char doorbellEventRing = 0;
+/// @brief XFactor's millis() at which the garage opening scheduled by @ref SafeBox_ScheduleGarageOpening is done.
+unsigned long garageOpeningTime_ms = 0;
+bool garageOpeningIsScheduled = false;
+
+/// @brief When the last snapshot was received. The getters read from memory while it is recent.
+unsigned long snapshotTime_ms = 0;
+bool snapshotIsValid = false;
+/// @brief Status of XFactor carried by the last snapshot request.
+XFactor_Status snapshotSentStatus = XFactor_Status::Off;
+/// @brief Status of XFactor carried by the snapshot request that is awaiting its answer.
+XFactor_Status snapshotPendingStatus = XFactor_Status::Off;
+
+/// @brief Handle of the status exchange sent by @ref SafeBox_UpdateStatusSync that awaits its answer.
+unsigned char statusSyncHandle = BT_INVALID_REQUEST;
+/// @brief Status of XFactor carried by the status exchange that awaits its answer.
+XFactor_Status statusSyncPendingStatus = XFactor_Status::Off;
+/// @brief Last status of XFactor that SafeBox acknowledged.
+XFactor_Status statusSyncAckedStatus = XFactor_Status::Off;
+bool statusSyncIsAcked = false;
+/// @brief When XFactor's status was last sent to SafeBox.
+unsigned long statusSyncSentTime_ms = 0;
+/// @brief When SafeBox last told its status.
+unsigned long safeBoxStatusTime_ms = 0;
 
 /**
  * @brief 
@@ -37,6 +65,37 @@ bool ResetSavedParameters()
     currentGarageState = false;
     currentDoorBellState = false;
     currentPackageCheckState = false;
+    currentPackageCount = 0;
+    snapshotIsValid = false;
+    statusSyncIsAcked = false;
+    return true;
+}
+
+/**
+ * @brief
+ * Saves the status that SafeBox sent through
+ * Bluetooth in the getter setter functions.
+ * @param statusCode
+ * Status code received from SafeBox.
+ * @return true:
+ * Successfully saved the status of SafeBox.
+ * @return false:
+ * Unknown status.
+ */
+bool SaveReceivedSafeBoxStatus(unsigned char statusCode)
+{
+    // - VARIABLES - //
+    SafeBox_Status status = SafeBox_Status::Off;
+
+    if(!StatusCodec_DecodeSafeBox(statusCode, &status))
+    {
+        Debug_Error("Communication", "SaveReceivedSafeBoxStatus", "Unknown SafeBox status");
+        Debug_Error("Communication", "SaveReceivedSafeBoxStatus", String(statusCode));
+        return false;
+    }
+
+    SafeBox_SetNewStatus(status);
+    safeBoxStatusTime_ms = millis();
     return true;
 }
 
@@ -51,123 +110,502 @@ bool ResetSavedParameters()
  * @return false:
  * No functions recognized this.
  */
-bool ParseReceivedAnswer(String answer)
+bool ParseReceivedAnswer(const Protocol_Frame* answer)
 {
     Debug_Start("ParseReceivedAnswer");
+    // - VARIABLES - //
+    unsigned char statusCode = 0;
 
-    Debug_Warning("Communication", "RX", answer);
-    if(answer == ANSWER_PACKAGE_CHECK_SUCCESS)
+    // Answers are parsed without being printed. At 115200 bauds, printing each one took longer than its round trip.
+    switch(answer->opcode)
     {
-        Debug_Warning("Communication", "ParseAnswerInDifferentCommand", "ANSWER_PACKAGE_CHECK_FAILED");
-        currentPackageCheckState = true;
-        Debug_End();
-        return true;
-    }
+        case(ANSWER_PACKAGE_CHECK_SUCCESS):
+            currentPackageCheckState = true;
+            Debug_End();
+            return true;
 
-    if(answer == ANSWER_PACKAGE_CHECK_FAILED)
-    {
-        Debug_Warning("Communication", "ParseAnswerInDifferentCommand", "ANSWER_PACKAGE_CHECK_FAILED");
-        currentPackageCheckState = false;
-        Debug_End();
-        return true;
+        case(ANSWER_PACKAGE_CHECK_FAILED):
+            currentPackageCheckState = false;
+            Debug_End();
+            return true;
+
+        case(ANSWER_DOORBELL_RANG):
+            currentDoorBellState = true;
+            Debug_End();
+            return true;
+
+        case(ANSWER_DOORBELL_NOT_RANG):
+            currentDoorBellState = false;
+            Debug_End();
+            return true;
+
+        case(ANSWER_GARAGE_SUCCESS):
+            currentGarageSuccess = true;
+            Debug_End();
+            return true;
+
+        case(ANSWER_GARAGE_FAILED):
+            currentGarageSuccess = false;
+            Debug_End();
+            return true;
+
+        case(ANSWER_GARAGE_OPEN):
+            currentGarageState = true;
+            Debug_End();
+            return true;
+
+        case(ANSWER_GARAGE_CLOSED):
+            currentGarageState = false;
+            Debug_End();
+            return true;
+
+        case(ANSWER_LID_SUCCESS):
+            currentLidSuccess = true;
+            Debug_End();
+            return true;
+
+        case(ANSWER_LID_FAILED):
+            currentLidSuccess = false;
+            Debug_End();
+            return true;
+
+        case(ANSWER_LID_OPEN):
+            currentLidState = true;
+            Debug_End();
+            return true;
+
+        case(ANSWER_LID_CLOSED):
+            currentLidState = false;
+            Debug_End();
+            return true;
+
+        case(ANSWER_PACKAGE_COUNT):
+            if(answer->length == 0)
+            {
+                Debug_Error("Communication", "ParseReceivedAnswer", "Package count is missing");
+                Debug_End();
+                return false;
+            }
+            currentPackageCount = answer->payload[0];
+            Debug_End();
+            return true;
+
+        case(ANSWER_UNKNOWN_COMMAND):
+            Debug_Error("Communication", "ParseReceivedAnswer", "SafeBox does not know the command");
+            Debug_End();
+            return true;
+
+        case(ANSWER_COMMAND_FAILED):
+            Debug_Warning("Communication", "ParseReceivedAnswer", "SafeBox failed to execute the command");
+            Debug_End();
+            return true;
+
+        case(ANSWER_STATUS_EXCHANGE):
+            if(answer->length == 0)
+            {
+                Debug_Error("Communication", "ParseReceivedAnswer", "Status is missing");
+                Debug_End();
+                return false;
+            }
+            statusCode = answer->payload[0];
+            if(answer->length >= STATUS_EXCHANGE_ANSWER_LENGTH)
+            {
+                ClockSync_SaveSample(ClockSync_DecodeTime(&answer->payload[STATUS_EXCHANGE_PAYLOAD_TIME]), ClockSync_DecodeTime(&answer->payload[STATUS_EXCHANGE_PAYLOAD_PEER_TIME]), millis());
+            }
+            break;
+
+        case(ANSWER_SNAPSHOT):
+            if(answer->length <= SNAPSHOT_PAYLOAD_STATUS)
+            {
+                Debug_Error("Communication", "ParseReceivedAnswer", "Snapshot is too short");
+                Debug_End();
+                return false;
+            }
+            currentGarageState = answer->payload[SNAPSHOT_PAYLOAD_GARAGE];
+            currentLidState = answer->payload[SNAPSHOT_PAYLOAD_LID];
+            currentDoorBellState = answer->payload[SNAPSHOT_PAYLOAD_DOORBELL];
+            currentPackageCount = answer->payload[SNAPSHOT_PAYLOAD_PACKAGES];
+            currentPackageCheckState = (currentPackageCount > 0);
+            snapshotSentStatus = snapshotPendingStatus;
+            snapshotTime_ms = millis();
+            snapshotIsValid = true;
+            // The snapshot request carried XFactor's status too.
+            statusSyncAckedStatus = snapshotPendingStatus;
+            statusSyncIsAcked = true;
+            statusCode = answer->payload[SNAPSHOT_PAYLOAD_STATUS];
+            break;
+
+        default:
+            Debug_Error("Communication", "ParseReceivedAnswer", "Answer matched no cases");
+            Debug_End();
+            return false;
     }
 
-    if(answer == ANSWER_DOORBELL_RANG)
+    if(SaveReceivedSafeBoxStatus(statusCode))
     {
-        Debug_Warning("Communication", "ParseAnswerInDifferentCommand", "ANSWER_DOORBELL_RANG");
-        currentDoorBellState = true;
         Debug_End();
         return true;
     }
 
-    if(answer == ANSWER_DOORBELL_NOT_RANG)
+    Debug_Error("Communication", "ParseReceivedAnswer", "Unknown SafeBox status");
+    Debug_End();
+    return false;
+}
+
+//#pragma region [Asynchronous_Commands]
+
+/**
+ * @brief
+ * Submits a command to be sent to SafeBox
+ * without waiting after its answer. Poll the
+ * returned handle with @ref SafeBox_PollCommand
+ * from loop while the program keeps running.
+ *
+ * @param command
+ * One of the COMMAND_ defines.
+ * @return unsigned char:
+ * Handle of the command or
+ * @ref BT_INVALID_REQUEST on failure.
+ */
+unsigned char SafeBox_SubmitCommand(unsigned char command)
+{
+    return BT_SubmitRequest(command, 0, 0, COMMS_TIMEOUT_MS);
+}
+
+/**
+ * @brief
+ * Submits a status exchange built from
+ * XFactor's current status without waiting
+ * after SafeBox's answer. It also carries the
+ * clocks so that @ref ClockSync_SaveSample is
+ * fed by the answer.
+ * @return unsigned char:
+ * Handle of the command or
+ * @ref BT_INVALID_REQUEST on failure.
+ */
+unsigned char SafeBox_SubmitStatusExchange()
+{
+    // - VARIABLES - //
+    unsigned char payload[STATUS_EXCHANGE_COMMAND_LENGTH];
+    unsigned int accuracy_ms = ClockSync_GetAccuracy();
+
+    if(!StatusCodec_EncodeXFactor(XFactor_GetStatus(), &payload[0]))
     {
-        Debug_Warning("Communication", "ParseAnswerInDifferentCommand", "ANSWER_DOORBELL_NOT_RANG");
-        currentDoorBellState = false;
-        Debug_End();
-        return true;
+        Debug_Error("Communication", "SafeBox_SubmitStatusExchange", "Unknown XFactor status");
+        return BT_INVALID_REQUEST;
     }
 
-    if(answer == ANSWER_GARAGE_SUCCESS)
+    // - Submit the status and the clocks as the command's payload
+    ClockSync_EncodeTime(millis(), &payload[STATUS_EXCHANGE_PAYLOAD_TIME]);
+    ClockSync_EncodeTime((unsigned long)ClockSync_GetOffset(), &payload[STATUS_EXCHANGE_PAYLOAD_OFFSET]);
+    payload[STATUS_EXCHANGE_PAYLOAD_ACCURACY] = (unsigned char)accuracy_ms;
+    payload[STATUS_EXCHANGE_PAYLOAD_ACCURACY + 1] = (unsigned char)(accuracy_ms >> 8);
+    payload[STATUS_EXCHANGE_PAYLOAD_DOORBELL_RING] = doorbellEventRing;
+    payload[STATUS_EXCHANGE_PAYLOAD_SESSION] = BT_GetSession();
+    return BT_SubmitRequest(COMMAND_STATUS_EXCHANGE, payload, STATUS_EXCHANGE_COMMAND_LENGTH, COMMS_TIMEOUT_MS);
+}
+
+/**
+ * @brief
+ * Submits a snapshot request carrying XFactor's
+ * current status without waiting after SafeBox's
+ * answer. Once answered, the getters read
+ * SafeBox's status, garage, lid, doorbell and
+ * packages from it.
+ * @return unsigned char:
+ * Handle of the command or
+ * @ref BT_INVALID_REQUEST on failure.
+ */
+unsigned char SafeBox_SubmitSnapshot()
+{
+    // - VARIABLES - //
+    unsigned char statusCode = 0;
+
+    if(!StatusCodec_EncodeXFactor(XFactor_GetStatus(), &statusCode))
     {
-        Debug_Warning("Communication", "ParseAnswerInDifferentCommand", "ANSWER_GARAGE_SUCCESS");
-        currentGarageSuccess = true;
-        Debug_End();
-        return true;
+        Debug_Error("Communication", "SafeBox_SubmitSnapshot", "Unknown XFactor status");
+        return BT_INVALID_REQUEST;
     }
 
-    if(answer == ANSWER_GARAGE_FAILED)
+    // - Submit the status as the command's payload
+    snapshotPendingStatus = XFactor_GetStatus();
+    return BT_SubmitRequest(COMMAND_SNAPSHOT, &statusCode, 1, COMMS_TIMEOUT_MS);
+}
+
+/**
+ * @brief
+ * Checks if a submitted command is done. Once it
+ * is, its answer is parsed so that the getters
+ * and SafeBox's status are updated, and the
+ * handle is released. A command that SafeBox
+ * did not know or failed to execute is
+ * @ref BT_RequestState::Failed
+ *
+ * @warning
+ * Stop polling a handle once this returns
+ * something other than
+ * @ref BT_RequestState::Queued or
+ * @ref BT_RequestState::WaitingForAnswer.
+ *
+ * @param handle
+ * Handle returned by @ref SafeBox_SubmitCommand
+ * @param answer
+ * Optional frame in which the answer is copied
+ * when the command completes. Can be 0.
+ * @return BT_RequestState:
+ * Current state of the command.
+ */
+BT_RequestState SafeBox_PollCommand(unsigned char handle, Protocol_Frame* answer)
+{
+    // - VARIABLES - //
+    Protocol_Frame receivedAnswer;
+    BT_RequestState state = BT_RequestState::Free;
+
+    BT_UpdateRequests();
+    state = BT_GetRequestState(handle);
+
+    switch(state)
     {
-        Debug_Warning("Communication", "ParseAnswerInDifferentCommand", "ANSWER_GARAGE_FAILED");
-        currentGarageSuccess = false;
-        Debug_End();
-        return true;
+        case(BT_RequestState::Queued):
+        case(BT_RequestState::WaitingForAnswer):
+            return state;
+
+        case(BT_RequestState::Completed):
+            BT_GetRequestAnswer(handle, &receivedAnswer);
+            BT_ReleaseRequest(handle);
+            if(answer != 0) memcpy(answer, &receivedAnswer, sizeof(Protocol_Frame));
+            if(!ParseReceivedAnswer(&receivedAnswer))
+            {
+                Debug_Error("Communication", "SafeBox_PollCommand", "UNKNOWN ANSWER");
+            }
+            if(receivedAnswer.opcode == ANSWER_UNKNOWN_COMMAND || receivedAnswer.opcode == ANSWER_COMMAND_FAILED)
+            {
+                return BT_RequestState::Failed;
+            }
+            return state;
+
+        case(BT_RequestState::TimedOut):
+        case(BT_RequestState::Failed):
+            BT_ReleaseRequest(handle);
+            Debug_Warning("Communication", "SafeBox_PollCommand", "Failed to get a reply");
+            return state;
+
+        default:
+            return state;
     }
+}
+
+/**
+ * @brief
+ * Blocks until a submitted command is done and
+ * returns its final state. This is what the
+ * blocking functions below are built on.
+ *
+ * @param handle
+ * Handle returned by @ref SafeBox_SubmitCommand
+ * @param answer
+ * Optional frame in which the answer is copied
+ * when the command completes. Can be 0.
+ * @return BT_RequestState:
+ * Final state of the command.
+ */
+BT_RequestState SafeBox_WaitForCommand(unsigned char handle, Protocol_Frame* answer)
+{
+    // - VARIABLES - //
+    BT_RequestState state = BT_RequestState::Free;
 
-    if(answer == ANSWER_GARAGE_OPEN)
+    if(handle == BT_INVALID_REQUEST) return BT_RequestState::Failed;
+
+    do
     {
-        Debug_Warning("Communication", "ParseAnswerInDifferentCommand", "ANSWER_GARAGE_OPEN");
-        currentGarageState = true;
-        Debug_End();
-        return true;
+        state = SafeBox_PollCommand(handle, answer);
+        // The other tasks keep running while the answer is awaited.
+        Scheduler_Yield();
     }
+    while(state == BT_RequestState::Queued || state == BT_RequestState::WaitingForAnswer);
+
+    return state;
+}
+
+//#pragma endregion
+
+//#pragma region [Snapshot]
+
+/**
+ * @brief
+ * Tells if the last snapshot of SafeBox can
+ * still be used instead of asking SafeBox again.
+ * It is recent if it was received less than
+ * @ref SNAPSHOT_MAX_AGE_MS ago and XFactor's
+ * status did not change since it was sent.
+ * @return true:
+ * The getters can read from memory.
+ * @return false:
+ * A new snapshot must be asked.
+ */
+bool SafeBox_SnapshotIsRecent()
+{
+    if(!snapshotIsValid) return false;
+    if(snapshotSentStatus != XFactor_GetStatus()) return false;
+    return (millis() - snapshotTime_ms) < SNAPSHOT_MAX_AGE_MS;
+}
 
-    if(answer == ANSWER_GARAGE_CLOSED)
+/**
+ * @brief
+ * Asks SafeBox for everything XFactor needs to
+ * know about it in a single round trip. XFactor's
+ * status is exchanged at the same time.
+ * @return true:
+ * Successfully received a snapshot.
+ * @return false:
+ * Failed to receive a snapshot.
+ */
+bool SafeBox_RefreshSnapshot()
+{
+    Debug_Start("SafeBox_RefreshSnapshot");
+    // - VARIABLES - //
+    Protocol_Frame answer;
+
+    if(SafeBox_WaitForCommand(SafeBox_SubmitSnapshot(), &answer) != BT_RequestState::Completed)
     {
-        Debug_Warning("Communication", "ParseAnswerInDifferentCommand", "ANSWER_GARAGE_CLOSED");
-        currentGarageState = false;
+        Debug_Error("Communication", "SafeBox_RefreshSnapshot", "No snapshot received");
         Debug_End();
-        return true;
+        return false;
     }
 
-    if(answer == ANSWER_LID_SUCCESS)
+    // - ANSWER CHECK - //
+    // The answer was already parsed. Only tell if it was a snapshot.
+    if(answer.opcode != ANSWER_SNAPSHOT)
     {
-        Debug_Warning("Communication", "ParseAnswerInDifferentCommand", "ANSWER_LID_SUCCESS");
-        currentLidSuccess = false;
+        Debug_Error("Communication", "SafeBox_RefreshSnapshot", "Received answer did not match:");
+        Debug_Error("Communication", "SafeBox_RefreshSnapshot", String(answer.opcode));
         Debug_End();
-        return true;
+        return false;
     }
-    if(answer == ANSWER_LID_FAILED)
+
+    Debug_End();
+    return true;
+}
+
+/**
+ * @brief
+ * Saves what an event sent by SafeBox tells
+ * about it so that the getters return it right
+ * away. A rang doorbell is remembered until
+ * @ref SafeBox_GetDoorBellStatus returns it.
+ * Repetitions of the same ring are ignored.
+ * @param event
+ * The event frame received from SafeBox.
+ * @return true:
+ * The event was saved.
+ * @return false:
+ * Unknown event.
+ */
+bool SafeBox_SaveReceivedEvent(const Protocol_Frame* event)
+{
+    switch(event->opcode)
     {
-        Debug_Warning("Communication", "ParseAnswerInDifferentCommand", "ANSWER_LID_FAILED");
-        currentLidSuccess = false;
-        Debug_End();
-        return true;
+        case(EVENT_DOORBELL_RANG):
+            // SafeBox repeats the event until a status exchange acknowledges it. A ring must only be returned once.
+            if(event->length >= 1)
+            {
+                if(event->payload[0] == doorbellEventRing) return true;
+                doorbellEventRing = event->payload[0];
+            }
+            Debug_Information("Communication", "SafeBox_SaveReceivedEvent", "EVENT_DOORBELL_RANG");
+            doorbellEventLatched = true;
+            return true;
+
+        case(EVENT_ALARM_STARTED):
+            Debug_Warning("Communication", "SafeBox_SaveReceivedEvent", "EVENT_ALARM_STARTED");
+            SafeBox_SetNewStatus(SafeBox_Status::Alarm);
+            return true;
+
+        case(EVENT_LID_CHANGED):
+            if(event->length < 1) return false;
+            Debug_Information("Communication", "SafeBox_SaveReceivedEvent", "EVENT_LID_CHANGED");
+            currentLidState = event->payload[0];
+            return true;
+
+        case(EVENT_STATUS_CHANGED):
+            if(event->length < 1) return false;
+            return SaveReceivedSafeBoxStatus(event->payload[0]);
+
+        default:
+            Debug_Error("Communication", "SafeBox_SaveReceivedEvent", "Unknown event");
+            Debug_Error("Communication", "SafeBox_SaveReceivedEvent", String(event->opcode));
+            return false;
     }
+}
+
+//#pragma endregion
+
+//#pragma region [Status_Sync]
+
+/**
+ * @brief
+ * Sends XFactor's status to SafeBox when
+ * @ref XFactor_SetNewStatus changed it or when
+ * @ref STATUS_SYNC_HEARTBEAT_MS went by since it
+ * was last sent. SafeBox's answer updates
+ * @ref SafeBox_GetStatus. This never blocks.
+ *
+ * @attention
+ * This must be called periodically from loop.
+ */
+void SafeBox_UpdateStatusSync()
+{
+    // - VARIABLES - //
+    BT_RequestState state = BT_RequestState::Free;
 
-    if(answer == ANSWER_LID_OPEN)
+    // - AWAITED EXCHANGE - //
+    if(statusSyncHandle != BT_INVALID_REQUEST)
     {
-        Debug_Error("Communication", "ParseAnswerInDifferentCommand", "ANSWER_LID_OPEN");
-        currentLidState = true;
-        Debug_End();
-        return true;
+        state = SafeBox_PollCommand(statusSyncHandle, 0);
+        if(state == BT_RequestState::Queued || state == BT_RequestState::WaitingForAnswer) return;
+
+        statusSyncHandle = BT_INVALID_REQUEST;
+        if(state != BT_RequestState::Completed)
+        {
+            // Tried again on the next call.
+            return;
+        }
+        statusSyncAckedStatus = statusSyncPendingStatus;
+        statusSyncIsAcked = true;
     }
 
-    if(answer == ANSWER_LID_CLOSED)
+    // - NEXT EXCHANGE - //
+    if(statusSyncIsAcked && statusSyncAckedStatus == XFactor_GetStatus())
     {
-        Debug_Error("Communication", "ParseAnswerInDifferentCommand", "ANSWER_LID_CLOSED");
-        currentLidState = false;
-        Debug_End();
-        return true;
+        if((millis() - statusSyncSentTime_ms) < STATUS_SYNC_HEARTBEAT_MS) return;
     }
-    if(answer.endsWith("CE"))   {SafeBox_SetNewStatus(SafeBox_Status::CommunicationError);  BT_ClearAllMessages();    Debug_Information("","",answer);     Debug_End();return true;}
-    if(answer.endsWith("O"))    {SafeBox_SetNewStatus(SafeBox_Status::Off);                 BT_ClearAllMessages();    Debug_Information("","",answer);     Debug_End();return true;}
-    if(answer.endsWith("WFX"))  {SafeBox_SetNewStatus(SafeBox_Status::WaitingForXFactor);   BT_ClearAllMessages();    Debug_Information("","",answer);     Debug_End();return true;}
-    if(answer.endsWith("WFD"))  {SafeBox_SetNewStatus(SafeBox_Status::WaitingForDelivery);  BT_ClearAllMessages();    Debug_Information("","",answer);     Debug_End();return true;}
-    if(answer.endsWith("WFRI")) {SafeBox_SetNewStatus(SafeBox_Status::WaitingForRetrieval); BT_ClearAllMessages();    Debug_Information("","",answer);     Debug_End();return true;}
-    if(answer.endsWith("WFR"))  {SafeBox_SetNewStatus(SafeBox_Status::WaitingForReturn);    BT_ClearAllMessages();    Debug_Information("","",answer);     Debug_End();return true;}
-    if(answer.endsWith("RFDO")) {SafeBox_SetNewStatus(SafeBox_Status::ReadyForDropOff);     BT_ClearAllMessages();    Debug_Information("","",answer);     Debug_End();return true;}
-    if(answer.endsWith("U"))    {SafeBox_SetNewStatus(SafeBox_Status::Unlocked);            BT_ClearAllMessages();    Debug_Information("","",answer);     Debug_End();return true;}
-    if(answer.endsWith("DO"))   {SafeBox_SetNewStatus(SafeBox_Status::DroppingOff);         BT_ClearAllMessages();    Debug_Information("","",answer);     Debug_End();return true;}
-    if(answer.endsWith("M"))    {SafeBox_SetNewStatus(SafeBox_Status::Maintenance);         BT_ClearAllMessages();    Debug_Information("","",answer);     Debug_End();return true;}
-    if(answer.endsWith("E"))    {SafeBox_SetNewStatus(SafeBox_Status::Error);               BT_ClearAllMessages();    Debug_Information("","",answer);     Debug_End();return true;}
-    if(answer.endsWith("A"))    {SafeBox_SetNewStatus(SafeBox_Status::Alarm);               BT_ClearAllMessages();    Debug_Information("","",answer);     Debug_End();return true;}
-
-    Debug_Error("Communication", "ParseReceivedAnswer", "Answer matched no cases");
-    Debug_End();
-    return false;
+
+    statusSyncPendingStatus = XFactor_GetStatus();
+    statusSyncHandle = SafeBox_SubmitStatusExchange();
+    statusSyncSentTime_ms = millis();
 }
 
+/**
+ * @brief
+ * Tells if the status of SafeBox saved in
+ * memory can be trusted. It is synced if SafeBox
+ * acknowledged XFactor's current status and told
+ * its own less than
+ * @ref STATUS_SYNC_MAX_AGE_MS ago.
+ * @return true:
+ * @ref SafeBox_GetStatus is up to date.
+ * @return false:
+ * The statuses are not synced yet.
+ */
+bool SafeBox_StatusIsSynced()
+{
+    if(!statusSyncIsAcked) return false;
+    if(statusSyncAckedStatus != XFactor_GetStatus()) return false;
+    return (millis() - safeBoxStatusTime_ms) < STATUS_SYNC_MAX_AGE_MS;
+}
+
+//#pragma endregion
+
 //#pragma region [Command_Requests]
 
 /**
@@ -188,14 +626,11 @@ bool SafeBox_ChangeLidState(bool wantedState)
 {
     Debug_Start("SafeBox_ChangeLidState");
     // - VARIABLES - //
-    String command = wantedState ? COMMAND_LID_OPEN : COMMAND_LID_CLOSE; //Ternary operators go brrr
-    String answer = "";
+    unsigned char command = wantedState ? COMMAND_LID_OPEN : COMMAND_LID_CLOSE; //Ternary operators go brrr
 
-    answer = BT_MessageExchange(command, COMMS_TIMEOUT_MS);
-    if(!ParseReceivedAnswer(answer))
-    {
-        Debug_Error("Communication", "SafeBox_ChangeLidState", "UNKNOWN ANSWER");
-    }
+    SafeBox_WaitForCommand(SafeBox_SubmitCommand(command), 0);
+    // The lid is about to move. What the snapshot says no longer holds.
+    snapshotIsValid = false;
     Debug_End();
     return currentLidSuccess;
 }
@@ -217,19 +652,92 @@ bool SafeBox_ChangeLidState(bool wantedState)
  */
 bool SafeBox_ChangeGarageState(bool wantedState)
 {
-    Debug_Start("SafeBox_ChangeLidState");
+    Debug_Start("SafeBox_ChangeGarageState");
+    // - VARIABLES - //
+    unsigned char command = wantedState ? COMMAND_GARAGE_OPEN : COMMAND_GARAGE_CLOSE; //Ternary operators go brrr
+
+    // Retransmitted until SafeBox acknowledges it. No need to send it more than once.
+    currentGarageSuccess = false;
+    SafeBox_WaitForCommand(SafeBox_SubmitCommand(command), 0);
+    // The garage is about to move. What the snapshot says no longer holds.
+    snapshotIsValid = false;
+    garageOpeningIsScheduled = false;
+    Debug_End();
+    return currentGarageSuccess;
+}
+
+/**
+ * @brief Asks SafeBox to have its garage open
+ * when XFactor arrives instead of waiting for
+ * XFactor to be in front of it. SafeBox starts
+ * opening it early enough for its servo to be
+ * done by then.
+ *
+ * @param arrivalTime_ms
+ * XFactor's millis() at which it expects to be
+ * in front of the garage.
+ * @return true:
+ * SafeBox scheduled the opening.
+ * @return false:
+ * The clocks are not synced or SafeBox did not
+ * acknowledge it.
+ */
+bool SafeBox_ScheduleGarageOpening(unsigned long arrivalTime_ms)
+{
+    Debug_Start("SafeBox_ScheduleGarageOpening");
     // - VARIABLES - //
-    String command = wantedState ? COMMAND_GARAGE_OPEN : COMMAND_GARAGE_CLOSE; //Ternary operators go brrr
-    String answer = "";
+    unsigned char payload[CLOCKSYNC_ENCODED_TIME_LENGTH];
 
-    answer = BT_MessageExchange(command, COMMS_TIMEOUT_MS);
-    if(answer != ANSWER_GARAGE_SUCCESS)
-    if(!ParseReceivedAnswer(answer))
+    if(!ClockSync_IsSynced())
     {
-        Debug_Error("Communication", "SafeBox_ChangeGarageState", "UNKNOWN ANSWER");
+        Debug_Warning("Communication", "SafeBox_ScheduleGarageOpening", "Clocks are not synced");
+        Debug_End();
+        return false;
     }
+
+    // - Submit the arrival time on SafeBox's clock as the command's payload
+    ClockSync_EncodeTime(Local_MillisToPeer(arrivalTime_ms), payload);
+    currentGarageSuccess = false;
+    SafeBox_WaitForCommand(BT_SubmitRequest(COMMAND_GARAGE_OPEN_AT, payload, CLOCKSYNC_ENCODED_TIME_LENGTH, COMMS_TIMEOUT_MS), 0);
+
+    garageOpeningIsScheduled = currentGarageSuccess;
+    garageOpeningTime_ms = arrivalTime_ms;
     Debug_End();
-    return true;
+    return currentGarageSuccess;
+}
+
+/**
+ * @brief Tells if the garage opening scheduled
+ * with @ref SafeBox_ScheduleGarageOpening is
+ * done. SafeBox should have opened the garage
+ * by now. Confirm it with
+ * @ref SafeBox_GetGarageState before driving in.
+ * @return true:
+ * The garage should be open.
+ * @return false:
+ * No opening was scheduled or it is not done
+ * yet.
+ */
+bool SafeBox_GarageOpeningIsDone()
+{
+    if(!garageOpeningIsScheduled) return false;
+    // Time differences handle millis() wrapping around.
+    return (long)(millis() - garageOpeningTime_ms) >= 0;
+}
+
+/**
+ * @brief Tells if a garage opening scheduled
+ * with @ref SafeBox_ScheduleGarageOpening is
+ * still to come. Asking SafeBox to open the
+ * garage is then not needed.
+ * @return true:
+ * SafeBox has not opened the garage yet.
+ * @return false:
+ * No opening was scheduled or it is done.
+ */
+bool SafeBox_GarageOpeningIsPending()
+{
+    return garageOpeningIsScheduled && !SafeBox_GarageOpeningIsDone();
 }
 
 /**
@@ -238,6 +746,9 @@ bool SafeBox_ChangeGarageState(bool wantedState)
  * returned parameter tells if a package was
  * deposited or not.
  *
+ * @note
+ * Read from the last snapshot of SafeBox while
+ * it is recent. See @ref SafeBox_SnapshotIsRecent
  * @return true:
  * A package was successfully deposited inside.
  * @return false:
@@ -246,115 +757,36 @@ bool SafeBox_ChangeGarageState(bool wantedState)
 bool SafeBox_CheckIfPackageDeposited()
 {
     Debug_Start("SafeBox_CheckIfPackageDeposited");
-    // - VARIABLES - //
-    String answer = "";
-
-    answer = BT_MessageExchange(COMMAND_CHECK_PACKAGE, COMMS_TIMEOUT_MS);
-    if(!ParseReceivedAnswer(answer))
-    {
-        Debug_Error("Communication", "SafeBox_CheckIfPackageDeposited", "UNKNOWN ANSWER");
-    }
+    if(!SafeBox_SnapshotIsRecent()) SafeBox_RefreshSnapshot();
+    Debug_End();
     return currentPackageCheckState;
 }
 
 /**
- * @brief Asks SafeBox to return its current
- * status. This is used when an alarm is
- * detected for example and allows both SafeBox
- * and XFactor to exchange their current status at
- * any time. Use Status functions to set and
- * compare their status. This one is only used to
- * exchange the status.
- *
- * @attention
- * This function needs to be called at roughly
- * periodic intervals or whenever a significant
- * event happens. XFactor is the one to initiate
- * this handshake, not SafeBox.
+ * @brief Makes sure that SafeBox and XFactor
+ * know each other's current status. This is used
+ * when an alarm is detected for example. Use
+ * Status functions to set and compare their
+ * status. This one is only used to exchange the
+ * status.
  *
+ * @note
+ * The status are kept synced by
+ * @ref SafeBox_UpdateStatusSync, which the
+ * communication task calls. This never blocks.
+ * It only tells if the status saved in memory
+ * can be used. Call it again on the next pass
+ * if it cannot. See @ref SafeBox_StatusIsSynced
  * @return true:
- * Successfully exchanged the status.
+ * The status are exchanged.
  * @return false:
- * Failed to exchange the status.
+ * The sync is not done yet or SafeBox went
+ * quiet.
  */
 bool SafeBox_ExchangeStatus()
 {
-    Debug_Start("SafeBox_ExchangeStatus");
-    // - VARIABLES - //
-    String command = COMMAND_STATUS_EXCHANGE;
-    String statusEnding = "     ";
-    String answer = "     ";
-    XFactor_Status currentStatus = XFactor_GetStatus();
-
-    // - Get the command ending.
-    switch(currentStatus)
-    {
-        case(XFactor_Status::Alarm):                    statusEnding = "A";     break;
-        case(XFactor_Status::CalculatingRouteHome):     statusEnding = "CRH";   break;
-        case(XFactor_Status::CommunicationError):       statusEnding = "CE";    break;
-        case(XFactor_Status::ConfirmingDropOff):        statusEnding = "CDO";   break;
-        case(XFactor_Status::DroppingOff):              statusEnding = "DO";    break;
-        case(XFactor_Status::EnteringSafeBox):          statusEnding = "ESB";   break;
-        case(XFactor_Status::Error):                    statusEnding = "E";     break;
-        case(XFactor_Status::ExaminatingAPackage):      statusEnding = "EAP";   break;
-        case(XFactor_Status::LeavingSafeBox):           statusEnding = "LSB";   break;
-        case(XFactor_Status::Maintenance):              statusEnding = "M";     break;
-        case(XFactor_Status::NoPackageFound):           statusEnding = "NPF";   break;
-        case(XFactor_Status::Off):                      statusEnding = "O";     break;
-        case(XFactor_Status::PackageDropOffFailed):     statusEnding = "PDOF";  break;
-        case(XFactor_Status::PackageExaminationFailed): statusEnding = "PEF";   break;
-        case(XFactor_Status::PackagePickUpFailed):      statusEnding = "PPUF";  break;
-        case(XFactor_Status::PreparingForDropOff):      statusEnding = "PFDO";  break;
-        case(XFactor_Status::PreparingForTheSearch):    statusEnding = "PFTS";  break;
-        case(XFactor_Status::ReturningHome):            statusEnding = "RH";    break;
-        case(XFactor_Status::SearchingForAPackage):     statusEnding = "SFAP";  break;
-        case(XFactor_Status::WaitingForDelivery):       statusEnding = "WFD";   break;
-        case(XFactor_Status::WaitingAfterSafeBox):      statusEnding = "WASB";  break;
-        case(XFactor_Status::Unlocked):      statusEnding = "U";  break;
-
-        default:
-            Debug_Error("Communication", "SafeBox_ExchangeStatus", "Unknown XFactor status");
-            Debug_Error("Communication", "SafeBox_ExchangeStatus", String((int)currentStatus));
-            Debug_End();
-            return false;
-    }
-
-    // - Build command string and send it
-    command.concat(statusEnding);
-    answer = BT_MessageExchange(command, COMMS_TIMEOUT_MS);
-    BT_ClearAllMessages();
-
-    if (answer == BT_ERROR_MESSAGE)
-    {
-        Debug_Error("Communication", "SafeBox_ExchangeStatus", "BT_MessageExchange Failed");
-        BT_ClearAllMessages();
-        Debug_End();
-        return false;
-    }
-
-    // - ANSWER CHECK - //
-    if(answer.endsWith("CE"))   {SafeBox_SetNewStatus(SafeBox_Status::CommunicationError);  BT_ClearAllMessages();     Debug_End();return true;}
-    if(answer.endsWith("O"))    {SafeBox_SetNewStatus(SafeBox_Status::Off);                 BT_ClearAllMessages();     Debug_End();return true;}
-    if(answer.endsWith("WFX"))  {SafeBox_SetNewStatus(SafeBox_Status::WaitingForXFactor);   BT_ClearAllMessages();     Debug_End();return true;}
-    if(answer.endsWith("WFD"))  {SafeBox_SetNewStatus(SafeBox_Status::WaitingForDelivery);  BT_ClearAllMessages();     Debug_End();return true;}
-    if(answer.endsWith("WFRI")) {SafeBox_SetNewStatus(SafeBox_Status::WaitingForRetrieval); BT_ClearAllMessages();     Debug_End();return true;}
-    if(answer.endsWith("WFR"))  {SafeBox_SetNewStatus(SafeBox_Status::WaitingForReturn);    BT_ClearAllMessages();     Debug_End();return true;}
-    if(answer.endsWith("RFDO")) {SafeBox_SetNewStatus(SafeBox_Status::ReadyForDropOff);     BT_ClearAllMessages();     Debug_End();return true;}
-    if(answer.endsWith("U"))    {SafeBox_SetNewStatus(SafeBox_Status::Unlocked);            BT_ClearAllMessages();     Debug_End();return true;}
-    if(answer.endsWith("DO"))   {SafeBox_SetNewStatus(SafeBox_Status::DroppingOff);         BT_ClearAllMessages();     Debug_End();return true;}
-    if(answer.endsWith("M"))    {SafeBox_SetNewStatus(SafeBox_Status::Maintenance);         BT_ClearAllMessages();     Debug_End();return true;}
-    if(answer.endsWith("E"))    {SafeBox_SetNewStatus(SafeBox_Status::Error);               BT_ClearAllMessages();     Debug_End();return true;}
-    if(answer.endsWith("A"))    {SafeBox_SetNewStatus(SafeBox_Status::Alarm);               BT_ClearAllMessages();     Debug_End();return true;}
-
-    if(!ParseReceivedAnswer(answer))
-    {
-        Debug_Error("Communication", "SafeBox_ExchangeStatus", "Received answer did not match:");
-        Debug_Error("Communication", "SafeBox_ExchangeStatus", answer);
-    }
-
-    BT_ClearAllMessages();
-    Debug_End();
-    return false;
+    // Waiting here would stop every other task. The communication task sends the exchange.
+    return SafeBox_StatusIsSynced();
 }
 
 //#pragma endregion
@@ -364,52 +796,50 @@ bool SafeBox_ExchangeStatus()
 /**
  * @brief Asks SafeBox to give XFactor its
  * current package lid state.
+ * @note
+ * Read from the last snapshot of SafeBox while
+ * it is recent. See @ref SafeBox_SnapshotIsRecent
  * @return true: The lid is opened
  * @return false: The lid is closed
  */
 bool SafeBox_GetLidState()
 {
     Debug_Start("SafeBox_GetLidState");
-    // - VARIABLES - //
-    String answer = "";
-
-    answer = BT_MessageExchange(COMMAND_LID_GET, COMMS_TIMEOUT_MS);
-    if(!ParseReceivedAnswer(answer))
-    {
-        Debug_Error("Communication", "SafeBox_GetLidState", "UNKNOWN ANSWER");
-    }
-    return currentGarageState;
+    if(!SafeBox_SnapshotIsRecent()) SafeBox_RefreshSnapshot();
+    Debug_End();
+    return currentLidState;
 }
 
 /**
  * @brief Asks SafeBox to give XFactor its
  * current garage status.
+ * @note
+ * Read from the last snapshot of SafeBox while
+ * it is recent. See @ref SafeBox_SnapshotIsRecent
  * @return true: The garage is opened
  * @return false: The garage is closed
  */
 bool SafeBox_GetGarageState()
 {
     Debug_Start("SafeBox_GetGarageState");
-    // - VARIABLES - //
-    String answer = "";
-
-    answer = BT_MessageExchange(COMMAND_GARAGE_GET, COMMS_TIMEOUT_MS);
-    if(!ParseReceivedAnswer(answer))
-    {
-        Debug_Error("Communication", "SafeBox_GetGarageState", "UNKNOWN ANSWER");
-    }
+    if(!SafeBox_SnapshotIsRecent()) SafeBox_RefreshSnapshot();
+    Debug_End();
     return currentGarageState;
 }
 
 /**
  * @brief Asks SafeBox to tell XFactor how many
  * packages are currently deposited inside of it
+ * @note
+ * Read from the last snapshot of SafeBox while
+ * it is recent. See @ref SafeBox_SnapshotIsRecent
  * @return int: How many packages are currently
  * deposited.
  */
 int SafeBox_GetPackagesDeposited()
 {
-    return -1;
+    if(!SafeBox_SnapshotIsRecent() && !SafeBox_RefreshSnapshot()) return -1;
+    return currentPackageCount;
 }
 
 /**
@@ -417,21 +847,77 @@ int SafeBox_GetPackagesDeposited()
  * current Doorbell status. This allowed it to
  * know if it should start the package retrieval
  * or not.
+ * @note
+ * SafeBox sends @ref EVENT_DOORBELL_RANG when it
+ * rings, so this does not ask SafeBox. It reads
+ * the last snapshot otherwise.
  * @return true: The doorbell was activated.
  * @return false: The doorbell wasn't activated.
  */
 bool SafeBox_GetDoorBellStatus()
 {
     Debug_Start("SafeBox_GetDoorBellStatus");
+    // SafeBox tells XFactor when its doorbell rings. No need to ask.
+    BT_UpdateRequests();
+    if(doorbellEventLatched)
+    {
+        doorbellEventLatched = false;
+        Debug_End();
+        return true;
+    }
+
+    if(!SafeBox_SnapshotIsRecent()) SafeBox_RefreshSnapshot();
+    Debug_End();
+    return currentDoorBellState;
+}
+
+//#pragma endregion
+
+//#pragma region [Statistics]
+
+/**
+ * @brief
+ * Prints XFactor's Bluetooth statistics on the
+ * debug serial port, then asks SafeBox for its
+ * own and prints them too.
+ * @return true:
+ * Both statistics were printed.
+ * @return false:
+ * SafeBox did not send its statistics.
+ */
+bool SafeBox_PrintLinkStats()
+{
+    Debug_Start("SafeBox_PrintLinkStats");
     // - VARIABLES - //
-    String answer = "";
+    Protocol_Frame answer;
+    BT_Stats safeBoxStats;
+    unsigned char handle = BT_SubmitRequest(COMMAND_LINK_STATS, 0, 0, COMMS_TIMEOUT_MS);
+
+    Debug_Information("Communication", "SafeBox_PrintLinkStats", "XFactor:");
+    BT_PrintStats(BT_GetStats());
 
-    answer = BT_MessageExchange(COMMAND_DOORBELL_GET, COMMS_TIMEOUT_MS);
-    if(!ParseReceivedAnswer(answer))
+    // - FUNCTION EXECUTION - //
+    // Not parsed by ParseReceivedAnswer. It holds no status.
+    if(BT_WaitForRequest(handle) != BT_RequestState::Completed || !BT_GetRequestAnswer(handle, &answer))
     {
-        Debug_Error("Communication", "SafeBox_GetDoorBellStatus", "UNKNOWN ANSWER");
+        BT_ReleaseRequest(handle);
+        Debug_Warning("Communication", "SafeBox_PrintLinkStats", "SafeBox did not answer");
+        Debug_End();
+        return false;
     }
-    return currentDoorBellState;
+    BT_ReleaseRequest(handle);
+
+    if(answer.opcode != ANSWER_LINK_STATS || !BT_DecodeStats(answer.payload, answer.length, &safeBoxStats))
+    {
+        Debug_Error("Communication", "SafeBox_PrintLinkStats", "Wrong answer");
+        Debug_End();
+        return false;
+    }
+
+    Debug_Information("Communication", "SafeBox_PrintLinkStats", "SafeBox:");
+    BT_PrintStats(&safeBoxStats);
+    Debug_End();
+    return true;
 }
 
-//#pragma endregion
\ No newline at end of file
+//#pragma endregion
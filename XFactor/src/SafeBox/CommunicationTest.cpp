@@ -15,230 +15,392 @@
 
 // - DEFINES - //
 
+/// @brief How many round trips took each millisecond. Indexed by round trip in milliseconds.
+unsigned int _roundTripSlots[SELF_TEST_ROUND_TRIP_SLOTS];
+unsigned long _roundTripCount = 0;
+unsigned long _roundTripSum_ms = 0;
+unsigned long _roundTripMin_ms = 0;
+/// @brief Commands that were never answered.
+unsigned long _transportErrors = 0;
+/// @brief Commands answered with the wrong opcode or an invalid payload.
+unsigned long _answerErrors = 0;
+/// @brief One bit per SafeBox status code received in an answer. Bit 0 of byte 0 is code 0.
+unsigned char _receivedSafeBoxCodes[32];
+/// @brief How long the benchmark of status exchanges took.
+unsigned long _benchmark_ms = 0;
+/// @brief Set once the results are printed.
+bool _selfTestIsDone = false;
+
 // - FUNCTIONS - //
 
 /**
  * @brief
- * Call this in main.cpp to test communications
- * between XFactor and SafeBox.
+ * Forgets every round trip and error counted
+ * by the self-test as well as the link's
+ * statistics.
  */
-void TestGoodCommunications()
+void ResetSelfTestResults()
 {
-    Debug_Start("TestGoodCommunications");
-    // - VARIABLES - //
-    static unsigned char currentTest = 0;
+    memset(_roundTripSlots, 0, sizeof(_roundTripSlots));
+    memset(_receivedSafeBoxCodes, 0, sizeof(_receivedSafeBoxCodes));
+    _roundTripCount = 0;
+    _roundTripSum_ms = 0;
+    _roundTripMin_ms = 0;
+    _transportErrors = 0;
+    _answerErrors = 0;
+    _benchmark_ms = 0;
+    BT_ResetStats();
+}
+
+/**
+ * @brief
+ * Adds a measured round trip to the ones used
+ * to compute the min, average and p99.
+ * @param roundTrip_ms
+ * Time in between the submission of a command
+ * and the reception of its answer.
+ */
+void SaveSelfTestRoundTrip(unsigned long roundTrip_ms)
+{
+    if(_roundTripCount == 0 || roundTrip_ms < _roundTripMin_ms) _roundTripMin_ms = roundTrip_ms;
+    _roundTripCount++;
+    _roundTripSum_ms += roundTrip_ms;
+    if(roundTrip_ms >= SELF_TEST_ROUND_TRIP_SLOTS) roundTrip_ms = SELF_TEST_ROUND_TRIP_SLOTS - 1;
+    _roundTripSlots[roundTrip_ms]++;
+}
 
-    // LEDS_SetColor(0, 64, 32, 0);
-    // delay(100);
+/**
+ * @brief
+ * Gets the round trip that 99% of the measured
+ * ones did not exceed.
+ * @return unsigned long:
+ * p99 in milliseconds. Saturates at
+ * @ref SELF_TEST_ROUND_TRIP_SLOTS minus 1.
+ */
+unsigned long GetSelfTestRoundTripP99()
+{
+    // - VARIABLES - //
+    unsigned long wanted = (_roundTripCount * 99 + 99) / 100;
+    unsigned long counted = 0;
 
-    switch(currentTest)
+    for(unsigned int slot = 0; slot < SELF_TEST_ROUND_TRIP_SLOTS; slot++)
     {
-        case(0):
-            Debug_Information("TEST", "SafeBox_ChangeLidState", "Testing Lid open");
-            if(SafeBox_ChangeLidState(true))
-            {
-                Debug_Information("TEST", "SafeBox_ChangeLidState", "OPEN SUCCESS");
-                currentTest++;
-                Debug_End();
-                return;
-            }
-            Debug_Error("TEST", "SafeBox_ChangeLidState", "OPEN FAILED");
-            break;
-
-        case(1):
-            if(SafeBox_ChangeLidState(false))
-            {
-                Debug_Information("TEST", "SafeBox_ChangeLidState", "CLOSE SUCCESS");
-                currentTest++;
-                Debug_End();
-                return;
-            }
-            Debug_Error("TEST", "SafeBox_ChangeLidState", "CLOSE FAILED");
-            break;
-
-        case(2):
-            if(SafeBox_ChangeGarageState(true))
-            {
-                Debug_Information("TEST", "SafeBox_ChangeGarageState", "OPEN SUCCESS");
-                currentTest++;
-                Debug_End();
-                return;
-            }
-            Debug_Error("TEST", "SafeBox_ChangeGarageState", "OPEN FAILED");
-            break;
-
-        case(3):
-            if(SafeBox_ChangeGarageState(false))
-            {
-                Debug_Information("TEST", "SafeBox_ChangeGarageState", "CLOSE SUCCESS");
-                currentTest++;
-                Debug_End();
-                return;
-            }
-            Debug_Error("TEST", "SafeBox_ChangeGarageState", "CLOSE FAILED");
-            break;
-
-        case(4):
-            if(SafeBox_GetDoorBellStatus())
-            {
-                Debug_Information("TEST", "SafeBox_GetDoorBellStatus", "SUCCESS");
-                currentTest++;
-                Debug_End();
-                return;
-            }
-            Debug_Error("TEST", "SafeBox_ChangeGarageState", "DOORBELL FAILED");
-            break;
-
-        case(5):
-            if(SafeBox_CheckIfPackageDeposited())
-            {
-                Debug_Information("TEST", "SafeBox_CheckIfPackageDeposited", "SUCCESS");
-                currentTest++;
-                Debug_End();
-                return;
-            }
-            Debug_Error("TEST", "SafeBox_CheckIfPackageDeposited", "PACKAGE CHECK FAILED");
-            break;
-
-        case(6):
-            XFactor_SetNewStatus(XFactor_Status::WaitingForDelivery);
-            if(SafeBox_ExchangeStatus())
-            {
-                Debug_Information("TEST", "SafeBox_ExchangeStatus", "SUCCESS");
-                currentTest++;
-                Debug_End();
-                return;
-            }
-            Debug_Error("TEST", "SafeBox_ExchangeStatus", "STATUS EXCHANGE FAILED");
-            break;
+        counted += _roundTripSlots[slot];
+        if(counted >= wanted && counted > 0) return slot;
     }
+    return SELF_TEST_ROUND_TRIP_SLOTS - 1;
+}
+
+/**
+ * @brief
+ * Counts how many bits are set in one of the
+ * tables of codes.
+ * @param codes
+ * 32 bytes table. Bit 0 of byte 0 is code 0.
+ * @return unsigned int:
+ * How many codes are set.
+ */
+unsigned int CountSelfTestCodes(const unsigned char* codes)
+{
+    // - VARIABLES - //
+    unsigned int count = 0;
 
-    if(currentTest == 7)
+    for(unsigned char i = 0; i < 32; i++)
     {
-        Debug_Information("TEST", "RESULT", "SUCCESS");
-        Debug_End();
-        delay(5000);
-        return;
+        for(unsigned char bit = 0; bit < 8; bit++)
+        {
+            if(codes[i] & (1 << bit)) count++;
+        }
     }
-
-    delay(5000);
-    Debug_End();
+    return count;
 }
 
-bool TestOneStatus(int testNumber, XFactor_Status status)
+/**
+ * @brief
+ * Waits after a submitted command and times its
+ * round trip. Errors are counted.
+ * @param handle
+ * Handle returned when the command was
+ * submitted.
+ * @param submitTime_ms
+ * millis() right before the command was
+ * submitted.
+ * @param answer
+ * Frame in which the answer is copied.
+ * @return true:
+ * The command got an answer.
+ * @return false:
+ * The command was never answered.
+ */
+bool WaitForSelfTestAnswer(unsigned char handle, unsigned long submitTime_ms, Protocol_Frame* answer)
 {
-    XFactor_SetNewStatus(status);
-    if(SafeBox_ExchangeStatus())
+    if(SafeBox_WaitForCommand(handle, answer) != BT_RequestState::Completed)
     {
-        Debug_Information("TEST", "SafeBox_ExchangeStatus", "SUCCESS");
-        return true;
+        _transportErrors++;
+        return false;
     }
-    Debug_Error("TEST", "SafeBox_ExchangeStatus", "CLOSE FAILED");
-    Debug_Error("TEST", "FAILED", String(testNumber));
-    return false;
+
+    SaveSelfTestRoundTrip(millis() - submitTime_ms);
+    return true;
 }
 
-void TestAllStatusCommunications()
+/**
+ * @brief
+ * Sends a command once and checks that SafeBox
+ * answered it with an answer opcode.
+ * @param opcode
+ * One of the COMMAND_ defines.
+ * @param payload
+ * Bytes sent with the opcode. Can be 0 if
+ * length is 0.
+ * @param length
+ * How many bytes of payload there is.
+ * @return true:
+ * SafeBox answered the command.
+ * @return false:
+ * No answer or an invalid one was received.
+ */
+bool TestOneCommand(unsigned char opcode, const unsigned char* payload, unsigned char length)
 {
     // - VARIABLES - //
-    static unsigned char currentTest = 0;
+    Protocol_Frame answer;
+    unsigned long submitTime_ms = millis();
+
+    if(!WaitForSelfTestAnswer(BT_SubmitRequest(opcode, payload, length, COMMS_TIMEOUT_MS), submitTime_ms, &answer))
+    {
+        Debug_Error("TEST", "TestOneCommand", "NO ANSWER TO " + String(opcode));
+        return false;
+    }
 
-    switch(currentTest)
+    if(answer.opcode < 0x80 || answer.opcode >= PROTOCOL_FIRST_TELEMETRY_OPCODE || answer.opcode == ANSWER_UNKNOWN_COMMAND || answer.opcode == ANSWER_COMMAND_FAILED)
     {
-        case(0):
-            if(TestOneStatus(0, XFactor_Status::Alarm)) currentTest++;
-            return;
+        _answerErrors++;
+        Debug_Error("TEST", "TestOneCommand", "BAD ANSWER TO " + String(opcode));
+        return false;
+    }
+    return true;
+}
 
-        case(1):
-            if(TestOneStatus(1, XFactor_Status::CalculatingRouteHome)) currentTest++;
-            return;
+/**
+ * @brief
+ * Sends every command that SafeBox handles
+ * once. What the lid and garage are asked to do
+ * is undone right after. @ref COMMAND_LINK_STATS
+ * is sent when the results are printed.
+ */
+void TestAllCommands()
+{
+    // - VARIABLES - //
+    unsigned char payload[CLOCKSYNC_ENCODED_TIME_LENGTH];
+    unsigned char statusCode = 0;
+
+    StatusCodec_EncodeXFactor(XFactor_GetStatus(), &statusCode);
+    TestOneCommand(COMMAND_LID_OPEN, 0, 0);
+    TestOneCommand(COMMAND_LID_CLOSE, 0, 0);
+    TestOneCommand(COMMAND_LID_GET, 0, 0);
+    TestOneCommand(COMMAND_GARAGE_OPEN, 0, 0);
+    TestOneCommand(COMMAND_GARAGE_GET, 0, 0);
+    TestOneCommand(COMMAND_GARAGE_CLOSE, 0, 0);
+    TestOneCommand(COMMAND_DOORBELL_GET, 0, 0);
+    TestOneCommand(COMMAND_GET_PACKAGE_COUNT, 0, 0);
+    TestOneCommand(COMMAND_CHECK_PACKAGE, 0, 0);
+    TestOneCommand(COMMAND_SNAPSHOT, &statusCode, 1);
+
+    // Scheduled in the past so that SafeBox opens the garage right away.
+    ClockSync_EncodeTime(Local_MillisToPeer(millis()), payload);
+    TestOneCommand(COMMAND_GARAGE_OPEN_AT, payload, CLOCKSYNC_ENCODED_TIME_LENGTH);
+    TestOneCommand(COMMAND_GARAGE_CLOSE, 0, 0);
+}
 
-        case(2):
-            if(TestOneStatus(2, XFactor_Status::CommunicationError)) currentTest++;
-            return;
+/**
+ * @brief
+ * Prints the results of the self-test along
+ * with the link statistics of both devices.
+ */
+void PrintSelfTestResults()
+{
+    // - VARIABLES - //
+    unsigned long average_ms = (_roundTripCount == 0) ? 0 : (_roundTripSum_ms / _roundTripCount);
+    float exchangesPerSecond = GetSelfTestExchangesPerSecond();
+    unsigned int validSafeBoxCodes = 0;
+    SafeBox_Status status = SafeBox_Status::Off;
 
-        case(3):
-            if(TestOneStatus(3, XFactor_Status::ConfirmingDropOff)) currentTest++;
-            return;
+    for(unsigned int code = 0; code < 256; code++)
+    {
+        if(StatusCodec_DecodeSafeBox((unsigned char)code, &status)) validSafeBoxCodes++;
+    }
 
-        case(4):
-            if(TestOneStatus(4, XFactor_Status::DroppingOff)) currentTest++;
-            return;
+    Debug_Information("TEST", "RESULT", "Round trips: " + String(_roundTripCount) + " Min: " + String(_roundTripMin_ms) + "ms Avg: " + String(average_ms) + "ms p99: " + String(GetSelfTestRoundTripP99()) + "ms");
+    Debug_Information("TEST", "RESULT", "Throughput: " + String(exchangesPerSecond) + " exchanges/s");
+    Debug_Information("TEST", "RESULT", "No answer: " + String(_transportErrors) + " Bad answer: " + String(_answerErrors));
+    Debug_Information("TEST", "RESULT", "SafeBox status received: " + String(CountSelfTestCodes(_receivedSafeBoxCodes)) + "/" + String(validSafeBoxCodes));
+    SafeBox_PrintLinkStats();
 
-        case(5):
-            if(TestOneStatus(4, XFactor_Status::EnteringSafeBox)) currentTest++;
-            return;
+    if(_transportErrors == 0 && _answerErrors == 0)
+    {
+        Debug_Information("TEST", "RESULT", "SUCCESS");
+        return;
+    }
+    Debug_Error("TEST", "RESULT", "FAILED");
+}
 
-        case(6):
-            if(TestOneStatus(6, XFactor_Status::Error)) currentTest++;
-            return;
+/**
+ * @brief
+ * Call this in main.cpp to test communications
+ * between XFactor and SafeBox. Exchanges every
+ * status code, sends every command once and
+ * then times @ref SELF_TEST_BENCHMARK_EXCHANGES
+ * status exchanges. The round trip min, average
+ * and p99, the exchanges per second and the
+ * error counts are then reported along with the
+ * link statistics of both devices. Runs once.
+ */
+void TestGoodCommunications()
+{
+    Debug_Start("TestGoodCommunications");
+    // - VARIABLES - //
+    XFactor_Status initialStatus = XFactor_GetStatus();
+    unsigned long benchmarkStart_ms = 0;
 
-        case(7):
-            if(TestOneStatus(7, XFactor_Status::ExaminatingAPackage)) currentTest++;
-            return;
+    if(_selfTestIsDone)
+    {
+        BT_UpdateRequests();
+        Debug_End();
+        return;
+    }
 
-        case(8):
-            if(TestOneStatus(8, XFactor_Status::LeavingSafeBox)) currentTest++;
-            return;
+    ResetSelfTestResults();
 
-        case(9):
-            if(TestOneStatus(9, XFactor_Status::Maintenance)) currentTest++;
-            return;
+    // Status first so that the clocks are synced before COMMAND_GARAGE_OPEN_AT.
+    Debug_Information("TEST", "TestGoodCommunications", "Testing every status");
+    TestAllStatusCommunications();
+    Debug_Information("TEST", "TestGoodCommunications", "Testing every command");
+    TestAllCommands();
 
-        case(10):
-            if(TestOneStatus(10, XFactor_Status::NoPackageFound)) currentTest++;
-            return;
+    Debug_Information("TEST", "TestGoodCommunications", "Benchmarking status exchanges");
+    benchmarkStart_ms = millis();
+    for(unsigned int i = 0; i < SELF_TEST_BENCHMARK_EXCHANGES; i++)
+    {
+        TestOneStatus(i, initialStatus);
+    }
 
-        case(11):
-            if(TestOneStatus(11, XFactor_Status::Off)) currentTest++;
-            return;
+    _benchmark_ms = millis() - benchmarkStart_ms;
 
-        case(12):
-            if(TestOneStatus(12, XFactor_Status::PackageDropOffFailed)) currentTest++;
-            return;
+    PrintSelfTestResults();
+    _selfTestIsDone = true;
+    Debug_End();
+}
 
-        case(13):
-            if(TestOneStatus(13, XFactor_Status::PackageExaminationFailed)) currentTest++;
-            return;
+/**
+ * @brief
+ * Exchanges one of XFactor's status with
+ * SafeBox and checks that SafeBox answered with
+ * a valid status of its own.
+ * @param testNumber
+ * Number printed if the test fails.
+ * @param status
+ * The status sent to SafeBox.
+ * @return true:
+ * SafeBox answered with a valid status.
+ * @return false:
+ * No answer or an invalid one was received.
+ */
+bool TestOneStatus(int testNumber, XFactor_Status status)
+{
+    // - VARIABLES - //
+    Protocol_Frame answer;
+    SafeBox_Status safeBoxStatus = SafeBox_Status::Off;
+    unsigned long submitTime_ms = millis();
 
-        case(14):
-            if(TestOneStatus(14, XFactor_Status::PackagePickUpFailed)) currentTest++;
-            return;
+    XFactor_SetNewStatus(status);
+    if(!WaitForSelfTestAnswer(SafeBox_SubmitStatusExchange(), submitTime_ms, &answer))
+    {
+        Debug_Error("TEST", "SafeBox_ExchangeStatus", "NO ANSWER");
+        Debug_Error("TEST", "FAILED", String(testNumber));
+        return false;
+    }
 
-        case(15):
-            if(TestOneStatus(15, XFactor_Status::PickingUpAPackage)) currentTest++;
-            return;
+    if(answer.opcode != ANSWER_STATUS_EXCHANGE || answer.length < 1 || !StatusCodec_DecodeSafeBox(answer.payload[0], &safeBoxStatus))
+    {
+        _answerErrors++;
+        Debug_Error("TEST", "SafeBox_ExchangeStatus", "BAD ANSWER");
+        Debug_Error("TEST", "FAILED", String(testNumber));
+        return false;
+    }
 
-        case(16):
-            if(TestOneStatus(16, XFactor_Status::PreparingForDropOff)) currentTest++;
-            return;
+    _receivedSafeBoxCodes[answer.payload[0] >> 3] |= (1 << (answer.payload[0] & 0x07));
+    return true;
+}
 
-        case(17):
-            if(TestOneStatus(17, XFactor_Status::PreparingForTheSearch)) currentTest++;
-            return;
+/**
+ * @brief
+ * Calls @ref TestOneStatus with every valid
+ * @ref XFactor_Status
+ */
+void TestAllStatusCommunications()
+{
+    // - VARIABLES - //
+    XFactor_Status status = XFactor_Status::Off;
+    int testNumber = 0;
 
-        case(18):
-            if(TestOneStatus(18, XFactor_Status::ReturningHome)) currentTest++;
-            return;
+    for(unsigned int code = 0; code < 256; code++)
+    {
+        if(!StatusCodec_DecodeXFactor((unsigned char)code, &status)) continue;
+        TestOneStatus(testNumber++, status);
+    }
+}
 
-        case(19):
-            if(TestOneStatus(19, XFactor_Status::SearchingForAPackage)) currentTest++;
-            return;
+/**
+ * @brief
+ * Tells if @ref TestGoodCommunications is done
+ * and printed its results.
+ * @return true:
+ * The getters below return the final results.
+ */
+bool SelfTestIsDone()
+{
+    return _selfTestIsDone;
+}
 
-        case(20):
-            if(TestOneStatus(20, XFactor_Status::WaitingAfterSafeBox)) currentTest++;
-            return;
+/**
+ * @brief
+ * Returns how many commands and status
+ * exchanges were answered during the self-test.
+ */
+unsigned long GetSelfTestRoundTrips()
+{
+    return _roundTripCount;
+}
 
-        case(21):
-            if(TestOneStatus(21, XFactor_Status::WaitingForDelivery)) currentTest++;
-            return;
-    }
+/**
+ * @brief
+ * Returns how many commands and status
+ * exchanges were not answered or answered with
+ * something invalid.
+ */
+unsigned long GetSelfTestErrors()
+{
+    return _transportErrors + _answerErrors;
+}
 
-    if(currentTest == 22)
-    {
-        Debug_Information("TEST", "RESULT", "SUCCESS");
-        currentTest = 23;
-    }
+/**
+ * @brief
+ * Returns how many of the benchmark's status
+ * exchanges were done per second.
+ * @return float:
+ * 0 until the benchmark is done.
+ */
+float GetSelfTestExchangesPerSecond()
+{
+    return (_benchmark_ms == 0) ? 0.0f : (SELF_TEST_BENCHMARK_EXCHANGES * 1000.0f / _benchmark_ms);
+}
 
-    delay(1000);
-}
\ No newline at end of file
+/**
+ * @brief
+ * Returns how many different status codes
+ * SafeBox answered with during the self-test.
+ */
+unsigned int GetSelfTestReceivedStatus()
+{
+    return CountSelfTestCodes(_receivedSafeBoxCodes);
+}
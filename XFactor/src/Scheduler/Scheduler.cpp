@@ -0,0 +1,235 @@
+/**
+ * @file Scheduler.cpp
+ * @author LyamBRS (lyam.brs@gmail.com)
+ * @brief
+ * File containing the cooperative scheduler
+ * that runs XFactor's periodic tasks. Tasks are
+ * plain functions registered with a period and
+ * a time budget. They run to completion in the
+ * order they were registered. Code that has to
+ * wait, such as a movement, calls
+ * @ref Scheduler_Yield so that the other tasks
+ * keep running meanwhile.
+ * @version 0.1
+ * @date 2023-12-04
+ * @copyright Copyright (c) 2023
+ */
+
+// - INCLUDES - //
+#include "Scheduler/Scheduler.hpp"
+
+/// @brief Every registered task. Indexed by task ID.
+Scheduler_Task _tasks[SCHEDULER_MAX_TASKS];
+unsigned char _taskCount = 0;
+
+/**
+ * @brief
+ * Runs a task once and updates its statistics.
+ * Periodic tasks are then due one period after
+ * they were due so that their rate does not
+ * drift.
+ * @param task
+ * The task to run.
+ * @param now_us
+ * micros() when the task was found to be due.
+ */
+void RunTask(Scheduler_Task* task, unsigned long now_us)
+{
+    // - VARIABLES - //
+    unsigned long jitter_us = 0;
+    unsigned long duration_us = 0;
+
+    if(task->period_us != SCHEDULER_EVERY_PASS)
+    {
+        jitter_us = now_us - task->due_us;
+        if(jitter_us > task->maxJitter_us) task->maxJitter_us = jitter_us;
+        task->totalJitter_us += jitter_us;
+
+        if(jitter_us >= task->period_us)
+        {
+            // Runs once for all the periods that were missed.
+            task->missedPeriods += jitter_us / task->period_us;
+            task->due_us = now_us + task->period_us;
+        }
+        else
+        {
+            task->due_us += task->period_us;
+        }
+    }
+
+    task->isRunning = true;
+    task->function();
+    task->isRunning = false;
+
+    duration_us = micros() - now_us;
+    task->runs++;
+    if(duration_us > task->maxDuration_us) task->maxDuration_us = duration_us;
+    if(task->budget_us != SCHEDULER_NO_BUDGET && duration_us > task->budget_us) task->overruns++;
+}
+
+/**
+ * @brief
+ * Registers a new task. Tasks run in the order
+ * they are registered, which makes the first
+ * ones the most important. Periodic tasks are
+ * first due one period after being registered.
+ * @param name
+ * Name of the task printed in its statistics.
+ * @param function
+ * Function executed each time the task runs.
+ * @param period_us
+ * Time in microseconds in between the start of
+ * two runs or @ref SCHEDULER_EVERY_PASS
+ * @param budget_us
+ * Longest that a run should take or
+ * @ref SCHEDULER_NO_BUDGET
+ * @return unsigned char:
+ * ID of the task or @ref SCHEDULER_INVALID_TASK
+ * if the table is full.
+ */
+unsigned char Scheduler_AddTask(const char* name, Scheduler_TaskFunction function, unsigned long period_us, unsigned long budget_us)
+{
+    // - VARIABLES - //
+    Scheduler_Task* task = 0;
+
+    // - PRELIMINARY CHECKS - //
+    if(function == 0) return SCHEDULER_INVALID_TASK;
+    if(_taskCount >= SCHEDULER_MAX_TASKS)
+    {
+        Debug_Error("Scheduler", "Scheduler_AddTask", "Task table is full");
+        return SCHEDULER_INVALID_TASK;
+    }
+
+    // - FUNCTION EXECUTION - //
+    task = &_tasks[_taskCount];
+    memset(task, 0, sizeof(Scheduler_Task));
+    task->name = name;
+    task->function = function;
+    task->period_us = period_us;
+    task->budget_us = budget_us;
+    task->due_us = micros() + period_us;
+    return _taskCount++;
+}
+
+/**
+ * @brief
+ * Runs each task that is due once, in the order
+ * they were registered. A late periodic task
+ * runs once and then catches up on its period
+ * instead of running for each missed period.
+ *
+ * @attention
+ * This must be called from loop.
+ */
+void Scheduler_Run()
+{
+    // - VARIABLES - //
+    Scheduler_Task* task = 0;
+    unsigned long now_us = 0;
+
+    for(unsigned char i = 0; i < _taskCount; i++)
+    {
+        task = &_tasks[i];
+        if(task->isRunning) continue;
+
+        now_us = micros();
+        // Time differences handle micros() wrapping around.
+        if(task->period_us != SCHEDULER_EVERY_PASS && (long)(now_us - task->due_us) < 0) continue;
+
+        RunTask(task, now_us);
+    }
+}
+
+/**
+ * @brief
+ * Lets the tasks that are due run while the
+ * calling task waits. Tasks that are already
+ * running, such as the caller, are skipped.
+ * Call this in every loop that waits after
+ * something.
+ */
+void Scheduler_Yield()
+{
+    Scheduler_Run();
+}
+
+/**
+ * @brief
+ * Waits for the specified time while letting
+ * the other tasks run. Replaces delay() in
+ * tasks.
+ * @param milliseconds
+ * How long to wait.
+ */
+void Scheduler_Delay(unsigned long milliseconds)
+{
+    // - VARIABLES - //
+    unsigned long start_ms = millis();
+
+    while(millis() - start_ms < milliseconds)
+    {
+        Scheduler_Yield();
+    }
+}
+
+/**
+ * @brief
+ * Returns a registered task and its statistics.
+ * @param taskID
+ * ID returned by @ref Scheduler_AddTask
+ * @return const Scheduler_Task*:
+ * The task or 0 if the ID is not valid.
+ */
+const Scheduler_Task* Scheduler_GetTask(unsigned char taskID)
+{
+    if(taskID >= _taskCount) return 0;
+    return &_tasks[taskID];
+}
+
+/**
+ * @brief
+ * Returns how many tasks are registered. Their
+ * IDs go from 0 to this minus 1.
+ * @return unsigned char:
+ * Number of registered tasks.
+ */
+unsigned char Scheduler_GetTaskCount()
+{
+    return _taskCount;
+}
+
+/**
+ * @brief
+ * Clears the statistics of every task.
+ */
+void Scheduler_ResetStats()
+{
+    for(unsigned char i = 0; i < _taskCount; i++)
+    {
+        _tasks[i].runs = 0;
+        _tasks[i].overruns = 0;
+        _tasks[i].missedPeriods = 0;
+        _tasks[i].maxJitter_us = 0;
+        _tasks[i].totalJitter_us = 0;
+        _tasks[i].maxDuration_us = 0;
+    }
+}
+
+/**
+ * @brief
+ * Prints the runs, overruns, missed periods,
+ * jitter and longest run of every task.
+ */
+void Scheduler_PrintStats()
+{
+    // - VARIABLES - //
+    const Scheduler_Task* task = 0;
+    unsigned long averageJitter_us = 0;
+
+    for(unsigned char i = 0; i < _taskCount; i++)
+    {
+        task = &_tasks[i];
+        averageJitter_us = (task->runs == 0) ? 0 : (task->totalJitter_us / task->runs);
+        Debug_Information("Scheduler", task->name, "Runs: " + String(task->runs) + " Overruns: " + String(task->overruns) + " Missed: " + String(task->missedPeriods) + " Jitter avg: " + String(averageJitter_us) + "us max: " + String(task->maxJitter_us) + "us Longest: " + String(task->maxDuration_us) + "us");
+    }
+}
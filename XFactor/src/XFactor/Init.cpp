@@ -28,7 +28,7 @@ void XFactor_Init()
 
     if (Debug_Init()){
         Debug_Start("XFactor_Init");
-        if(BT_Init()){
+        if(BT_Init() && BT_InitRequests()){
             /**
              * @brief
             * DO NOT TOUCH
@@ -102,13 +102,15 @@ void XFactor_Init()
 
                 if(Alarm_Init()){
                     if(Package_Init()){
-                        if(XFactor_SetNewStatus(XFactor_Status::WaitingForDelivery)){
-                            if(SetNewExecutionFunction(FUNCTION_ID_WAIT_AFTER_SAFEBOX)){
-                                Debug_Information("Init", "XFactor_Init", "Successful initialisation");
-                                Debug_End();
-                                return;
-                            } else Debug_Error("Init", "XFactor_Init", "SetNewExecutionFunction Failed");
-                        } else Debug_Error("Init", "XFactor_Init", "XFactor_SetNewStatus Failed");
+                        if(MotionControl_Init()){
+                            if(XFactor_SetNewStatus(XFactor_Status::WaitingForDelivery)){
+                                if(SetNewExecutionFunction(FUNCTION_ID_WAIT_AFTER_SAFEBOX)){
+                                    Debug_Information("Init", "XFactor_Init", "Successful initialisation");
+                                    Debug_End();
+                                    return;
+                                } else Debug_Error("Init", "XFactor_Init", "SetNewExecutionFunction Failed");
+                            } else Debug_Error("Init", "XFactor_Init", "XFactor_SetNewStatus Failed");
+                        } else Debug_Error("Init", "XFactor_Init", "MotionControl_Init Failed");
                     } else Debug_Error("Init", "XFactor_Init", "Package_Init Failed");
                 } else Debug_Error("Init", "XFactor_Init", "Alarm_Init Failed");
             } else Debug_Error("Init", "XFactor_Init", "LEDS_Init Failed");
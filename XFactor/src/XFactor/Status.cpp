@@ -54,6 +54,7 @@ bool XFactor_SetNewStatus(XFactor_Status newStatus)
         case(XFactor_Status::PackageDropOffFailed):
         case(XFactor_Status::PackageExaminationFailed):
         case(XFactor_Status::PackagePickUpFailed):
+        case(XFactor_Status::PickingUpAPackage):
         case(XFactor_Status::PreparingForDropOff):
         case(XFactor_Status::PreparingForTheSearch):
         case(XFactor_Status::ReturningHome):